@@ -5,24 +5,28 @@
 
 struct printer_pool;
 struct timed_queue;
+struct job_dispatcher;
 struct simulation_parameters;
 struct simulation_statistics;
 
 // --- Autoscaling Thread Arguments ---
 typedef struct autoscaling_thread_args {
     pthread_mutex_t* job_queue_mutex;
-    pthread_mutex_t* stats_mutex;
-    pthread_mutex_t* simulation_state_mutex;
+    pthread_mutex_t* paper_refill_queue_mutex;
+    pthread_mutex_t* simulation_state_mutex; // protects terminate_now and all_jobs_served
+    pthread_cond_t* simulation_state_cv; // broadcast when one of them is set (see clock_sleep_unless)
     pthread_cond_t* job_queue_not_empty_cv;
     pthread_cond_t* refill_needed_cv;
     pthread_cond_t* refill_supplier_cv;
-    pthread_t* paper_refill_thread;
     struct timed_queue* job_queue;
+    struct job_dispatcher* dispatcher; // per-printer deques, NULL when all printers share job_queue
     struct linked_list* paper_refill_queue;
     struct simulation_parameters* params;
     struct simulation_statistics* stats;
     int* all_jobs_served;
     int* all_jobs_arrived;
+    int* terminate_now; // set to stop this run early (Ctrl+C, "stop")
+    int session_id; // log_router session of this run (see log_router_bind_session)
     struct printer_pool* pool;
 } autoscaling_thread_args_t;
 
@@ -30,11 +34,10 @@ typedef struct autoscaling_thread_args {
 
 /**
  * @brief Get the scale-up threshold based on current active printer count.
- * Uses stepped thresholds to prevent thrashing:
- * - 2 printers: threshold = 10
- * - 3 printers: threshold = 15
- * - 4 printers: threshold = 20
- * - 5 printers: no scaling (max capacity)
+ * The threshold grows with the pool to prevent thrashing:
+ * CONFIG_AUTOSCALE_THRESHOLD_PER_PRINTER jobs per active printer
+ * (10 for 2 printers, 15 for 3, ...). A single printer never scales up, and
+ * should_scale_up stops at the pool capacity (max_consumer_count).
  * 
  * @param active_printers Current number of active printers.
  * @return Queue length threshold for scaling up.
@@ -66,6 +69,7 @@ int should_scale_down(struct printer_pool* pool, int queue_length, unsigned long
 
 /**
  * @brief Scale up by adding one printer to the pool.
+ * With per-printer deques, the new printer's deque is filled by rebalancing.
  * @param args Autoscaling thread arguments containing all shared resources.
  * @return 1 on success, 0 on failure.
  */
@@ -73,6 +77,7 @@ int scale_up(autoscaling_thread_args_t* args);
 
 /**
  * @brief Scale down by removing the most recently added printer.
+ * With per-printer deques, the jobs left on its deque move to the remaining printers.
  * @param args Autoscaling thread arguments containing all shared resources.
  * @return 1 on success, 0 on failure.
  */
@@ -2,7 +2,6 @@
 #define COMMON_H
 
 extern int g_debug;
-extern int g_terminate_now;
 
 #ifndef TRUE
 #define FALSE 0
@@ -1,24 +1,131 @@
 #ifndef TIMEUTILS_H
 #define TIMEUTILS_H
 
+#include <pthread.h>
+#include <time.h>
+
 /**
  * @file timeutils.h
- * @brief Utility functions for time management in microseconds and milliseconds.
+ * @brief The simulation clock: current time, sleeps and timed waits in microseconds.
+ *
+ * Every component reads the time with get_time_in_us and waits with
+ * clock_sleep_until/clock_sleep_us/clock_timed_wait, all in simulated
+ * microseconds. The clock is CLOCK_MONOTONIC, so NTP or manual clock changes
+ * never make time jump (and the time-weighted queue area never goes negative).
  *
- * This header provides functions to get the current time in microseconds,
- * convert time from microseconds to milliseconds and microseconds, and
- * calculate wake-up times based on a given delay in milliseconds.
+ * clock_set_time_scale runs simulated time faster than wall-clock time: at a
+ * scale of 10 a 2 s print takes 0.2 s, yet get_time_in_us still advances
+ * 2 s across it, so every logged timestamp and statistic stays in simulated
+ * units. While a virtual clock is running on the calling thread (see
+ * virtual_clock_start), get_time_in_us returns the time the discrete-event
+ * engine has advanced to and the sleeps return at once.
  *
- * All time calculations are based on the `gettimeofday` function.
+ * Deadlines that pace I/O rather than the simulation (WebSocket batching, the
+ * log formatter) use get_unscaled_time_in_us and get_wake_up_time_us instead.
  */
 
 /**
- * @brief Get the current time in microseconds since the Epoch.
+ * @brief Get the current simulated time in microseconds.
  *
- * @return Current time in microseconds.
+ * @return Current time in microseconds (monotonic, not since the Epoch).
  */
 unsigned long get_time_in_us();
 
+/**
+ * @brief Get the current CLOCK_MONOTONIC time in microseconds, ignoring the
+ * time scale and any virtual clock.
+ *
+ * @return Current unscaled time in microseconds.
+ */
+unsigned long get_unscaled_time_in_us();
+
+/**
+ * @brief Run simulated time at scale times wall-clock speed from now on.
+ * get_time_in_us stays continuous across the change, and readers never see
+ * the new scale with the old origin. Call it while no simulation threads
+ * are sleeping, e.g. before a run starts.
+ *
+ * @param scale Simulated seconds per wall-clock second (1 = real time);
+ *              values <= 0 reset it to 1.
+ */
+void clock_set_time_scale(double scale);
+
+/**
+ * @brief Get the current time scale.
+ *
+ * @return Simulated seconds per wall-clock second.
+ */
+double clock_get_time_scale(void);
+
+/**
+ * @brief Sleep until get_time_in_us reaches wake_time_us. Returns at once if
+ * that time has passed. A cancellation point, like usleep.
+ *
+ * @param wake_time_us Simulated time to wake up at, in microseconds.
+ */
+void clock_sleep_until(unsigned long wake_time_us);
+
+/**
+ * @brief Sleep for duration_us of simulated time.
+ *
+ * @param duration_us Simulated duration in microseconds.
+ */
+void clock_sleep_us(unsigned long duration_us);
+
+/**
+ * @brief Sleep for duration_us of simulated time like clock_sleep_us, but
+ * return early once *stop is set. Lets a thread that must not be cancelled
+ * (a pooled worker, see worker_pool.h) be stopped in the middle of a sleep.
+ *
+ * @param duration_us Simulated duration in microseconds.
+ * @param stop Flag that ends the sleep, protected by mutex.
+ * @param mutex Mutex protecting *stop, not held by the caller.
+ * @param cv Condition variable initialized with clock_cond_init and broadcast after *stop is set.
+ * @return 1 if the whole duration passed, 0 if *stop was set.
+ */
+int clock_sleep_unless(unsigned long duration_us, const int* stop, pthread_mutex_t* mutex, pthread_cond_t* cv);
+
+/**
+ * @brief Initialize a condition variable that clock_timed_wait can wait on
+ * (its timeouts are measured on CLOCK_MONOTONIC).
+ *
+ * @param cv Condition variable to initialize.
+ * @return 0 on success, an error number otherwise (as pthread_cond_init).
+ */
+int clock_cond_init(pthread_cond_t* cv);
+
+/**
+ * @brief Wait on cv for at most timeout_us of simulated time.
+ *
+ * @param cv Condition variable initialized with clock_cond_init.
+ * @param mutex Mutex held by the caller, as for pthread_cond_timedwait.
+ * @param timeout_us Simulated timeout in microseconds.
+ * @return 0 if signalled, ETIMEDOUT on timeout (as pthread_cond_timedwait).
+ */
+int clock_timed_wait(pthread_cond_t* cv, pthread_mutex_t* mutex, unsigned long timeout_us);
+
+/**
+ * @brief Switch get_time_in_us over to a virtual clock that only moves when
+ * virtual_clock_advance is called. The virtual clock belongs to the calling
+ * thread; other threads keep reading the real clock.
+ *
+ * @param start_us Time the virtual clock starts at, in microseconds. Starting
+ *                 at the real time keeps "0 = never" timestamps meaningful.
+ */
+void virtual_clock_start(unsigned long start_us);
+
+/**
+ * @brief Move the virtual clock forward. Earlier times are ignored, so the clock never runs backwards.
+ *
+ * @param now_us New virtual time in microseconds.
+ */
+void virtual_clock_advance(unsigned long now_us);
+
+/**
+ * @brief Switch the calling thread's get_time_in_us back to the real clock.
+ */
+void virtual_clock_stop(void);
+
 /**
  * @brief Convert time from microseconds to milliseconds and microseconds.
  *
@@ -31,16 +138,17 @@ unsigned long get_time_in_us();
 void time_in_us_to_ms(unsigned long current_time_us, int* time_ms, int* time_us);
 
 /**
- * @brief Calculate the wake-up time based on a delay in milliseconds.
+ * @brief Calculate an absolute pthread_cond_timedwait deadline for a
+ * condition variable initialized with clock_cond_init.
  *
- * @param time_ms Delay time in milliseconds.
- * @return A timespec struct representing the wake-up time.
+ * @param timeout_us Unscaled delay in microseconds.
+ * @return A timespec struct representing the wake-up time on CLOCK_MONOTONIC.
  */
-struct timespec get_wake_up_time(int time_ms);
+struct timespec get_wake_up_time_us(unsigned long timeout_us);
 
-/** 
+/**
  * Format string for time output: "milliseconds.microseconds"
  */
 extern const char time_format[];
 
-#endif // TIMEUTILS_H
\ No newline at end of file
+#endif // TIMEUTILS_H
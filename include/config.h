@@ -19,6 +19,7 @@
 // Printer configuration
 #define CONFIG_DEFAULT_PRINT_RATE           5.0     // pages/second
 #define CONFIG_DEFAULT_CONSUMER_COUNT       2       // number of printers
+#define CONFIG_DEFAULT_MAX_CONSUMER_COUNT   5       // printer pool size (autoscaling ceiling)
 #define CONFIG_DEFAULT_AUTO_SCALING         1       // false (0) or true (1)
 #define CONFIG_DEFAULT_REFILL_RATE          25.0    // papers/second
 #define CONFIG_DEFAULT_PAPER_CAPACITY       150     // maximum papers per printer
@@ -32,6 +33,14 @@
 #define CONFIG_DEFAULT_MAX_QUEUE            -1      // -1 = unlimited queue size
 #define CONFIG_DEFAULT_MIN_PAPERS           5       // minimum pages per job
 #define CONFIG_DEFAULT_MAX_PAPERS           15      // maximum pages per job
+#define CONFIG_DEFAULT_QUEUE_BACKEND        0       // 0 = linked list, 1 = lock-free ring
+#define CONFIG_DEFAULT_PREMIUM_JOB_PERCENT  0       // share of jobs in the premium class
+#define CONFIG_DEFAULT_BULK_JOB_PERCENT     0       // share of jobs in the bulk class
+#define CONFIG_DEFAULT_PRINTER_BATCH_SIZE   1       // jobs claimed per queue lock (1 = one at a time)
+#define CONFIG_DEFAULT_JOB_BURST_SIZE       1       // jobs arriving at the same instant (1 = no bursts)
+#define CONFIG_DEFAULT_DISPATCH_MODE        0       // 0 = shared queue, 1 = round-robin deques, 2 = shortest deque
+#define CONFIG_DEFAULT_ENGINE               0       // 0 = real-time threads, 1 = virtual-time event engine
+#define CONFIG_DEFAULT_TIME_SCALE           1.0     // simulated seconds per wall-clock second (1 = real time)
 
 // UI display flags
 #define CONFIG_DEFAULT_SHOW_TIME            1       // true
@@ -49,7 +58,7 @@
 
 // Consumer count range (number of printers)
 #define CONFIG_RANGE_CONSUMER_COUNT_MIN     1
-#define CONFIG_RANGE_CONSUMER_COUNT_MAX     5
+#define CONFIG_RANGE_CONSUMER_COUNT_MAX     512     // also bounds max_consumer_count
 
 // Refill rate range (papers/second)
 #define CONFIG_RANGE_REFILL_RATE_MIN        15.0
@@ -79,6 +88,129 @@
 #define CONFIG_RANGE_MAX_PAPERS_MIN         15
 #define CONFIG_RANGE_MAX_PAPERS_MAX         30
 
+// Time scale range (simulated seconds per wall-clock second)
+#define CONFIG_RANGE_TIME_SCALE_MIN         1.0
+#define CONFIG_RANGE_TIME_SCALE_MAX         1000.0
+
+// ============================================================================
+// JOB QUEUE CONFIGURATION
+// ============================================================================
+
+// Ring backend capacity when the queue is unlimited (-1); rounded up to a power of two
+#define CONFIG_RING_QUEUE_DEFAULT_CAPACITY  4096
+
+// Service classes (premium, standard, bulk) and their weighted round-robin
+// shares: a printer takes up to WEIGHT consecutive jobs from a class before
+// moving on to the next non-empty class
+#define CONFIG_JOB_CLASS_COUNT              3
+#define CONFIG_JOB_CLASS_WEIGHT_PREMIUM     4
+#define CONFIG_JOB_CLASS_WEIGHT_STANDARD    2
+#define CONFIG_JOB_CLASS_WEIGHT_BULK        1
+
+// Most jobs a printer may claim per job_queue_mutex acquisition (-printer_batch)
+#define CONFIG_PRINTER_BATCH_MAX            8
+
+// Most jobs the receiver admits per burst, i.e. per job_queue_mutex acquisition (-burst)
+#define CONFIG_JOB_BURST_MAX                64
+
+// Initial size of the job id index (list backend); it grows with the queue
+#define CONFIG_JOB_INDEX_INITIAL_CAPACITY   64
+
+// Per-printer deques (-dispatch rr|shortest): how long an idle printer waits on
+// its own deque before trying to steal from the other deques again
+#define CONFIG_DISPATCH_STEAL_RETRY_US      10000    // 10 ms
+
+// Per-printer records (pool slots, statistics, deques) are padded to this size
+// so printers updating their own record never share a cache line
+#define CONFIG_CACHE_LINE_SIZE              64
+
+// ============================================================================
+// LOGGING CONFIGURATION
+// ============================================================================
+
+// Event records queued between the simulation threads and the log formatter
+// thread (rounded up to a power of two). A producer that finds every record
+// in use yields until the formatter frees one; events are never dropped.
+#define CONFIG_LOG_EVENT_QUEUE_CAPACITY     4096
+
+// Longest the idle formatter thread sleeps before re-checking the queue
+#define CONFIG_LOG_FORMATTER_IDLE_WAIT_US   10000    // 10 ms
+
+// Stats updates are published on a fixed tick rather than per event: simulation
+// threads only mark the statistics dirty, and the formatter thread sends one
+// snapshot per interval at most (about 30 per second, as fast as a UI redraws)
+#define CONFIG_STATS_PUBLISH_INTERVAL_MS    33
+
+// Sessions whose events the log router keeps apart: each has its own stats
+// tick and subscriber flag (bin/cli runs everything as session 0)
+#define CONFIG_LOG_MAX_SESSIONS             8
+
+// ============================================================================
+// WEBSOCKET CONFIGURATION
+// ============================================================================
+
+// Server event loop poll interval while no outbound batch is pending (milliseconds)
+#define CONFIG_WS_POLL_INTERVAL_MS          100
+
+// Protocol 2 (batched frames, see the "hello" command): a batch is sent once
+// its oldest message is this old or the frame reaches this size. A client can
+// override both in its "hello", within the ranges below.
+#define CONFIG_WS_BATCH_WINDOW_MS           20
+#define CONFIG_WS_BATCH_MAX_BYTES           16384
+
+#define CONFIG_RANGE_WS_BATCH_WINDOW_MS_MIN 1
+#define CONFIG_RANGE_WS_BATCH_WINDOW_MS_MAX 1000
+#define CONFIG_RANGE_WS_BATCH_MAX_BYTES_MIN 1024
+#define CONFIG_RANGE_WS_BATCH_MAX_BYTES_MAX 1048576
+
+// Messages queued between the formatter thread and the event loop (rounded up
+// to a power of two). Past this the formatter drops per-job log lines and
+// queues other messages on an overflow list; it never waits for the loop
+#define CONFIG_WS_OUTBOX_CAPACITY           4096
+
+// Websocket clients (dashboards) connected at once, across all sessions
+#define CONFIG_WS_MAX_CLIENTS               16
+
+// Simulations the server runs at once. Clients that connect with the same
+// ?session=<key> share one simulation; a client without a key gets its own.
+#define CONFIG_WS_MAX_SESSIONS              CONFIG_LOG_MAX_SESSIONS
+#define CONFIG_WS_SESSION_KEY_MAX           64
+
+// Threads the server keeps for the sessions' job receivers, refillers, printers
+// and autoscalers. They are started on demand and reused by later runs; a run
+// needs max_consumer_count + 3 of them.
+#define CONFIG_WORKER_POOL_MAX_THREADS      1024
+
+// A client's messages move from its queue into its send buffer only while the
+// buffer holds at most this many bytes, so one slow client never stalls the rest
+#define CONFIG_WS_SEND_HIGH_WATER_BYTES     262144
+
+// Per-client queue of messages waiting for room in the send buffer. Once it
+// holds CONFIG_WS_CLIENT_LOSSY_THRESHOLD messages, the client gets only one in
+// CONFIG_WS_CLIENT_LOSSY_KEEP_EVERY per-job log lines; a client that fills the
+// whole queue is disconnected. stats_update is held back until the queue is empty.
+#define CONFIG_WS_CLIENT_QUEUE_LIMIT        4096
+#define CONFIG_WS_CLIENT_LOSSY_THRESHOLD    512
+#define CONFIG_WS_CLIENT_LOSSY_KEEP_EVERY   4
+
+// With "statsDelta" on the start command, stats_update frames carry only the
+// fields that changed; every this-many frames a client gets a full keyframe
+#define CONFIG_WS_STATS_KEYFRAME_INTERVAL   10
+
+// permessage-deflate, used when the client offers it on upgrade (browsers do).
+// Level 3 with a 13-bit (8 KB) window keeps a 10k-job stream at 13-18% of its
+// size for about 1-4 us of CPU per event; levels 6-9 and the 15-bit window save
+// a few more percent for up to twice the CPU or memory (tests/bench_ws_deflate).
+// Messages shorter than CONFIG_WS_DEFLATE_MIN_BYTES are sent as they are.
+#define CONFIG_WS_DEFLATE_ENABLED           1
+#define CONFIG_WS_DEFLATE_LEVEL             3
+#define CONFIG_WS_DEFLATE_WINDOW_BITS       13
+#define CONFIG_WS_DEFLATE_MEM_LEVEL         8
+#define CONFIG_WS_DEFLATE_MIN_BYTES         64
+
+// Largest client command accepted once inflated (bytes)
+#define CONFIG_WS_DEFLATE_MAX_INFLATED      65536
+
 // ============================================================================
 // AUTOSCALING CONFIGURATION
 // ============================================================================
@@ -98,9 +230,28 @@
 // Autoscaling monitoring interval (microseconds)
 #define CONFIG_AUTOSCALE_CHECK_INTERVAL_US  1000000  // 1 second
 
-// Stepped scale-up thresholds (queue length based on active printer count)
-#define CONFIG_AUTOSCALE_THRESHOLD_2_PRINTERS  10
-#define CONFIG_AUTOSCALE_THRESHOLD_3_PRINTERS  15
-#define CONFIG_AUTOSCALE_THRESHOLD_4_PRINTERS  20
+// Scale-up threshold: add a printer once the queue holds this many jobs per
+// active printer (10 jobs for 2 printers, 15 for 3, ...). A single printer
+// never scales up.
+#define CONFIG_AUTOSCALE_THRESHOLD_PER_PRINTER  5
+#define CONFIG_AUTOSCALE_MIN_SCALING_PRINTERS   2
+
+// ============================================================================
+// VIRTUAL-TIME ENGINE CONFIGURATION
+// ============================================================================
+
+// The virtual-time engine (-engine virtual) runs every component on one thread
+// and checks for Ctrl+C once per this many events
+#define CONFIG_VIRTUAL_ENGINE_SIGNAL_POLL_EVENTS  256
+
+// ============================================================================
+// PARAMETER SWEEP CONFIGURATION
+// ============================================================================
+
+// bin/sweep: most swept options, values per option, grid points per sweep and worker threads
+#define CONFIG_SWEEP_MAX_AXES               8
+#define CONFIG_SWEEP_MAX_VALUES             64
+#define CONFIG_SWEEP_MAX_POINTS             100000
+#define CONFIG_SWEEP_MAX_WORKERS            256
 
 #endif // CONFIG_H
@@ -0,0 +1,71 @@
+#ifndef EVENT_HEAP_H
+#define EVENT_HEAP_H
+
+/**
+ * @file event_heap.h
+ * @brief Binary min-heap of timestamped events for the discrete-event engine.
+ *
+ * Events come out in time order. Events scheduled for the same time come out
+ * in the order they were pushed (a sequence number breaks ties), so a run is
+ * reproducible for a given random seed.
+ *
+ * @note The heap grows (doubling) when full; it never shrinks. It does not
+ *       manage the memory its events point to and is not thread-safe.
+ */
+
+// --- Data Structures ---
+typedef struct event_heap_entry {
+    unsigned long time_us; // when the event happens
+    unsigned long seq; // push order, breaks ties between events at the same time
+    int type; // caller-defined event kind
+    void* arg; // caller-defined payload
+} event_heap_entry_t;
+
+typedef struct event_heap {
+    event_heap_entry_t* entries;
+    int length;
+    int capacity;
+    unsigned long next_seq;
+} event_heap_t;
+
+// --- Function Declarations ---
+/**
+ * @brief Initialize an EventHeap with room for capacity events before growing.
+ * @param heap Pointer to the EventHeap to initialize.
+ * @param capacity Expected number of pending events.
+ * @return 1 on success, 0 on failure (e.g., memory allocation failure).
+ */
+int event_heap_init(event_heap_t* heap, int capacity);
+
+/**
+ * @brief Release the storage of an EventHeap.
+ * @param heap Pointer to the EventHeap.
+ */
+void event_heap_destroy(event_heap_t* heap);
+
+/**
+ * @brief Schedule an event.
+ * @param heap Pointer to the EventHeap.
+ * @param time_us When the event happens, in microseconds.
+ * @param type Caller-defined event kind.
+ * @param arg Caller-defined payload.
+ * @return 1 on success, 0 on failure (failed growth).
+ */
+int event_heap_push(event_heap_t* heap, unsigned long time_us, int type, void* arg);
+
+/**
+ * @brief Remove the earliest event.
+ * @param heap Pointer to the EventHeap.
+ * @param out Receives the event.
+ * @return 1 if an event was removed, 0 if the heap is empty.
+ */
+int event_heap_pop(event_heap_t* heap, event_heap_entry_t* out);
+
+/**
+ * @brief Get the number of pending events.
+ * @param heap Pointer to the EventHeap.
+ * @return The number of pending events.
+ */
+int event_heap_length(const event_heap_t* heap);
+
+#endif // EVENT_HEAP_H
@@ -0,0 +1,79 @@
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include <stddef.h>
+
+/**
+ * @file hash_index.h
+ * @brief Open-addressing hash map from integer ids to object pointers.
+ *
+ * Used by TimedQueue to find queued nodes by id in O(1). Collisions are
+ * resolved with linear probing and removals use backward-shift deletion,
+ * so there are no tombstones and lookups never slow down over time.
+ *
+ * @note The table grows (doubling) when it becomes half full; it never shrinks.
+ *
+ * @note Like the LinkedList, the index does not manage the memory of the
+ *       objects it points to. It is not thread-safe; callers guard it with
+ *       the lock that already protects the indexed container.
+ */
+
+// --- Data Structures ---
+typedef struct hash_index_slot {
+    int key;
+    void* value; // NULL marks an empty slot
+} hash_index_slot_t;
+
+typedef struct hash_index {
+    hash_index_slot_t* slots;
+    size_t capacity; // always a power of two
+    size_t count;
+} hash_index_t;
+
+// --- Function Declarations ---
+/**
+ * @brief Initialize a HashIndex with room for at least capacity entries before growing.
+ * @param index Pointer to the HashIndex to initialize.
+ * @param capacity Expected number of entries.
+ * @return 1 on success, 0 on failure (e.g., memory allocation failure).
+ */
+int hash_index_init(hash_index_t* index, size_t capacity);
+
+/**
+ * @brief Release the slot storage of a HashIndex.
+ * @param index Pointer to the HashIndex.
+ */
+void hash_index_destroy(hash_index_t* index);
+
+/**
+ * @brief Insert or replace the value stored for a key.
+ * @param index Pointer to the HashIndex.
+ * @param key Integer key.
+ * @param value Non-NULL pointer to store.
+ * @return 1 on success, 0 on failure (e.g., NULL value or failed growth).
+ */
+int hash_index_put(hash_index_t* index, int key, void* value);
+
+/**
+ * @brief Look up the value stored for a key.
+ * @param index Pointer to the HashIndex.
+ * @param key Integer key.
+ * @return The stored pointer, or NULL if the key is not present.
+ */
+void* hash_index_get(hash_index_t* index, int key);
+
+/**
+ * @brief Remove a key from the index.
+ * @param index Pointer to the HashIndex.
+ * @param key Integer key.
+ * @return The pointer that was stored, or NULL if the key was not present.
+ */
+void* hash_index_remove(hash_index_t* index, int key);
+
+/**
+ * @brief Remove every entry without releasing the slot storage.
+ * @param index Pointer to the HashIndex.
+ */
+void hash_index_clear(hash_index_t* index);
+
+#endif // HASH_INDEX_H
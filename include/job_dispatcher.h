@@ -0,0 +1,179 @@
+#ifndef JOB_DISPATCHER_H
+#define JOB_DISPATCHER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "config.h"
+#include "timed_queue.h"
+
+/**
+ * @file job_dispatcher.h
+ * @brief Per-printer job deques with work stealing.
+ *
+ * Instead of one shared job queue behind one mutex, every printer slot owns a
+ * deque guarded by its own mutex. The job receiver places each job on one
+ * deque (round-robin or shortest deque first), the owning printer takes jobs
+ * from the front, and a printer whose deque is empty steals from the back of
+ * the deepest other deque.
+ *
+ * Every operation holds at most one deque mutex, except moving jobs between
+ * deques (closing or rebalancing), which locks both deques in index order.
+ *
+ * @note Like the TimedQueue, the dispatcher does not own the jobs: the deques
+ *       are intrusive and link the caller's embedded nodes.
+ */
+
+// --- Dispatch modes (simulation_parameters_t.dispatch_mode) ---
+#define JOB_DISPATCH_SHARED          0 // one shared job queue, no dispatcher
+#define JOB_DISPATCH_ROUND_ROBIN     1 // jobs go to the open deques in turn
+#define JOB_DISPATCH_SHORTEST_QUEUE  2 // jobs go to the open deque with the fewest jobs
+
+// --- Data Structures ---
+typedef struct printer_deque {
+    // Each deque starts on its own cache line so printers never share one
+    _Alignas(CONFIG_CACHE_LINE_SIZE) pthread_mutex_t mutex;
+    pthread_cond_t not_empty_cv; // signalled when a job lands on this deque
+    timed_queue_t queue; // intrusive list with an id index
+    atomic_int depth; // mirror of the queue length, readable without the mutex
+    atomic_int open; // 1 while the owning printer is running
+} printer_deque_t;
+
+typedef struct job_dispatcher {
+    printer_deque_t* deques; // one per printer pool slot, allocated by job_dispatcher_init
+    int deque_count;
+    int policy; // JOB_DISPATCH_ROUND_ROBIN or JOB_DISPATCH_SHORTEST_QUEUE
+    atomic_uint next_deque; // round-robin cursor
+    atomic_int length; // jobs across all deques
+} job_dispatcher_t;
+
+// --- Function Declarations ---
+/**
+ * @brief Initialize a JobDispatcher with every deque empty and closed.
+ * @param d Pointer to the JobDispatcher to initialize.
+ * @param policy JOB_DISPATCH_ROUND_ROBIN or JOB_DISPATCH_SHORTEST_QUEUE.
+ * @param deque_count Number of deques (the printer pool capacity).
+ * @param key_of Returns the id of the object that embeds a node (for job_dispatcher_remove_by_id).
+ * @param index_capacity Initial size of each deque's id index.
+ * @return 1 on success, 0 on failure (e.g., invalid policy or memory allocation failure).
+ */
+int job_dispatcher_init(job_dispatcher_t* d, int policy, int deque_count,
+                        int (*key_of)(const list_node_t* node), int index_capacity);
+
+/**
+ * @brief Release and free the deques of a JobDispatcher. Does not free the linked objects.
+ * @param d Pointer to the JobDispatcher.
+ */
+void job_dispatcher_destroy(job_dispatcher_t* d);
+
+/**
+ * @brief Mark a deque as accepting new jobs (its printer has started).
+ * @param d Pointer to the JobDispatcher.
+ * @param idx Zero-based deque index (printer id - 1).
+ */
+void job_dispatcher_open(job_dispatcher_t* d, int idx);
+
+/**
+ * @brief Stop placing jobs on a deque and move the jobs it still holds to the open deques,
+ * an even share to each, keeping their arrival order.
+ * Call after its printer has stopped (e.g. on scale-down).
+ * @param d Pointer to the JobDispatcher.
+ * @param idx Zero-based deque index.
+ * @return The number of jobs moved.
+ */
+int job_dispatcher_close(job_dispatcher_t* d, int idx);
+
+/**
+ * @brief Even out the open deques by moving runs of jobs from the back of the deepest
+ * deque to the shallowest one, in arrival order, until they differ by at most one job.
+ * Call after a deque is opened mid-run (e.g. on scale-up).
+ * @param d Pointer to the JobDispatcher.
+ * @return The number of jobs moved.
+ */
+int job_dispatcher_rebalance(job_dispatcher_t* d);
+
+/**
+ * @brief Place a node on the deque picked by the dispatch policy and wake its printer.
+ * Falls back to deque 0 if no deque is open yet.
+ * @param d Pointer to the JobDispatcher.
+ * @param node Pointer to the embedded ListNode to enqueue.
+ * @return The index of the deque that received the node, or -1 on failure.
+ */
+int job_dispatcher_push(job_dispatcher_t* d, list_node_t* node);
+
+/**
+ * @brief Take up to max nodes from the front of a printer's own deque.
+ * Stops at the first node that accept rejects (see timed_queue_dequeue_batch_while).
+ * @param d Pointer to the JobDispatcher.
+ * @param idx Zero-based index of the caller's deque.
+ * @param out Array receiving the removed ListNodes.
+ * @param max Capacity of out.
+ * @param accept Callback returning 1 to take the node, 0 to stop; NULL accepts all.
+ * @param ctx Caller data passed to accept.
+ * @return The number of nodes taken.
+ */
+int job_dispatcher_take(job_dispatcher_t* d, int idx, list_node_t** out, int max,
+                        int (*accept)(list_node_t* node, void* ctx), void* ctx);
+
+/**
+ * @brief Steal one node from the back of the deepest other deque.
+ * The deepest deque is tried first, then the others in index order after it;
+ * a victim whose back node accept rejects is skipped.
+ * @param d Pointer to the JobDispatcher.
+ * @param thief Zero-based index of the caller's deque (never used as a victim).
+ * @param accept Callback returning 1 to take the node, 0 to skip the victim; NULL accepts all.
+ * @param ctx Caller data passed to accept.
+ * @return Pointer to the stolen ListNode, or NULL if there was nothing to steal.
+ */
+list_node_t* job_dispatcher_steal(job_dispatcher_t* d, int thief,
+                                  int (*accept)(list_node_t* node, void* ctx), void* ctx);
+
+/**
+ * @brief Block until a job lands on the caller's deque or timeout_us elapses.
+ * Returns immediately if the deque is not empty. The timeout lets an idle
+ * printer retry stealing from busier deques.
+ * @param d Pointer to the JobDispatcher.
+ * @param idx Zero-based index of the caller's deque.
+ * @param timeout_us Longest time to wait, in microseconds.
+ */
+void job_dispatcher_wait(job_dispatcher_t* d, int idx, unsigned long timeout_us);
+
+/**
+ * @brief Wake every printer blocked in job_dispatcher_wait (e.g. on termination).
+ * @param d Pointer to the JobDispatcher.
+ */
+void job_dispatcher_wake_all(job_dispatcher_t* d);
+
+/**
+ * @brief Remove the node with the given id from whichever deque holds it.
+ * @param d Pointer to the JobDispatcher.
+ * @param id Id of the object to remove.
+ * @return Pointer to the unlinked ListNode, or NULL if no deque holds the id.
+ */
+list_node_t* job_dispatcher_remove_by_id(job_dispatcher_t* d, int id);
+
+/**
+ * @brief Remove every node from every deque, front first, passing each to drop.
+ * @param d Pointer to the JobDispatcher.
+ * @param drop Callback receiving each removed node (e.g. to log and free the job).
+ * @param ctx Caller data passed to drop.
+ * @return The number of nodes removed.
+ */
+int job_dispatcher_drain(job_dispatcher_t* d, void (*drop)(list_node_t* node, void* ctx), void* ctx);
+
+/**
+ * @brief Get the number of jobs across all deques.
+ * @param d Pointer to the JobDispatcher.
+ * @return The total number of queued jobs.
+ */
+int job_dispatcher_length(job_dispatcher_t* d);
+
+/**
+ * @brief Get the queue-length area summed over all deques (see timed_queue_area_us).
+ * The area of the total length is the sum of the per-deque areas.
+ * @param d Pointer to the JobDispatcher.
+ * @return Integral of the total queue length over time, in job x microseconds.
+ */
+unsigned long job_dispatcher_area_us(job_dispatcher_t* d);
+
+#endif // JOB_DISPATCHER_H
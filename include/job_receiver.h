@@ -3,16 +3,27 @@
 
 # include <pthread.h>
 
+#include "config.h"
+#include "linked_list.h"
+
 struct timed_queue;
+struct job_dispatcher;
 struct simulation_parameters;
 struct simulation_statistics;
 
+// --- Service classes (lower value = served first when placing jobs in the queue) ---
+#define JOB_CLASS_PREMIUM  0
+#define JOB_CLASS_STANDARD 1
+#define JOB_CLASS_BULK     2
+#define JOB_CLASS_COUNT    CONFIG_JOB_CLASS_COUNT
+
 // --- Job structure ---
 typedef struct job {
     // --- Job Attributes ---
     int id;
     int inter_arrival_time_us; // time between this job and the previous job
     int papers_required; // number of papers required by the job
+    int service_class; // JOB_CLASS_PREMIUM, JOB_CLASS_STANDARD or JOB_CLASS_BULK
     
     // --- Service Attributes ---
     int service_time_requested_ms; // time required to service the job depending on papers required
@@ -23,11 +34,15 @@ typedef struct job {
     unsigned long queue_departure_time_us; // time job left service queue
     unsigned long service_arrival_time_us; // time job started being serviced
     unsigned long service_departure_time_us; // time job left the system
+
+    // --- Queue Links ---
+    list_node_t node; // embedded job queue node, see list_init_intrusive
 } job_t;
 
 // --- Utility functions ---
 /**
  * @brief Initializes a Job struct with given parameters.
+ * The job starts in the standard service class.
  *
  * @param job Pointer to the Job struct to initialize.
  * @param job_id Unique identifier for the job.
@@ -44,6 +59,55 @@ int init_job(job_t* job, int job_id, int inter_arrival_time_us, int papers_requi
  * @param stats Pointer to the simulation_statistics struct to update.
  */
 void drop_job_from_system(job_t* job, unsigned long previous_job_arrival_time_us, struct simulation_statistics* stats);
+/**
+ * @brief Returns the id of the job that embeds a queue node (key for the job id index).
+ * @param node Pointer to the node embedded in a Job.
+ * @return The job id.
+ */
+int job_queue_key(const list_node_t* node);
+
+/**
+ * @brief Returns the service class of the job that embeds a queue node.
+ * @param node Pointer to the node embedded in a Job.
+ * @return The job's service class.
+ */
+int job_queue_class(const list_node_t* node);
+
+/**
+ * @brief Picks a service class for a new job from the configured class percentages.
+ * @param params Pointer to the simulation parameters.
+ * @return JOB_CLASS_PREMIUM, JOB_CLASS_STANDARD or JOB_CLASS_BULK.
+ */
+int pick_job_class(const struct simulation_parameters* params);
+
+/**
+ * @brief Initializes the (intrusive) job queue with the backend selected in the simulation parameters.
+ * Jobs are linked through their embedded node with timed_queue_enqueue_node.
+ * The list backend also gets a job id index for timed_queue_find_by_id/remove_by_id
+ * and serves the service classes by weighted round-robin; the ring backend stays FIFO.
+ * The ring backend is sized from queue_capacity, or CONFIG_RING_QUEUE_DEFAULT_CAPACITY when unlimited.
+ * @param job_queue Pointer to the TimedQueue to initialize.
+ * @param params Pointer to the simulation parameters.
+ * @return 1 on success, 0 on failure.
+ */
+int job_queue_init(struct timed_queue* job_queue, const struct simulation_parameters* params);
+
+/**
+ * @brief Returns the number of jobs waiting for a printer, wherever they are queued.
+ * @param job_queue Pointer to the shared job queue.
+ * @param dispatcher Pointer to the per-printer deques, or NULL in shared dispatch mode.
+ * @return The length of the dispatcher's deques if dispatcher is set, else of job_queue.
+ */
+int job_backlog_length(struct timed_queue* job_queue, struct job_dispatcher* dispatcher);
+
+/**
+ * @brief Returns the queue-length area of the jobs waiting for a printer (see timed_queue_area_us).
+ * @param job_queue Pointer to the shared job queue.
+ * @param dispatcher Pointer to the per-printer deques, or NULL in shared dispatch mode.
+ * @return The area in job x microseconds.
+ */
+unsigned long job_backlog_area_us(struct timed_queue* job_queue, struct job_dispatcher* dispatcher);
+
 /**
  * @brief Prints job details for debugging purposes.
  * @param job Pointer to the Job struct to print.
@@ -56,15 +120,43 @@ void debug_job(job_t* job);
  */
 typedef struct job_thread_args {
     pthread_mutex_t* job_queue_mutex;
-    pthread_mutex_t* stats_mutex;
-    pthread_mutex_t* simulation_state_mutex; // protects all_jobs_arrived and g_terminate_now
+    pthread_mutex_t* simulation_state_mutex; // protects all_jobs_arrived and terminate_now
+    pthread_cond_t* simulation_state_cv; // broadcast when one of them is set (see clock_sleep_unless)
     pthread_cond_t* job_queue_not_empty_cv;
     struct timed_queue* job_queue;
+    struct job_dispatcher* dispatcher; // per-printer deques, NULL when all printers share job_queue
     struct simulation_parameters* simulation_params;
     struct simulation_statistics* stats;
     int* all_jobs_arrived;
+    int* terminate_now; // set to stop this run early (Ctrl+C, "stop")
+    int session_id; // log_router session of this run (see log_router_bind_session)
+    unsigned int random_seed; // seeds the receiver's job stream at the start of the run
 } job_thread_args_t;
 
+// --- Arrival steps (shared by the receiver thread and the virtual-time engine) ---
+/**
+ * @brief Allocates the jobs of the next burst (one job unless -burst is set),
+ * drawing each job's papers and service class.
+ *
+ * @param params Pointer to the simulation parameters.
+ * @param burst Array of at least CONFIG_JOB_BURST_MAX entries receiving the jobs.
+ * @param job_id Id of the last job created; advanced past the new jobs.
+ * @return The number of jobs created (0 once num_jobs have been created).
+ */
+int job_receiver_create_burst(const struct simulation_parameters* params, job_t** burst, int* job_id);
+
+/**
+ * @brief Logs the arrival of a burst at the current time, queues the jobs that
+ * fit (waking one idle printer per job) and drops the rest.
+ *
+ * @param args Receiver arguments (queue or dispatcher, its mutex and condition variable, stats).
+ * @param burst The jobs of the burst; all are queued or freed.
+ * @param burst_count Number of jobs in burst.
+ * @param previous_job_arrival_time_us Arrival time of the previous burst; set to this burst's.
+ */
+void job_receiver_admit_burst(job_thread_args_t* args, job_t** burst, int burst_count,
+                              unsigned long* previous_job_arrival_time_us);
+
 // --- Thread function ---
 /**
  * @brief Function executed by the job receiver thread.
@@ -1,6 +1,8 @@
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
 
+#include <stddef.h>
+
 /** 
  * @file linked_list.h
  * @brief Header file for linked_list.c, containing function declarations
@@ -10,8 +12,31 @@
  *
  * @note The list does not manage the memory of the objects it contains;
  *       it is the caller's responsibility to free the objects if needed.
+ *
+ * @note Nodes come from a per-list free-list pool. Nodes returned by
+ *       list_pop/list_pop_left must be handed back with list_release_node
+ *       (not free) so the next append can reuse them without a malloc.
+ *       The pool is protected by whatever lock already protects the list.
+ *
+ * @note A list set up with list_init_intrusive links nodes that the caller
+ *       embeds in its own objects (e.g. the node member of job_t). Nodes are
+ *       linked with list_append_node/list_append_node_left and are never
+ *       allocated, pooled or freed by the list; list_entry recovers the
+ *       containing object from a node without dereferencing node->data.
  */
 
+// Upper bound on recycled nodes kept per list; extra nodes are freed
+#define LIST_NODE_POOL_MAX 1024
+
+/**
+ * @brief Get a pointer to the object that embeds a list node.
+ * @param node Pointer to the embedded ListNode.
+ * @param type Type of the containing object.
+ * @param member Name of the list_node_t member inside type.
+ */
+#define list_entry(node, type, member) \
+    ((type*)((char*)(node) - offsetof(type, member)))
+
 // --- Data Structures ---
 typedef struct list_node {
     void* data;
@@ -23,6 +48,13 @@ typedef struct linked_list {
     int members_count;
     list_node_t head;
     list_node_t tail;
+    int intrusive; // nodes are owned by the caller, see list_init_intrusive
+
+    // --- Node pool ---
+    list_node_t* free_nodes; // singly linked through next
+    int free_count;
+    unsigned long pool_hits; // appends served from the pool
+    unsigned long pool_misses; // appends that had to malloc
 } linked_list_t;
 
 // --- Function Declarations ---
@@ -56,6 +88,29 @@ int  list_append(linked_list_t* list, void* data);
  */
 int  list_append_left(linked_list_t* list, void* data);
 
+/**
+ * @brief Link a caller-owned node to the end of an intrusive list.
+ * The node's data field is left as the caller set it.
+ * @param list Pointer to the LinkedList.
+ * @param node Pointer to the ListNode to link; must not already be in a list.
+ */
+void list_append_node(linked_list_t* list, list_node_t* node);
+
+/**
+ * @brief Link a caller-owned node to the beginning of an intrusive list.
+ * @param list Pointer to the LinkedList.
+ * @param node Pointer to the ListNode to link; must not already be in a list.
+ */
+void list_append_node_left(linked_list_t* list, list_node_t* node);
+
+/**
+ * @brief Link a caller-owned node right after another node of an intrusive list.
+ * @param list Pointer to the LinkedList.
+ * @param prev Node to insert after; may be &list->head to insert at the front.
+ * @param node Pointer to the ListNode to link; must not already be in a list.
+ */
+void list_insert_node_after(linked_list_t* list, list_node_t* prev, list_node_t* node);
+
 /**
  * @brief Remove and return the last object from the list.
  * @param list Pointer to the LinkedList.
@@ -70,6 +125,22 @@ list_node_t* list_pop(linked_list_t* list);
  */
 list_node_t* list_pop_left(linked_list_t* list);
 
+/**
+ * @brief Return a node obtained from list_pop/list_pop_left to the list's pool.
+ * No-op for intrusive lists, whose nodes belong to the caller.
+ * @param list Pointer to the LinkedList the node was popped from.
+ * @param node Pointer to the ListNode to recycle.
+ */
+void list_release_node(linked_list_t* list, list_node_t* node);
+
+/**
+ * @brief Unlink a specific node without recycling it.
+ * The caller owns the node afterwards, exactly as if it had been popped.
+ * @param list Pointer to the LinkedList.
+ * @param node Pointer to the ListNode to unlink.
+ */
+void list_unlink(linked_list_t* list, list_node_t* node);
+
 /**
  * @brief Remove a specific node from the list.
  * @param list Pointer to the LinkedList.
@@ -127,4 +198,18 @@ list_node_t* list_find(linked_list_t* list, void* data);
  */
 int list_init(linked_list_t* list);
 
+/**
+ * @brief Initialize a LinkedList whose nodes are embedded in the caller's objects.
+ * list_append/list_append_left fail on such a list; use list_append_node instead.
+ * @param list Pointer to the LinkedList to initialize.
+ * @return 1 on success, 0 on failure.
+ */
+int list_init_intrusive(linked_list_t* list);
+
+/**
+ * @brief Clear the list and free every pooled node.
+ * @param list Pointer to the LinkedList.
+ */
+void list_destroy(linked_list_t* list);
+
 #endif // LINKED_LIST_H
\ No newline at end of file
@@ -14,41 +14,86 @@ struct timed_queue;
 #define LOG_MODE_TERMINAL 0
 #define LOG_MODE_SERVER   1
 
-// Unified logging operations vtable
+// --- Event types (log_event_t.type) ---
+#define LOG_EVENT_SYSTEM_ARRIVAL          1
+#define LOG_EVENT_DROPPED_JOB             2
+#define LOG_EVENT_REMOVED_JOB             3
+#define LOG_EVENT_QUEUE_ARRIVAL           4
+#define LOG_EVENT_QUEUE_DEPARTURE         5
+#define LOG_EVENT_JOB_UPDATE              6
+#define LOG_EVENT_PRINTER_ARRIVAL         7
+#define LOG_EVENT_SYSTEM_DEPARTURE        8
+#define LOG_EVENT_PAPER_EMPTY             9
+#define LOG_EVENT_PAPER_REFILL_START      10
+#define LOG_EVENT_PAPER_REFILL_END        11
+#define LOG_EVENT_SCALE_UP                12
+#define LOG_EVENT_SCALE_DOWN              13
+#define LOG_EVENT_PRINTER_IDLE            14
+#define LOG_EVENT_PRINTER_BUSY            15
+#define LOG_EVENT_PRINTER_WAITING_REFILL  16
+#define LOG_EVENT_STATS_UPDATE            17
+#define LOG_EVENT_JOBS_UPDATE             18
+
+// One queued job in a LOG_EVENT_JOBS_UPDATE snapshot
+typedef struct log_job_ref {
+    int id;
+    int papers_required;
+} log_job_ref_t;
+
+/**
+ * @brief A compact copy of everything a backend needs to format one event.
+ * The router fills it on the emitting thread, so the job or printer it
+ * describes may change or be freed before the event is formatted.
+ * Fields an event does not use are zero.
+ */
+typedef struct log_event {
+    int type;                  // LOG_EVENT_*
+    int job_id;
+    int printer_id;
+    int papers;                // papers required, papers to refill, or papers left in the printer
+    int queue_length;          // jobs queued when the event happened
+    int count;                 // new printer count (scale events) or jobs in the snapshot (jobs update)
+    unsigned long time_us;     // when the event happened
+    unsigned long duration_us; // inter-arrival, queue, service or refill time of the event
+    struct simulation_statistics* stats; // LOG_EVENT_STATS_UPDATE only
+    log_job_ref_t* jobs;       // LOG_EVENT_JOBS_UPDATE only, owned by the router
+    int session_id;            // session of the emitting thread (see log_router_bind_session)
+} log_event_t;
+
+/*
+ * Unified logging operations vtable. Per-job, per-printer and update events
+ * receive a log_event_t and run on the log formatter thread once
+ * log_router_start has been called. Run lifecycle events (parameters, start,
+ * end, stopped, statistics) run on the caller's thread after every earlier
+ * event has been formatted.
+ */
 typedef struct log_ops {
     void (*simulation_parameters)(const struct simulation_parameters* params);
     void (*simulation_start)(struct simulation_statistics* stats);
     void (*simulation_end)(struct simulation_statistics* stats);
 
-    void (*system_arrival)(struct job* job, unsigned long previous_job_arrival_time_us,
-                           struct simulation_statistics* stats);
-    void (*dropped_job)(struct job* job, unsigned long previous_job_arrival_time_us,
-                        struct simulation_statistics* stats);
-    void (*removed_job)(struct job* job);
-
-    void (*queue_arrival)(const struct job* job, struct simulation_statistics* stats,
-                          struct timed_queue* job_queue, unsigned long last_interaction_time_us);
-    void (*queue_departure)(const struct job* job, struct simulation_statistics* stats,
-                            struct timed_queue* job_queue, unsigned long last_interaction_time_us);
-    void (*job_update)(const struct job* job);
-    void (*jobs_update)(struct timed_queue* job_queue);
-
-    void (*printer_arrival)(const struct job* job, const struct printer* printer);
-    void (*system_departure)(const struct job* job, const struct printer* printer,
-                             struct simulation_statistics* stats);
-
-    void (*paper_empty)(struct printer* printer, int job_id, unsigned long current_time_us);
-    void (*paper_refill_start)(struct printer* printer, int papers_needed,
-                               int time_to_refill_us, unsigned long current_time_us);
-    void (*paper_refill_end)(struct printer* printer, int refill_duration_us,
-                             unsigned long current_time_us);
-
-    void (*scale_up)(int new_printer_count, int queue_length, unsigned long current_time_us);
-    void (*scale_down)(int new_printer_count, int queue_length, unsigned long current_time_us);
-    void (*printer_idle)(const struct printer* printer);
-    void (*printer_busy)(const struct printer* printer, int job_id);
-    void (*printer_waiting_refill)(const struct printer* printer);
-    void (*stats_update)(struct simulation_statistics* stats, int queue_length);
+    void (*system_arrival)(const log_event_t* event);
+    void (*dropped_job)(const log_event_t* event);
+    void (*removed_job)(const log_event_t* event);
+
+    void (*queue_arrival)(const log_event_t* event);
+    void (*queue_departure)(const log_event_t* event);
+    void (*job_update)(const log_event_t* event);
+    void (*jobs_update)(const log_event_t* event);
+
+    void (*printer_arrival)(const log_event_t* event);
+    void (*system_departure)(const log_event_t* event);
+
+    void (*paper_empty)(const log_event_t* event);
+    void (*paper_refill_start)(const log_event_t* event);
+    void (*paper_refill_end)(const log_event_t* event);
+
+    void (*scale_up)(const log_event_t* event);
+    void (*scale_down)(const log_event_t* event);
+    void (*printer_idle)(const log_event_t* event);
+    void (*printer_busy)(const log_event_t* event);
+    void (*printer_waiting_refill)(const log_event_t* event);
+    void (*stats_update)(const log_event_t* event);
 
     void (*simulation_stopped)(struct simulation_statistics* stats);
     void (*statistics)(struct simulation_statistics* stats);
@@ -60,6 +105,44 @@ extern const log_ops_t* logger;
 // Bind mode and select an already-registered handler (console/websocket)
 void set_log_mode(int mode);
 
+/**
+ * @brief Tells the router whether the active backend has anyone to deliver
+ * to, in every session. While nobody is subscribed, per-job and per-printer
+ * events cost a single atomic load: no record is built, queued or formatted
+ * (statistics are still kept). set_log_mode resets it: the terminal is always
+ * subscribed, the server only while a WebSocket client is connected.
+ *
+ * @param subscribed 1 if events have a subscriber, 0 otherwise.
+ */
+void log_router_set_subscribed(int subscribed);
+
+/**
+ * @brief Like log_router_set_subscribed, for one session only.
+ *
+ * @param session_id The session, 0 to CONFIG_LOG_MAX_SESSIONS - 1.
+ * @param subscribed 1 if the session's events have a subscriber, 0 otherwise.
+ */
+void log_router_set_session_subscribed(int session_id, int subscribed);
+
+/**
+ * @brief Binds the calling thread to a session. Several simulations can share
+ * the router this way: their events are tagged with their session, each
+ * session's stats updates have their own publish tick, and backends see the
+ * session of the event they are formatting as log_router_session(), on the
+ * formatter thread too. Threads start in session 0.
+ *
+ * @param session_id The session, 0 to CONFIG_LOG_MAX_SESSIONS - 1 (others are ignored).
+ */
+void log_router_bind_session(int session_id);
+
+/**
+ * @brief Gets the session the calling thread is bound to. Inside a backend
+ * call this is the session of the event being formatted.
+ *
+ * @return The session id.
+ */
+int log_router_session(void);
+
 /*
  * Allow CLI/server to register their respective handlers without creating
  * link-time dependencies in the router.
@@ -67,7 +150,29 @@ void set_log_mode(int mode);
 void log_router_register_console_handler(const log_ops_t* ops);
 void log_router_register_websocket_handler(const log_ops_t* ops);
 
+/**
+ * @brief Starts the log formatter thread. From then on emit_* only records
+ * the event in a lock-free queue and the formatter thread calls the backend,
+ * so simulation threads never wait on stdout or the WebSocket bridge.
+ * Without it (e.g. in unit tests) every event is formatted on the caller's thread.
+ *
+ * @return 1 on success, 0 on failure (events then stay synchronous).
+ */
+int log_router_start(void);
+
+/**
+ * @brief Formats every queued event, then stops and joins the formatter thread.
+ */
+void log_router_stop(void);
+
+/**
+ * @brief Blocks until every event emitted before the call has been formatted,
+ * including a stats update of the caller's session still waiting for its tick.
+ */
+void log_router_flush(void);
+
 // --- Wrapper API that routes to stdout or websocket ---
+// Statistics are updated here, on the emitting thread (see simulation_stats_bind_shard).
 
 /**
  * @brief Emits the simulation parameters at the start of the simulation.
@@ -129,11 +234,11 @@ void emit_removed_job(struct job* job);
  * 
  * @param job The job that has arrived at the queue.
  * @param stats The simulation statistics to update.
- * @param job_queue The job queue to check the length of.
- * @param last_interaction_time_us The last interaction time of the queue in microseconds.
+ * @param queue_length The number of queued jobs after the arrival.
+ * @param queue_area_us The queue-length area after the arrival (see timed_queue_area_us).
  */
 void emit_queue_arrival(const struct job* job, struct simulation_statistics* stats,
-                        struct timed_queue* job_queue, unsigned long last_interaction_time_us);
+                        int queue_length, unsigned long queue_area_us);
 
 /**
  * @brief Emits an event when a job departs from the queue.
@@ -141,11 +246,11 @@ void emit_queue_arrival(const struct job* job, struct simulation_statistics* sta
  *
  * @param job The job that has departed from the queue.
  * @param stats The simulation statistics to update.
- * @param job_queue The job queue to check the length of.
- * @param last_interaction_time_us The last interaction time of the queue in microseconds.
+ * @param queue_length The number of queued jobs after the departure.
+ * @param queue_area_us The queue-length area after the departure (see timed_queue_area_us).
  */
 void emit_queue_departure(const struct job* job, struct simulation_statistics* stats,
-                          struct timed_queue* job_queue, unsigned long last_interaction_time_us);
+                          int queue_length, unsigned long queue_area_us);
 
 /**
  * @brief Emits a job state update for real-time frontend synchronization.
@@ -263,7 +368,10 @@ void emit_printer_waiting_refill(const struct printer* printer);
 
 /**
  * @brief Emits real-time statistics update for frontend dashboard.
- * Routes to the active logger (console or websocket).
+ * Routes to the active logger (console or websocket). While the formatter
+ * thread runs this only marks the statistics dirty: the formatter publishes
+ * at most one snapshot per CONFIG_STATS_PUBLISH_INTERVAL_MS, and
+ * log_router_flush publishes any change still pending.
  * 
  * @param stats The simulation statistics to broadcast.
  * @param queue_length The current queue length.
@@ -3,10 +3,12 @@
 
 #include <pthread.h>
 
+struct printer;
 struct linked_list;
 struct simulation_parameters;
 struct simulation_statistics;
 struct timed_queue;
+struct job_dispatcher;
 
 // --- Utility functions ---
 /**
@@ -22,17 +24,44 @@ void debug_refiller(int papers_supplied);
  */
 typedef struct paper_refill_thread_args {
     pthread_mutex_t* paper_refill_queue_mutex;
-    pthread_mutex_t* stats_mutex;
-    pthread_mutex_t* simulation_state_mutex; // protects g_terminate_now
+    pthread_mutex_t* simulation_state_mutex; // protects terminate_now and all_jobs_served
+    pthread_cond_t* simulation_state_cv; // broadcast when one of them is set (see clock_sleep_unless)
     pthread_cond_t* refill_needed_cv;
     pthread_cond_t* refill_supplier_cv;
     struct linked_list* paper_refill_queue;
     struct timed_queue* job_queue;
+    struct job_dispatcher* dispatcher; // per-printer deques, NULL when all printers share job_queue
     struct simulation_parameters* params;
     struct simulation_statistics* stats;
     int* all_jobs_served;
+    int* terminate_now; // set to stop this run early (Ctrl+C, "stop")
+    int session_id; // log_router session of this run (see log_router_bind_session)
 } paper_refill_thread_args_t;
 
+// --- Refill steps (shared by the refiller thread and the virtual-time engine) ---
+/**
+ * @brief Starts refilling a printer to capacity and logs it.
+ *
+ * @param args Refiller arguments (refill rate).
+ * @param printer The printer to refill.
+ * @param refill_start_time_us When the refill starts.
+ * @param papers_needed Set to the papers the refill adds.
+ * @return How long the refill takes in microseconds, or 0 if the printer is already full.
+ */
+int paper_refill_begin(paper_refill_thread_args_t* args, struct printer* printer, unsigned long refill_start_time_us,
+                       int* papers_needed);
+
+/**
+ * @brief Finishes a refill: logs it, adds the papers and updates the statistics.
+ *
+ * @param args Refiller arguments (stats, job queue or dispatcher).
+ * @param printer The refilled printer.
+ * @param papers_needed The papers paper_refill_begin returned.
+ * @param refill_start_time_us When the refill started.
+ */
+void paper_refill_finish(paper_refill_thread_args_t* args, struct printer* printer, int papers_needed,
+                         unsigned long refill_start_time_us);
+
 // --- Thread function ---
 /**
  * @brief The main function for the paper refiller thread.
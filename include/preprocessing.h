@@ -21,6 +21,15 @@ typedef struct simulation_parameters {
     int fixed_arrival;
     int min_arrival_time;
     int max_arrival_time;
+    int queue_backend;
+    int premium_job_percent;
+    int bulk_job_percent;
+    int printer_batch_size;
+    int job_burst_size;
+    int dispatch_mode;
+    int max_consumer_count;
+    int engine;
+    double time_scale;
 } simulation_parameters_t;
 
 /**
@@ -37,9 +46,18 @@ typedef struct simulation_parameters {
  * fixed_arrival: 1 (true, fixedArrival)
  * min_arrival_time: 300 ms (minArrivalTime)
  * max_arrival_time: 600 ms (maxArrivalTime)
+ * queue_backend: 0 (linked list, queueBackend)
+ * premium_job_percent: 0% (premiumPercent)
+ * bulk_job_percent: 0% (bulkPercent)
+ * printer_batch_size: 1 job per queue lock acquisition (printerBatch)
+ * job_burst_size: 1 job per arrival (burstSize)
+ * dispatch_mode: 0 (one shared job queue, dispatch)
+ * max_consumer_count: 5 printers, the pool size and autoscaling ceiling (maxConsumers)
+ * engine: 0 (real-time threads; 1 runs the discrete-event engine on a virtual clock)
+ * time_scale: 1.0 (simulated seconds per wall-clock second for the thread engine, timeScale)
  */
-#define SIMULATION_DEFAULT_PARAMS {500000, 5, 15, -1, 5, 150, 25, 10, 2, 0, 1, 300, 600}
-#define SIMULATION_DEFAULT_PARAMS_HIGH_LOAD {200000, 10, 30, -1, 5, 90, 25, 20, 2, 1, 1, 300, 600}
+#define SIMULATION_DEFAULT_PARAMS {500000, 5, 15, -1, 5, 150, 25, 10, 2, 0, 1, 300, 600, 0, 0, 0, 1, 1, 0, 5, 0, 1.0}
+#define SIMULATION_DEFAULT_PARAMS_HIGH_LOAD {200000, 10, 30, -1, 5, 90, 25, 20, 2, 1, 1, 300, 600, 0, 0, 0, 1, 1, 0, 5, 0, 1.0}
 
 /**
  * @brief Print usage information for the program.
@@ -47,7 +65,15 @@ typedef struct simulation_parameters {
 void usage();
 
 /**
- * @brief Generate a random integer between lower and upper (inclusive).
+ * @brief Restart the calling thread's random stream (random_between) from seed.
+ * Every thread starts from seed 1.
+ * @param seed The new seed.
+ */
+void random_seed(unsigned int seed);
+
+/**
+ * @brief Generate a random integer between lower and upper (inclusive),
+ * from the calling thread's own random stream.
  * @param lower The lower bound inclusive.
  * @param upper The upper bound inclusive.
  * @return A random integer between lower and upper.
@@ -96,6 +122,19 @@ int is_in_range_double(const char* str, double value, double min, double max);
  */
 int is_in_range_int(const char* str, int value, int min, int max);
 
+/**
+ * @brief Check that the premium and bulk job percentages add up to at most 100.
+ * @param params Pointer to the SimulationParameters to check.
+ * @return 1 if the split is valid, 0 otherwise.
+ */
+int is_valid_class_split(const simulation_parameters_t* params);
+
+/**
+ * @brief Raise the printer pool size (max_consumer_count) to at least the starting consumer_count.
+ * @param params Pointer to the SimulationParameters to adjust.
+ */
+void clamp_pool_size(simulation_parameters_t* params);
+
 /**
  * @brief Process command line arguments
  * @param argc Argument count
@@ -2,22 +2,33 @@
 #define PRINTER_H
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include "config.h"
 
+struct job;
+struct list_node;
 struct linked_list;
 struct timed_queue;
+struct job_dispatcher;
+struct worker;
+struct worker_pool;
 struct simulation_parameters;
 struct simulation_statistics;
 
 // --- Printer structure ---
 typedef struct printer {
+    // Cold: set when the pool is created, read by the refiller and the loggers
     int id; // Unique identifier for the printer
-    int current_paper_count; // Current number of papers in the printer
-    int total_papers_used; // Total number of papers used by this printer
     int capacity; // Maximum paper capacity of the printer
-    int jobs_printed_count; // Total number of jobs printed by this printer
-    unsigned long last_job_completion_time_us; // Last time this printer completed a job (for idle tracking)
+
+    // Hot: written on every job by the printer thread (paper also by the refiller)
+    // and polled by the autoscaler. Starts its own cache line so these writes do
+    // not invalidate the cold fields or the neighbouring pool slot.
+    _Alignas(CONFIG_CACHE_LINE_SIZE) int current_paper_count; // Current number of papers in the printer
     int is_idle; // 1 if idle, 0 if serving
+    unsigned long last_job_completion_time_us; // Last time this printer completed a job (for idle tracking)
+    int total_papers_used; // Total number of papers used by this printer
+    int jobs_printed_count; // Total number of jobs printed by this printer
 } printer_t;
 
 // --- Utility functions ---
@@ -34,34 +45,41 @@ void debug_printer(const printer_t* printer);
 typedef struct printer_thread_args {
     pthread_mutex_t* paper_refill_queue_mutex;
     pthread_mutex_t* job_queue_mutex;
-    pthread_mutex_t* stats_mutex;
-    pthread_mutex_t* simulation_state_mutex; // protects g_terminate_now
+    pthread_mutex_t* simulation_state_mutex; // protects terminate_now, all_jobs_arrived and all_jobs_served
+    pthread_cond_t* simulation_state_cv; // broadcast when one of them is set (see clock_sleep_unless)
     pthread_cond_t* job_queue_not_empty_cv;
     pthread_cond_t* refill_needed_cv;
     pthread_cond_t* refill_supplier_cv;
-    pthread_t* paper_refill_thread;
     struct timed_queue* job_queue;
+    struct job_dispatcher* dispatcher; // per-printer deques, NULL when all printers share job_queue
     struct linked_list* paper_refill_queue;
     struct simulation_parameters* params;
     struct simulation_statistics* stats;
     int* all_jobs_served;
     int* all_jobs_arrived;
+    int* terminate_now; // set to stop this run early (Ctrl+C, "stop")
+    int session_id; // log_router session of this run (see log_router_bind_session)
+    atomic_int retire; // set by printer_pool_stop_printer: return once the current jobs are printed
     printer_t* printer;
 } printer_thread_args_t;
 
 // --- Printer Instance (for array management) ---
 typedef struct printer_instance {
-    pthread_t thread;
-    printer_t printer;
+    // Each slot starts on its own cache line so printers never share one.
+    // Cold, rarely written fields first; the printer's hot line comes last.
+    _Alignas(CONFIG_CACHE_LINE_SIZE) struct worker* worker; // runs the printer thread, NULL if it has none
+    int active; // 1 if the printer is in service, 0 if the slot is free
     printer_thread_args_t args;
-    int active; // 1 if thread is running, 0 if not yet spawned
+    printer_t printer;
 } printer_instance_t;
 
 // --- Printer Pool (manages all printers) ---
 typedef struct printer_pool {
-    printer_instance_t printers[CONFIG_RANGE_CONSUMER_COUNT_MAX]; // Array sized by config constant
+    printer_instance_t* printers; // capacity slots, allocated by printer_pool_init
+    int capacity; // Maximum printers (max_consumer_count); autoscaling stops here
     int active_count; // Number of currently active printers
     int min_count; // Minimum printers (from config consumer_count)
+    struct worker_pool* workers; // Runs the printer threads; NULL if the caller drives the printers
     pthread_mutex_t pool_mutex; // Protects the pool during scaling operations
     unsigned long last_scale_time_us; // Last time we scaled up or down (for cooldown)
     unsigned long low_queue_start_time_us; // When queue first went below scale-down threshold
@@ -76,17 +94,60 @@ typedef struct printer_pool {
  */
 void* printer_thread_func(void* arg);
 
+// --- Printer steps (shared by the printer threads and the virtual-time engine) ---
+/**
+ * @brief Claims the next jobs for args->printer and logs their queue departures.
+ * Takes from the shared queue (call with job_queue_mutex held) or, in the
+ * dispatch modes, from the printer's own deque. Claims the front job and, in
+ * batch mode, the jobs behind it while they fit in the paper tray.
+ *
+ * @param args Arguments of the claiming printer.
+ * @param claimed Array of at least CONFIG_PRINTER_BATCH_MAX entries receiving the jobs' nodes.
+ * @param may_steal With per-printer deques: steal from the busiest deque when the own deque is empty.
+ * @param blocked_job_id Set to the id of the front job if it needs more paper than is left, else 0.
+ * @param blocked_papers Set to the papers that job needs.
+ * @return The number of jobs claimed.
+ */
+int printer_claim_jobs(printer_thread_args_t* args, struct list_node** claimed, int may_steal,
+                       int* blocked_job_id, int* blocked_papers);
+
+/**
+ * @brief Starts printing a claimed job: sets its service time from the
+ * printing rate, logs its arrival at the printer and marks the printer busy.
+ * Called without job_queue_mutex held.
+ *
+ * @param args Arguments of the printer.
+ * @param job The job; done after service_time_requested_ms.
+ */
+void printer_begin_job(printer_thread_args_t* args, struct job* job);
+
+/**
+ * @brief Finishes printing a job: uses its paper, marks the printer idle,
+ * logs the job's departure from the system and frees it.
+ * Called without job_queue_mutex held.
+ *
+ * @param args Arguments of the printer.
+ * @param job The job passed to printer_begin_job.
+ */
+void printer_finish_job(printer_thread_args_t* args, struct job* job);
+
 // --- Printer Pool Management ---
 /**
  * @brief Initialize the printer pool with base configuration.
  * @param pool Pointer to the printer pool.
  * @param min_printers Minimum number of printers to maintain.
+ * @param max_printers Number of printer slots to allocate (raised to min_printers if lower).
  * @param paper_capacity Initial paper capacity for each printer.
+ * @param workers Worker pool that runs the printer threads (printer_pool_start_printer),
+ *                NULL if the caller drives the printers (printer_pool_add_printer).
+ * @return 1 on success, 0 on failure (memory allocation failure).
  */
-void printer_pool_init(printer_pool_t* pool, int min_printers, int paper_capacity);
+int printer_pool_init(printer_pool_t* pool, int min_printers, int max_printers, int paper_capacity,
+                      struct worker_pool* workers);
 
 /**
- * @brief Start a new printer in the pool.
+ * @brief Start a new printer in the pool, on a parked worker of pool->workers
+ * when there is one, so scaling up does not create a thread.
  * @param pool Pointer to the printer pool.
  * @param printer_id The ID for the new printer.
  * @param shared_args Template args to copy from (contains all mutexes, queues, etc).
@@ -95,13 +156,34 @@ void printer_pool_init(printer_pool_t* pool, int min_printers, int paper_capacit
 int printer_pool_start_printer(printer_pool_t* pool, int printer_id, const printer_thread_args_t* shared_args);
 
 /**
- * @brief Join all active printer threads.
+ * @brief Activate a printer slot without starting a thread, for the
+ * virtual-time engine that drives the printers itself. The slot gets the same
+ * args and bookkeeping as printer_pool_start_printer.
+ * @param pool Pointer to the printer pool.
+ * @param printer_id The ID for the new printer.
+ * @param shared_args Template args to copy from (contains all queues, stats, etc).
+ * @return 1 on success, 0 on failure.
+ */
+int printer_pool_add_printer(printer_pool_t* pool, int printer_id, const printer_thread_args_t* shared_args);
+
+/**
+ * @brief Stop a printer thread once it has printed the jobs it holds, and
+ * wait for it; its worker goes back to pool->workers. Wakes the printer if it
+ * is waiting for jobs or paper. The slot stays active: the caller frees it.
+ * Call without pool_mutex held; does nothing if the printer has already been joined.
+ * @param pool Pointer to the printer pool.
+ * @param printer_id The ID of the printer to stop.
+ */
+void printer_pool_stop_printer(printer_pool_t* pool, int printer_id);
+
+/**
+ * @brief Wait for all printer threads to finish, including any the autoscaler starts meanwhile.
  * @param pool Pointer to the printer pool.
  */
 void printer_pool_join_all(printer_pool_t* pool);
 
 /**
- * @brief Cleanup the printer pool.
+ * @brief Cleanup the printer pool and free its slots.
  * @param pool Pointer to the printer pool.
  */
 void printer_pool_destroy(printer_pool_t* pool);
@@ -0,0 +1,88 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/**
+ * @file ring_buffer.h
+ * @brief Bounded lock-free multi-producer/multi-consumer ring buffer.
+ *
+ * Each slot carries a sequence number that tells producers and consumers
+ * whether the slot is free for the current lap. Producers claim a ticket
+ * from enqueue_pos, consumers claim one from dequeue_pos, and neither side
+ * ever takes a lock.
+ *
+ * @note The capacity is rounded up to the next power of two.
+ *
+ * @note Like the LinkedList, the ring does not manage the memory of the
+ *       objects it contains.
+ */
+
+#define RING_BUFFER_CACHE_LINE 64
+
+// --- Data Structures ---
+typedef struct ring_slot {
+    atomic_size_t sequence;
+    void* data;
+} ring_slot_t;
+
+typedef struct ring_buffer {
+    ring_slot_t* slots;
+    size_t capacity;
+    size_t mask;
+    // Producer and consumer cursors live on separate cache lines
+    _Alignas(RING_BUFFER_CACHE_LINE) atomic_size_t enqueue_pos;
+    _Alignas(RING_BUFFER_CACHE_LINE) atomic_size_t dequeue_pos;
+} ring_buffer_t;
+
+// --- Function Declarations ---
+/**
+ * @brief Initialize a RingBuffer with room for at least capacity objects.
+ * @param rb Pointer to the RingBuffer to initialize.
+ * @param capacity Minimum number of slots (rounded up to a power of two).
+ * @return 1 on success, 0 on failure (e.g., memory allocation failure).
+ */
+int ring_buffer_init(ring_buffer_t* rb, size_t capacity);
+
+/**
+ * @brief Release the slot storage of a RingBuffer.
+ * @param rb Pointer to the RingBuffer.
+ */
+void ring_buffer_destroy(ring_buffer_t* rb);
+
+/**
+ * @brief Push an object to the back of the ring. Safe from any thread.
+ * @param rb Pointer to the RingBuffer.
+ * @param data Pointer to the object to push.
+ * @return 1 on success, 0 if the ring is full.
+ */
+int ring_buffer_push(ring_buffer_t* rb, void* data);
+
+/**
+ * @brief Pop the object at the front of the ring. Safe from any thread.
+ * @param rb Pointer to the RingBuffer.
+ * @return Pointer to the removed object, or NULL if the ring is empty.
+ */
+void* ring_buffer_pop(ring_buffer_t* rb);
+
+/**
+ * @brief Get the number of objects in the ring.
+ * The value is exact when no push or pop is in flight and a best-effort
+ * snapshot otherwise.
+ * @param rb Pointer to the RingBuffer.
+ * @return The number of objects in the ring.
+ */
+int ring_buffer_length(ring_buffer_t* rb);
+
+/**
+ * @brief Get the object at a given offset from the front without removing it.
+ * Only stable while consumers are excluded by the caller (e.g. a printer
+ * peeking at the head job while holding job_queue_mutex).
+ * @param rb Pointer to the RingBuffer.
+ * @param offset Zero-based offset from the front of the ring.
+ * @return Pointer to the object, or NULL if offset is out of range.
+ */
+void* ring_buffer_peek_at(ring_buffer_t* rb, int offset);
+
+#endif // RING_BUFFER_H
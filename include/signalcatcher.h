@@ -5,6 +5,7 @@
 #include <signal.h>
 
 struct timed_queue;
+struct job_dispatcher;
 struct simulation_statistics;
 
 // --- Utility functions ---
@@ -16,6 +17,26 @@ struct simulation_statistics;
  */
 void empty_queue_if_terminating(struct timed_queue* queue, struct simulation_statistics* stats);
 
+/**
+ * @brief Empties every per-printer deque, logging each removal and updating statistics,
+ * then wakes the printers waiting on their deques. Call with stats_mutex held.
+ * No-op if dispatcher is NULL (shared dispatch mode).
+ * 
+ * @param dispatcher Pointer to the JobDispatcher holding the per-printer deques.
+ * @param stats Pointer to the SimulationStatistics struct to update statistics.
+ */
+void empty_dispatcher_if_terminating(struct job_dispatcher* dispatcher, struct simulation_statistics* stats);
+
+/**
+ * @brief Takes a pending SIGINT without blocking, for the single-threaded
+ * virtual-time engine that polls for it between events instead of running
+ * the signal catching thread.
+ *
+ * @param signal_set The blocked signal set containing SIGINT.
+ * @return 1 if SIGINT was pending (it is now consumed), 0 otherwise.
+ */
+int sig_int_take_pending(sigset_t* signal_set);
+
 // --- Signal Catching Thread Arguments ---
 /**
  * @brief Arguments for the signal catching thread.
@@ -24,16 +45,17 @@ typedef struct signal_catching_thread_args {
     sigset_t* signal_set; // Set of signals to wait for
     pthread_mutex_t* job_queue_mutex; // Mutex to protect shared state
     pthread_mutex_t* simulation_state_mutex; // Mutex to protect shared state
+    pthread_cond_t* simulation_state_cv; // Broadcast once terminate_now is set, to stop sleeping threads
     pthread_mutex_t* paper_refill_queue_mutex; // Mutex to protect paper refill queue
     pthread_mutex_t* stats_mutex; // Mutex to protect statistics data structure
     pthread_cond_t* job_queue_not_empty_cv; // Condition variable to signal printer threads
     pthread_cond_t* refill_needed_cv; // Condition variable to signal printers waiting for paper
     pthread_cond_t* refill_supplier_cv; // Condition variable to signal paper refill thread
     struct timed_queue* job_queue; // Pointer to the job queue to be emptied
+    struct job_dispatcher* dispatcher; // Per-printer deques to be emptied (NULL in shared dispatch mode)
     struct simulation_statistics* stats; // Simulation statistics to update
-    pthread_t* job_receiver_thread; // Pointer to job receiver thread to cancel
-    pthread_t* paper_refill_thread; // Pointer to paper refill thread to cancel
     int* all_jobs_arrived; // Flag indicating if all jobs have arrived
+    int* terminate_now; // Flag telling every simulation thread to stop
 } signal_catching_thread_args_t;
 
 // --- Thread function ---
@@ -3,7 +3,53 @@
 
 #include "config.h"
 
-#define MAX_PRINTERS CONFIG_RANGE_CONSUMER_COUNT_MAX
+#define MAX_JOB_CLASSES CONFIG_JOB_CLASS_COUNT
+
+// --- Statistics shards (see simulation_stats_bind_shard) ---
+#define STATS_SHARD_SHARED      0 // threads without a shard of their own; writers hold stats_mutex
+#define STATS_SHARD_RECEIVER    1 // the job receiver thread
+#define STATS_SHARD_REFILLER    2 // the paper refiller thread
+#define STATS_SHARD_PRINTERS    3 // first printer shard; printer id N uses STATS_SHARD_PRINTER(N)
+#define STATS_SHARD_PRINTER(printer_id) (STATS_SHARD_PRINTERS + (printer_id) - 1)
+
+/**
+ * @brief Statistics of one printer. Each record starts on its own cache line
+ * so printers finishing jobs at the same time do not contend on one line.
+ * Only the printer's own thread writes its record; the fields are atomic so a
+ * reader merging a snapshot mid-run never sees a torn value.
+ */
+typedef struct printer_statistics {
+    _Alignas(CONFIG_CACHE_LINE_SIZE) _Atomic double jobs_served; // Jobs completed by this printer
+    _Atomic int paper_used;                      // Paper used by this printer
+    _Atomic unsigned long total_service_time_us; // Service time of this printer
+    _Atomic unsigned long paper_empty_time_us;   // Idle time due to no paper
+} printer_statistics_t;
+
+/**
+ * @brief Counters one thread accumulates without taking stats_mutex.
+ * Every shard has a single writer (the thread bound to it), so updates are a
+ * relaxed load and store rather than a locked read-modify-write. Readers fold
+ * all shards into a snapshot with simulation_stats_snapshot.
+ */
+typedef struct stats_shard {
+    _Alignas(CONFIG_CACHE_LINE_SIZE) _Atomic unsigned long jobs_arrived;
+    _Atomic unsigned long jobs_served;
+    _Atomic unsigned long jobs_dropped;
+    _Atomic unsigned long jobs_removed;
+    _Atomic unsigned long inter_arrival_time_us;
+    _Atomic unsigned long system_time_us;
+    _Atomic double system_time_squared_us2;
+    _Atomic unsigned long queue_wait_time_us;
+    _Atomic unsigned long queue_area_us;       // Latest queue area this thread saw; merged by max
+    _Atomic unsigned int max_queue_length;     // Merged by max
+    _Atomic int max_printer_id;                // Highest printer id that served a job; merged by max
+    _Atomic unsigned long jobs_served_by_class[MAX_JOB_CLASSES];
+    _Atomic unsigned long queue_wait_time_class_us[MAX_JOB_CLASSES];
+    _Atomic unsigned long system_time_class_us[MAX_JOB_CLASSES];
+    _Atomic unsigned long paper_refill_events;
+    _Atomic unsigned long refill_service_time_us;
+    _Atomic int papers_refilled;
+} stats_shard_t;
 
 typedef struct simulation_statistics {
     // --- General Simulation Metrics ---
@@ -24,20 +70,161 @@ typedef struct simulation_statistics {
     unsigned long area_num_in_job_queue_us;     // Integral of queue length over time, for avg queue length
     unsigned int max_job_queue_length;          // Peak number of jobs ever in the queue
 
-    // --- Per-Printer Metrics (arrays for all 5 printers) ---
-    double jobs_served_by_printer[MAX_PRINTERS];        // Jobs completed by each printer [0-4]
-    int printer_paper_used[MAX_PRINTERS];                // Paper used by each printer [0-4]
-    unsigned long total_service_time_printer_us[MAX_PRINTERS];  // Service times by each printer [0-4]
-    unsigned long printer_paper_empty_time_us[MAX_PRINTERS];    // Idle time due to no paper [0-4]
-    int max_printers_used;                               // Track how many printers were actually used (1-5)
+    // --- Per-Printer Metrics (one record per pool slot, see simulation_stats_init) ---
+    printer_statistics_t* printers;             // Indexed by printer id - 1
+    int printer_capacity;                       // Number of records in printers
+    int max_printers_used;                      // Track how many printers were actually used
+
+    // --- Per-Class Metrics (indexed by JOB_CLASS_*: premium, standard, bulk) ---
+    double jobs_served_by_class[MAX_JOB_CLASSES];                // SERVED jobs per service class
+    unsigned long total_queue_wait_time_class_us[MAX_JOB_CLASSES]; // Queue wait of served jobs per class
+    unsigned long total_system_time_class_us[MAX_JOB_CLASSES];     // System time of served jobs per class
 
     // --- Paper Refill Metrics ---
     double paper_refill_events;                 // Number of times the paper was refilled
     unsigned long total_refill_service_time_us; // Total time spent actively refilling paper
     int papers_refilled;                        // Total number of papers refilled during the simulation
 
+    // --- Per-Thread Shards (folded into the fields above by simulation_stats_snapshot) ---
+    stats_shard_t* shards;                      // Indexed by STATS_SHARD_*
+    int shard_count;                            // STATS_SHARD_PRINTERS + printer_capacity
+
 } simulation_statistics_t;
 
+/**
+ * @brief Zeroes a statistics struct and allocates its per-printer records and
+ * per-thread shards.
+ *
+ * @param stats A simulation statistics struct.
+ * @param printer_capacity Number of printers to track (the printer pool size).
+ * @return 1 on success, 0 on failure (memory allocation failure).
+ */
+int simulation_stats_init(simulation_statistics_t* stats, int printer_capacity);
+
+/**
+ * @brief Frees the per-printer records and shards and zeroes the struct.
+ *
+ * @param stats A simulation statistics struct.
+ */
+void simulation_stats_destroy(simulation_statistics_t* stats);
+
+/**
+ * @brief Returns the statistics record of one printer.
+ *
+ * @param stats A simulation statistics struct.
+ * @param printer_id One-based printer id.
+ * @return Pointer to the record, or NULL if the id is outside the tracked pool.
+ */
+printer_statistics_t* simulation_stats_printer(simulation_statistics_t* stats, int printer_id);
+
+/**
+ * @brief Binds the calling thread to one shard, so its simulation_stats_count_*
+ * and simulation_stats_record_* calls update that shard without locking.
+ * Threads that never bind update STATS_SHARD_SHARED and must hold stats_mutex.
+ *
+ * @param stats A simulation statistics struct.
+ * @param shard_index STATS_SHARD_RECEIVER, STATS_SHARD_REFILLER or STATS_SHARD_PRINTER(id).
+ * @return 1 on success, 0 if the index is outside the allocated shards.
+ */
+int simulation_stats_bind_shard(simulation_statistics_t* stats, int shard_index);
+
+/**
+ * @brief Merges the fields of stats and all of its shards into snapshot.
+ * Safe to call while other threads are updating their shards; the snapshot
+ * shares the per-printer records and has no shards of its own.
+ *
+ * @param stats A simulation statistics struct.
+ * @param snapshot Receives the merged statistics.
+ */
+void simulation_stats_snapshot(const simulation_statistics_t* stats, simulation_statistics_t* snapshot);
+
+/**
+ * @brief Counts a job entering the system.
+ *
+ * @param stats A simulation statistics struct.
+ * @param inter_arrival_time_us Time since the previous arrival.
+ */
+void simulation_stats_count_arrival(simulation_statistics_t* stats, unsigned long inter_arrival_time_us);
+
+/**
+ * @brief Counts a job dropped on arrival (e.g., queue full).
+ *
+ * @param stats A simulation statistics struct.
+ */
+void simulation_stats_count_dropped(simulation_statistics_t* stats);
+
+/**
+ * @brief Counts a job removed before it was served (termination or cancel).
+ *
+ * @param stats A simulation statistics struct.
+ */
+void simulation_stats_count_removed(simulation_statistics_t* stats);
+
+/**
+ * @brief Counts a served job leaving the system.
+ *
+ * @param stats A simulation statistics struct.
+ * @param service_class Service class of the job (JOB_CLASS_*).
+ * @param queue_wait_time_us Time the job spent in the queue.
+ * @param system_time_us Time the job spent in the system.
+ */
+void simulation_stats_count_departure(simulation_statistics_t* stats, int service_class,
+    unsigned long queue_wait_time_us, unsigned long system_time_us);
+
+/**
+ * @brief Adds a printed job to its printer's record.
+ *
+ * @param stats A simulation statistics struct.
+ * @param printer_id One-based printer id.
+ * @param papers Papers the job used.
+ * @param service_time_us Time the printer spent on the job.
+ */
+void simulation_stats_count_printed(simulation_statistics_t* stats, int printer_id,
+    int papers, unsigned long service_time_us);
+
+/**
+ * @brief Adds time a printer spent waiting for paper to its record.
+ *
+ * @param stats A simulation statistics struct.
+ * @param printer_id One-based printer id.
+ * @param paper_empty_time_us Time spent waiting.
+ */
+void simulation_stats_count_paper_empty(simulation_statistics_t* stats, int printer_id,
+    unsigned long paper_empty_time_us);
+
+/**
+ * @brief Counts a completed paper refill.
+ *
+ * @param stats A simulation statistics struct.
+ * @param papers Papers added to the printer.
+ * @param refill_time_us Time the refill took.
+ */
+void simulation_stats_count_refill(simulation_statistics_t* stats, int papers, unsigned long refill_time_us);
+
+/**
+ * @brief Records the integral of the queue length so far (the queue tracks it).
+ *
+ * @param stats A simulation statistics struct.
+ * @param queue_area_us Queue length integrated over time, in job x microseconds.
+ */
+void simulation_stats_record_queue_area(simulation_statistics_t* stats, unsigned long queue_area_us);
+
+/**
+ * @brief Raises the peak queue length if queue_length exceeds it.
+ *
+ * @param stats A simulation statistics struct.
+ * @param queue_length A queue length a job observed.
+ */
+void simulation_stats_record_queue_length(simulation_statistics_t* stats, unsigned int queue_length);
+
+/**
+ * @brief Returns a buffer size large enough for write_statistics_to_buffer.
+ *
+ * @param stats A simulation statistics struct.
+ * @return Buffer size in bytes; grows with the number of printers reported.
+ */
+int statistics_buffer_size(const simulation_statistics_t* stats);
+
 /**
  * @brief Calculates all relevant simulation statistics and formats them as a JSON string to the provided buffer.
  *
@@ -48,6 +235,33 @@ typedef struct simulation_statistics {
  */
 int write_statistics_to_buffer(simulation_statistics_t* stats, char* buf, int buf_size);
 
+/**
+ * @brief Formats the same statistics as write_statistics_to_buffer as a bare
+ * JSON object, without the {"type":"statistics","data":...} message around it.
+ *
+ * @param stats A simulation statistics struct.
+ * @param buf A character buffer to hold the JSON object (statistics_buffer_size bytes suffice).
+ * @param buf_size The size of the provided buffer.
+ * @return The number of bytes written to the buffer, or -1 on error.
+ */
+int write_statistics_data_to_buffer(simulation_statistics_t* stats, char* buf, int buf_size);
+
+/**
+ * Column names of write_statistics_csv_row, comma separated, without a newline.
+ */
+extern const char statistics_csv_header[];
+
+/**
+ * @brief Formats the scalar statistics of write_statistics_to_buffer (no
+ * per-printer or per-class arrays) as one CSV row, without a newline.
+ *
+ * @param stats A simulation statistics struct.
+ * @param buf A character buffer to hold the row.
+ * @param buf_size The size of the provided buffer.
+ * @return The number of bytes written to the buffer, or -1 on error.
+ */
+int write_statistics_csv_row(simulation_statistics_t* stats, char* buf, int buf_size);
+
 /**
  * @brief Calculates and logs all relevant simulation statistics to stdout.
  *
@@ -65,7 +279,7 @@ void debug_statistics(const simulation_statistics_t* stats);
 /**
  * @brief Calculates the average system time (completion time) in seconds.
  *
- * @param stats A simulation statistics struct.
+ * @param stats A snapshot from simulation_stats_snapshot.
  * @return Average system time in seconds.
  */
 double calculate_average_system_time(simulation_statistics_t* stats);
@@ -73,7 +287,7 @@ double calculate_average_system_time(simulation_statistics_t* stats);
 /**
  * @brief Calculates the total papers used across all printers.
  *
- * @param stats A simulation statistics struct.
+ * @param stats A snapshot from simulation_stats_snapshot.
  * @return Total papers used.
  */
 int calculate_total_papers_used(simulation_statistics_t* stats);
@@ -81,7 +295,7 @@ int calculate_total_papers_used(simulation_statistics_t* stats);
 /**
  * @brief Calculates the overall average service time across all printers in seconds.
  *
- * @param stats A simulation statistics struct.
+ * @param stats A snapshot from simulation_stats_snapshot.
  * @return Average service time in seconds.
  */
 double calculate_overall_average_service_time(simulation_statistics_t* stats);
@@ -0,0 +1,102 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>
+
+#include "config.h"
+
+/**
+ * @file sweep.h
+ * @brief Parameter sweeps: one simulation per point of a grid of bin/cli options, run in parallel.
+ *
+ * An axis names a bin/cli option and the values it takes, e.g. "s=4,6,8" or
+ * "dispatch=shared,rr". The grid is every combination of the axes' values on
+ * top of a set of base options. Each point is parsed by process_args, so its
+ * values are validated exactly as bin/cli validates them, and is run on the
+ * virtual-time engine (virtual_engine_simulate) by a pool of worker threads.
+ * Every run has its own job queue, printer pool, statistics, virtual clock and
+ * random stream (restarted from seed 1), so a point's results match
+ * `bin/cli -engine virtual` with the same options, whatever else runs beside it.
+ */
+
+struct simulation_parameters;
+
+// --- Output formats ---
+#define SWEEP_FORMAT_CSV  0 // one row per point: the axis values, then the scalar statistics
+#define SWEEP_FORMAT_JSON 1 // an array of {"point":{...},"statistics":{...}}, per-printer and per-class stats included
+
+typedef struct sweep_axis {
+    char* option;                          // bin/cli option without the dash; owns the values' storage
+    char* values[CONFIG_SWEEP_MAX_VALUES];
+    int value_count;
+} sweep_axis_t;
+
+typedef struct sweep_spec {
+    sweep_axis_t axes[CONFIG_SWEEP_MAX_AXES];
+    int axis_count;
+    int point_count;  // product of the axes' value counts (1 with no axes)
+    int base_argc;
+    char** base_argv; // argv-style base options, base_argv[0] is the program name (not owned)
+} sweep_spec_t;
+
+/**
+ * @brief Initializes an empty sweep (a single point: the base options).
+ *
+ * @param spec Sweep to initialize.
+ * @param base_argc Number of entries in base_argv.
+ * @param base_argv Program name followed by the bin/cli options every point starts from.
+ */
+void sweep_init(sweep_spec_t* spec, int base_argc, char** base_argv);
+
+/**
+ * @brief Adds an axis parsed from "option=value1,value2,...".
+ *
+ * @param spec Sweep to add to.
+ * @param axis Axis text; copied.
+ * @return 1 on success, 0 (with a message on stderr) if the text is malformed
+ *         or the sweep would exceed the CONFIG_SWEEP_MAX_* limits.
+ */
+int sweep_add_axis(sweep_spec_t* spec, const char* axis);
+
+/**
+ * @brief Frees the axes of a sweep.
+ *
+ * @param spec Sweep to destroy.
+ */
+void sweep_destroy(sweep_spec_t* spec);
+
+/**
+ * @brief Gets the axis values of a grid point. Points are numbered with the
+ * last axis varying fastest.
+ *
+ * @param spec Sweep.
+ * @param point Point index, 0 to point_count - 1.
+ * @param values Receives one value per axis.
+ */
+void sweep_point_values(const sweep_spec_t* spec, int point, const char** values);
+
+/**
+ * @brief Builds the parameters of a grid point: bin/cli's defaults, then the
+ * base options, then "-option value" for every axis.
+ *
+ * @param spec Sweep.
+ * @param point Point index, 0 to point_count - 1.
+ * @param params Receives the parameters.
+ * @return 1 on success, 0 if process_args rejects the options (it prints why).
+ */
+int sweep_point_params(const sweep_spec_t* spec, int point, struct simulation_parameters* params);
+
+/**
+ * @brief Runs every point of the sweep on up to worker_count threads and
+ * writes the results to out in point order. All points are validated before
+ * any runs.
+ *
+ * @param spec Sweep to run.
+ * @param worker_count Number of worker threads (at least 1).
+ * @param format SWEEP_FORMAT_CSV or SWEEP_FORMAT_JSON.
+ * @param out Stream to write the results to.
+ * @return 1 on success, 0 on failure (invalid point, memory allocation failure).
+ */
+int sweep_run(const sweep_spec_t* spec, int worker_count, int format, FILE* out);
+
+#endif // SWEEP_H
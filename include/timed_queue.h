@@ -2,6 +2,8 @@
 #define TIMED_QUEUE_H
 
 #include "linked_list.h"
+#include "ring_buffer.h"
+#include "hash_index.h"
 
 /**
  * @file timed_queue.h
@@ -9,11 +11,68 @@
  *
  * @note This queue automatically updates the last_interaction_time_us field
  *       whenever items are added or removed.
+ *
+ * @note Two storage backends are available and picked at init time:
+ *       - TIMED_QUEUE_BACKEND_LIST: unbounded doubly linked list (default).
+ *       - TIMED_QUEUE_BACKEND_RING: bounded lock-free MPMC ring buffer.
+ *         Enqueue (back) and dequeue_front are lock-free; enqueue_front,
+ *         dequeue (back) and remove are not supported and fail. Peeking and
+ *         iteration are only stable while the caller excludes consumers.
+ *         timed_queue_next/prev are list-only; walk a ring with
+ *         timed_queue_for_each, which reads it by offset in O(n).
+ *
+ * @note A queue set up with timed_queue_init_intrusive holds nodes embedded
+ *       in the caller's objects (see list_init_intrusive). Use
+ *       timed_queue_enqueue_node instead of timed_queue_enqueue; dequeued
+ *       nodes still belong to the caller and need no release. This works
+ *       with both backends.
+ *
+ * @note timed_queue_enable_index adds an optional id -> node hash index
+ *       (list backend only). Once enabled it is kept in sync by every
+ *       enqueue/dequeue/remove/clear, and timed_queue_find_by_id and
+ *       timed_queue_remove_by_id run in O(1) instead of scanning the list.
+ *
+ * @note timed_queue_enable_classes turns an intrusive list-backed queue into
+ *       a multi-level queue. Nodes are kept in per-class FIFO segments of the
+ *       one list (highest-priority class first), and timed_queue_dequeue_front
+ *       and timed_queue_first serve the classes by weighted round-robin in O(1).
+ *       timed_queue_dequeue (back) removes the newest lowest-priority node.
+ *
+ * @note last_interaction_time_us is atomic and only ever moves forward, so
+ *       concurrent ring producers and consumers can update it without a lock.
+ *
+ * @note Every mutation also adds (time since last interaction) x (length
+ *       before the mutation) to area_us, the integral of queue length over
+ *       time used for the average queue length. A batch counts as a single
+ *       state change. area_us is exact while mutations are serialized by the
+ *       caller, which is how the job queue is used (job_queue_mutex).
  */
 
+// Storage backends
+#define TIMED_QUEUE_BACKEND_LIST 0
+#define TIMED_QUEUE_BACKEND_RING 1
+
+// Upper bound on service classes for timed_queue_enable_classes
+#define TIMED_QUEUE_MAX_CLASSES 4
+
 typedef struct timed_queue {
     linked_list_t list;
-    unsigned long last_interaction_time_us;
+    ring_buffer_t ring;
+    int backend;
+    hash_index_t index;
+    int (*key_of)(const list_node_t* node); // NULL when the index is disabled
+
+    // --- Service classes (see timed_queue_enable_classes) ---
+    int (*class_of)(const list_node_t* node); // NULL when classes are disabled
+    int class_count;
+    int class_weights[TIMED_QUEUE_MAX_CLASSES];
+    int class_length[TIMED_QUEUE_MAX_CLASSES];
+    list_node_t* class_head[TIMED_QUEUE_MAX_CLASSES]; // first node of each class segment
+    list_node_t* class_tail[TIMED_QUEUE_MAX_CLASSES]; // last node of each class segment
+    int wrr_class; // class currently being served
+    int wrr_credit; // dequeues left for wrr_class in this round
+    _Atomic unsigned long last_interaction_time_us;
+    unsigned long area_us; // integral of queue length over time (jobs x us)
 } timed_queue_t;
 
 // --- Function Declarations ---
@@ -25,6 +84,62 @@ typedef struct timed_queue {
  */
 int timed_queue_init(timed_queue_t* tq);
 
+/**
+ * @brief Initialize a TimedQueue structure with a specific storage backend.
+ * @param tq Pointer to the TimedQueue to initialize.
+ * @param backend TIMED_QUEUE_BACKEND_LIST or TIMED_QUEUE_BACKEND_RING.
+ * @param capacity Ring capacity (rounded up to a power of two); ignored by the list backend.
+ * @return 1 on success, 0 on failure.
+ */
+int timed_queue_init_backend(timed_queue_t* tq, int backend, int capacity);
+
+/**
+ * @brief Initialize a TimedQueue that links caller-owned (embedded) nodes.
+ * @param tq Pointer to the TimedQueue to initialize.
+ * @param backend TIMED_QUEUE_BACKEND_LIST or TIMED_QUEUE_BACKEND_RING.
+ * @param capacity Ring capacity (rounded up to a power of two); ignored by the list backend.
+ * @return 1 on success, 0 on failure.
+ */
+int timed_queue_init_intrusive(timed_queue_t* tq, int backend, int capacity);
+
+/**
+ * @brief Enable the id -> node index. Nodes already in the queue are indexed.
+ * Ids must be unique among queued nodes.
+ * @param tq Pointer to the TimedQueue (list backend only).
+ * @param key_of Callback returning the id of a queued node.
+ * @param capacity Expected queue depth; the index grows beyond it as needed.
+ * @return 1 on success, 0 on failure (e.g., ring backend or memory allocation failure).
+ */
+int timed_queue_enable_index(timed_queue_t* tq, int (*key_of)(const list_node_t* node), int capacity);
+
+/**
+ * @brief Serve nodes by service class with weighted round-robin.
+ * Class 0 has the highest priority when placing nodes in the list; each
+ * class is served up to weights[class] times in a row while non-empty.
+ * @param tq Pointer to an empty, intrusive, list-backed TimedQueue.
+ * @param class_of Callback returning the class (0 .. class_count - 1) of a node.
+ * @param weights Per-class weights (values below 1 are treated as 1).
+ * @param class_count Number of classes, at most TIMED_QUEUE_MAX_CLASSES.
+ * @return 1 on success, 0 on failure (e.g., ring backend or non-empty queue).
+ */
+int timed_queue_enable_classes(timed_queue_t* tq, int (*class_of)(const list_node_t* node),
+                               const int* weights, int class_count);
+
+/**
+ * @brief Get the number of nodes queued in one service class.
+ * @param tq Pointer to the TimedQueue.
+ * @param cls Class index.
+ * @return The number of queued nodes of that class (0 if classes are disabled).
+ */
+int timed_queue_class_length(timed_queue_t* tq, int cls);
+
+/**
+ * @brief Clear the queue and release any backend storage and pooled nodes.
+ * The queue must be re-initialized before it is used again.
+ * @param tq Pointer to the TimedQueue.
+ */
+void timed_queue_destroy(timed_queue_t* tq);
+
 /**
  * @brief Get the number of elements in the queue.
  * @param tq Pointer to the TimedQueue.
@@ -44,7 +159,7 @@ int timed_queue_is_empty(timed_queue_t* tq);
  * Automatically updates the last_interaction_time_us.
  * @param tq Pointer to the TimedQueue.
  * @param data Pointer to the object to enqueue.
- * @return 1 on success, 0 on failure (e.g., memory allocation failure).
+ * @return 1 on success, 0 on failure (e.g., memory allocation failure, full ring or intrusive queue).
  */
 int timed_queue_enqueue(timed_queue_t* tq, void* data);
 
@@ -53,29 +168,96 @@ int timed_queue_enqueue(timed_queue_t* tq, void* data);
  * Automatically updates the last_interaction_time_us.
  * @param tq Pointer to the TimedQueue.
  * @param data Pointer to the object to enqueue.
- * @return 1 on success, 0 on failure (e.g., memory allocation failure).
+ * @return 1 on success, 0 on failure (e.g., memory allocation failure, ring backend or intrusive queue).
  */
 int timed_queue_enqueue_front(timed_queue_t* tq, void* data);
 
+/**
+ * @brief Link a caller-owned node to the end of an intrusive queue.
+ * Automatically updates the last_interaction_time_us.
+ * @param tq Pointer to the TimedQueue.
+ * @param node Pointer to the embedded ListNode to enqueue.
+ * @return 1 on success, 0 on failure (e.g., full ring or non-intrusive queue).
+ */
+int timed_queue_enqueue_node(timed_queue_t* tq, list_node_t* node);
+
+/**
+ * @brief Link a caller-owned node to the front of an intrusive queue.
+ * Automatically updates the last_interaction_time_us.
+ * @param tq Pointer to the TimedQueue.
+ * @param node Pointer to the embedded ListNode to enqueue.
+ * @return 1 on success, 0 on failure (e.g., ring backend or non-intrusive queue).
+ */
+int timed_queue_enqueue_node_front(timed_queue_t* tq, list_node_t* node);
+
+/**
+ * @brief Link several caller-owned nodes to the back of an intrusive queue, in order.
+ * Stops at the first node that cannot be enqueued (e.g. the ring is full), so
+ * nodes[result..count-1] are left untouched for the caller to drop.
+ * Updates the last_interaction_time_us once for the batch.
+ * @param tq Pointer to the TimedQueue.
+ * @param nodes Array of embedded ListNodes to enqueue.
+ * @param count Number of nodes in the array.
+ * @return The number of nodes enqueued.
+ */
+int timed_queue_enqueue_batch(timed_queue_t* tq, list_node_t** nodes, int count);
+
 /**
  * @brief Dequeue (remove) and return the last object from the queue.
  * Automatically updates the last_interaction_time_us.
  * @param tq Pointer to the TimedQueue.
- * @return Pointer to the removed ListNode, or NULL if the queue is empty.
+ * @return Pointer to the removed ListNode, or NULL if the queue is empty (always NULL for the ring backend).
  */
 list_node_t* timed_queue_dequeue(timed_queue_t* tq);
 
 /**
  * @brief Dequeue (remove) and return the first object from the queue.
- * Automatically updates the last_interaction_time_us.
+ * With service classes enabled this is the head of the class picked by
+ * weighted round-robin. Automatically updates the last_interaction_time_us.
  * @param tq Pointer to the TimedQueue.
  * @return Pointer to the removed ListNode, or NULL if the queue is empty.
  */
 list_node_t* timed_queue_dequeue_front(timed_queue_t* tq);
 
+/**
+ * @brief Dequeue up to max objects from the front of the queue in one call.
+ * Nodes come out in the same order repeated timed_queue_dequeue_front calls
+ * would produce. Updates the last_interaction_time_us once for the batch.
+ * @param tq Pointer to the TimedQueue.
+ * @param out Array receiving the removed ListNodes.
+ * @param max Capacity of out.
+ * @return The number of nodes removed (0 if the queue is empty).
+ */
+int timed_queue_dequeue_batch(timed_queue_t* tq, list_node_t** out, int max);
+
+/**
+ * @brief Like timed_queue_dequeue_batch, but stops at the first front node
+ * that accept rejects. accept sees each candidate before it is removed and
+ * may update ctx (e.g. to track a remaining budget).
+ * @param tq Pointer to the TimedQueue.
+ * @param out Array receiving the removed ListNodes.
+ * @param max Capacity of out.
+ * @param accept Callback returning 1 to take the node, 0 to stop; NULL accepts all.
+ * @param ctx Caller data passed to accept.
+ * @return The number of nodes removed.
+ */
+int timed_queue_dequeue_batch_while(timed_queue_t* tq, list_node_t** out, int max,
+                                    int (*accept)(list_node_t* node, void* ctx), void* ctx);
+
+/**
+ * @brief Recycle a node returned by timed_queue_dequeue/timed_queue_dequeue_front.
+ * Does NOT update the timestamp. List nodes go back to the list's node pool,
+ * so call this under the same lock that guards the queue; ring nodes are freed.
+ * No-op for intrusive queues.
+ * @param tq Pointer to the TimedQueue the node was dequeued from.
+ * @param node Pointer to the ListNode to recycle.
+ */
+void timed_queue_release_node(timed_queue_t* tq, list_node_t* node);
+
 /**
  * @brief Remove a specific node from the queue.
  * Automatically updates the last_interaction_time_us.
+ * No-op for the ring backend.
  * @param tq Pointer to the TimedQueue.
  * @param node Pointer to the ListNode to remove.
  */
@@ -90,12 +272,24 @@ void timed_queue_clear(timed_queue_t* tq);
 
 /**
  * @brief Get the first node in the queue without removing it.
+ * With service classes enabled this is the node dequeue_front would return.
  * Does NOT update the timestamp (read-only operation).
  * @param tq Pointer to the TimedQueue.
  * @return Pointer to the first ListNode, or NULL if the queue is empty.
  */
 list_node_t* timed_queue_first(timed_queue_t* tq);
 
+/**
+ * @brief Get the node at the head of the queue's storage without removing it.
+ * Unlike timed_queue_first this ignores service classes, so walking from here
+ * (timed_queue_next, or timed_queue_for_each) visits every queued node, class
+ * segments in priority order.
+ * Does NOT update the timestamp (read-only operation).
+ * @param tq Pointer to the TimedQueue.
+ * @return Pointer to the head ListNode, or NULL if the queue is empty.
+ */
+list_node_t* timed_queue_head(timed_queue_t* tq);
+
 /**
  * @brief Get the last node in the queue without removing it.
  * Does NOT update the timestamp (read-only operation).
@@ -114,20 +308,57 @@ list_node_t* timed_queue_last(timed_queue_t* tq);
 list_node_t* timed_queue_find(timed_queue_t* tq, void* data);
 
 /**
- * @brief Get the next node in the queue.
+ * @brief Get the integral of queue length over time since init.
+ * Does NOT update the timestamp (read-only operation).
+ * @param tq Pointer to the TimedQueue.
+ * @return The area in job-microseconds, up to the last mutation.
+ */
+unsigned long timed_queue_area_us(timed_queue_t* tq);
+
+/**
+ * @brief Find a node in the queue by id using the index.
+ * Does NOT update the timestamp (read-only operation).
+ * @param tq Pointer to the TimedQueue.
+ * @param id Id to look up (as returned by the key_of callback).
+ * @return Pointer to the found ListNode, or NULL if not found or the index is disabled.
+ */
+list_node_t* timed_queue_find_by_id(timed_queue_t* tq, int id);
+
+/**
+ * @brief Unlink a node from the queue by id using the index.
+ * Automatically updates the last_interaction_time_us. The node is handed to
+ * the caller like a dequeued node (see timed_queue_release_node).
+ * @param tq Pointer to the TimedQueue.
+ * @param id Id to remove (as returned by the key_of callback).
+ * @return Pointer to the unlinked ListNode, or NULL if not found or the index is disabled.
+ */
+list_node_t* timed_queue_remove_by_id(timed_queue_t* tq, int id);
+
+/**
+ * @brief Call visit on every queued node, head to tail (see timed_queue_head).
+ * O(n) on both backends. Does NOT update the timestamp (read-only operation).
+ * @param tq Pointer to the TimedQueue.
+ * @param visit Callback given each node and ctx.
+ * @param ctx Caller data passed to visit.
+ * @return Number of nodes visited.
+ */
+int timed_queue_for_each(timed_queue_t* tq, void (*visit)(list_node_t* node, void* ctx), void* ctx);
+
+/**
+ * @brief Get the next node in the queue (list backend only).
  * Does NOT update the timestamp (read-only operation).
  * @param tq Pointer to the TimedQueue.
  * @param node Pointer to the current ListNode.
- * @return Pointer to the next ListNode, or NULL if at the end of the queue.
+ * @return Pointer to the next ListNode, or NULL at the end of the queue or on a ring queue.
  */
 list_node_t* timed_queue_next(timed_queue_t* tq, list_node_t* node);
 
 /**
- * @brief Get the previous node in the queue.
+ * @brief Get the previous node in the queue (list backend only).
  * Does NOT update the timestamp (read-only operation).
  * @param tq Pointer to the TimedQueue.
  * @param node Pointer to the current ListNode.
- * @return Pointer to the previous ListNode, or NULL if at the beginning of the queue.
+ * @return Pointer to the previous ListNode, or NULL at the beginning of the queue or on a ring queue.
  */
 list_node_t* timed_queue_prev(timed_queue_t* tq, list_node_t* node);
 
@@ -0,0 +1,69 @@
+#ifndef VIRTUAL_ENGINE_H
+#define VIRTUAL_ENGINE_H
+
+#include <signal.h>
+
+/**
+ * @file virtual_engine.h
+ * @brief Discrete-event engine that runs a simulation on a virtual clock.
+ *
+ * The thread engine gives the job receiver, each printer, the paper refiller
+ * and the autoscaler a thread that sleeps through every inter-arrival, print
+ * and refill time, so a run takes as long as the simulated time. This engine
+ * runs the same steps (job_receiver_admit_burst, printer_claim_jobs,
+ * printer_begin_job/printer_finish_job, paper_refill_begin/paper_refill_finish,
+ * should_scale_up/should_scale_down) on the calling thread. It takes the next
+ * event off an event_heap and moves the virtual clock (virtual_clock_advance)
+ * to that event's time instead of sleeping. Logging (log_router) and statistics
+ * are unchanged and show simulated times, so a 100k-job run finishes in seconds.
+ */
+
+// --- Engines (simulation_parameters_t.engine) ---
+#define SIMULATION_ENGINE_THREADS 0
+#define SIMULATION_ENGINE_VIRTUAL 1
+
+struct timed_queue;
+struct job_dispatcher;
+struct printer_pool;
+struct simulation_parameters;
+struct simulation_statistics;
+
+// --- Engine Arguments ---
+typedef struct virtual_engine_args {
+    struct timed_queue* job_queue;
+    struct job_dispatcher* dispatcher; // per-printer deques, NULL when all printers share job_queue
+    struct simulation_parameters* params;
+    struct simulation_statistics* stats;
+    struct printer_pool* pool; // initialized, with no printer started yet
+    sigset_t* signal_set; // blocked set polled for SIGINT between events, NULL to ignore
+    int* terminate_now; // polled between events like SIGINT; set once the run is stopped
+} virtual_engine_args_t;
+
+/**
+ * @brief Runs a whole simulation and returns once every job has left the
+ * system, or after Ctrl+C (or *terminate_now) once the printing jobs finish.
+ * Starts the pool's first consumer_count printers.
+ *
+ * The caller starts the virtual clock (virtual_clock_start) before
+ * emit_simulation_start and stops it after emit_statistics, so that the start,
+ * end and duration of the simulation are virtual times too.
+ *
+ * @param args Pointer to the engine arguments.
+ * @return 1 on success, 0 on failure (memory allocation failure).
+ */
+int virtual_engine_run(virtual_engine_args_t* args);
+
+/**
+ * @brief Runs a whole simulation on the calling thread: builds its own job
+ * queue, deques and printer pool from params, runs virtual_engine_run on the
+ * thread's virtual clock and records the start time and duration in stats
+ * (emit_simulation_start/emit_simulation_end are not called). All its state is
+ * per run or per thread, so several threads can each run one at once.
+ *
+ * @param params Parameters of the run (engine is ignored).
+ * @param stats Initialized statistics (simulation_stats_init) to fill in.
+ * @return 1 on success, 0 on failure (memory allocation failure).
+ */
+int virtual_engine_simulate(struct simulation_parameters* params, struct simulation_statistics* stats);
+
+#endif // VIRTUAL_ENGINE_H
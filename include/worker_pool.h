@@ -0,0 +1,102 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+
+#include "config.h"
+
+/**
+ * @file worker_pool.h
+ * @brief Persistent threads that run the simulation roles (job receiver,
+ * paper refiller, printers, autoscaler) as tasks, and outlive the runs.
+ *
+ * A worker is a thread parked on its own condition variable. Handing it a
+ * task pops it off the pool's stack of parked workers and signals it, so
+ * starting a role (and scaling up a printer) costs no thread creation once
+ * the pool is warm; worker_pool_reserve warms it ahead of a run. Waiting for
+ * a task, like joining a thread, puts its worker back on the stack.
+ *
+ * Tasks cannot be cancelled: a pooled thread must survive the role it runs.
+ * The roles stop cooperatively instead (terminate_now, all_jobs_served and
+ * the printers' retire flag, see clock_sleep_unless).
+ */
+
+typedef void* (*worker_task_t)(void* arg);
+
+// One pooled thread. Each worker starts on its own cache line, like the printer slots.
+typedef struct worker {
+    _Alignas(CONFIG_CACHE_LINE_SIZE) pthread_t thread;
+    struct worker* next_parked; // next worker on the pool's parked stack
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;          // signalled when a task is handed over and when it returns
+    worker_task_t task;         // task being run, NULL while parked
+    void* arg;
+    int finished;               // the task has returned and worker_wait has not reaped it yet
+    int exiting;                // set by worker_pool_destroy
+} worker_t;
+
+typedef struct worker_pool {
+    worker_t* workers;     // capacity slots, allocated by worker_pool_init
+    int capacity;          // most threads the pool starts
+    int thread_count;      // threads started so far: workers[0] to workers[thread_count - 1]
+    int parked_count;
+    worker_t* parked;      // stack of idle workers, most recently used first
+    pthread_mutex_t mutex; // protects thread_count and the parked stack
+} worker_pool_t;
+
+/**
+ * @brief Initialize an empty worker pool. Threads are started on demand or by worker_pool_reserve.
+ * @param pool Pointer to the pool.
+ * @param capacity Most threads the pool may start.
+ * @return 1 on success, 0 on failure (memory allocation failure).
+ */
+int worker_pool_init(worker_pool_t* pool, int capacity);
+
+/**
+ * @brief Start threads until at least count workers are parked, so that the
+ * next count tasks start without creating a thread.
+ * @param pool Pointer to the pool.
+ * @param count Number of parked workers wanted.
+ * @return 1 if count workers are parked, 0 if the pool is full or a thread could not be created.
+ */
+int worker_pool_reserve(worker_pool_t* pool, int count);
+
+/**
+ * @brief Run task(arg) on a parked worker, or on a new thread if none is parked.
+ * @param pool Pointer to the pool.
+ * @param task Task to run.
+ * @param arg Argument passed to the task.
+ * @return The worker running the task, to pass to worker_wait, or NULL if the
+ *         pool is full or a thread could not be created.
+ */
+worker_t* worker_pool_run(worker_pool_t* pool, worker_task_t task, void* arg);
+
+/**
+ * @brief Wait for a worker's task to return, then park the worker again.
+ * Every task must be waited for exactly once, like a joinable thread.
+ * @param pool Pointer to the pool that runs the worker.
+ * @param worker The worker returned by worker_pool_run.
+ */
+void worker_wait(worker_pool_t* pool, worker_t* worker);
+
+/**
+ * @brief Get the number of threads the pool has started.
+ * @param pool Pointer to the pool.
+ * @return Number of threads, parked or running a task.
+ */
+int worker_pool_thread_count(worker_pool_t* pool);
+
+/**
+ * @brief Get the number of parked workers.
+ * @param pool Pointer to the pool.
+ * @return Number of workers waiting for a task.
+ */
+int worker_pool_parked_count(worker_pool_t* pool);
+
+/**
+ * @brief Stop and join every thread and free the pool. Every task must have been waited for.
+ * @param pool Pointer to the pool.
+ */
+void worker_pool_destroy(worker_pool_t* pool);
+
+#endif // WORKER_POOL_H
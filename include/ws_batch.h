@@ -0,0 +1,109 @@
+#ifndef WS_BATCH_H
+#define WS_BATCH_H
+
+#include <stddef.h>
+
+/**
+ * @file ws_batch.h
+ * @brief Outbound WebSocket batch: coalesces JSON messages into one JSON-array frame.
+ *
+ * Messages are appended to a growing "[m1,m2,..." buffer. The batch is ready
+ * to send once it holds max_bytes or its oldest message is window_us old;
+ * ws_batch_frame closes the array and ws_batch_clear starts the next batch.
+ *
+ * @note The batch does no locking: only the server's event loop thread
+ *       touches it (see ws_bridge.h).
+ */
+
+// --- Data Structures ---
+typedef struct ws_batch {
+    char* buf; // "[" followed by the comma-separated messages
+    size_t len;
+    size_t cap;
+    int count; // messages in the batch
+    unsigned long oldest_us; // when the first message of the batch was appended
+    size_t max_bytes; // flush once the frame reaches this size
+    unsigned long window_us; // flush once the first message is this old
+} ws_batch_t;
+
+// --- Function Declarations ---
+/**
+ * @brief Initialize an empty WsBatch.
+ * @param b Pointer to the WsBatch to initialize.
+ * @param max_bytes Frame size at which the batch is full.
+ * @param window_us Age of the oldest message at which the batch is due, in microseconds.
+ * @return 1 on success, 0 on failure (e.g., memory allocation failure).
+ */
+int ws_batch_init(ws_batch_t* b, size_t max_bytes, unsigned long window_us);
+
+/**
+ * @brief Release the buffer of a WsBatch.
+ * @param b Pointer to the WsBatch.
+ */
+void ws_batch_destroy(ws_batch_t* b);
+
+/**
+ * @brief Change the size and age limits. Takes effect for the current batch.
+ * @param b Pointer to the WsBatch.
+ * @param max_bytes Frame size at which the batch is full.
+ * @param window_us Age of the oldest message at which the batch is due, in microseconds.
+ */
+void ws_batch_configure(ws_batch_t* b, size_t max_bytes, unsigned long window_us);
+
+/**
+ * @brief Append one JSON message. The buffer grows past max_bytes rather than
+ * split or drop a message; the batch then reports itself full.
+ * @param b Pointer to the WsBatch.
+ * @param json The JSON message (a complete object).
+ * @param len The length of the message.
+ * @param now_us The current time in microseconds (starts the window of an empty batch).
+ * @return 1 on success, 0 on failure (memory allocation failure; the message is not added).
+ */
+int ws_batch_append(ws_batch_t* b, const char* json, size_t len, unsigned long now_us);
+
+/**
+ * @brief Check if a WsBatch holds no messages.
+ * @param b Pointer to the WsBatch.
+ * @return 1 if empty, 0 otherwise.
+ */
+int ws_batch_is_empty(const ws_batch_t* b);
+
+/**
+ * @brief Check if a WsBatch has reached max_bytes.
+ * @param b Pointer to the WsBatch.
+ * @return 1 if full, 0 otherwise.
+ */
+int ws_batch_is_full(const ws_batch_t* b);
+
+/**
+ * @brief Check if a non-empty WsBatch should be sent now (full, or its window has passed).
+ * @param b Pointer to the WsBatch.
+ * @param now_us The current time in microseconds.
+ * @return 1 if due, 0 otherwise.
+ */
+int ws_batch_is_due(const ws_batch_t* b, unsigned long now_us);
+
+/**
+ * @brief Get the time until a non-empty WsBatch is due.
+ * @param b Pointer to the WsBatch.
+ * @param now_us The current time in microseconds.
+ * @return Microseconds until the window passes, 0 if already due or empty.
+ */
+unsigned long ws_batch_time_left_us(const ws_batch_t* b, unsigned long now_us);
+
+/**
+ * @brief Close the JSON array and get the frame to send.
+ * The frame stays valid until the next append or clear.
+ * @param b Pointer to the WsBatch.
+ * @param len Receives the length of the frame.
+ * @return Pointer to the frame, or NULL if the batch is empty.
+ */
+const char* ws_batch_frame(ws_batch_t* b, size_t* len);
+
+/**
+ * @brief Drop every message and start a new batch. Keeps the buffer.
+ * @param b Pointer to the WsBatch.
+ */
+void ws_batch_clear(ws_batch_t* b);
+
+#endif // WS_BATCH_H
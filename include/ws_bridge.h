@@ -3,13 +3,42 @@
 
 #include <stddef.h>
 
+#include "ws_stats.h"
+
+// WebSocket protocol versions, negotiated per connection with {"command":"hello","protocol":N}
+#define WS_PROTOCOL_SINGLE   1 // default: one JSON message per frame
+#define WS_PROTOCOL_BATCHED  2 // event frames carry a JSON array of one or more messages
+#define WS_PROTOCOL_LATEST   WS_PROTOCOL_BATCHED
+
 /** 
- * @brief Thread-safe enqueue of a websocket text frame to the active client.
- * This can be called from any thread. Delivery is performed on the
- * Mongoose event loop via MG_EV_WAKEUP.
+ * @brief Thread-safe enqueue of a websocket text frame to every client of the
+ * calling thread's session (see log_router_session). This can be called from
+ * any thread. The message is queued on the session's outbox ring (see
+ * ws_outbox.h) and fanned out by the Mongoose event loop: one frame
+ * per message for protocol 1 clients, appended to the client's batch for
+ * protocol 2 clients.
  * @param json The JSON string to send.
  * @param len The length of the JSON string.
  */
 void ws_bridge_send_json_from_any_thread(const char *json, size_t len);
 
+/**
+ * @brief Thread-safe enqueue of a per-job log line to every client of the
+ * session. Like
+ * ws_bridge_send_json_from_any_thread, except that a client whose queue is
+ * over CONFIG_WS_CLIENT_LOSSY_THRESHOLD gets only some of these lines.
+ * @param json The JSON string to send.
+ * @param len The length of the JSON string.
+ */
+void ws_bridge_send_log_from_any_thread(const char *json, size_t len);
+
+/**
+ * @brief Thread-safe enqueue of a stats snapshot to every client of the session.
+ * Replaces any snapshot the event loop has not sent yet, and is held back
+ * from a client until everything queued before it has gone out. The event
+ * loop encodes it per client, as a delta when the simulation asked for them.
+ * @param stats The snapshot to send.
+ */
+void ws_bridge_send_stats_from_any_thread(const ws_stats_t *stats);
+
 #endif // WS_BRIDGE_H
@@ -0,0 +1,100 @@
+#ifndef WS_DEFLATE_H
+#define WS_DEFLATE_H
+
+#include <stddef.h>
+#include <zlib.h>
+
+/**
+ * @file ws_deflate.h
+ * @brief permessage-deflate (RFC 7692) for one WebSocket connection.
+ *
+ * Outbound messages are raw-deflated with a sync flush and sent with RSV1 set;
+ * the trailing 00 00 ff ff of the flush is stripped as the RFC requires. With
+ * context takeover (the default) the deflate window carries over between
+ * messages, so the repeated text of log lines compresses against earlier ones.
+ * Inbound compressed messages (client commands) are inflated the same way.
+ *
+ * @note Not thread-safe: the server's event loop thread owns every instance.
+ */
+
+// RSV1 bit of the first frame header byte: the message is compressed
+#define WS_DEFLATE_RSV1 0x40
+
+// --- Data Structures ---
+typedef struct ws_deflate_buffer {
+    unsigned char* data;
+    size_t cap;
+} ws_deflate_buffer_t;
+
+typedef struct ws_deflate {
+    z_stream deflater;
+    z_stream inflater;
+    int no_context_takeover; // client asked for server_no_context_takeover
+    ws_deflate_buffer_t compressed; // last outbound message
+    ws_deflate_buffer_t inflated; // last inbound message
+} ws_deflate_t;
+
+// --- Function Declarations ---
+/**
+ * @brief Parse a Sec-WebSocket-Extensions request header for a permessage-deflate
+ * offer the server can accept.
+ * @param header The header value.
+ * @param len The length of the header value.
+ * @param window_bits In: the server's preferred window (9-15). Out: the window to use,
+ *        lowered to the offer's server_max_window_bits if it has one.
+ * @param no_context_takeover Out: TRUE if the offer has server_no_context_takeover.
+ * @return 1 if the offer can be accepted, 0 if there is none or it asks for a window below 9.
+ */
+int ws_deflate_parse_offer(const char* header, size_t len, int* window_bits, int* no_context_takeover);
+
+/**
+ * @brief Format the Sec-WebSocket-Extensions response header for an accepted offer.
+ * @param buf Output buffer.
+ * @param size Size of buf.
+ * @param window_bits The window the server will use.
+ * @param no_context_takeover TRUE to confirm server_no_context_takeover.
+ * @return Number of characters written (as snprintf).
+ */
+int ws_deflate_response_header(char* buf, size_t size, int window_bits, int no_context_takeover);
+
+/**
+ * @brief Initialize the compression state of a connection.
+ * @param d Pointer to the WsDeflate to initialize.
+ * @param level zlib compression level (1-9).
+ * @param window_bits Deflate window, 9-15.
+ * @param mem_level zlib memLevel (1-9): memory for the match finder.
+ * @param no_context_takeover TRUE to start every message from an empty window.
+ * @return 1 on success, 0 on failure (e.g., memory allocation failure).
+ */
+int ws_deflate_init(ws_deflate_t* d, int level, int window_bits, int mem_level, int no_context_takeover);
+
+/**
+ * @brief Release the compression state of a connection.
+ * @param d Pointer to the WsDeflate.
+ */
+void ws_deflate_destroy(ws_deflate_t* d);
+
+/**
+ * @brief Compress one message for a frame with RSV1 set.
+ * @param d Pointer to the WsDeflate.
+ * @param data The message.
+ * @param len The length of the message.
+ * @param out_len Receives the compressed length.
+ * @return The compressed message, valid until the next compress on d, or NULL on failure
+ *         (the stream is then unusable: close the connection).
+ */
+const unsigned char* ws_deflate_compress(ws_deflate_t* d, const void* data, size_t len, size_t* out_len);
+
+/**
+ * @brief Inflate one message received with RSV1 set.
+ * @param d Pointer to the WsDeflate.
+ * @param data The compressed message.
+ * @param len The length of the compressed message.
+ * @param max_len Largest inflated size accepted.
+ * @param out_len Receives the inflated length.
+ * @return The inflated message, valid until the next inflate on d, or NULL if it is
+ *         corrupt or larger than max_len (close the connection).
+ */
+const unsigned char* ws_deflate_inflate(ws_deflate_t* d, const void* data, size_t len, size_t max_len, size_t* out_len);
+
+#endif // WS_DEFLATE_H
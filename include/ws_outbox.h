@@ -0,0 +1,141 @@
+#ifndef WS_OUTBOX_H
+#define WS_OUTBOX_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "ring_buffer.h"
+
+/**
+ * @file ws_outbox.h
+ * @brief Hand-off of outbound WebSocket messages from simulation threads to the event loop.
+ *
+ * Producers on any thread copy a message once into a heap record and push it
+ * onto a lock-free ring; the event loop pops and sends on every poll tick.
+ * Only the producer that finds the doorbell unrung has to wake the loop, so a
+ * burst of messages costs one wakeup instead of one pipe copy per message.
+ *
+ * stats_update snapshots skip the ring: each one replaces the previous one in a
+ * single latest-value slot. The loop encodes whichever is newest for each client
+ * that has room for it (see ws_stats.h), so a slow client loses intermediate
+ * stats, never events.
+ *
+ * Each message is copied once and shared by every client it is fanned out to:
+ * the event loop takes a reference per client queue and releases it once sent.
+ *
+ * Producers never wait for the loop: the loop may itself be waiting on a
+ * producer (the log formatter). When the ring is full a lossy message is
+ * dropped and counted, and any other message is appended to an overflow list
+ * that the loop drains after the ring. Messages keep their order.
+ *
+ * @note Popped and taken messages carry one reference that belongs to the caller.
+ *       Reference counts are not atomic: only the event loop thread touches them.
+ */
+
+// --- Data Structures ---
+typedef struct ws_message {
+    int refs; // the message is freed when the last holder releases it
+    int lossy; // TRUE if a slow client may skip it (see ws_outbox_push)
+    struct ws_message* next; // next message in the overflow list
+    size_t len;
+    char data[]; // the JSON message, not NUL-terminated (or a stats snapshot)
+} ws_message_t;
+
+typedef struct ws_outbox {
+    ring_buffer_t pending; // ws_message_t*, oldest first
+    _Atomic(ws_message_t*) latest_stats; // newest unsent stats_update, or NULL
+    atomic_int doorbell; // 1 from the first unanswered push until the loop answers
+    pthread_mutex_t overflow_mutex; // protects the overflow list
+    ws_message_t* overflow_head; // messages that found the ring full, oldest first
+    ws_message_t* overflow_tail;
+    atomic_int overflow_count; // while non-zero, new messages queue behind the overflow list
+    atomic_ulong dropped; // lossy messages dropped on a full ring
+} ws_outbox_t;
+
+// --- Function Declarations ---
+/**
+ * @brief Initialize an empty WsOutbox.
+ * @param outbox Pointer to the WsOutbox to initialize.
+ * @param capacity Messages the ring holds before lossy messages are dropped and the rest overflow.
+ * @return 1 on success, 0 on failure (e.g., memory allocation failure).
+ */
+int ws_outbox_init(ws_outbox_t* outbox, size_t capacity);
+
+/**
+ * @brief Free every pending message and the ring.
+ * @param outbox Pointer to the WsOutbox.
+ */
+void ws_outbox_destroy(ws_outbox_t* outbox);
+
+/**
+ * @brief Queue a copy of a message. Thread-safe, never waits for the loop.
+ * On a full ring a lossy message is dropped (see ws_outbox_dropped), any other
+ * one goes to the overflow list, so events are delayed rather than lost.
+ * @param outbox Pointer to the WsOutbox.
+ * @param json The JSON message.
+ * @param len The length of the message.
+ * @param lossy TRUE for messages a client that falls behind can do without
+ *        (per-job log lines), FALSE for messages every client must get.
+ * @return 1 if the caller must ring the event loop's doorbell, 0 if a wakeup is already pending
+ *         or the message could not be allocated.
+ */
+int ws_outbox_push(ws_outbox_t* outbox, const char* json, size_t len, int lossy);
+
+/**
+ * @brief Replace the pending stats snapshot with a copy of this one. Thread-safe, never waits.
+ * @param outbox Pointer to the WsOutbox.
+ * @param stats The snapshot (the server passes a ws_stats_t; the outbox only copies bytes).
+ * @param len The size of the snapshot.
+ * @return 1 if the caller must ring the event loop's doorbell, 0 otherwise (as ws_outbox_push).
+ */
+int ws_outbox_put_stats(ws_outbox_t* outbox, const void* stats, size_t len);
+
+/**
+ * @brief Mark the doorbell as answered. The event loop calls this before it
+ * drains, so a push that lands after the drain rings again.
+ * @param outbox Pointer to the WsOutbox.
+ */
+void ws_outbox_answer_doorbell(ws_outbox_t* outbox);
+
+/**
+ * @brief Get the number of lossy messages dropped because the ring was full.
+ * @param outbox Pointer to the WsOutbox.
+ * @return Messages dropped since init.
+ */
+unsigned long ws_outbox_dropped(ws_outbox_t* outbox);
+
+/**
+ * @brief Take the oldest queued message, from the ring or else the overflow list. Event loop only.
+ * @param outbox Pointer to the WsOutbox.
+ * @return The message (released by the caller), or NULL if none is queued.
+ */
+ws_message_t* ws_outbox_pop(ws_outbox_t* outbox);
+
+/**
+ * @brief Take the pending stats_update. Event loop only.
+ * @param outbox Pointer to the WsOutbox.
+ * @return The message (released by the caller), or NULL if none is pending.
+ */
+ws_message_t* ws_outbox_take_stats(ws_outbox_t* outbox);
+
+/**
+ * @brief Take another reference to a message. Event loop only.
+ * @param message The message.
+ * @return The same message, for chaining.
+ */
+ws_message_t* ws_message_retain(ws_message_t* message);
+
+/**
+ * @brief Drop a reference to a message, freeing it with the last one. Event loop only.
+ * @param message The message (NULL is ignored).
+ */
+void ws_message_release(ws_message_t* message);
+
+/**
+ * @brief Release every queued message (overflow list included) and the pending stats_update.
+ * @param outbox Pointer to the WsOutbox.
+ */
+void ws_outbox_clear(ws_outbox_t* outbox);
+
+#endif // WS_OUTBOX_H
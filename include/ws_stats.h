@@ -0,0 +1,62 @@
+#ifndef WS_STATS_H
+#define WS_STATS_H
+
+#include <stddef.h>
+
+/**
+ * @file ws_stats.h
+ * @brief stats_update frames for WebSocket clients, full or delta-encoded.
+ *
+ * The formatter thread fills a WsStats snapshot instead of a JSON string; the
+ * event loop encodes it once per client. In delta mode a frame carries only
+ * the fields that changed since the last frame sent to that client, and every
+ * CONFIG_WS_STATS_KEYFRAME_INTERVAL-th frame is a full keyframe so a client
+ * that missed a frame (or joined late) converges.
+ *
+ * Keyframe: {"type":"stats_update", "data":{<every field>}}
+ * Delta:    {"type":"stats_update", "delta":true, "data":{<changed fields>}}
+ */
+
+// Field indexes, in the order the full frame lists them
+#define WS_STATS_JOBS_PROCESSED      0
+#define WS_STATS_JOBS_RECEIVED       1
+#define WS_STATS_QUEUE_LENGTH        2
+#define WS_STATS_AVG_COMPLETION_TIME 3
+#define WS_STATS_PAPERS_USED         4
+#define WS_STATS_REFILL_EVENTS       5
+#define WS_STATS_AVG_SERVICE_TIME    6
+#define WS_STATS_FIELD_COUNT         7
+
+// Largest frame ws_stats_encode writes
+#define WS_STATS_FRAME_MAX           512
+
+// --- Data Structures ---
+typedef struct ws_stats {
+    double values[WS_STATS_FIELD_COUNT];
+} ws_stats_t;
+
+// What one client was last sent
+typedef struct ws_stats_encoder {
+    long long sent[WS_STATS_FIELD_COUNT]; // values as last sent, scaled to their printed precision
+    int frames_since_keyframe; // -1 until the first keyframe
+} ws_stats_encoder_t;
+
+// --- Function Declarations ---
+/**
+ * @brief Start a client over: its next frame is a keyframe.
+ * @param encoder Pointer to the WsStatsEncoder.
+ */
+void ws_stats_encoder_reset(ws_stats_encoder_t* encoder);
+
+/**
+ * @brief Encode a snapshot for one client and remember what it was sent.
+ * @param encoder Pointer to the client's WsStatsEncoder.
+ * @param stats The snapshot.
+ * @param delta TRUE to send only changed fields between keyframes, FALSE to always send keyframes.
+ * @param buf Output buffer of at least WS_STATS_FRAME_MAX bytes.
+ * @param size Size of buf.
+ * @return Length of the frame, or 0 if there is nothing to send (a delta with no changed field).
+ */
+size_t ws_stats_encode(ws_stats_encoder_t* encoder, const ws_stats_t* stats, int delta, char* buf, size_t size);
+
+#endif // WS_STATS_H
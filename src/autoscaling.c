@@ -1,39 +1,46 @@
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
-#include <unistd.h>
 
 #include "autoscaling.h"
 #include "config.h"
 #include "printer.h"
 #include "timed_queue.h"
+#include "job_dispatcher.h"
 #include "preprocessing.h"
 #include "timeutils.h"
 #include "common.h"
 #include "log_router.h"
 
 extern int g_debug;
-extern int g_terminate_now;
+
+/**
+ * @brief Reads the number of queued jobs from the shared queue or the per-printer deques.
+ */
+static int backlog_length(autoscaling_thread_args_t* args) {
+    if (args->dispatcher != NULL) {
+        return job_dispatcher_length(args->dispatcher); // lock-free, no job_queue_mutex needed
+    }
+    pthread_mutex_lock(args->job_queue_mutex);
+    int queue_length = timed_queue_length(args->job_queue);
+    pthread_mutex_unlock(args->job_queue_mutex);
+    return queue_length;
+}
 
 int get_scale_up_threshold(int active_printers) {
-    switch (active_printers) {
-        case 2:
-            return CONFIG_AUTOSCALE_THRESHOLD_2_PRINTERS;
-        case 3:
-            return CONFIG_AUTOSCALE_THRESHOLD_3_PRINTERS;
-        case 4:
-            return CONFIG_AUTOSCALE_THRESHOLD_4_PRINTERS;
-        default:
-            return 999999; // No scaling for 5+ printers
+    if (active_printers < CONFIG_AUTOSCALE_MIN_SCALING_PRINTERS) {
+        return INT_MAX; // No scaling from a single printer
     }
+    return active_printers * CONFIG_AUTOSCALE_THRESHOLD_PER_PRINTER;
 }
 
 int should_scale_up(printer_pool_t* pool, int queue_length, unsigned long current_time_us) {
     pthread_mutex_lock(&pool->pool_mutex);
     
     // Check if we're at max capacity
-    if (pool->active_count >= CONFIG_RANGE_CONSUMER_COUNT_MAX) {
+    if (pool->active_count >= pool->capacity) {
         pthread_mutex_unlock(&pool->pool_mutex);
         return 0;
     }
@@ -107,7 +114,7 @@ int scale_up(autoscaling_thread_args_t* args) {
     
     pthread_mutex_lock(&pool->pool_mutex);
     
-    if (pool->active_count >= CONFIG_RANGE_CONSUMER_COUNT_MAX) {
+    if (pool->active_count >= pool->capacity) {
         pthread_mutex_unlock(&pool->pool_mutex);
         return 0;
     }
@@ -116,32 +123,34 @@ int scale_up(autoscaling_thread_args_t* args) {
     
     // Create template args for new printer
     printer_thread_args_t shared_args = {
-        .paper_refill_queue_mutex = args->job_queue_mutex,
+        .paper_refill_queue_mutex = args->paper_refill_queue_mutex,
         .job_queue_mutex = args->job_queue_mutex,
-        .stats_mutex = args->stats_mutex,
         .simulation_state_mutex = args->simulation_state_mutex,
+        .simulation_state_cv = args->simulation_state_cv,
         .job_queue_not_empty_cv = args->job_queue_not_empty_cv,
         .refill_needed_cv = args->refill_needed_cv,
         .refill_supplier_cv = args->refill_supplier_cv,
-        .paper_refill_thread = args->paper_refill_thread,
         .job_queue = args->job_queue,
+        .dispatcher = args->dispatcher,
         .paper_refill_queue = args->paper_refill_queue,
         .params = args->params,
         .stats = args->stats,
         .all_jobs_served = args->all_jobs_served,
         .all_jobs_arrived = args->all_jobs_arrived,
+        .terminate_now = args->terminate_now,
+        .session_id = args->session_id,
         .printer = NULL // Will be set by printer_pool_start_printer
     };
     
-    pthread_mutex_lock(args->job_queue_mutex);
-    int queue_length = timed_queue_length(args->job_queue);
-    pthread_mutex_unlock(args->job_queue_mutex);
+    int queue_length = backlog_length(args);
     
     unsigned long current_time_us = get_time_in_us();
     emit_scale_up(pool->active_count + 1, queue_length, current_time_us); // +1 because this log prints before actual scaling
     if (printer_pool_start_printer(pool, new_printer_id, &shared_args)) {
         pool->last_scale_time_us = current_time_us;
         pool->low_queue_start_time_us = 0; // Reset scale-down timer
+        // Hand the new printer its share of the queued jobs
+        job_dispatcher_rebalance(args->dispatcher);
 
         if (g_debug) {
             printf("Printer %d thread started\n", new_printer_id);
@@ -178,21 +187,20 @@ int scale_down(autoscaling_thread_args_t* args) {
         return 0;
     }
     
-    // Cancel and join the printer thread
-    pthread_cancel(pool->printers[printer_to_remove].thread);
-    pthread_mutex_unlock(&pool->pool_mutex); // Unlock before join to avoid deadlock
-    pthread_join(pool->printers[printer_to_remove].thread, NULL);
+    // Stop the printer after its current jobs; its worker parks for the next scale-up
+    pthread_mutex_unlock(&pool->pool_mutex); // Unlock before waiting to avoid deadlock
+    printer_pool_stop_printer(pool, printer_to_remove + 1);
     pthread_mutex_lock(&pool->pool_mutex);
     
     pool->printers[printer_to_remove].active = 0;
     pool->active_count--;
+    // Move the jobs still on the stopped printer's deque to the remaining printers
+    job_dispatcher_close(args->dispatcher, printer_to_remove);
     unsigned long current_time_us = get_time_in_us();
     pool->last_scale_time_us = current_time_us;
     pool->low_queue_start_time_us = 0; // Reset timer
     
-    pthread_mutex_lock(args->job_queue_mutex);
-    int queue_length = timed_queue_length(args->job_queue);
-    pthread_mutex_unlock(args->job_queue_mutex);
+    int queue_length = backlog_length(args);
     
     emit_scale_down(pool->active_count, queue_length, current_time_us);
     if (g_debug) {
@@ -207,19 +215,18 @@ void* autoscaling_thread_func(void* arg) {
     autoscaling_thread_args_t* args = (autoscaling_thread_args_t*)arg;
     
     if (g_debug) printf("Autoscaling thread started\n");
+    log_router_bind_session(args->session_id);
     
     while (1) {
         // Check termination
         pthread_mutex_lock(args->simulation_state_mutex);
-        int terminate = g_terminate_now || *args->all_jobs_served;
+        int terminate = *(args->terminate_now) || *args->all_jobs_served;
         pthread_mutex_unlock(args->simulation_state_mutex);
         
         if (terminate) break;
         
         // Get current queue length
-        pthread_mutex_lock(args->job_queue_mutex);
-        int queue_length = timed_queue_length(args->job_queue);
-        pthread_mutex_unlock(args->job_queue_mutex);
+        int queue_length = backlog_length(args);
         
         unsigned long current_time_us = get_time_in_us();
         
@@ -230,8 +237,9 @@ void* autoscaling_thread_func(void* arg) {
             scale_down(args);
         }
         
-        // Sleep for check interval
-        usleep(CONFIG_AUTOSCALE_CHECK_INTERVAL_US);
+        // Sleep for check interval, or until the last printer is done
+        clock_sleep_unless(CONFIG_AUTOSCALE_CHECK_INTERVAL_US, args->all_jobs_served,
+                           args->simulation_state_mutex, args->simulation_state_cv);
     }
     
     if (g_debug) printf("Autoscaling thread exiting\n");
@@ -8,6 +8,7 @@
 #include "linked_list.h"
 #include "timed_queue.h"
 #include "job_receiver.h"
+#include "job_dispatcher.h"
 #include "paper_refiller.h"
 #include "printer.h"
 #include "autoscaling.h"
@@ -17,9 +18,11 @@
 #include "console_handler.h"
 #include "simulation_stats.h"
 #include "signalcatcher.h"
+#include "virtual_engine.h"
+#include "timeutils.h"
+#include "worker_pool.h"
 
 extern int g_debug;
-extern int g_terminate_now;
 
 int main(int argc, char *argv[]) {
     sigset_t set;
@@ -27,11 +30,11 @@ int main(int argc, char *argv[]) {
     sigaddset(&set, SIGINT);
     sigprocmask(SIG_BLOCK, &set, (sigset_t*)0);
 
-    // --- Thread identifiers ---
-    pthread_t job_receiver_thread;
-    pthread_t paper_refill_thread;
+    // --- Thread identifiers (the simulation roles run on workers, see worker_pool.h) ---
     pthread_t signal_catching_thread;
-    pthread_t autoscaling_thread;
+    worker_t* job_receiver_worker;
+    worker_t* paper_refill_worker;
+    worker_t* autoscaling_worker = NULL;
 
     // --- Synchronization primitives (shared) ---
     pthread_mutex_t job_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -41,81 +44,122 @@ int main(int argc, char *argv[]) {
     pthread_cond_t job_queue_not_empty_cv = PTHREAD_COND_INITIALIZER;
     pthread_cond_t refill_needed_cv = PTHREAD_COND_INITIALIZER;
     pthread_cond_t refill_supplier_cv = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t simulation_state_cv; // timed waits (clock_sleep_unless) need the monotonic clock
+    clock_cond_init(&simulation_state_cv);
 
     // --- Simulation state ---
     simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS_HIGH_LOAD;
-    simulation_statistics_t stats = (simulation_statistics_t){0};
+    simulation_statistics_t stats;
     int all_jobs_arrived = 0;
     int all_jobs_served = 0;
+    int terminate_now = 0; // set by the signal catcher on Ctrl+C
     timed_queue_t job_queue;
     linked_list_t paper_refill_queue;
-    timed_queue_init(&job_queue);
     list_init(&paper_refill_queue);
 
     if (!process_args(argc, argv, &params)) return 1;
+    if (!simulation_stats_init(&stats, params.max_consumer_count)) {
+        fprintf(stderr, "Error: Failed to allocate printer statistics\n");
+        return 1;
+    }
+    if (!job_queue_init(&job_queue, &params)) {
+        fprintf(stderr, "Error: Failed to initialize job queue\n");
+        return 1;
+    }
+
+    // --- Per-printer deques (only in the round-robin / shortest-queue dispatch modes) ---
+    job_dispatcher_t job_dispatcher;
+    job_dispatcher_t* dispatcher = NULL;
+    if (params.dispatch_mode != JOB_DISPATCH_SHARED) {
+        if (!job_dispatcher_init(&job_dispatcher, params.dispatch_mode, params.max_consumer_count,
+                job_queue_key, CONFIG_JOB_INDEX_INITIAL_CAPACITY)) {
+            fprintf(stderr, "Error: Failed to initialize job dispatcher\n");
+            return 1;
+        }
+        dispatcher = &job_dispatcher;
+    }
+
+    // --- Worker threads: receiver, refiller, autoscaler and one per printer slot ---
+    worker_pool_t workers;
+    if (!worker_pool_init(&workers, params.max_consumer_count + 3)) {
+        fprintf(stderr, "Error: Failed to allocate worker pool\n");
+        return 1;
+    }
 
     // --- Printer Pool ---
     printer_pool_t printer_pool;
-    printer_pool_init(&printer_pool, params.consumer_count, params.printer_paper_capacity);
+    if (!printer_pool_init(&printer_pool, params.consumer_count, params.max_consumer_count,
+            params.printer_paper_capacity, &workers)) {
+        fprintf(stderr, "Error: Failed to allocate printer pool\n");
+        return 1;
+    }
 
     // --- Thread argument structs ---
     job_thread_args_t job_receiver_args = {
         .job_queue_mutex = &job_queue_mutex,
-        .stats_mutex = &stats_mutex,
         .simulation_state_mutex = &simulation_state_mutex,
+        .simulation_state_cv = &simulation_state_cv,
         .job_queue_not_empty_cv = &job_queue_not_empty_cv,
         .job_queue = &job_queue,
+        .dispatcher = dispatcher,
         .simulation_params = &params,
         .stats = &stats,
-        .all_jobs_arrived = &all_jobs_arrived
+        .all_jobs_arrived = &all_jobs_arrived,
+        .terminate_now = &terminate_now,
+        .random_seed = 1 // every CLI run draws the same jobs
     };
 
     // Shared printer args template (printer pointer will be set by pool)
     printer_thread_args_t shared_printer_args = {
         .paper_refill_queue_mutex = &paper_refill_queue_mutex,
         .job_queue_mutex = &job_queue_mutex,
-        .stats_mutex = &stats_mutex,
         .simulation_state_mutex = &simulation_state_mutex,
+        .simulation_state_cv = &simulation_state_cv,
         .job_queue_not_empty_cv = &job_queue_not_empty_cv,
         .refill_needed_cv = &refill_needed_cv,
         .refill_supplier_cv = &refill_supplier_cv,
-        .paper_refill_thread = &paper_refill_thread,
         .job_queue = &job_queue,
+        .dispatcher = dispatcher,
         .paper_refill_queue = &paper_refill_queue,
         .params = &params,
         .stats = &stats,
         .all_jobs_served = &all_jobs_served,
         .all_jobs_arrived = &all_jobs_arrived,
+        .terminate_now = &terminate_now,
         .printer = NULL // Set by printer_pool_start_printer
     };
 
     paper_refill_thread_args_t paper_refill_args = {
         .paper_refill_queue_mutex = &paper_refill_queue_mutex,
-        .stats_mutex = &stats_mutex,
         .simulation_state_mutex = &simulation_state_mutex,
+        .simulation_state_cv = &simulation_state_cv,
         .refill_needed_cv = &refill_needed_cv,
         .refill_supplier_cv = &refill_supplier_cv,
         .paper_refill_queue = &paper_refill_queue,
         .job_queue = &job_queue,
+        .dispatcher = dispatcher,
         .params = &params,
         .stats = &stats,
-        .all_jobs_served = &all_jobs_served
+        .all_jobs_served = &all_jobs_served,
+        .terminate_now = &terminate_now
     };
 
     autoscaling_thread_args_t autoscaling_args = {
         .job_queue_mutex = &job_queue_mutex,
-        .stats_mutex = &stats_mutex,
+        .paper_refill_queue_mutex = &paper_refill_queue_mutex,
         .simulation_state_mutex = &simulation_state_mutex,
+        .simulation_state_cv = &simulation_state_cv,
         .job_queue_not_empty_cv = &job_queue_not_empty_cv,
         .refill_needed_cv = &refill_needed_cv,
         .refill_supplier_cv = &refill_supplier_cv,
-        .paper_refill_thread = &paper_refill_thread,
         .job_queue = &job_queue,
+        .dispatcher = dispatcher,
         .paper_refill_queue = &paper_refill_queue,
         .params = &params,
         .stats = &stats,
         .all_jobs_served = &all_jobs_served,
         .all_jobs_arrived = &all_jobs_arrived,
+        .terminate_now = &terminate_now,
         .pool = &printer_pool
     };
 
@@ -123,78 +167,121 @@ int main(int argc, char *argv[]) {
         .signal_set = &set,
         .job_queue_mutex = &job_queue_mutex,
         .simulation_state_mutex = &simulation_state_mutex,
+        .simulation_state_cv = &simulation_state_cv,
         .paper_refill_queue_mutex = &paper_refill_queue_mutex,
         .stats_mutex = &stats_mutex,
         .job_queue_not_empty_cv = &job_queue_not_empty_cv,
         .refill_needed_cv = &refill_needed_cv,
         .refill_supplier_cv = &refill_supplier_cv,
         .job_queue = &job_queue,
+        .dispatcher = dispatcher,
         .stats = &stats,
-        .job_receiver_thread = &job_receiver_thread,
-        .paper_refill_thread = &paper_refill_thread,
-        .all_jobs_arrived = &all_jobs_arrived
+        .all_jobs_arrived = &all_jobs_arrived,
+        .terminate_now = &terminate_now
     };
 
     // Register console handler (stdout logger) via handler module
     console_handler_register();
     // Terminal mode: print to stdout
     set_log_mode(LOG_MODE_TERMINAL);
+    // Format log lines on their own thread so simulation threads never wait on stdout
+    if (!log_router_start()) {
+        fprintf(stderr, "Failed to start the log formatter thread, logging synchronously\n");
+    }
+    // The virtual-time engine moves the clock every module reads, from the start message on;
+    // the thread engine sleeps on the scaled clock instead
+    if (params.engine == SIMULATION_ENGINE_VIRTUAL) {
+        virtual_clock_start(get_time_in_us());
+    } else {
+        clock_set_time_scale(params.time_scale);
+    }
     // --- Start of simulation logging ---
     emit_simulation_parameters(&params);
     emit_simulation_start(&stats);
 
-    // --- Create threads in order ---
-    // 1) Job receiver (produces jobs)
-    pthread_create(&job_receiver_thread, NULL, job_receiver_thread_func, &job_receiver_args);
+    if (params.engine == SIMULATION_ENGINE_VIRTUAL) {
+        // --- Run every component on this thread, on the virtual clock ---
+        virtual_engine_args_t engine_args = {
+            .job_queue = &job_queue,
+            .dispatcher = dispatcher,
+            .params = &params,
+            .stats = &stats,
+            .pool = &printer_pool,
+            .signal_set = &set,
+            .terminate_now = &terminate_now
+        };
+        if (!virtual_engine_run(&engine_args)) {
+            fprintf(stderr, "Error: Failed to start the virtual-time engine\n");
+        }
+    } else {
+        // --- Start threads in order ---
+        // Start every worker up front, so scaling up never waits for a new thread
+        if (!worker_pool_reserve(&workers, params.max_consumer_count + 3)) {
+            fprintf(stderr, "Warning: Failed to start all worker threads, scaling up may start them later\n");
+        }
 
-    // 2) Paper refiller (services refill requests)
-    pthread_create(&paper_refill_thread, NULL, paper_refill_thread_func, &paper_refill_args);
+        // 1) Job receiver (produces jobs)
+        job_receiver_worker = worker_pool_run(&workers, job_receiver_thread_func, &job_receiver_args);
 
-    // 3) Start initial printers (minimum count)
-    for (int i = 1; i <= params.consumer_count; i++) {
-        printer_pool_start_printer(&printer_pool, i, &shared_printer_args);
-    }
+        // 2) Paper refiller (services refill requests)
+        paper_refill_worker = worker_pool_run(&workers, paper_refill_thread_func, &paper_refill_args);
+        if (job_receiver_worker == NULL || paper_refill_worker == NULL) {
+            fprintf(stderr, "Error: Failed to start the simulation threads\n");
+            return 1;
+        }
 
-    // 4) Autoscaling thread (if enabled)
-    if (params.auto_scaling) {
-        pthread_create(&autoscaling_thread, NULL, autoscaling_thread_func, &autoscaling_args);
-        if (g_debug) printf("Autoscaling enabled\n");
-    }
+        // 3) Start initial printers (minimum count)
+        for (int i = 1; i <= params.consumer_count; i++) {
+            printer_pool_start_printer(&printer_pool, i, &shared_printer_args);
+        }
 
-    // 5) Signal catcher (created last, after we have thread IDs to pass by pointer)
-    pthread_create(&signal_catching_thread, NULL, sig_int_catching_thread_func, &signal_catching_args);
+        // 4) Autoscaling thread (if enabled)
+        if (params.auto_scaling) {
+            autoscaling_worker = worker_pool_run(&workers, autoscaling_thread_func, &autoscaling_args);
+            if (g_debug) printf("Autoscaling enabled\n");
+        }
 
-    // --- Wait for threads to finish ---
-    // Join producer first so no new jobs are created
-    pthread_join(job_receiver_thread, NULL);
-    if (g_debug) printf("job_receiver_thread joined\n");
+        // 5) Signal catcher (a thread of its own: it is cancelled once the run is over)
+        pthread_create(&signal_catching_thread, NULL, sig_int_catching_thread_func, &signal_catching_args);
 
-    // Join all printers
-    printer_pool_join_all(&printer_pool);
-    if (g_debug) printf("all printer threads joined\n");
+        // --- Wait for threads to finish ---
+        // Join producer first so no new jobs are created
+        worker_wait(&workers, job_receiver_worker);
+        if (g_debug) printf("job_receiver_thread joined\n");
 
-    // Join paper refiller
-    pthread_join(paper_refill_thread, NULL);
-    if (g_debug) printf("paper_refill_thread joined\n");
+        // Join all printers
+        printer_pool_join_all(&printer_pool);
+        if (g_debug) printf("all printer threads joined\n");
 
-    // Join autoscaling thread if it was started
-    if (params.auto_scaling) {
-        pthread_cancel(autoscaling_thread);
-        pthread_join(autoscaling_thread, NULL);
-        if (g_debug) printf("autoscaling thread joined\n");
-    }
+        // Join paper refiller
+        worker_wait(&workers, paper_refill_worker);
+        if (g_debug) printf("paper_refill_thread joined\n");
 
-    // Signal catcher might still be waiting for SIGINT; cancel and join
-    pthread_cancel(signal_catching_thread);
-    pthread_join(signal_catching_thread, NULL);
-    if (g_debug) printf("signal catching thread joined\n");
+        // Join autoscaling thread if it was started; it returns once the last printer is done
+        if (autoscaling_worker != NULL) {
+            worker_wait(&workers, autoscaling_worker);
+            if (g_debug) printf("autoscaling thread joined\n");
+        }
+
+        // Signal catcher might still be waiting for SIGINT; cancel and join
+        pthread_cancel(signal_catching_thread);
+        pthread_join(signal_catching_thread, NULL);
+        if (g_debug) printf("signal catching thread joined\n");
+    }
 
     // --- Final logging ---
     emit_simulation_end(&stats);
     emit_statistics(&stats);
+    log_router_stop();
+    virtual_clock_stop();
 
-    // --- Cleanup printer pool ---
+    // --- Cleanup printer pool and worker threads ---
     printer_pool_destroy(&printer_pool);
+    worker_pool_destroy(&workers);
+    timed_queue_destroy(&job_queue);
+    if (dispatcher != NULL) job_dispatcher_destroy(dispatcher);
+    list_destroy(&paper_refill_queue);
+    simulation_stats_destroy(&stats);
 
     // --- Cleanup synchronization primitives ---
     pthread_mutex_destroy(&job_queue_mutex);
@@ -204,6 +291,7 @@ int main(int argc, char *argv[]) {
     pthread_cond_destroy(&job_queue_not_empty_cv);
     pthread_cond_destroy(&refill_needed_cv);
     pthread_cond_destroy(&refill_supplier_cv);
+    pthread_cond_destroy(&simulation_state_cv);
 
     if (g_debug) printf("All threads joined and resources cleaned up.\n");
     return 0;
@@ -1,16 +1,159 @@
-#include <sys/time.h>
+#include <time.h>
 #include <math.h>
+#include <errno.h>
 #include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
 
 #include "timeutils.h"
 
 const char time_format[] = "%08d.%03dms: ";
 
+// Set while a discrete-event engine runs on this thread. Per thread, so several
+// engines (e.g. a parameter sweep) can each run on their own virtual clock
+static _Thread_local int t_virtual_enabled = 0;
+static _Thread_local unsigned long t_virtual_now_us = 0;
+
+// Simulated time = s_origin_sim_us + (unscaled time - s_origin_real_us) * s_time_scale.
+// All zero/one until clock_set_time_scale is called, so simulated time starts as the unscaled time.
+// The three change together under a seqlock: s_clock_seq is odd while clock_set_time_scale
+// rewrites them, and readers retry until they load all three within one even sequence.
+static atomic_ulong s_origin_real_us = 0;
+static atomic_ulong s_origin_sim_us = 0;
+static _Atomic double s_time_scale = 1.0;
+static atomic_uint s_clock_seq = 0;
+static pthread_mutex_t s_clock_writer_mutex = PTHREAD_MUTEX_INITIALIZER; // one writer at a time
+
+typedef struct {
+    unsigned long origin_real_us;
+    unsigned long origin_sim_us;
+    double scale;
+} clock_mapping_t;
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Loads the origin and scale published by the same clock_set_time_scale call.
+ */
+static clock_mapping_t load_clock_mapping(void) {
+    clock_mapping_t mapping;
+    unsigned int seq;
+    do {
+        seq = atomic_load_explicit(&s_clock_seq, memory_order_acquire);
+        mapping.origin_real_us = atomic_load_explicit(&s_origin_real_us, memory_order_relaxed);
+        mapping.origin_sim_us = atomic_load_explicit(&s_origin_sim_us, memory_order_relaxed);
+        mapping.scale = atomic_load_explicit(&s_time_scale, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) || seq != atomic_load_explicit(&s_clock_seq, memory_order_relaxed));
+    return mapping;
+}
+
+/**
+ * @brief Converts a simulated time to the unscaled (CLOCK_MONOTONIC) time it happens at.
+ */
+static unsigned long sim_to_real_us(unsigned long sim_time_us) {
+    clock_mapping_t mapping = load_clock_mapping();
+    if (sim_time_us <= mapping.origin_sim_us) return mapping.origin_real_us;
+    return mapping.origin_real_us + (unsigned long)((sim_time_us - mapping.origin_sim_us) / mapping.scale);
+}
+
+static struct timespec us_to_timespec(unsigned long time_us) {
+    struct timespec ts;
+    ts.tv_sec = time_us / 1000000;
+    ts.tv_nsec = (long)(time_us % 1000000) * 1000;
+    return ts;
+}
+
+// --- Public API Function Implementations ---
+
+unsigned long get_unscaled_time_in_us() {
+    struct timespec now;
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 unsigned long get_time_in_us() {
-    struct timeval now;
-    (void) gettimeofday(&now, NULL);
-    unsigned long time_us = now.tv_sec * 1000000 + now.tv_usec;
-    return time_us;
+    if (t_virtual_enabled) return t_virtual_now_us;
+    clock_mapping_t mapping = load_clock_mapping();
+    unsigned long real_us = get_unscaled_time_in_us();
+    return mapping.origin_sim_us + (unsigned long)((real_us - mapping.origin_real_us) * mapping.scale);
+}
+
+void clock_set_time_scale(double scale) {
+    if (scale <= 0) scale = 1.0;
+    pthread_mutex_lock(&s_clock_writer_mutex);
+    unsigned int seq = atomic_load_explicit(&s_clock_seq, memory_order_relaxed);
+    atomic_store_explicit(&s_clock_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    // Re-anchor at the current instant so simulated time stays continuous
+    unsigned long real_now_us = get_unscaled_time_in_us();
+    unsigned long origin_real_us = atomic_load_explicit(&s_origin_real_us, memory_order_relaxed);
+    unsigned long origin_sim_us = atomic_load_explicit(&s_origin_sim_us, memory_order_relaxed);
+    double old_scale = atomic_load_explicit(&s_time_scale, memory_order_relaxed);
+    unsigned long sim_now_us = origin_sim_us + (unsigned long)((real_now_us - origin_real_us) * old_scale);
+    atomic_store_explicit(&s_origin_real_us, real_now_us, memory_order_relaxed);
+    atomic_store_explicit(&s_origin_sim_us, sim_now_us, memory_order_relaxed);
+    atomic_store_explicit(&s_time_scale, scale, memory_order_relaxed);
+
+    atomic_store_explicit(&s_clock_seq, seq + 2, memory_order_release);
+    pthread_mutex_unlock(&s_clock_writer_mutex);
+}
+
+double clock_get_time_scale(void) {
+    return atomic_load_explicit(&s_time_scale, memory_order_relaxed);
+}
+
+void clock_sleep_until(unsigned long wake_time_us) {
+    // The discrete-event engine never sleeps; it moves the virtual clock instead
+    if (t_virtual_enabled) return;
+    struct timespec deadline = us_to_timespec(sim_to_real_us(wake_time_us));
+    // Absolute deadline: a signal interrupting the sleep does not stretch it
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) continue;
+}
+
+void clock_sleep_us(unsigned long duration_us) {
+    clock_sleep_until(get_time_in_us() + duration_us);
+}
+
+int clock_sleep_unless(unsigned long duration_us, const int* stop, pthread_mutex_t* mutex, pthread_cond_t* cv) {
+    unsigned long wake_time_us = get_time_in_us() + duration_us;
+    pthread_mutex_lock(mutex);
+    if (!t_virtual_enabled) {
+        struct timespec deadline = us_to_timespec(sim_to_real_us(wake_time_us));
+        while (!*stop && pthread_cond_timedwait(cv, mutex, &deadline) != ETIMEDOUT) continue;
+    }
+    int stopped = *stop;
+    pthread_mutex_unlock(mutex);
+    return !stopped;
+}
+
+int clock_cond_init(pthread_cond_t* cv) {
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0) return -1;
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int result = pthread_cond_init(cv, &attr);
+    pthread_condattr_destroy(&attr);
+    return result;
+}
+
+int clock_timed_wait(pthread_cond_t* cv, pthread_mutex_t* mutex, unsigned long timeout_us) {
+    double scale = atomic_load_explicit(&s_time_scale, memory_order_relaxed);
+    struct timespec deadline = get_wake_up_time_us((unsigned long)(timeout_us / scale));
+    return pthread_cond_timedwait(cv, mutex, &deadline);
+}
+
+void virtual_clock_start(unsigned long start_us) {
+    t_virtual_now_us = start_us;
+    t_virtual_enabled = 1;
+}
+
+void virtual_clock_advance(unsigned long now_us) {
+    if (now_us > t_virtual_now_us) t_virtual_now_us = now_us;
+}
+
+void virtual_clock_stop(void) {
+    t_virtual_enabled = 0;
 }
 
 void time_in_us_to_ms(unsigned long current_time_us, int* time_ms, int* time_us) {
@@ -18,19 +161,6 @@ void time_in_us_to_ms(unsigned long current_time_us, int* time_ms, int* time_us)
     *time_us = (int)(current_time_us % 1000);
 }
 
-struct timespec get_wake_up_time(int time_ms) {
-    struct timeval now;
-    struct timespec relative_timeout, absolute_timeout;
-    
-    gettimeofday(&now, 0);
-    relative_timeout.tv_sec = 0;
-    relative_timeout.tv_nsec = time_ms * 1000000; // milliseconds -> nanoseconds
-    absolute_timeout.tv_sec = now.tv_sec + relative_timeout.tv_sec;
-    absolute_timeout.tv_nsec = 1000*now.tv_usec + relative_timeout.tv_nsec;
-    while (absolute_timeout.tv_nsec >= 1000000000) {
-        // deal with the carry
-        absolute_timeout.tv_nsec -= 1000000000;
-        absolute_timeout.tv_sec++;
-    }
-    return absolute_timeout;
-}
\ No newline at end of file
+struct timespec get_wake_up_time_us(unsigned long timeout_us) {
+    return us_to_timespec(get_unscaled_time_in_us() + timeout_us);
+}
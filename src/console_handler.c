@@ -71,159 +71,98 @@ static void log_simulation_end(simulation_statistics_t* stats) {
 /**
  * @brief Logs an event when a new job is created in the system or when a job is dropped
  * 
- * @param job_id The id of the job that has been created or dropped.
- * @param papers_required The number of papers required by the job.
- * @param previous_job_arrival_time_us The arrival time of the previous job in microseconds
- * @param current_job_arrival_time_us The current simulation time in microseconds.
+ * @param event The arrival event (job id, papers required, arrival and inter-arrival time).
  * @param is_dropped Whether the job was dropped (TRUE) or created (FALSE).
  */
-static void job_arrival_helper(int job_id, int papers_required,
-    unsigned long previous_job_arrival_time_us, unsigned long current_job_arrival_time_us,
-    int is_dropped)
-{
+static void job_arrival_helper(const log_event_t* event, int is_dropped) {
     flockfile(stdout);
-    log_time(current_job_arrival_time_us, reference_time_us);
+    log_time(event->time_us, reference_time_us);
 
-    int inter_arrival_time_us = current_job_arrival_time_us - previous_job_arrival_time_us;
-    int time_in_ms = inter_arrival_time_us / 1000;
-    int time_in_us = inter_arrival_time_us % 1000;
+    int time_in_ms = event->duration_us / 1000;
+    int time_in_us = event->duration_us % 1000;
     printf("job%d arrives, needs %d paper%s, inter-arrival time = %d.%03dms%s\n",
-        job_id, papers_required,
-        papers_required == 1 ? "" : "s", time_in_ms, time_in_us,
+        event->job_id, event->papers,
+        event->papers == 1 ? "" : "s", time_in_ms, time_in_us,
         is_dropped ? ", dropped" : "");
     funlockfile(stdout);
 }
 
-static void log_system_arrival(job_t* job, unsigned long previous_job_arrival_time_us,
-    simulation_statistics_t* stats) {
-    stats->total_jobs_arrived++; // stats: total jobs arrived
-    stats->total_inter_arrival_time_us += job->system_arrival_time_us - previous_job_arrival_time_us; // stats: avg job inter-arrival time
-    job_arrival_helper(job->id, job->papers_required,
-        previous_job_arrival_time_us, job->system_arrival_time_us, FALSE);
+static void log_system_arrival(const log_event_t* event) {
+    job_arrival_helper(event, FALSE);
 }
 
-static void log_dropped_job(job_t* job, unsigned long previous_job_arrival_time_us,
-    simulation_statistics_t* stats) {
-    stats->total_jobs_dropped++; // stats: total jobs dropped
-    job_arrival_helper(job->id, job->papers_required,
-        previous_job_arrival_time_us, job->system_arrival_time_us, TRUE);
+static void log_dropped_job(const log_event_t* event) {
+    job_arrival_helper(event, TRUE);
 }
 
-static void log_removed_job(job_t* job) {
-    unsigned long current_time_us = get_time_in_us();
+static void log_removed_job(const log_event_t* event) {
     flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    printf("job%d removed from system\n", job->id);
+    log_time(event->time_us, reference_time_us);
+    printf("job%d removed from system\n", event->job_id);
     funlockfile(stdout);
 }
 
-static void log_queue_arrival(const job_t* job, simulation_statistics_t* stats,
-    timed_queue_t* job_queue, unsigned long last_interaction_time_us)
-{
-    stats->area_num_in_job_queue_us +=
-        (job->queue_arrival_time_us - last_interaction_time_us) * // duration of previous state
-        (timed_queue_length(job_queue) - 1); // -1 for the job that just entered the queue
-    // stats: avg job queue length
-    job_queue->last_interaction_time_us = job->queue_arrival_time_us;
-
+static void log_queue_arrival(const log_event_t* event) {
     flockfile(stdout);
-    log_time(job->queue_arrival_time_us, reference_time_us);
-    printf("job%d enters queue, queue length = %d\n", job->id,
-        timed_queue_length(job_queue));
+    log_time(event->time_us, reference_time_us);
+    printf("job%d enters queue, queue length = %d\n", event->job_id,
+        event->queue_length);
     funlockfile(stdout);
 }
 
-static void log_queue_departure(const job_t* job, simulation_statistics_t* stats,
-    timed_queue_t* job_queue, unsigned long last_interaction_time_us)
-{
-    stats->area_num_in_job_queue_us +=
-        (job->queue_departure_time_us - last_interaction_time_us) * // duration of previous state
-        (timed_queue_length(job_queue) + 1); // +1 for the job that just left the queue
-    // stats: avg job queue length
-    job_queue->last_interaction_time_us = job->queue_departure_time_us;
-
+static void log_queue_departure(const log_event_t* event) {
     flockfile(stdout);
-    log_time(job->queue_departure_time_us, reference_time_us);
-    int queue_duration = job->queue_departure_time_us - job->queue_arrival_time_us;
-    int time_ms = queue_duration / 1000;
-    int time_us = queue_duration % 1000;
+    log_time(event->time_us, reference_time_us);
+    int time_ms = event->duration_us / 1000;
+    int time_us = event->duration_us % 1000;
     printf("job%d leaves queue, time in queue = %d.%03dms, queue_length = %d\n",
-        job->id, time_ms, time_us, timed_queue_length(job_queue));
+        event->job_id, time_ms, time_us, event->queue_length);
     funlockfile(stdout);
 }
 
-static void log_printer_arrival(const job_t* job, const printer_t* printer) {
+static void log_printer_arrival(const log_event_t* event) {
     flockfile(stdout);
-    log_time(job->service_arrival_time_us, reference_time_us);
-    printf("job%d begins service at printer%d, printing %d pages in about %dms\n",
-        job->id, printer->id, job->papers_required, job->service_time_requested_ms);
+    log_time(event->time_us, reference_time_us);
+    printf("job%d begins service at printer%d, printing %d pages in about %lums\n",
+        event->job_id, event->printer_id, event->papers, event->duration_us / 1000);
     funlockfile(stdout);
 }
 
-static void log_system_departure(const job_t* job, const printer_t* printer,
-    simulation_statistics_t* stats)
-{
+static void log_system_departure(const log_event_t* event) {
     flockfile(stdout);
-    log_time(job->service_departure_time_us, reference_time_us);
-
-    int system_time = job->service_departure_time_us - job->system_arrival_time_us;
-    stats->total_system_time_us += system_time; // stats: avg job system time
-    stats->sum_of_system_time_squared_us2 += system_time * system_time; // stats: stddev job system time
-    stats->total_jobs_served += 1; // stats: total jobs served
-    
-    int service_duration = job->service_departure_time_us - job->service_arrival_time_us;
-    
-    // Track in array format (0-indexed)
-    int idx = printer->id - 1;
-    if (idx >= 0 && idx < MAX_PRINTERS) {
-        stats->jobs_served_by_printer[idx] += 1;
-        stats->printer_paper_used[idx] += job->papers_required;
-        stats->total_service_time_printer_us[idx] += service_duration;
-        
-        // Update max_printers_used
-        if (printer->id > stats->max_printers_used) {
-            stats->max_printers_used = printer->id;
-        }
-    }
-
-    stats->total_queue_wait_time_us +=
-        (job->queue_departure_time_us - job->queue_arrival_time_us); // stats: avg job queue wait time
-
-    int time_ms = service_duration / 1000;
-    int time_us = service_duration % 1000;
+    log_time(event->time_us, reference_time_us);
+    int time_ms = event->duration_us / 1000;
+    int time_us = event->duration_us % 1000;
     printf("job%d departs from printer%d, service time = %d.%03dms\n",
-        job->id, printer->id, time_ms, time_us);
+        event->job_id, event->printer_id, time_ms, time_us);
     funlockfile(stdout);
 }
 
-static void log_paper_empty(printer_t* printer, int job_id, unsigned long current_time_us) {
+static void log_paper_empty(const log_event_t* event) {
     flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    printf("printer%d does not have enough paper for job%d and is requesting refill\n", printer->id, job_id);
+    log_time(event->time_us, reference_time_us);
+    printf("printer%d does not have enough paper for job%d and is requesting refill\n",
+        event->printer_id, event->job_id);
     funlockfile(stdout);
 }
 
-static void log_paper_refill_start(printer_t* printer, int papers_needed, 
-    int time_to_refill_us, unsigned long current_time_us)
-{
+static void log_paper_refill_start(const log_event_t* event) {
     flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    int time_ms = time_to_refill_us / 1000;
-    int time_us = time_to_refill_us % 1000;
+    log_time(event->time_us, reference_time_us);
+    int time_ms = event->duration_us / 1000;
+    int time_us = event->duration_us % 1000;
     printf("printer%d starts refilling %d papers, estimated time = %d.%03dms\n",
-        printer->id, papers_needed, time_ms, time_us);
+        event->printer_id, event->papers, time_ms, time_us);
     funlockfile(stdout);
 }
 
-static void log_paper_refill_end(printer_t* printer, int refill_duration_us,
-    unsigned long current_time_us)
-{
+static void log_paper_refill_end(const log_event_t* event) {
     flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    int time_ms = refill_duration_us / 1000;
-    int time_us = refill_duration_us % 1000;
+    log_time(event->time_us, reference_time_us);
+    int time_ms = event->duration_us / 1000;
+    int time_us = event->duration_us % 1000;
     printf("printer%d finishes refilling paper, actual time = %d.%03d ms\n",
-        printer->id, time_ms, time_us);
+        event->printer_id, time_ms, time_us);
     funlockfile(stdout);
 }
 
@@ -237,17 +176,17 @@ static void log_ctrl_c_pressed(simulation_statistics_t* stats) {
     funlockfile(stdout);
 }
 
-static void log_scale_up(int new_printer_count, int queue_length, unsigned long current_time_us) {
+static void log_scale_up(const log_event_t* event) {
     flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    printf("Autoscaling: Scaled UP to %d printers (queue length: %d)\n", new_printer_count, queue_length);
+    log_time(event->time_us, reference_time_us);
+    printf("Autoscaling: Scaled UP to %d printers (queue length: %d)\n", event->count, event->queue_length);
     funlockfile(stdout);
 }
 
-static void log_scale_down(int new_printer_count, int queue_length, unsigned long current_time_us) {
+static void log_scale_down(const log_event_t* event) {
     flockfile(stdout);
-    log_time(current_time_us, reference_time_us);
-    printf("Autoscaling: Scaled DOWN to %d printers (queue length: %d)\n", new_printer_count, queue_length);
+    log_time(event->time_us, reference_time_us);
+    printf("Autoscaling: Scaled DOWN to %d printers (queue length: %d)\n", event->count, event->queue_length);
     funlockfile(stdout);
 }
 
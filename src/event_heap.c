@@ -0,0 +1,90 @@
+#include <stdlib.h>
+#include "common.h"
+#include "event_heap.h"
+
+// --- Private Helper Functions ---
+/**
+ * @brief Orders events by time, then by push order.
+ */
+static int is_before(const event_heap_entry_t* a, const event_heap_entry_t* b) {
+    return a->time_us < b->time_us || (a->time_us == b->time_us && a->seq < b->seq);
+}
+
+static void sift_up(event_heap_t* heap, int pos) {
+    event_heap_entry_t entry = heap->entries[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!is_before(&entry, &heap->entries[parent])) break;
+        heap->entries[pos] = heap->entries[parent];
+        pos = parent;
+    }
+    heap->entries[pos] = entry;
+}
+
+static void sift_down(event_heap_t* heap, int pos) {
+    event_heap_entry_t entry = heap->entries[pos];
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= heap->length) break;
+        if (child + 1 < heap->length && is_before(&heap->entries[child + 1], &heap->entries[child])) {
+            child++;
+        }
+        if (!is_before(&heap->entries[child], &entry)) break;
+        heap->entries[pos] = heap->entries[child];
+        pos = child;
+    }
+    heap->entries[pos] = entry;
+}
+
+// --- Public API Function Implementations ---
+int event_heap_init(event_heap_t* heap, int capacity) {
+    if (heap == NULL) {
+        return FALSE;
+    }
+    heap->capacity = capacity > 0 ? capacity : 16;
+    heap->entries = (event_heap_entry_t*) malloc(sizeof(event_heap_entry_t) * heap->capacity);
+    if (heap->entries == NULL) {
+        return FALSE; // Memory allocation failure
+    }
+    heap->length = 0;
+    heap->next_seq = 0;
+    return TRUE;
+}
+
+void event_heap_destroy(event_heap_t* heap) {
+    free(heap->entries);
+    heap->entries = NULL;
+    heap->length = 0;
+    heap->capacity = 0;
+}
+
+int event_heap_push(event_heap_t* heap, unsigned long time_us, int type, void* arg) {
+    if (heap->length == heap->capacity) {
+        event_heap_entry_t* grown = (event_heap_entry_t*) realloc(heap->entries,
+            sizeof(event_heap_entry_t) * heap->capacity * 2);
+        if (grown == NULL) {
+            return FALSE;
+        }
+        heap->entries = grown;
+        heap->capacity *= 2;
+    }
+    heap->entries[heap->length] = (event_heap_entry_t){time_us, heap->next_seq++, type, arg};
+    sift_up(heap, heap->length++);
+    return TRUE;
+}
+
+int event_heap_pop(event_heap_t* heap, event_heap_entry_t* out) {
+    if (heap->length == 0) {
+        return FALSE;
+    }
+    *out = heap->entries[0];
+    heap->entries[0] = heap->entries[--heap->length];
+    if (heap->length > 0) {
+        sift_down(heap, 0);
+    }
+    return TRUE;
+}
+
+int event_heap_length(const event_heap_t* heap) {
+    return heap->length;
+}
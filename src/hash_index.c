@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "hash_index.h"
+
+// --- Private Helper Functions ---
+/**
+ * @brief Spreads sequential ids across the table (Knuth multiplicative hash).
+ */
+static size_t slot_for(const hash_index_t* index, int key) {
+    return ((unsigned int)key * 2654435761u) & (index->capacity - 1);
+}
+
+static int allocate_slots(hash_index_t* index, size_t capacity) {
+    index->slots = (hash_index_slot_t*) calloc(capacity, sizeof(hash_index_slot_t));
+    if (index->slots == NULL) {
+        return FALSE; // Memory allocation failure
+    }
+    index->capacity = capacity;
+    index->count = 0;
+    return TRUE;
+}
+
+/**
+ * @brief Doubles the table and re-inserts every entry.
+ */
+static int grow(hash_index_t* index) {
+    hash_index_slot_t* old_slots = index->slots;
+    size_t old_capacity = index->capacity;
+    if (!allocate_slots(index, old_capacity * 2)) {
+        index->slots = old_slots;
+        index->capacity = old_capacity;
+        return FALSE;
+    }
+
+    size_t moved = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i].value != NULL) {
+            size_t pos = slot_for(index, old_slots[i].key);
+            while (index->slots[pos].value != NULL) {
+                pos = (pos + 1) & (index->capacity - 1);
+            }
+            index->slots[pos] = old_slots[i];
+            moved++;
+        }
+    }
+    index->count = moved;
+    free(old_slots);
+    return TRUE;
+}
+
+// --- Public API Function Implementations ---
+int hash_index_init(hash_index_t* index, size_t capacity) {
+    if (index == NULL) {
+        return FALSE;
+    }
+    // Keep the load factor at or below one half
+    size_t size = 8;
+    while (size < capacity * 2) {
+        size <<= 1;
+    }
+    return allocate_slots(index, size);
+}
+
+void hash_index_destroy(hash_index_t* index) {
+    if (index == NULL) {
+        return;
+    }
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+int hash_index_put(hash_index_t* index, int key, void* value) {
+    if (index == NULL || value == NULL) {
+        return FALSE;
+    }
+    if ((index->count + 1) * 2 > index->capacity && !grow(index)) {
+        return FALSE;
+    }
+
+    size_t pos = slot_for(index, key);
+    while (index->slots[pos].value != NULL) {
+        if (index->slots[pos].key == key) {
+            index->slots[pos].value = value; // Replace existing entry
+            return TRUE;
+        }
+        pos = (pos + 1) & (index->capacity - 1);
+    }
+    index->slots[pos].key = key;
+    index->slots[pos].value = value;
+    index->count++;
+    return TRUE;
+}
+
+void* hash_index_get(hash_index_t* index, int key) {
+    if (index == NULL || index->slots == NULL) {
+        return NULL;
+    }
+    size_t pos = slot_for(index, key);
+    while (index->slots[pos].value != NULL) {
+        if (index->slots[pos].key == key) {
+            return index->slots[pos].value;
+        }
+        pos = (pos + 1) & (index->capacity - 1);
+    }
+    return NULL;
+}
+
+void* hash_index_remove(hash_index_t* index, int key) {
+    if (index == NULL || index->slots == NULL) {
+        return NULL;
+    }
+    size_t mask = index->capacity - 1;
+    size_t pos = slot_for(index, key);
+    while (index->slots[pos].value != NULL && index->slots[pos].key != key) {
+        pos = (pos + 1) & mask;
+    }
+    void* value = index->slots[pos].value;
+    if (value == NULL) {
+        return NULL; // Key not present
+    }
+
+    // Backward-shift deletion: pull later members of the probe run into the hole
+    size_t hole = pos;
+    size_t next = (hole + 1) & mask;
+    while (index->slots[next].value != NULL) {
+        size_t home = slot_for(index, index->slots[next].key);
+        // Move the entry if its home slot is not in the (hole, next] range
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index->slots[hole] = index->slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    index->slots[hole].value = NULL;
+    index->count--;
+    return value;
+}
+
+void hash_index_clear(hash_index_t* index) {
+    if (index == NULL || index->slots == NULL) {
+        return;
+    }
+    memset(index->slots, 0, index->capacity * sizeof(hash_index_slot_t));
+    index->count = 0;
+}
@@ -0,0 +1,386 @@
+#include <limits.h>
+#include <stdlib.h>
+#include "common.h"
+#include "job_dispatcher.h"
+#include "timed_queue.h"
+#include "timeutils.h"
+
+// --- Private Helper Functions ---
+static int is_open(job_dispatcher_t* d, int idx) {
+    return atomic_load(&d->deques[idx].open);
+}
+
+static int depth_of(job_dispatcher_t* d, int idx) {
+    return atomic_load(&d->deques[idx].depth);
+}
+
+/**
+ * @brief Picks the open deque that should receive the next job.
+ * @param exclude Deque index to skip (e.g. the deque being closed), or -1.
+ * @return The deque index, or -1 if no other deque is open.
+ */
+static int pick_target(job_dispatcher_t* d, int exclude) {
+    if (d->policy == JOB_DISPATCH_ROUND_ROBIN) {
+        for (int tries = 0; tries < d->deque_count; tries++) {
+            int idx = (int)(atomic_fetch_add(&d->next_deque, 1) % d->deque_count);
+            if (idx != exclude && is_open(d, idx)) {
+                return idx;
+            }
+        }
+        return -1;
+    }
+
+    int best = -1;
+    int best_depth = INT_MAX;
+    for (int idx = 0; idx < d->deque_count; idx++) {
+        if (idx != exclude && is_open(d, idx) && depth_of(d, idx) < best_depth) {
+            best = idx;
+            best_depth = depth_of(d, idx);
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Returns the deepest non-empty deque other than exclude; -1 if there is none.
+ */
+static int pick_deepest(job_dispatcher_t* d, int exclude) {
+    int best = -1;
+    int best_depth = 0;
+    for (int idx = 0; idx < d->deque_count; idx++) {
+        if (idx == exclude) continue;
+        if (depth_of(d, idx) > best_depth) {
+            best = idx;
+            best_depth = depth_of(d, idx);
+        }
+    }
+    return best;
+}
+
+static int count_open(job_dispatcher_t* d, int exclude) {
+    int open = 0;
+    for (int idx = 0; idx < d->deque_count; idx++) {
+        if (idx != exclude && is_open(d, idx)) open++;
+    }
+    return open;
+}
+
+/**
+ * @brief Moves the last count nodes of deque from to the back of deque to, as
+ * one run in arrival order (oldest first).
+ * Both mutexes are taken in index order so concurrent moves cannot deadlock.
+ * The total length never changes, so no printer sees a spurious empty system.
+ * @return The number of nodes moved (fewer than count if from ran out).
+ */
+static int move_back(job_dispatcher_t* d, int from, int to, int count) {
+    printer_deque_t* source = &d->deques[from];
+    printer_deque_t* target = &d->deques[to];
+    pthread_mutex_t* first = from < to ? &source->mutex : &target->mutex;
+    pthread_mutex_t* second = from < to ? &target->mutex : &source->mutex;
+
+    pthread_mutex_lock(first);
+    pthread_mutex_lock(second);
+    // Unlink the run newest first, chaining it oldest first through the unlinked nodes' next
+    list_node_t* run = NULL;
+    for (int taken = 0; taken < count; taken++) {
+        list_node_t* node = timed_queue_dequeue(&source->queue);
+        if (node == NULL) break;
+        node->next = run;
+        run = node;
+    }
+    int moved = 0;
+    while (run != NULL) {
+        list_node_t* node = run;
+        run = node->next;
+        if (!timed_queue_enqueue_node(&target->queue, node)) {
+            // Put the rest back, still in order
+            timed_queue_enqueue_node(&source->queue, node);
+            while (run != NULL) {
+                node = run;
+                run = node->next;
+                timed_queue_enqueue_node(&source->queue, node);
+            }
+            break;
+        }
+        moved++;
+    }
+    if (moved > 0) {
+        atomic_fetch_sub(&source->depth, moved);
+        atomic_fetch_add(&target->depth, moved);
+        pthread_cond_signal(&target->not_empty_cv);
+    }
+    pthread_mutex_unlock(second);
+    pthread_mutex_unlock(first);
+    return moved;
+}
+
+/**
+ * @brief Pops the back node of a victim deque if accept allows it.
+ * @return The node, or NULL if the deque was empty or its back node was rejected.
+ */
+static list_node_t* steal_back(job_dispatcher_t* d, int victim,
+                               int (*accept)(list_node_t* node, void* ctx), void* ctx) {
+    printer_deque_t* deque = &d->deques[victim];
+    pthread_mutex_lock(&deque->mutex);
+    list_node_t* node = timed_queue_last(&deque->queue);
+    if (node != NULL && (accept == NULL || accept(node, ctx))) {
+        timed_queue_dequeue(&deque->queue);
+        atomic_fetch_sub(&deque->depth, 1);
+        atomic_fetch_sub(&d->length, 1);
+    } else {
+        node = NULL;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return node;
+}
+
+static void unlock_mutex(void* mutex) {
+    pthread_mutex_unlock((pthread_mutex_t*)mutex);
+}
+
+// --- Public API Function Implementations ---
+int job_dispatcher_init(job_dispatcher_t* d, int policy, int deque_count,
+                        int (*key_of)(const list_node_t* node), int index_capacity) {
+    if (d == NULL || deque_count < 1
+        || (policy != JOB_DISPATCH_ROUND_ROBIN && policy != JOB_DISPATCH_SHORTEST_QUEUE)) {
+        return FALSE;
+    }
+    // printer_deque_t is cache-line aligned, so its size is a multiple of the alignment
+    d->deques = aligned_alloc(CONFIG_CACHE_LINE_SIZE, sizeof(printer_deque_t) * deque_count);
+    if (d->deques == NULL) {
+        return FALSE;
+    }
+    d->deque_count = deque_count;
+    for (int idx = 0; idx < d->deque_count; idx++) {
+        printer_deque_t* deque = &d->deques[idx];
+        if (!timed_queue_init_intrusive(&deque->queue, TIMED_QUEUE_BACKEND_LIST, 0)
+            || (key_of != NULL && !timed_queue_enable_index(&deque->queue, key_of, index_capacity))) {
+            for (int i = 0; i <= idx; i++) timed_queue_destroy(&d->deques[i].queue);
+            free(d->deques);
+            d->deques = NULL;
+            return FALSE;
+        }
+        pthread_mutex_init(&deque->mutex, NULL);
+        clock_cond_init(&deque->not_empty_cv);
+        atomic_init(&deque->depth, 0);
+        atomic_init(&deque->open, 0);
+    }
+    d->policy = policy;
+    atomic_init(&d->next_deque, 0);
+    atomic_init(&d->length, 0);
+    return TRUE;
+}
+
+void job_dispatcher_destroy(job_dispatcher_t* d) {
+    if (d == NULL) {
+        return;
+    }
+    for (int idx = 0; idx < d->deque_count; idx++) {
+        timed_queue_destroy(&d->deques[idx].queue);
+        pthread_mutex_destroy(&d->deques[idx].mutex);
+        pthread_cond_destroy(&d->deques[idx].not_empty_cv);
+    }
+    free(d->deques);
+    d->deques = NULL;
+    d->deque_count = 0;
+}
+
+void job_dispatcher_open(job_dispatcher_t* d, int idx) {
+    if (d == NULL || idx < 0 || idx >= d->deque_count) {
+        return;
+    }
+    atomic_store(&d->deques[idx].open, 1);
+}
+
+int job_dispatcher_close(job_dispatcher_t* d, int idx) {
+    if (d == NULL || idx < 0 || idx >= d->deque_count) {
+        return 0;
+    }
+    atomic_store(&d->deques[idx].open, 0);
+
+    // An even share per open deque, each share moved as one run in arrival order
+    int moved = 0;
+    int targets = count_open(d, idx);
+    while (depth_of(d, idx) > 0 && targets > 0) {
+        int target = pick_target(d, idx);
+        int share = (depth_of(d, idx) + targets - 1) / targets;
+        int run = target < 0 ? 0 : move_back(d, idx, target, share);
+        if (run == 0) {
+            break; // No open deque left (shutting down) or already drained
+        }
+        moved += run;
+        if (targets > 1) targets--;
+    }
+    return moved;
+}
+
+int job_dispatcher_rebalance(job_dispatcher_t* d) {
+    if (d == NULL) {
+        return 0;
+    }
+    int moved = 0;
+    int limit = job_dispatcher_length(d); // no job needs to move more than once
+    while (moved < limit) {
+        int deepest = pick_deepest(d, -1);
+        int shallowest = -1;
+        for (int idx = 0; idx < d->deque_count; idx++) {
+            if (is_open(d, idx) && (shallowest < 0 || depth_of(d, idx) < depth_of(d, shallowest))) {
+                shallowest = idx;
+            }
+        }
+        if (deepest < 0 || shallowest < 0 || depth_of(d, deepest) - depth_of(d, shallowest) <= 1) {
+            break;
+        }
+        // Half the difference, as one run in arrival order
+        int count = (depth_of(d, deepest) - depth_of(d, shallowest)) / 2;
+        if (count > limit - moved) count = limit - moved;
+        int run = move_back(d, deepest, shallowest, count);
+        if (run == 0) {
+            break;
+        }
+        moved += run;
+    }
+    return moved;
+}
+
+int job_dispatcher_push(job_dispatcher_t* d, list_node_t* node) {
+    if (d == NULL || node == NULL) {
+        return -1;
+    }
+    int idx = pick_target(d, -1);
+    if (idx < 0) {
+        idx = 0; // No printer has opened its deque yet
+    }
+
+    printer_deque_t* deque = &d->deques[idx];
+    pthread_mutex_lock(&deque->mutex);
+    int ok = timed_queue_enqueue_node(&deque->queue, node);
+    if (ok) {
+        atomic_fetch_add(&deque->depth, 1);
+        atomic_fetch_add(&d->length, 1);
+        pthread_cond_signal(&deque->not_empty_cv);
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return ok ? idx : -1;
+}
+
+int job_dispatcher_take(job_dispatcher_t* d, int idx, list_node_t** out, int max,
+                        int (*accept)(list_node_t* node, void* ctx), void* ctx) {
+    if (d == NULL || idx < 0 || idx >= d->deque_count) {
+        return 0;
+    }
+    printer_deque_t* deque = &d->deques[idx];
+    pthread_mutex_lock(&deque->mutex);
+    int count = timed_queue_dequeue_batch_while(&deque->queue, out, max, accept, ctx);
+    if (count > 0) {
+        atomic_fetch_sub(&deque->depth, count);
+        atomic_fetch_sub(&d->length, count);
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return count;
+}
+
+list_node_t* job_dispatcher_steal(job_dispatcher_t* d, int thief,
+                                  int (*accept)(list_node_t* node, void* ctx), void* ctx) {
+    if (d == NULL) {
+        return NULL;
+    }
+    // Depths are read without locks; each victim is re-checked under its mutex
+    int deepest = pick_deepest(d, thief);
+    if (deepest < 0) {
+        return NULL;
+    }
+    for (int step = 0; step < d->deque_count; step++) {
+        int victim = (deepest + step) % d->deque_count;
+        if (victim == thief || (step > 0 && depth_of(d, victim) == 0)) continue;
+        list_node_t* node = steal_back(d, victim, accept, ctx);
+        if (node != NULL) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+void job_dispatcher_wait(job_dispatcher_t* d, int idx, unsigned long timeout_us) {
+    if (d == NULL || idx < 0 || idx >= d->deque_count) {
+        return;
+    }
+    printer_deque_t* deque = &d->deques[idx];
+
+    pthread_mutex_lock(&deque->mutex);
+    // A printer may be cancelled (scale-down) while waiting; release the mutex if so
+    pthread_cleanup_push(unlock_mutex, &deque->mutex);
+    if (timed_queue_is_empty(&deque->queue)) {
+        clock_timed_wait(&deque->not_empty_cv, &deque->mutex, timeout_us);
+    }
+    pthread_cleanup_pop(1);
+}
+
+void job_dispatcher_wake_all(job_dispatcher_t* d) {
+    if (d == NULL) {
+        return;
+    }
+    for (int idx = 0; idx < d->deque_count; idx++) {
+        pthread_mutex_lock(&d->deques[idx].mutex);
+        pthread_cond_broadcast(&d->deques[idx].not_empty_cv);
+        pthread_mutex_unlock(&d->deques[idx].mutex);
+    }
+}
+
+list_node_t* job_dispatcher_remove_by_id(job_dispatcher_t* d, int id) {
+    if (d == NULL) {
+        return NULL;
+    }
+    for (int idx = 0; idx < d->deque_count; idx++) {
+        printer_deque_t* deque = &d->deques[idx];
+        pthread_mutex_lock(&deque->mutex);
+        list_node_t* node = timed_queue_remove_by_id(&deque->queue, id);
+        if (node != NULL) {
+            atomic_fetch_sub(&deque->depth, 1);
+            atomic_fetch_sub(&d->length, 1);
+        }
+        pthread_mutex_unlock(&deque->mutex);
+        if (node != NULL) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+int job_dispatcher_drain(job_dispatcher_t* d, void (*drop)(list_node_t* node, void* ctx), void* ctx) {
+    if (d == NULL) {
+        return 0;
+    }
+    int removed = 0;
+    for (int idx = 0; idx < d->deque_count; idx++) {
+        printer_deque_t* deque = &d->deques[idx];
+        pthread_mutex_lock(&deque->mutex);
+        list_node_t* node;
+        while ((node = timed_queue_dequeue_front(&deque->queue)) != NULL) {
+            atomic_fetch_sub(&deque->depth, 1);
+            atomic_fetch_sub(&d->length, 1);
+            if (drop != NULL) drop(node, ctx);
+            removed++;
+        }
+        pthread_mutex_unlock(&deque->mutex);
+    }
+    return removed;
+}
+
+int job_dispatcher_length(job_dispatcher_t* d) {
+    if (d == NULL) {
+        return 0;
+    }
+    return atomic_load(&d->length);
+}
+
+unsigned long job_dispatcher_area_us(job_dispatcher_t* d) {
+    if (d == NULL) {
+        return 0;
+    }
+    unsigned long area_us = 0;
+    for (int idx = 0; idx < d->deque_count; idx++) {
+        area_us += timed_queue_area_us(&d->deques[idx].queue);
+    }
+    return area_us;
+}
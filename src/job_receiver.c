@@ -2,18 +2,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
-#include <unistd.h>
 
 #include "common.h"
+#include "config.h"
 #include "job_receiver.h"
 #include "preprocessing.h"
 #include "linked_list.h"
 #include "timed_queue.h"
+#include "job_dispatcher.h"
 #include "timeutils.h"
 #include "log_router.h"
 #include "simulation_stats.h"
 
-extern int g_terminate_now;
 extern int g_debug;
 
 int init_job(job_t* job, int job_id, int inter_arrival_time_us, int papers_required) {
@@ -23,6 +23,7 @@ int init_job(job_t* job, int job_id, int inter_arrival_time_us, int papers_requi
     job->id = job_id;
     job->inter_arrival_time_us = inter_arrival_time_us;
     job->papers_required = papers_required;
+    job->service_class = JOB_CLASS_STANDARD;
 
     // Initialize service time to 0; will be set later based on printing rate
     job->service_time_requested_ms = 0;
@@ -34,6 +35,11 @@ int init_job(job_t* job, int job_id, int inter_arrival_time_us, int papers_requi
     job->service_arrival_time_us = 0;
     job->service_departure_time_us = 0;
 
+    // Queue links live inside the job; data points back so timed_queue_find still works
+    job->node.data = job;
+    job->node.next = NULL;
+    job->node.prev = NULL;
+
     return TRUE;
 }
 
@@ -47,6 +53,217 @@ void drop_job_from_system(job_t* job, unsigned long previous_job_arrival_time_us
     free(job);
 }
 
+int job_queue_key(const list_node_t* node) {
+    return list_entry(node, job_t, node)->id;
+}
+
+int job_queue_class(const list_node_t* node) {
+    return list_entry(node, job_t, node)->service_class;
+}
+
+int pick_job_class(const simulation_parameters_t* params) {
+    if (params->premium_job_percent + params->bulk_job_percent <= 0) {
+        return JOB_CLASS_STANDARD; // Single class: don't consume random numbers
+    }
+    int roll = random_between(1, 100);
+    if (roll <= params->premium_job_percent) {
+        return JOB_CLASS_PREMIUM;
+    }
+    if (roll <= params->premium_job_percent + params->bulk_job_percent) {
+        return JOB_CLASS_BULK;
+    }
+    return JOB_CLASS_STANDARD;
+}
+
+int job_queue_init(timed_queue_t* job_queue, const simulation_parameters_t* params) {
+    if (params->queue_backend == TIMED_QUEUE_BACKEND_RING) {
+        int capacity = params->queue_capacity != -1
+            ? params->queue_capacity : CONFIG_RING_QUEUE_DEFAULT_CAPACITY;
+        return timed_queue_init_intrusive(job_queue, TIMED_QUEUE_BACKEND_RING, capacity);
+    }
+    int index_capacity = params->queue_capacity != -1
+        ? params->queue_capacity : CONFIG_JOB_INDEX_INITIAL_CAPACITY;
+    const int class_weights[JOB_CLASS_COUNT] = {
+        CONFIG_JOB_CLASS_WEIGHT_PREMIUM,
+        CONFIG_JOB_CLASS_WEIGHT_STANDARD,
+        CONFIG_JOB_CLASS_WEIGHT_BULK,
+    };
+    return timed_queue_init_intrusive(job_queue, TIMED_QUEUE_BACKEND_LIST, 0)
+        && timed_queue_enable_index(job_queue, job_queue_key, index_capacity)
+        && timed_queue_enable_classes(job_queue, job_queue_class, class_weights, JOB_CLASS_COUNT);
+}
+
+int job_backlog_length(timed_queue_t* job_queue, job_dispatcher_t* dispatcher) {
+    return dispatcher != NULL ? job_dispatcher_length(dispatcher) : timed_queue_length(job_queue);
+}
+
+unsigned long job_backlog_area_us(timed_queue_t* job_queue, job_dispatcher_t* dispatcher) {
+    return dispatcher != NULL ? job_dispatcher_area_us(dispatcher) : timed_queue_area_us(job_queue);
+}
+
+/**
+ * @brief Returns how many jobs arrive together per inter-arrival time.
+ */
+static int burst_size_of(const simulation_parameters_t* params) {
+    int burst_size = params->job_burst_size;
+    if (burst_size < 1) return 1;
+    if (burst_size > CONFIG_JOB_BURST_MAX) return CONFIG_JOB_BURST_MAX;
+    return burst_size;
+}
+
+/**
+ * @brief Returns how many jobs of a burst fit in the queue (all of them if unlimited).
+ */
+static int admit_count_of(const simulation_parameters_t* params, int queue_length, int burst_count) {
+    // Only check capacity if it's not unlimited (-1)
+    if (params->queue_capacity == -1) {
+        return burst_count;
+    }
+    int room = params->queue_capacity - queue_length;
+    return room < 0 ? 0 : (room < burst_count ? room : burst_count);
+}
+
+/**
+ * @brief Wakes at most one idle printer per new job. Call with job_queue_mutex held.
+ *
+ * A broadcast would wake every idle printer for every job and all but one of
+ * them would find the queue empty again. Signalling with no waiter is a no-op,
+ * so the count is only capped at the largest possible pool.
+ */
+static void wake_printers(pthread_cond_t* job_queue_not_empty_cv, int job_count) {
+    int wake_count = job_count < CONFIG_RANGE_CONSUMER_COUNT_MAX ? job_count : CONFIG_RANGE_CONSUMER_COUNT_MAX;
+    for (int i = 0; i < wake_count; i++) {
+        pthread_cond_signal(job_queue_not_empty_cv);
+    }
+}
+
+/**
+ * @brief Adds a burst to the shared job queue under one job_queue_mutex
+ * acquisition and wakes one idle printer per enqueued job.
+ * @return The number of jobs enqueued; burst[result..] must be dropped.
+ */
+static int enqueue_burst(job_thread_args_t* args, job_t** burst, int burst_count) {
+    timed_queue_t* job_queue = args->job_queue;
+    simulation_statistics_t* stats = args->stats;
+    list_node_t* burst_nodes[CONFIG_JOB_BURST_MAX];
+
+    pthread_mutex_lock(args->job_queue_mutex);
+
+    int queue_length = timed_queue_length(job_queue);
+    int admit_count = admit_count_of(args->simulation_params, queue_length, burst_count);
+    
+    // Add the admitted jobs to the queue in one batch; a bounded backend may take fewer
+    unsigned long queue_arrival_time_us = get_time_in_us();
+    for (int i = 0; i < admit_count; i++) {
+        burst[i]->queue_arrival_time_us = queue_arrival_time_us;
+        burst_nodes[i] = &burst[i]->node;
+    }
+    int enqueued_count = admit_count > 0
+        ? timed_queue_enqueue_batch(job_queue, burst_nodes, admit_count) : 0;
+    
+    if (enqueued_count > 0) {
+        // Update statistics (the receiver's own shard, no stats_mutex)
+        int peak_length = queue_length + enqueued_count - 1; // length seen by the last job before it was added
+        simulation_stats_record_queue_length(stats, peak_length);
+        for (int i = 0; i < enqueued_count; i++) {
+            emit_queue_arrival(burst[i], stats, timed_queue_length(job_queue), timed_queue_area_us(job_queue));
+            emit_job_update(burst[i]);
+        }
+        emit_stats_update(stats, timed_queue_length(job_queue));
+        
+        // Signal that jobs are available
+        wake_printers(args->job_queue_not_empty_cv, enqueued_count);
+    }
+    pthread_mutex_unlock(args->job_queue_mutex);
+    return enqueued_count;
+}
+
+/**
+ * @brief Places a burst on the printers' deques; each push locks only the target deque.
+ * Each job's queue arrival is logged before it is pushed, so no printer logs its
+ * departure (or frees it) first. The logged length is the one the job sees once
+ * it is on its deque. A job the dispatcher rejects gets a matching queue
+ * departure, so the log never shows it waiting in a queue it never reached.
+ * @return The number of jobs placed; burst[result..] must be dropped.
+ */
+static int dispatch_burst(job_thread_args_t* args, job_t** burst, int burst_count) {
+    job_dispatcher_t* dispatcher = args->dispatcher;
+    simulation_statistics_t* stats = args->stats;
+
+    int queue_length = job_dispatcher_length(dispatcher);
+    int admit_count = admit_count_of(args->simulation_params, queue_length, burst_count);
+
+    unsigned long queue_arrival_time_us = get_time_in_us();
+    int enqueued_count = 0;
+    while (enqueued_count < admit_count) {
+        job_t* job = burst[enqueued_count];
+        job->queue_arrival_time_us = queue_arrival_time_us;
+        emit_queue_arrival(job, stats, job_dispatcher_length(dispatcher) + 1, job_dispatcher_area_us(dispatcher));
+        emit_job_update(job);
+        if (job_dispatcher_push(dispatcher, &job->node) < 0) {
+            // Only on allocation failure; the caller drops this job and the rest
+            job->queue_departure_time_us = queue_arrival_time_us;
+            emit_queue_departure(job, stats, job_dispatcher_length(dispatcher), job_dispatcher_area_us(dispatcher));
+            break;
+        }
+        enqueued_count++;
+    }
+
+    if (enqueued_count > 0) {
+        int peak_length = queue_length + enqueued_count - 1; // length seen by the last job before it was added
+        simulation_stats_record_queue_length(stats, peak_length);
+        emit_stats_update(stats, job_dispatcher_length(dispatcher));
+    }
+    return enqueued_count;
+}
+
+int job_receiver_create_burst(const simulation_parameters_t* params, job_t** burst, int* job_id) {
+    const int inter_arrival_time_us = (int)params->job_arrival_time_us;
+    const int burst_size = burst_size_of(params);
+    int burst_count = 0;
+    while (burst_count < burst_size && *job_id < params->num_jobs) {
+        const int papers_required = random_between(params->papers_required_lower_bound, params->papers_required_upper_bound);
+        job_t* job = (job_t*)malloc(sizeof(job_t));
+        (*job_id)++;
+        // Jobs after the first in a burst arrive together with it
+        if (!init_job(job, *job_id, burst_count == 0 ? inter_arrival_time_us : 0, papers_required)) {
+            fprintf(stderr, "Error: Failed to initialize job %d\n", *job_id);
+            free(job);
+            continue;
+        }
+        job->service_class = pick_job_class(params);
+        burst[burst_count++] = job;
+    }
+    return burst_count;
+}
+
+void job_receiver_admit_burst(job_thread_args_t* args, job_t** burst, int burst_count,
+                              unsigned long* previous_job_arrival_time_us) {
+    simulation_statistics_t* stats = args->stats;
+
+    // Set system arrival time (shared by the whole burst)
+    unsigned long burst_arrival_time_us = get_time_in_us();
+    unsigned long arrival_reference_us = *previous_job_arrival_time_us;
+    for (int i = 0; i < burst_count; i++) {
+        burst[i]->system_arrival_time_us = burst_arrival_time_us;
+        emit_system_arrival(burst[i], arrival_reference_us, stats);
+        arrival_reference_us = burst_arrival_time_us;
+    }
+    emit_stats_update(stats, job_backlog_length(args->job_queue, args->dispatcher));
+
+    // Queue the jobs of the burst that fit (the rest are dropped)
+    int enqueued_count = args->dispatcher != NULL
+        ? dispatch_burst(args, burst, burst_count)
+        : enqueue_burst(args, burst, burst_count);
+
+    // Drop the jobs that did not fit
+    for (int i = enqueued_count; i < burst_count; i++) {
+        drop_job_from_system(burst[i], i == 0 ? *previous_job_arrival_time_us : burst_arrival_time_us, stats);
+    }
+
+    *previous_job_arrival_time_us = burst_arrival_time_us;
+}
+
 void debug_job(job_t* job) {
     if (job == NULL) {
         printf("Job is NULL\n");
@@ -57,6 +274,7 @@ void debug_job(job_t* job) {
     printf("  Job ID: %d\n", job->id);
     printf("  Inter-arrival time: %d us\n", job->inter_arrival_time_us);
     printf("  Papers required: %d\n", job->papers_required);
+    printf("  Service class: %d\n", job->service_class);
     printf("  Service time requested: %d ms\n", job->service_time_requested_ms);
     printf("  System arrival time: %lu us\n", job->system_arrival_time_us);
     printf("  Queue arrival time: %lu us\n", job->queue_arrival_time_us);
@@ -66,8 +284,6 @@ void debug_job(job_t* job) {
 }
 
 void* job_receiver_thread_func(void* arg) {
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-
     job_thread_args_t* args = (job_thread_args_t*)arg;
     if (args == NULL) {
         fprintf(stderr, "Error: JobThreadArgs is NULL\n");
@@ -75,89 +291,38 @@ void* job_receiver_thread_func(void* arg) {
     }
     
     if (g_debug) printf("Job receiver thread started\n");
+    simulation_stats_bind_shard(args->stats, STATS_SHARD_RECEIVER);
+    log_router_bind_session(args->session_id);
+    random_seed(args->random_seed); // a pooled thread would otherwise carry the previous run's stream
     // Extract arguments
     pthread_mutex_t* job_queue_mutex = args->job_queue_mutex;
-    pthread_mutex_t* stats_mutex = args->stats_mutex;
     pthread_mutex_t* simulation_state_mutex = args->simulation_state_mutex;
     pthread_cond_t* job_queue_not_empty_cv = args->job_queue_not_empty_cv;
-    timed_queue_t* job_queue = args->job_queue;
     simulation_parameters_t* params = args->simulation_params;
     simulation_statistics_t* stats = args->stats;
     int* all_jobs_arrived = args->all_jobs_arrived;
 
     unsigned long previous_job_arrival_time_us = stats->simulation_start_time_us;
+    job_t* burst[CONFIG_JOB_BURST_MAX];
     
-    for (int job_id = 0; job_id < params->num_jobs; job_id++) {
+    for (int job_id = 0; job_id < params->num_jobs; ) {
         const int inter_arrival_time_us = (int)params->job_arrival_time_us;
-        const int papers_required = random_between(params->papers_required_lower_bound, params->papers_required_upper_bound);
 
-        // Allocate and initialize job
-        job_t* job = (job_t*)malloc(sizeof(job_t));
-        if (!init_job(job, job_id + 1, inter_arrival_time_us, papers_required)) {
-            fprintf(stderr, "Error: Failed to initialize job %d\n", job_id + 1);
-            free(job);
+        // Allocate and initialize the jobs of this burst (one job unless -burst is set)
+        int burst_count = job_receiver_create_burst(params, burst, &job_id);
+        if (burst_count == 0) {
             continue;
         }
         
-        // Sleep for inter-arrival time
-        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-        usleep(inter_arrival_time_us);
-        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-        
-        // Check for termination signal
-        pthread_mutex_lock(simulation_state_mutex);
-        int terminate_now = g_terminate_now;
-        pthread_mutex_unlock(simulation_state_mutex);
-        if (terminate_now) {
+        // Sleep for inter-arrival time; a termination signal cuts the sleep short
+        if (!clock_sleep_unless(inter_arrival_time_us, args->terminate_now,
+                                simulation_state_mutex, args->simulation_state_cv)) {
             *all_jobs_arrived = 1;
-            free(job);
+            for (int i = 0; i < burst_count; i++) free(burst[i]);
             break;
         }
         
-        // Set system arrival time
-        job->system_arrival_time_us = get_time_in_us();
-        pthread_mutex_lock(stats_mutex);
-        emit_system_arrival(job, previous_job_arrival_time_us, stats);
-        emit_stats_update(stats, timed_queue_length(job_queue));
-        pthread_mutex_unlock(stats_mutex);
-        
-        // Check if job should be dropped (e.g., if queue is full)
-        pthread_mutex_lock(job_queue_mutex);
-
-        int queue_length = timed_queue_length(job_queue);
-        // Only check capacity if it's not unlimited (-1)
-        if (params->queue_capacity != -1 && queue_length >= params->queue_capacity) {
-            // Drop the job
-            pthread_mutex_unlock(job_queue_mutex);
-            unsigned long temp_arrival_time_us = job->system_arrival_time_us; // store before freeing
-            
-            pthread_mutex_lock(stats_mutex);
-            drop_job_from_system(job, previous_job_arrival_time_us, stats);
-            pthread_mutex_unlock(stats_mutex);
-
-            previous_job_arrival_time_us = temp_arrival_time_us;
-            continue;
-        }
-        
-        // Add job to queue
-        job->queue_arrival_time_us = get_time_in_us();
-        unsigned long queue_last_interaction_time_us = job_queue->last_interaction_time_us;
-        timed_queue_enqueue(job_queue, job);
-        
-        // Update statistics
-        pthread_mutex_lock(stats_mutex);
-        stats->max_job_queue_length = 
-            (queue_length > stats->max_job_queue_length) ? (queue_length) : stats->max_job_queue_length;
-        emit_queue_arrival(job, stats, job_queue, queue_last_interaction_time_us);
-        emit_job_update(job);
-        emit_stats_update(stats, timed_queue_length(job_queue));
-        pthread_mutex_unlock(stats_mutex);
-        
-        previous_job_arrival_time_us = job->system_arrival_time_us;
-        
-        // Signal that a job is available
-        pthread_cond_broadcast(job_queue_not_empty_cv);
-        pthread_mutex_unlock(job_queue_mutex);
+        job_receiver_admit_burst(args, burst, burst_count, &previous_job_arrival_time_us);
     }
     
     // Mark that all jobs have arrived
@@ -169,6 +334,7 @@ void* job_receiver_thread_func(void* arg) {
     pthread_mutex_lock(job_queue_mutex);
     pthread_cond_broadcast(job_queue_not_empty_cv);
     pthread_mutex_unlock(job_queue_mutex);
+    job_dispatcher_wake_all(args->dispatcher);
     if (g_debug) printf("Job receiver thread gracefully exited\n");
     return NULL;
 }
\ No newline at end of file
@@ -2,6 +2,25 @@
 #include "common.h"
 #include "linked_list.h"
 
+/**
+ * @brief Takes a node from the list's pool, falling back to malloc when empty.
+ * @param list Pointer to the LinkedList.
+ * @return Pointer to an uninitialized node, or NULL on allocation failure.
+ */
+static list_node_t* alloc_node(linked_list_t* list) {
+    if (list->intrusive) {
+        return NULL; // Intrusive lists never allocate nodes
+    }
+    list_node_t* node = list->free_nodes;
+    if (node != NULL) {
+        list->free_nodes = node->next;
+        list->free_count--;
+        list->pool_hits++;
+        return node;
+    }
+    list->pool_misses++;
+    return (list_node_t*) malloc(sizeof(list_node_t));
+}
 
 int list_length(linked_list_t* list) {
     return list->members_count;
@@ -11,7 +30,7 @@ int list_is_empty(linked_list_t* list) {
 }
 
 int list_append(linked_list_t* list, void* obj) {
-    list_node_t* newNode = (list_node_t*) malloc(sizeof(list_node_t));
+    list_node_t* newNode = alloc_node(list);
     if (newNode == NULL) {
         return FALSE; // Memory allocation failure
     }
@@ -27,7 +46,7 @@ int list_append(linked_list_t* list, void* obj) {
 }
 
 int list_append_left(linked_list_t* list, void* obj) {
-    list_node_t* newNode = (list_node_t*) malloc(sizeof(list_node_t));
+    list_node_t* newNode = alloc_node(list);
     if (newNode == NULL) {
         return FALSE; // Memory allocation failure
     }
@@ -41,6 +60,23 @@ int list_append_left(linked_list_t* list, void* obj) {
 
     return TRUE;
 }
+void list_append_node(linked_list_t* list, list_node_t* node) {
+    list_insert_node_after(list, list->tail.prev, node);
+}
+
+void list_append_node_left(linked_list_t* list, list_node_t* node) {
+    list_insert_node_after(list, &list->head, node);
+}
+
+void list_insert_node_after(linked_list_t* list, list_node_t* prev, list_node_t* node) {
+    node->prev = prev;
+    node->next = prev->next;
+
+    prev->next->prev = node;
+    prev->next = node;
+    list->members_count++;
+}
+
 list_node_t* list_pop(linked_list_t* list) {
     if (list_is_empty(list)) {
         return NULL;
@@ -63,20 +99,47 @@ list_node_t* list_pop_left(linked_list_t* list) {
     return first;
 }
 
-void list_remove(linked_list_t* list, list_node_t* node) {
+void list_release_node(linked_list_t* list, list_node_t* node) {
+    if (node == NULL) {
+        return;
+    }
+    if (list->intrusive) {
+        node->next = NULL;
+        node->prev = NULL;
+        return; // Caller owns the node
+    }
+    if (list->free_count >= LIST_NODE_POOL_MAX) {
+        free(node);
+        return;
+    }
+    node->data = NULL;
+    node->prev = NULL;
+    node->next = list->free_nodes;
+    list->free_nodes = node;
+    list->free_count++;
+}
+
+void list_unlink(linked_list_t* list, list_node_t* node) {
     if (node == NULL || list_is_empty(list)) {
         return;
     }
     node->prev->next = node->next;
     node->next->prev = node->prev;
     list->members_count--;
-    free(node);
+}
+
+void list_remove(linked_list_t* list, list_node_t* node) {
+    if (node == NULL || list_is_empty(list)) {
+        return;
+    }
+    list_unlink(list, node);
+    list_release_node(list, node);
 }
 
 void list_clear(linked_list_t* list) {
     while (!list_is_empty(list)) {
-    list_node_t* node = list_pop_left(list);
-        free(node);
+        list_node_t* node = list_pop_left(list);
+        list_release_node(list, node);
     }
 }
 
@@ -139,5 +202,32 @@ int list_init(linked_list_t* list) {
     list->tail.next = NULL;
     list->tail.data = NULL;
 
+    list->intrusive = FALSE;
+    list->free_nodes = NULL;
+    list->free_count = 0;
+    list->pool_hits = 0;
+    list->pool_misses = 0;
+
     return TRUE;
+}
+
+int list_init_intrusive(linked_list_t* list) {
+    if (!list_init(list)) {
+        return FALSE;
+    }
+    list->intrusive = TRUE;
+    return TRUE;
+}
+
+void list_destroy(linked_list_t* list) {
+    if (list == NULL) {
+        return;
+    }
+    list_clear(list);
+    while (list->free_nodes != NULL) {
+        list_node_t* node = list->free_nodes;
+        list->free_nodes = node->next;
+        free(node);
+    }
+    list->free_count = 0;
 }
\ No newline at end of file
@@ -1,4 +1,20 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "config.h"
 #include "log_router.h"
+#include "job_receiver.h"
+#include "linked_list.h"
+#include "printer.h"
+#include "ring_buffer.h"
+#include "simulation_stats.h"
+#include "timed_queue.h"
+#include "timeutils.h"
+
+typedef void (*log_event_fn)(const log_event_t* event);
 
 static int log_mode = LOG_MODE_TERMINAL;
 
@@ -9,6 +25,275 @@ static const log_ops_t* s_websocket_handler = NULL;
 // Active backend pointer
 const log_ops_t* logger = NULL;
 
+/*
+ * Event pipeline. Records come from a preallocated pool: producers pop one
+ * from free_records, fill it and push it to pending; the formatter thread pops
+ * pending records, calls the backend and returns them to free_records.
+ */
+static log_event_t* s_records = NULL;
+static ring_buffer_t s_free_records;
+static ring_buffer_t s_pending;
+static pthread_t s_formatter_thread;
+static atomic_int s_running = 0; // 1 while the formatter thread accepts events
+static atomic_int s_stopping = 0;
+
+// Events reserved by producers and events formatted, for log_router_flush
+static atomic_ulong s_published = 0;
+static atomic_ulong s_handled = 0;
+
+// The formatter sleeps on s_pending_cv only while s_formatter_waiting is set,
+// so producers skip the mutex on the common path. s_pending_cv times out on
+// CLOCK_MONOTONIC, so log_router_start initializes it (once) with clock_cond_init.
+static pthread_mutex_t s_formatter_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_pending_cv = PTHREAD_COND_INITIALIZER;
+static pthread_once_t s_pending_cv_once = PTHREAD_ONCE_INIT;
+static pthread_cond_t s_drained_cv = PTHREAD_COND_INITIALIZER;
+static atomic_int s_formatter_waiting = 0;
+static atomic_int s_flush_waiters = 0;
+
+// The session the calling thread's events belong to (see log_router_bind_session).
+// The formatter thread rebinds itself to each event's session before formatting it.
+static _Thread_local int t_session_id = 0;
+
+// Whether each session has anyone to deliver to (see log_router_set_subscribed)
+static atomic_int s_subscribed[CONFIG_LOG_MAX_SESSIONS];
+
+/*
+ * Stats publishing, per session. While the formatter runs, emit_stats_update
+ * only records the latest statistics and queue length and marks them dirty;
+ * the formatter publishes one snapshot per CONFIG_STATS_PUBLISH_INTERVAL_MS
+ * at most. Claiming and publishing happen under s_stats_mutex, so once
+ * log_router_flush has claimed the flag no tick is still reading the statistics.
+ */
+typedef struct stats_slot {
+    _Atomic(struct simulation_statistics*) source;
+    atomic_int queue_length;
+    atomic_int dirty;
+    unsigned long published_us; // formatter thread only
+} stats_slot_t;
+
+static pthread_mutex_t s_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static stats_slot_t s_stats[CONFIG_LOG_MAX_SESSIONS];
+
+
+// --- Private Helper Functions ---
+static inline int has(const void* fn) { return fn != NULL; }
+
+/**
+ * @brief The no-subscriber fast path: one relaxed atomic load, checked before an
+ * event record is built, queued or formatted.
+ */
+static inline int nobody_listening(void) {
+    return !atomic_load_explicit(&s_subscribed[t_session_id], memory_order_relaxed);
+}
+
+/**
+ * @brief Gets the active backend's handler for an event type.
+ * @return The handler, or NULL if there is no backend or it ignores the event.
+ */
+static log_event_fn handler_for(int type) {
+    if (logger == NULL) return NULL;
+    switch (type) {
+        case LOG_EVENT_SYSTEM_ARRIVAL:         return logger->system_arrival;
+        case LOG_EVENT_DROPPED_JOB:            return logger->dropped_job;
+        case LOG_EVENT_REMOVED_JOB:            return logger->removed_job;
+        case LOG_EVENT_QUEUE_ARRIVAL:          return logger->queue_arrival;
+        case LOG_EVENT_QUEUE_DEPARTURE:        return logger->queue_departure;
+        case LOG_EVENT_JOB_UPDATE:             return logger->job_update;
+        case LOG_EVENT_JOBS_UPDATE:            return logger->jobs_update;
+        case LOG_EVENT_PRINTER_ARRIVAL:        return logger->printer_arrival;
+        case LOG_EVENT_SYSTEM_DEPARTURE:       return logger->system_departure;
+        case LOG_EVENT_PAPER_EMPTY:            return logger->paper_empty;
+        case LOG_EVENT_PAPER_REFILL_START:     return logger->paper_refill_start;
+        case LOG_EVENT_PAPER_REFILL_END:       return logger->paper_refill_end;
+        case LOG_EVENT_SCALE_UP:               return logger->scale_up;
+        case LOG_EVENT_SCALE_DOWN:             return logger->scale_down;
+        case LOG_EVENT_PRINTER_IDLE:           return logger->printer_idle;
+        case LOG_EVENT_PRINTER_BUSY:           return logger->printer_busy;
+        case LOG_EVENT_PRINTER_WAITING_REFILL: return logger->printer_waiting_refill;
+        case LOG_EVENT_STATS_UPDATE:           return logger->stats_update;
+        default:                               return NULL;
+    }
+}
+
+/**
+ * @brief Calls the backend for an event and releases the event's job snapshot.
+ */
+static void dispatch_event(const log_event_t* event) {
+    log_event_fn handler = handler_for(event->type);
+    if (handler != NULL) handler(event);
+    free(event->jobs);
+}
+
+/**
+ * @brief Wakes the formatter thread if it is sleeping on an empty queue.
+ */
+static void wake_formatter(void) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&s_formatter_waiting)) {
+        pthread_mutex_lock(&s_formatter_mutex);
+        pthread_cond_signal(&s_pending_cv);
+        pthread_mutex_unlock(&s_formatter_mutex);
+    }
+}
+
+/**
+ * @brief Hands an event to the formatter thread, or formats it on the caller's
+ * thread if the formatter is not running. Events the backend has no handler for stop here.
+ * Blocks (yielding) only while every pooled record is in use, so no event is ever lost.
+ * The wait is bounded: the formatter never waits on another thread (a full
+ * WebSocket outbox drops or overflows, see ws_outbox_push), so it keeps freeing records.
+ */
+static void route_event(const log_event_t* event) {
+    if (handler_for(event->type) == NULL) {
+        free(event->jobs); // the backend ignores this event
+        return;
+    }
+    if (!atomic_load_explicit(&s_running, memory_order_acquire)) {
+        dispatch_event(event);
+        return;
+    }
+
+    log_event_t* record;
+    while ((record = (log_event_t*)ring_buffer_pop(&s_free_records)) == NULL) {
+        wake_formatter();
+        sched_yield();
+    }
+    *record = *event;
+    record->session_id = t_session_id;
+
+    // Reserve before pushing, so a flush that starts after this call returns waits for the record
+    atomic_fetch_add(&s_published, 1);
+    ring_buffer_push(&s_pending, record); // cannot fail: the ring holds every pooled record
+    wake_formatter();
+}
+
+/**
+ * @brief Takes a session's dirty statistics, if any, as a stats_update event.
+ * The caller holds s_stats_mutex.
+ * @return TRUE if the statistics were dirty and event was filled.
+ */
+static int claim_dirty_stats(int session_id, log_event_t* event) {
+    stats_slot_t* slot = &s_stats[session_id];
+    if (!atomic_exchange(&slot->dirty, 0)) return FALSE;
+    *event = (log_event_t){
+        .type = LOG_EVENT_STATS_UPDATE, .stats = atomic_load(&slot->source),
+        .queue_length = atomic_load(&slot->queue_length), .session_id = session_id,
+    };
+    return TRUE;
+}
+
+/**
+ * @brief Formatter thread: publishes each session's dirty statistics once the
+ * publish interval has passed since that session's last tick.
+ */
+static void publish_stats_if_due(void) {
+    unsigned long now_us = 0;
+    for (int session_id = 0; session_id < CONFIG_LOG_MAX_SESSIONS; session_id++) {
+        stats_slot_t* slot = &s_stats[session_id];
+        if (!atomic_load_explicit(&slot->dirty, memory_order_relaxed)) continue;
+        // A UI redraw rate: wall-clock, whatever the time scale
+        if (now_us == 0) now_us = get_unscaled_time_in_us();
+        if (now_us - slot->published_us < CONFIG_STATS_PUBLISH_INTERVAL_MS * 1000UL) continue;
+
+        log_event_t event;
+        pthread_mutex_lock(&s_stats_mutex);
+        if (claim_dirty_stats(session_id, &event)) {
+            t_session_id = session_id;
+            dispatch_event(&event);
+            slot->published_us = now_us;
+        }
+        pthread_mutex_unlock(&s_stats_mutex);
+    }
+}
+
+/**
+ * @brief Sleeps until a producer signals new events, a flush or stop wants
+ * progress, or the idle timeout passes.
+ */
+static void wait_for_events(void) {
+    pthread_mutex_lock(&s_formatter_mutex);
+    atomic_store(&s_formatter_waiting, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (ring_buffer_length(&s_pending) == 0 && !atomic_load(&s_stopping)) {
+        struct timespec deadline = get_wake_up_time_us(CONFIG_LOG_FORMATTER_IDLE_WAIT_US);
+        pthread_cond_timedwait(&s_pending_cv, &s_formatter_mutex, &deadline);
+    }
+    atomic_store(&s_formatter_waiting, 0);
+    pthread_mutex_unlock(&s_formatter_mutex);
+}
+
+/**
+ * @brief Formatter thread: drains pending events to the active backend in order.
+ * Exits once stopping is requested and every reserved event has been formatted.
+ */
+static void* formatter_thread_func(void* arg) {
+    (void)arg;
+    while (1) {
+        publish_stats_if_due();
+        log_event_t* record = (log_event_t*)ring_buffer_pop(&s_pending);
+        if (record != NULL) {
+            t_session_id = record->session_id;
+            dispatch_event(record);
+            ring_buffer_push(&s_free_records, record);
+            atomic_fetch_add(&s_handled, 1);
+            if (atomic_load(&s_flush_waiters) > 0) {
+                pthread_mutex_lock(&s_formatter_mutex);
+                pthread_cond_broadcast(&s_drained_cv);
+                pthread_mutex_unlock(&s_formatter_mutex);
+            }
+            continue;
+        }
+        if (atomic_load(&s_stopping) && atomic_load(&s_handled) == atomic_load(&s_published)) {
+            break;
+        }
+        wait_for_events();
+    }
+    return NULL;
+}
+
+typedef struct {
+    log_job_ref_t* jobs;
+    int count;
+    int capacity;
+} job_snapshot_t;
+
+static void snapshot_job(list_node_t* node, void* ctx) {
+    job_snapshot_t* snapshot = (job_snapshot_t*)ctx;
+    if (snapshot->count == snapshot->capacity) return;
+    job_t* job = list_entry(node, job_t, node);
+    snapshot->jobs[snapshot->count++] = (log_job_ref_t){job->id, job->papers_required};
+}
+
+/**
+ * @brief Copies the ids and paper counts of every queued job for a jobs update.
+ * The caller holds the queue's mutex. Returns NULL (an empty snapshot) if the
+ * queue is empty or the copy cannot be allocated.
+ */
+static log_job_ref_t* snapshot_jobs(timed_queue_t* job_queue, int* count) {
+    *count = 0;
+    int length = timed_queue_length(job_queue);
+    log_job_ref_t* jobs = length > 0 ? malloc(sizeof(log_job_ref_t) * length) : NULL;
+    if (jobs == NULL) return NULL;
+
+    // Every node from the head, in O(n) on the ring too; timed_queue_first would
+    // start at the class served next and skip the classes queued before it
+    job_snapshot_t snapshot = {jobs, 0, length};
+    timed_queue_for_each(job_queue, snapshot_job, &snapshot);
+    *count = snapshot.count;
+    return jobs;
+}
+
+/**
+ * @brief Re-initializes s_pending_cv so wait_for_events can time out on CLOCK_MONOTONIC.
+ */
+static void init_pending_cv(void) {
+    pthread_cond_destroy(&s_pending_cv);
+    clock_cond_init(&s_pending_cv);
+}
+
+
+// --- Public API Function Implementations ---
 void log_router_register_console_handler(const log_ops_t* ops) {
     s_console_handler = ops;
 }
@@ -21,108 +306,297 @@ void set_log_mode(int mode) {
     log_mode = mode;
     if (log_mode == LOG_MODE_SERVER) {
         logger = s_websocket_handler;
+        log_router_set_subscribed(FALSE); // until a client connects
     } else {
         logger = s_console_handler;
+        log_router_set_subscribed(TRUE); // stdout is always there
     }
 }
 
-static inline int has(const void* fn) { return fn != NULL; }
+void log_router_set_subscribed(int subscribed) {
+    for (int session_id = 0; session_id < CONFIG_LOG_MAX_SESSIONS; session_id++) {
+        log_router_set_session_subscribed(session_id, subscribed);
+    }
+}
+
+void log_router_set_session_subscribed(int session_id, int subscribed) {
+    if (session_id < 0 || session_id >= CONFIG_LOG_MAX_SESSIONS) return;
+    atomic_store_explicit(&s_subscribed[session_id], subscribed ? TRUE : FALSE, memory_order_relaxed);
+}
+
+void log_router_bind_session(int session_id) {
+    if (session_id < 0 || session_id >= CONFIG_LOG_MAX_SESSIONS) return;
+    t_session_id = session_id;
+}
+
+int log_router_session(void) {
+    return t_session_id;
+}
+
+int log_router_start(void) {
+    if (atomic_load(&s_running)) return TRUE;
+    pthread_once(&s_pending_cv_once, init_pending_cv);
+
+    s_records = malloc(sizeof(log_event_t) * CONFIG_LOG_EVENT_QUEUE_CAPACITY);
+    if (s_records == NULL) return FALSE;
+    if (!ring_buffer_init(&s_free_records, CONFIG_LOG_EVENT_QUEUE_CAPACITY)) {
+        free(s_records);
+        return FALSE;
+    }
+    if (!ring_buffer_init(&s_pending, CONFIG_LOG_EVENT_QUEUE_CAPACITY)) {
+        ring_buffer_destroy(&s_free_records);
+        free(s_records);
+        return FALSE;
+    }
+    for (int i = 0; i < CONFIG_LOG_EVENT_QUEUE_CAPACITY; i++) {
+        ring_buffer_push(&s_free_records, &s_records[i]);
+    }
+
+    atomic_store(&s_stopping, 0);
+    if (pthread_create(&s_formatter_thread, NULL, formatter_thread_func, NULL) != 0) {
+        ring_buffer_destroy(&s_pending);
+        ring_buffer_destroy(&s_free_records);
+        free(s_records);
+        return FALSE;
+    }
+    atomic_store_explicit(&s_running, 1, memory_order_release);
+    return TRUE;
+}
+
+void log_router_stop(void) {
+    if (!atomic_load(&s_running)) return;
+
+    atomic_store(&s_stopping, 1);
+    pthread_mutex_lock(&s_formatter_mutex);
+    pthread_cond_signal(&s_pending_cv);
+    pthread_mutex_unlock(&s_formatter_mutex);
+    pthread_join(s_formatter_thread, NULL);
+    atomic_store(&s_running, 0);
+
+    ring_buffer_destroy(&s_pending);
+    ring_buffer_destroy(&s_free_records);
+    free(s_records);
+    s_records = NULL;
+}
+
+void log_router_flush(void) {
+    if (!atomic_load(&s_running)) return;
+
+    // A cancelled flush would leave the formatter mutex held (see sig_int_catching_thread_func)
+    int cancel_state;
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancel_state);
+
+    // The session's statistics changed since the last tick go out ahead of whatever the caller emits next
+    log_event_t stats_event;
+    pthread_mutex_lock(&s_stats_mutex);
+    int stats_dirty = claim_dirty_stats(t_session_id, &stats_event);
+    pthread_mutex_unlock(&s_stats_mutex);
+    if (stats_dirty) route_event(&stats_event); // outside the mutex: it may wait on the formatter
+
+    unsigned long target = atomic_load(&s_published);
+    pthread_mutex_lock(&s_formatter_mutex);
+    atomic_fetch_add(&s_flush_waiters, 1);
+    while (atomic_load(&s_handled) < target) {
+        pthread_cond_signal(&s_pending_cv);
+        pthread_cond_wait(&s_drained_cv, &s_formatter_mutex);
+    }
+    atomic_fetch_sub(&s_flush_waiters, 1);
+    pthread_mutex_unlock(&s_formatter_mutex);
+    pthread_setcancelstate(cancel_state, NULL);
+}
 
 void emit_simulation_parameters(const struct simulation_parameters* params) {
+    log_router_flush();
     if (logger && has(logger->simulation_parameters)) logger->simulation_parameters(params);
 }
 
 void emit_simulation_start(struct simulation_statistics* stats) {
+    log_router_flush();
     if (logger && has(logger->simulation_start)) logger->simulation_start(stats);
 }
 
 void emit_simulation_end(struct simulation_statistics* stats) {
+    log_router_flush();
     if (logger && has(logger->simulation_end)) logger->simulation_end(stats);
 }
 
 void emit_system_arrival(struct job* job, unsigned long previous_job_arrival_time_us,
                          struct simulation_statistics* stats) {
-    if (logger && has(logger->system_arrival)) logger->system_arrival(job, previous_job_arrival_time_us, stats);
+    unsigned long inter_arrival_time_us = job->system_arrival_time_us - previous_job_arrival_time_us;
+    simulation_stats_count_arrival(stats, inter_arrival_time_us);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_SYSTEM_ARRIVAL, .job_id = job->id, .papers = job->papers_required,
+        .time_us = job->system_arrival_time_us, .duration_us = inter_arrival_time_us,
+    });
 }
 
 void emit_dropped_job(struct job* job, unsigned long previous_job_arrival_time_us,
                       struct simulation_statistics* stats) {
-    if (logger && has(logger->dropped_job)) logger->dropped_job(job, previous_job_arrival_time_us, stats);
+    simulation_stats_count_dropped(stats);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_DROPPED_JOB, .job_id = job->id, .papers = job->papers_required,
+        .time_us = job->system_arrival_time_us,
+        .duration_us = job->system_arrival_time_us - previous_job_arrival_time_us,
+    });
 }
 
 void emit_removed_job(struct job* job) {
-    if (logger && has(logger->removed_job)) logger->removed_job(job);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_REMOVED_JOB, .job_id = job->id, .time_us = get_time_in_us(),
+    });
 }
 
 void emit_queue_arrival(const struct job* job, struct simulation_statistics* stats,
-                        struct timed_queue* job_queue, unsigned long last_interaction_time_us) {
-    if (logger && has(logger->queue_arrival)) logger->queue_arrival(job, stats, job_queue, last_interaction_time_us);
+                        int queue_length, unsigned long queue_area_us) {
+    // stats: avg job queue length (the queue integrates its own length over time)
+    simulation_stats_record_queue_area(stats, queue_area_us);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_QUEUE_ARRIVAL, .job_id = job->id, .queue_length = queue_length,
+        .time_us = job->queue_arrival_time_us,
+    });
 }
 
 void emit_queue_departure(const struct job* job, struct simulation_statistics* stats,
-                          struct timed_queue* job_queue, unsigned long last_interaction_time_us) {
-    if (logger && has(logger->queue_departure)) logger->queue_departure(job, stats, job_queue, last_interaction_time_us);
+                          int queue_length, unsigned long queue_area_us) {
+    simulation_stats_record_queue_area(stats, queue_area_us);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_QUEUE_DEPARTURE, .job_id = job->id, .queue_length = queue_length,
+        .time_us = job->queue_departure_time_us,
+        .duration_us = job->queue_departure_time_us - job->queue_arrival_time_us,
+    });
 }
 
 void emit_job_update(const struct job* job) {
-    if (logger && has(logger->job_update)) logger->job_update(job);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_JOB_UPDATE, .job_id = job->id, .papers = job->papers_required,
+    });
 }
 
 void emit_jobs_update(struct timed_queue* job_queue) {
-    if (logger && has(logger->jobs_update)) logger->jobs_update(job_queue);
+    // Only copy the queue for a backend that shows it to someone
+    if (nobody_listening() || !logger || !has(logger->jobs_update)) return;
+    log_event_t event = {.type = LOG_EVENT_JOBS_UPDATE};
+    event.jobs = snapshot_jobs(job_queue, &event.count);
+    route_event(&event);
 }
 
 void emit_printer_arrival(const struct job* job, const struct printer* printer) {
-    if (logger && has(logger->printer_arrival)) logger->printer_arrival(job, printer);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_PRINTER_ARRIVAL, .job_id = job->id, .printer_id = printer->id,
+        .papers = job->papers_required, .time_us = job->service_arrival_time_us,
+        .duration_us = job->service_time_requested_ms * 1000UL,
+    });
 }
 
 void emit_system_departure(const struct job* job, const struct printer* printer,
                            struct simulation_statistics* stats) {
-    if (logger && has(logger->system_departure)) logger->system_departure(job, printer, stats);
+    unsigned long service_duration_us = job->service_departure_time_us - job->service_arrival_time_us;
+    // stats: system time, queue wait and per-class totals, plus the printer's own record
+    simulation_stats_count_departure(stats, job->service_class,
+        job->queue_departure_time_us - job->queue_arrival_time_us,
+        job->service_departure_time_us - job->system_arrival_time_us);
+    simulation_stats_count_printed(stats, printer->id, job->papers_required, service_duration_us);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_SYSTEM_DEPARTURE, .job_id = job->id, .printer_id = printer->id,
+        .time_us = job->service_departure_time_us, .duration_us = service_duration_us,
+    });
 }
 
 void emit_paper_empty(struct printer* printer, int job_id, unsigned long current_time_us) {
-    if (logger && has(logger->paper_empty)) logger->paper_empty(printer, job_id, current_time_us);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_PAPER_EMPTY, .job_id = job_id, .printer_id = printer->id,
+        .time_us = current_time_us,
+    });
 }
 
 void emit_paper_refill_start(struct printer* printer, int papers_needed,
                              int time_to_refill_us, unsigned long current_time_us) {
-    if (logger && has(logger->paper_refill_start)) logger->paper_refill_start(printer, papers_needed, time_to_refill_us, current_time_us);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_PAPER_REFILL_START, .printer_id = printer->id, .papers = papers_needed,
+        .time_us = current_time_us, .duration_us = time_to_refill_us,
+    });
 }
 
 void emit_paper_refill_end(struct printer* printer, int refill_duration_us,
                            unsigned long current_time_us) {
-    if (logger && has(logger->paper_refill_end)) logger->paper_refill_end(printer, refill_duration_us, current_time_us);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_PAPER_REFILL_END, .printer_id = printer->id,
+        .time_us = current_time_us, .duration_us = refill_duration_us,
+    });
 }
 
 void emit_scale_up(int new_printer_count, int queue_length, unsigned long current_time_us) {
-    if (logger && has(logger->scale_up)) logger->scale_up(new_printer_count, queue_length, current_time_us);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_SCALE_UP, .count = new_printer_count, .queue_length = queue_length,
+        .time_us = current_time_us,
+    });
 }
 
 void emit_scale_down(int new_printer_count, int queue_length, unsigned long current_time_us) {
-    if (logger && has(logger->scale_down)) logger->scale_down(new_printer_count, queue_length, current_time_us);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_SCALE_DOWN, .count = new_printer_count, .queue_length = queue_length,
+        .time_us = current_time_us,
+    });
 }
 
 void emit_printer_idle(const struct printer* printer) {
-    if (logger && has(logger->printer_idle)) logger->printer_idle(printer);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_PRINTER_IDLE, .printer_id = printer->id,
+        .papers = printer->current_paper_count, .time_us = get_time_in_us(),
+    });
 }
 
 void emit_printer_busy(const struct printer* printer, int job_id) {
-    if (logger && has(logger->printer_busy)) logger->printer_busy(printer, job_id);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_PRINTER_BUSY, .job_id = job_id, .printer_id = printer->id,
+        .papers = printer->current_paper_count, .time_us = get_time_in_us(),
+    });
 }
 
 void emit_printer_waiting_refill(const struct printer* printer) {
-    if (logger && has(logger->printer_waiting_refill)) logger->printer_waiting_refill(printer);
+    if (nobody_listening()) return;
+    route_event(&(log_event_t){
+        .type = LOG_EVENT_PRINTER_WAITING_REFILL, .printer_id = printer->id,
+        .papers = printer->current_paper_count, .time_us = get_time_in_us(),
+    });
 }
 
 void emit_stats_update(struct simulation_statistics* stats, int queue_length) {
-    if (logger && has(logger->stats_update)) logger->stats_update(stats, queue_length);
+    if (nobody_listening() || !logger || !has(logger->stats_update)) return;
+    if (!atomic_load_explicit(&s_running, memory_order_acquire)) {
+        dispatch_event(&(log_event_t){
+            .type = LOG_EVENT_STATS_UPDATE, .queue_length = queue_length, .stats = stats,
+        });
+        return;
+    }
+    // A dirty-flag set: the formatter publishes on its next tick (see publish_stats_if_due)
+    stats_slot_t* slot = &s_stats[t_session_id];
+    atomic_store_explicit(&slot->source, stats, memory_order_relaxed);
+    atomic_store_explicit(&slot->queue_length, queue_length, memory_order_relaxed);
+    atomic_store_explicit(&slot->dirty, 1, memory_order_release);
 }
 
 void emit_simulation_stopped(struct simulation_statistics* stats) {
+    log_router_flush();
     if (logger && has(logger->simulation_stopped)) logger->simulation_stopped(stats);
 }
 
 void emit_statistics(struct simulation_statistics* stats) {
+    log_router_flush();
     if (logger && has(logger->statistics)) logger->statistics(stats);
 }
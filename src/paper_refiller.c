@@ -1,7 +1,6 @@
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <unistd.h>
 
 #include "paper_refiller.h"
 #include "common.h"
@@ -9,12 +8,12 @@
 #include "printer.h"
 #include "linked_list.h"
 #include "timed_queue.h"
+#include "job_receiver.h"
 #include "preprocessing.h"
 #include "log_router.h"
 #include "simulation_stats.h"
 
 extern int g_debug;
-extern int g_terminate_now;
 
 void debug_refiller(int papers_supplied) {
     printf("Debug: Paper Refiller supplied %d papers\n", papers_supplied);
@@ -34,19 +33,44 @@ static int is_exit_condition_met(int all_jobs_served) {
     return FALSE;
 }
 
-void* paper_refill_thread_func(void* arg) {
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+int paper_refill_begin(paper_refill_thread_args_t* args, printer_t* printer, unsigned long refill_start_time_us,
+                       int* papers_needed) {
+    *papers_needed = printer->capacity - printer->current_paper_count;
+    if (*papers_needed <= 0) {
+        if (g_debug) printf("Debug: Paper Refiller found printer %d already full, skipping refill\n", printer->id);
+        return 0;
+    }
+    int time_to_refill_us = (unsigned long)((*papers_needed / args->params->refill_rate) * 1000000);
+    emit_paper_refill_start(printer, *papers_needed, time_to_refill_us, refill_start_time_us);
+    return time_to_refill_us;
+}
+
+void paper_refill_finish(paper_refill_thread_args_t* args, printer_t* printer, int papers_needed,
+                         unsigned long refill_start_time_us) {
+    unsigned long refill_end_time_us = get_time_in_us();
+    int refill_duration_us = refill_end_time_us - refill_start_time_us;
+    emit_paper_refill_end(printer, refill_duration_us, refill_end_time_us);
     
+    // Done refilling: update printer state and simulation stats
+    printer->current_paper_count += papers_needed;
+    simulation_stats_count_refill(args->stats, papers_needed, refill_end_time_us - refill_start_time_us);
+    emit_stats_update(args->stats, job_backlog_length(args->job_queue, args->dispatcher));
+    if (g_debug) debug_refiller(papers_needed);
+}
+
+void* paper_refill_thread_func(void* arg) {
     paper_refill_thread_args_t* args = (paper_refill_thread_args_t*)arg;
 
     if (g_debug) printf("Paper refiller thread started\n");
+    simulation_stats_bind_shard(args->stats, STATS_SHARD_REFILLER);
+    log_router_bind_session(args->session_id);
     while (1) {
         pthread_mutex_lock(args->paper_refill_queue_mutex);
 
         for (;;) {
             // Safely check shared flags
             pthread_mutex_lock(args->simulation_state_mutex);
-            int terminate_now = g_terminate_now;
+            int terminate_now = *(args->terminate_now);
             int are_all_jobs_served = *(args->all_jobs_served);
             pthread_mutex_unlock(args->simulation_state_mutex);
 
@@ -61,52 +85,33 @@ void* paper_refill_thread_func(void* arg) {
                 break; // there's work
             }
 
-            /* 
-             * Disabling cancellation to avoid deadlock from thread
-             * being cancelled while holding mutex
-             *
-             * Wait until signaled to refill paper or terminate
-             */
+            // Wait until signaled to refill paper or terminate
             pthread_cond_wait(args->refill_supplier_cv, args->paper_refill_queue_mutex);
         }
         unsigned long refill_start_time_us = get_time_in_us();
         list_node_t* elem = list_pop_left(args->paper_refill_queue);
         printer_t* printer = (printer_t*)elem->data;
+        list_release_node(args->paper_refill_queue, elem); // recycle while still holding the mutex
         pthread_mutex_unlock(args->paper_refill_queue_mutex); // unlock while refilling
 
         // Refill paper
-        int papers_needed = printer->capacity - printer->current_paper_count;
-        if (papers_needed <= 0) {
-            if (g_debug) printf("Debug: Paper Refiller found printer %d already full, skipping refill\n", printer->id);
-            free(elem);
+        int papers_needed;
+        int time_to_refill_us = paper_refill_begin(args, printer, refill_start_time_us, &papers_needed);
+        if (time_to_refill_us == 0) {
             // Still broadcast to wake up any waiting printers
             pthread_mutex_lock(args->paper_refill_queue_mutex);
             pthread_cond_broadcast(args->refill_needed_cv);
             pthread_mutex_unlock(args->paper_refill_queue_mutex);
             continue;
         }
-
-        int time_to_refill_us = (unsigned long)((papers_needed / args->params->refill_rate) * 1000000);
-        emit_paper_refill_start(printer, papers_needed, time_to_refill_us, refill_start_time_us);
         
-        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-        usleep(time_to_refill_us);
-        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-        
-        unsigned long refill_end_time_us = get_time_in_us();
-        int refill_duration_us = refill_end_time_us - refill_start_time_us;
-        emit_paper_refill_end(printer, refill_duration_us, refill_end_time_us);
+        // Once the last printer is done (or the run is stopped) the refill is abandoned
+        if (!clock_sleep_unless(time_to_refill_us, args->all_jobs_served,
+                                args->simulation_state_mutex, args->simulation_state_cv)) {
+            goto exit_refiller;
+        }
         
-        // Done refilling: update printer state and simulation stats
-        printer->current_paper_count += papers_needed;
-        pthread_mutex_lock(args->stats_mutex);
-        args->stats->papers_refilled += papers_needed;
-        args->stats->total_refill_service_time_us += refill_end_time_us - refill_start_time_us;
-        args->stats->paper_refill_events++;
-        emit_stats_update(args->stats, timed_queue_length(args->job_queue));
-        pthread_mutex_unlock(args->stats_mutex);
-        free(elem);
-        if (g_debug) debug_refiller(papers_needed);
+        paper_refill_finish(args, printer, papers_needed, refill_start_time_us);
 
         // Notify waiting printers that refill is done
         pthread_mutex_lock(args->paper_refill_queue_mutex);
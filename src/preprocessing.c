@@ -5,10 +5,11 @@
 #include <math.h>
 #include "common.h"
 #include "config.h"
+#include "job_dispatcher.h"
+#include "virtual_engine.h"
 #include "preprocessing.h"
 
 int g_debug = 0;
-int g_terminate_now = 0;
 
 void usage() {
     fprintf(stderr, "usage: ./bin/cli [-debug] [-help] [-num num_jobs] [-q queue_capacity]\n");
@@ -17,16 +18,42 @@ void usage() {
     fprintf(stderr, "                 [-papers_lower papers_required_lower_bound]\n");
     fprintf(stderr, "                 [-papers_upper papers_required_upper_bound]\n");
     fprintf(stderr, "                 [-consumers consumer_count] [-auto_scale 0|1]\n");
+    fprintf(stderr, "                 [-max_consumers max_consumer_count]\n");
     fprintf(stderr, "                 [-fixed_arrival 0|1] [-job_arr_time job_arrival_time_ms]\n");
     fprintf(stderr, "                 [-min_arr min_arrival_time] [-max_arr max_arrival_time]\n");
+    fprintf(stderr, "                 [-queue_backend list|ring]\n");
+    fprintf(stderr, "                 [-premium_pct percent] [-bulk_pct percent]\n");
+    fprintf(stderr, "                 [-printer_batch jobs_per_lock] [-burst jobs_per_arrival]\n");
+    fprintf(stderr, "                 [-dispatch shared|rr|shortest] [-engine threads|virtual]\n");
+    fprintf(stderr, "                 [-time_scale factor]\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Notes:\n");
     fprintf(stderr, "  - If fixed_arrival is 1, job_arr_time (ms) determines inter-arrival time\n");
     fprintf(stderr, "  - If fixed_arrival is 0, inter-arrival time is random between min_arr and max_arr\n");
+    fprintf(stderr, "  - queue_backend ring uses a bounded lock-free job queue (capacity from -q)\n");
+    fprintf(stderr, "  - premium_pct/bulk_pct split jobs into service classes (rest are standard);\n");
+    fprintf(stderr, "    printers serve classes by weighted round-robin (list backend only)\n");
+    fprintf(stderr, "  - printer_batch > 1 lets a printer claim several jobs (that fit its paper) per queue lock\n");
+    fprintf(stderr, "  - burst > 1 makes that many jobs arrive together after each inter-arrival time\n");
+    fprintf(stderr, "  - dispatch rr|shortest gives each printer its own job deque (filled round-robin or\n");
+    fprintf(stderr, "    shortest deque first); idle printers steal from busy ones\n");
+    fprintf(stderr, "  - max_consumers sizes the printer pool: autoscaling adds printers up to this many\n");
+    fprintf(stderr, "  - engine virtual runs the same simulation on a virtual clock without sleeping,\n");
+    fprintf(stderr, "    so large runs finish in seconds; logged times are simulated times\n");
+    fprintf(stderr, "  - time_scale N runs the threads N times faster than real time (e.g. 10 or 100);\n");
+    fprintf(stderr, "    logged times and statistics stay in simulated time\n");
+}
+
+// Each thread draws from its own stream, so the jobs a simulation generates do
+// not depend on what simulations running on other threads draw
+static _Thread_local unsigned int t_random_state = 1;
+
+void random_seed(unsigned int seed) {
+    t_random_state = seed;
 }
 
 int random_between(int lower, int upper) {
-    return (rand() % (upper - lower + 1)) + lower;
+    return (rand_r(&t_random_state) % (upper - lower + 1)) + lower;
 }
 
 void swap_bounds(int* lower, int* upper) {
@@ -67,6 +94,20 @@ int is_in_range_int(const char* str, int value, int min, int max) {
     return TRUE;
 }
 
+int is_valid_class_split(const simulation_parameters_t* params) {
+    if (params->premium_job_percent + params->bulk_job_percent > 100) {
+        fprintf(stderr, "Error: premium_pct + bulk_pct must not exceed 100.\n");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void clamp_pool_size(simulation_parameters_t* params) {
+    if (params->max_consumer_count < params->consumer_count) {
+        params->max_consumer_count = params->consumer_count;
+    }
+}
+
 int process_args(int argc, char *argv[], simulation_parameters_t* params) {
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-help") == 0) {
@@ -147,6 +188,16 @@ int process_args(int argc, char *argv[], simulation_parameters_t* params) {
                 CONFIG_RANGE_CONSUMER_COUNT_MAX)
             ) return FALSE;
         }
+        // Printer pool size (autoscaling ceiling)
+        else if (strcmp(argv[i], "-max_consumers") == 0) {
+            params->max_consumer_count = atoi(argv[++i]);
+            if (!is_in_range_int(
+                "max_consumer_count",
+                params->max_consumer_count,
+                CONFIG_RANGE_CONSUMER_COUNT_MIN,
+                CONFIG_RANGE_CONSUMER_COUNT_MAX)
+            ) return FALSE;
+        }
         // Auto-scaling
         else if (strcmp(argv[i], "-auto_scale") == 0) {
             params->auto_scaling = atoi(argv[++i]);
@@ -192,6 +243,76 @@ int process_args(int argc, char *argv[], simulation_parameters_t* params) {
                 CONFIG_RANGE_MAX_ARRIVAL_TIME_MAX)
             ) return FALSE;
         }
+        // Job queue backend
+        else if (strcmp(argv[i], "-queue_backend") == 0) {
+            const char* backend = argv[++i];
+            if (strcmp(backend, "list") == 0) {
+                params->queue_backend = 0;
+            } else if (strcmp(backend, "ring") == 0) {
+                params->queue_backend = 1;
+            } else {
+                fprintf(stderr, "Error: queue_backend must be list or ring.\n");
+                return FALSE;
+            }
+        }
+        // Shared job queue or per-printer deques with work stealing
+        else if (strcmp(argv[i], "-dispatch") == 0) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "shared") == 0) {
+                params->dispatch_mode = JOB_DISPATCH_SHARED;
+            } else if (strcmp(mode, "rr") == 0) {
+                params->dispatch_mode = JOB_DISPATCH_ROUND_ROBIN;
+            } else if (strcmp(mode, "shortest") == 0) {
+                params->dispatch_mode = JOB_DISPATCH_SHORTEST_QUEUE;
+            } else {
+                fprintf(stderr, "Error: dispatch must be shared, rr or shortest.\n");
+                return FALSE;
+            }
+        }
+        // Real-time threads or the virtual-time event engine
+        else if (strcmp(argv[i], "-engine") == 0) {
+            const char* engine = argv[++i];
+            if (strcmp(engine, "threads") == 0) {
+                params->engine = SIMULATION_ENGINE_THREADS;
+            } else if (strcmp(engine, "virtual") == 0) {
+                params->engine = SIMULATION_ENGINE_VIRTUAL;
+            } else {
+                fprintf(stderr, "Error: engine must be threads or virtual.\n");
+                return FALSE;
+            }
+        }
+        // Simulated seconds per wall-clock second
+        else if (strcmp(argv[i], "-time_scale") == 0) {
+            params->time_scale = atof(argv[++i]);
+            if (!is_in_range_double(
+                "time_scale",
+                params->time_scale,
+                CONFIG_RANGE_TIME_SCALE_MIN,
+                CONFIG_RANGE_TIME_SCALE_MAX)
+            ) return FALSE;
+        }
+        // Share of premium jobs
+        else if (strcmp(argv[i], "-premium_pct") == 0) {
+            params->premium_job_percent = atoi(argv[++i]);
+            if (!is_in_range_int("premium_pct", params->premium_job_percent, 0, 100)
+                || !is_valid_class_split(params)) return FALSE;
+        }
+        // Share of bulk jobs
+        else if (strcmp(argv[i], "-bulk_pct") == 0) {
+            params->bulk_job_percent = atoi(argv[++i]);
+            if (!is_in_range_int("bulk_pct", params->bulk_job_percent, 0, 100)
+                || !is_valid_class_split(params)) return FALSE;
+        }
+        // Jobs claimed per printer queue-lock acquisition
+        else if (strcmp(argv[i], "-printer_batch") == 0) {
+            params->printer_batch_size = atoi(argv[++i]);
+            if (!is_in_range_int("printer_batch", params->printer_batch_size, 1, CONFIG_PRINTER_BATCH_MAX)) return FALSE;
+        }
+        // Jobs arriving together per inter-arrival time
+        else if (strcmp(argv[i], "-burst") == 0) {
+            params->job_burst_size = atoi(argv[++i]);
+            if (!is_in_range_int("burst", params->job_burst_size, 1, CONFIG_JOB_BURST_MAX)) return FALSE;
+        }
         // Debug mode
         else if (strcmp(argv[i], "-debug") == 0) {
             g_debug = 1;
@@ -204,5 +325,6 @@ int process_args(int argc, char *argv[], simulation_parameters_t* params) {
         }
         swap_bounds(&params->papers_required_lower_bound, &params->papers_required_upper_bound);
     }
+    clamp_pool_size(params);
     return TRUE;
 }
\ No newline at end of file
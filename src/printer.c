@@ -2,7 +2,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
-#include <unistd.h>
 
 #include "preprocessing.h"
 #include "config.h"
@@ -13,10 +12,11 @@
 #include "linked_list.h"
 #include "timed_queue.h"
 #include "job_receiver.h"
+#include "job_dispatcher.h"
 #include "printer.h"
+#include "worker_pool.h"
 
 extern int g_debug;
-extern int g_terminate_now;
 
 /**
  * @brief Checks if the exit condition for the server thread is met.
@@ -27,6 +27,243 @@ static int is_exit_condition_met(int all_jobs_arrived, timed_queue_t* job_queue)
     return all_jobs_arrived && timed_queue_is_empty(job_queue);
 }
 
+/**
+ * @brief Reads the termination flag under the simulation state mutex.
+ *
+ * @return TRUE if the simulation is terminating, FALSE otherwise.
+ */
+static int is_terminating(printer_thread_args_t* args) {
+    pthread_mutex_lock(args->simulation_state_mutex);
+    int terminate = *(args->terminate_now);
+    pthread_mutex_unlock(args->simulation_state_mutex);
+    return terminate;
+}
+
+/**
+ * @brief Returns how many jobs a printer may claim per job queue lock acquisition.
+ */
+static int batch_size_of(const simulation_parameters_t* params) {
+    int batch_size = params->printer_batch_size;
+    if (batch_size < 1) return 1;
+    if (batch_size > CONFIG_PRINTER_BATCH_MAX) return CONFIG_PRINTER_BATCH_MAX;
+    return batch_size;
+}
+
+// Paper left for the jobs a printer is claiming, and the first job that did not fit
+typedef struct paper_budget {
+    int remaining;
+    int blocked_job_id; // 0 if every candidate fitted
+    int blocked_papers;
+} paper_budget_t;
+
+/**
+ * @brief Batch filter: accepts a queued job while it fits in the remaining paper budget.
+ *
+ * @param node Queue node embedded in the candidate job.
+ * @param ctx Pointer to a paper_budget_t; remaining is reduced on accept and
+ *            the rejected job is recorded otherwise.
+ * @return TRUE to claim the job, FALSE to stop the batch.
+ */
+static int job_fits_paper_budget(list_node_t* node, void* ctx) {
+    paper_budget_t* budget = (paper_budget_t*)ctx;
+    job_t* job = list_entry(node, job_t, node);
+    if (job->papers_required > budget->remaining) {
+        budget->blocked_job_id = job->id;
+        budget->blocked_papers = job->papers_required;
+        return FALSE;
+    }
+    budget->remaining -= job->papers_required;
+    return TRUE;
+}
+
+/**
+ * @brief Queues this printer for a refill and blocks until it holds at least papers_required papers.
+ * Called without job_queue_mutex held.
+ *
+ * @param papers_required Papers needed by the job that did not fit.
+ * @param job_id Id of that job (for logging).
+ * @return TRUE once refilled, FALSE if the simulation is terminating or finished.
+ */
+static int wait_for_paper(printer_thread_args_t* args, int papers_required, int job_id) {
+    pthread_mutex_lock(args->paper_refill_queue_mutex);
+    unsigned long refill_start_time_us = get_time_in_us();
+    emit_paper_empty(args->printer, job_id, refill_start_time_us);
+    emit_printer_waiting_refill(args->printer);
+    list_append(args->paper_refill_queue, args->printer);
+    pthread_cond_signal(args->refill_supplier_cv); // Notify refill thread (the only waiter)
+    
+    // Wait until paper is refilled - loop until we actually have enough
+    while (papers_required > args->printer->current_paper_count) {
+        // Check termination before every wait. Once another printer has served the
+        // last job (e.g. the one this printer was waiting to print) the refiller
+        // stops, so no refill is coming. A retiring printer stops waiting too.
+        pthread_mutex_lock(args->simulation_state_mutex);
+        int terminate = *(args->terminate_now) || *(args->all_jobs_served) || atomic_load(&args->retire);
+        pthread_mutex_unlock(args->simulation_state_mutex);
+        if (terminate) {
+            // Leave the refill queue, unless the refiller has already taken this printer
+            list_node_t* queued = list_find(args->paper_refill_queue, args->printer);
+            if (queued != NULL) list_remove(args->paper_refill_queue, queued);
+            pthread_mutex_unlock(args->paper_refill_queue_mutex);
+            return FALSE;
+        }
+
+        pthread_cond_wait(args->refill_needed_cv, args->paper_refill_queue_mutex);
+    }
+    pthread_mutex_unlock(args->paper_refill_queue_mutex);
+
+    // Printer is no longer waiting for refill
+    emit_printer_idle(args->printer);
+    
+    // Update stats for paper empty duration (in the printer's own record)
+    int paper_empty_duration_us = get_time_in_us() - refill_start_time_us;
+    simulation_stats_count_paper_empty(args->stats, args->printer->id, paper_empty_duration_us);
+    return TRUE;
+}
+
+/**
+ * @brief Prints a claimed job and records its departure from the system.
+ * Called without job_queue_mutex held.
+ */
+static void serve_job(printer_thread_args_t* args, job_t* job) {
+    printer_begin_job(args, job);
+    clock_sleep_us(job->service_time_requested_ms * 1000UL); // Convert ms to us
+    printer_finish_job(args, job);
+}
+
+/**
+ * @brief Serves the jobs a printer has claimed, in order.
+ * If the simulation terminates mid-batch, the jobs not yet started count as removed.
+ */
+static void serve_claimed(printer_thread_args_t* args, list_node_t** claimed, int claimed_count) {
+    for (int i = 0; i < claimed_count; i++) {
+        job_t* job = list_entry(claimed[i], job_t, node);
+        if (i > 0 && is_terminating(args)) {
+            // Stopped mid-batch: the rest of the claimed jobs count as removed
+            emit_removed_job(job);
+            simulation_stats_count_removed(args->stats);
+            free(job);
+            continue;
+        }
+        serve_job(args, job);
+    }
+}
+
+/**
+ * @brief Printer loop for the per-printer deque dispatch modes.
+ * Serves the printer's own deque front first, steals from the back of the
+ * busiest deque when its own runs dry, and waits for paper when the job at
+ * its front does not fit. Never touches job_queue_mutex.
+ */
+static void run_dispatched(printer_thread_args_t* args) {
+    job_dispatcher_t* dispatcher = args->dispatcher;
+    int own = args->printer->id - 1;
+
+    while (!is_terminating(args) && !atomic_load(&args->retire)) {
+        list_node_t* claimed[CONFIG_PRINTER_BATCH_MAX];
+        int blocked_job_id, blocked_papers;
+        int claimed_count = printer_claim_jobs(args, claimed, TRUE, &blocked_job_id, &blocked_papers);
+
+        if (claimed_count == 0) {
+            if (blocked_job_id != 0) {
+                // The job at the front of our deque needs more paper than is left
+                if (!wait_for_paper(args, blocked_papers, blocked_job_id)) return;
+                continue;
+            }
+
+            pthread_mutex_lock(args->simulation_state_mutex);
+            int have_all_jobs_arrived = *(args->all_jobs_arrived);
+            pthread_mutex_unlock(args->simulation_state_mutex);
+            if (have_all_jobs_arrived && job_dispatcher_length(dispatcher) == 0) {
+                if (g_debug) printf("Printer %d has finished\n", args->printer->id);
+                return;
+            }
+            job_dispatcher_wait(dispatcher, own, CONFIG_DISPATCH_STEAL_RETRY_US);
+            continue;
+        }
+
+        serve_claimed(args, claimed, claimed_count);
+
+        if (g_debug) printf("Printer %d is looking for next job\n", args->printer->id);
+        if (g_debug) debug_printer(args->printer);
+    }
+}
+
+int printer_claim_jobs(printer_thread_args_t* args, list_node_t** claimed, int may_steal,
+                       int* blocked_job_id, int* blocked_papers) {
+    paper_budget_t budget = {args->printer->current_paper_count, 0, 0};
+    int claimed_count;
+    if (args->dispatcher == NULL) {
+        claimed_count = timed_queue_dequeue_batch_while(args->job_queue, claimed,
+            batch_size_of(args->params), job_fits_paper_budget, &budget);
+    } else {
+        int own = args->printer->id - 1;
+        claimed_count = job_dispatcher_take(args->dispatcher, own, claimed,
+            batch_size_of(args->params), job_fits_paper_budget, &budget);
+        if (claimed_count == 0 && budget.blocked_job_id == 0 && may_steal) {
+            // Own deque is empty: steal a job that fits from the busiest printer
+            paper_budget_t steal_budget = {args->printer->current_paper_count, 0, 0};
+            claimed[0] = job_dispatcher_steal(args->dispatcher, own, job_fits_paper_budget, &steal_budget);
+            claimed_count = claimed[0] != NULL ? 1 : 0;
+        }
+    }
+    *blocked_job_id = claimed_count == 0 ? budget.blocked_job_id : 0;
+    *blocked_papers = budget.blocked_papers;
+    if (claimed_count == 0) {
+        return 0;
+    }
+
+    // Log the departures (the receiver logged each arrival when it queued the job)
+    unsigned long queue_departure_time_us = get_time_in_us();
+    int queue_length = job_backlog_length(args->job_queue, args->dispatcher);
+    unsigned long queue_area_us = job_backlog_area_us(args->job_queue, args->dispatcher);
+    for (int i = 0; i < claimed_count; i++) {
+        job_t* job = list_entry(claimed[i], job_t, node);
+        job->queue_departure_time_us = queue_departure_time_us;
+        emit_queue_departure(job, args->stats, queue_length, queue_area_us);
+    }
+    if (args->dispatcher == NULL) {
+        emit_jobs_update(args->job_queue);
+    }
+    emit_stats_update(args->stats, queue_length);
+    return claimed_count;
+}
+
+void printer_begin_job(printer_thread_args_t* args, job_t* job) {
+    // Update job service_time_requested_ms based on printer speed
+    job->service_time_requested_ms =
+            (int)((job->papers_required / args->params->printing_rate) * 1000); // in ms
+
+    // Log job arrival at printer
+    job->service_arrival_time_us = get_time_in_us();
+    emit_printer_arrival(job, args->printer);
+
+    // Service the job
+    args->printer->is_idle = 0; // Mark as busy
+    emit_printer_busy(args->printer, job->id);
+}
+
+void printer_finish_job(printer_thread_args_t* args, job_t* job) {
+    args->printer->current_paper_count -= job->papers_required;
+    args->printer->total_papers_used += job->papers_required;
+
+    // Update job departure time
+    job->service_departure_time_us = get_time_in_us();
+    
+    // Track completion time for idle detection
+    args->printer->last_job_completion_time_us = job->service_departure_time_us;
+    args->printer->is_idle = 1; // Mark as idle
+    emit_printer_idle(args->printer);
+
+    // Log job departure from system and update stats (this printer's shard, no stats_mutex)
+    args->printer->jobs_printed_count++;
+    emit_system_departure(job, args->printer, args->stats);
+    emit_stats_update(args->stats, job_backlog_length(args->job_queue, args->dispatcher));
+
+    // Free job resources (queue links are embedded in the job)
+    free(job);
+}
+
 void debug_printer(const printer_t* printer) {
     printf("Debug: Printer %d has printed %d jobs and used %d papers\n",
         printer->id, printer->jobs_printed_count, printer->total_papers_used);
@@ -36,16 +273,25 @@ void* printer_thread_func(void* arg) {
     printer_thread_args_t* args = (printer_thread_args_t*)arg;
 
     if (g_debug) printf("Printer %d thread started\n", args->printer->id);
+    simulation_stats_bind_shard(args->stats, STATS_SHARD_PRINTER(args->printer->id));
+    log_router_bind_session(args->session_id);
+
+    if (args->dispatcher != NULL) {
+        run_dispatched(args);
+        goto exit_printer;
+    }
 
     while (1) {
         for (;;) {
             // Safely check shared flags
             pthread_mutex_lock(args->simulation_state_mutex);
-            int terminate = g_terminate_now;
+            int terminate = *(args->terminate_now);
             pthread_mutex_unlock(args->simulation_state_mutex);
 
+            // retire is set under job_queue_mutex, so a printer about to wait cannot miss it
             pthread_mutex_lock(args->job_queue_mutex);
-            if (terminate || is_exit_condition_met(*(args->all_jobs_arrived), args->job_queue)) {
+            if (terminate || atomic_load(&args->retire)
+                    || is_exit_condition_met(*(args->all_jobs_arrived), args->job_queue)) {
                 if (g_debug) printf("Printer %d is terminating or finished\n", args->printer->id);
                 pthread_mutex_unlock(args->job_queue_mutex);
                 goto exit_printer;
@@ -60,97 +306,21 @@ void* printer_thread_func(void* arg) {
             pthread_mutex_unlock(args->job_queue_mutex);
         }
 
-        // Check if there are enough papers for the job at the front of the queue
-        list_node_t* elem = timed_queue_first(args->job_queue);
-        job_t* job_to_dequeue = (job_t*)elem->data;
-        if (job_to_dequeue->papers_required > args->printer->current_paper_count) {
-            // Not enough paper for the job at the front of the queue
+        // Claim the head job and, in batch mode, the jobs behind it that still fit in the paper tray
+        list_node_t* claimed[CONFIG_PRINTER_BATCH_MAX];
+        int blocked_job_id, blocked_papers;
+        int claimed_count = printer_claim_jobs(args, claimed, TRUE, &blocked_job_id, &blocked_papers);
+        if (claimed_count == 0) {
+            // Not enough paper for the job at the front of the queue: pass this
+            // printer's wakeup on so an idle printer with paper can take the job
+            pthread_cond_signal(args->job_queue_not_empty_cv);
             pthread_mutex_unlock(args->job_queue_mutex);
-            
-            pthread_mutex_lock(args->paper_refill_queue_mutex);
-            unsigned long refill_start_time_us = get_time_in_us();
-            emit_paper_empty(args->printer, job_to_dequeue->id, refill_start_time_us);
-            emit_printer_waiting_refill(args->printer);
-            list_append(args->paper_refill_queue, args->printer);
-            pthread_cond_broadcast(args->refill_supplier_cv); // Notify refill thread
-            
-            // Wait until paper is refilled - loop until we actually have enough
-            while (job_to_dequeue->papers_required > args->printer->current_paper_count) {
-                pthread_cond_wait(args->refill_needed_cv, args->paper_refill_queue_mutex);
-                
-                // Check termination after waking up
-                pthread_mutex_lock(args->simulation_state_mutex);
-                int terminate = g_terminate_now;
-                pthread_mutex_unlock(args->simulation_state_mutex);
-                if (terminate) {
-                    pthread_mutex_unlock(args->paper_refill_queue_mutex);
-                    goto exit_printer;
-                }
-            }
-            pthread_mutex_unlock(args->paper_refill_queue_mutex);
-
-            // Printer is no longer waiting for refill
-            emit_printer_idle(args->printer);
-            
-            // Update stats for paper empty duration
-            pthread_mutex_lock(args->stats_mutex);
-            int paper_empty_duration_us = get_time_in_us() - refill_start_time_us;
-            
-            // Track in array format (0-indexed)
-            int idx = args->printer->id - 1;
-            if (idx >= 0 && idx < MAX_PRINTERS) {
-                args->stats->printer_paper_empty_time_us[idx] += paper_empty_duration_us;
-            }
-
-            pthread_mutex_unlock(args->stats_mutex);
+            if (!wait_for_paper(args, blocked_papers, blocked_job_id)) goto exit_printer;
             continue;
         }
-
-        // Get the next job from the queue
-        unsigned long queue_last_interaction_time_us = args->job_queue->last_interaction_time_us;
-        elem = timed_queue_dequeue_front(args->job_queue);
-        job_t* job = (job_t*)elem->data;
-        job->queue_departure_time_us = get_time_in_us();
-        emit_queue_departure(job, args->stats, args->job_queue, queue_last_interaction_time_us);
-        emit_jobs_update(args->job_queue);
-        emit_stats_update(args->stats, timed_queue_length(args->job_queue));
-
         pthread_mutex_unlock(args->job_queue_mutex);
 
-        // Update job service_time_requested_ms based on printer speed
-        job->service_time_requested_ms =
-                (int)((job->papers_required / args->params->printing_rate) * 1000); // in ms
-
-        // Log job arrival at printer
-        job->service_arrival_time_us = get_time_in_us();
-        emit_printer_arrival(job, args->printer);
-
-        // Service the job
-        args->printer->is_idle = 0; // Mark as busy
-        emit_printer_busy(args->printer, job->id);
-        usleep(job->service_time_requested_ms * 1000); // Convert ms to us
-        args->printer->current_paper_count -= job->papers_required;
-        args->printer->total_papers_used += job->papers_required;
-
-        // Update job departure time
-        job->service_departure_time_us = get_time_in_us();
-        
-        // Track completion time for idle detection
-        args->printer->last_job_completion_time_us = job->service_departure_time_us;
-        args->printer->is_idle = 1; // Mark as idle
-        emit_printer_idle(args->printer);
-
-        // Update stats
-        pthread_mutex_lock(args->stats_mutex);
-        args->printer->jobs_printed_count++;
-        // Log job departure from system and update stats
-        emit_system_departure(job, args->printer, args->stats);
-        emit_stats_update(args->stats, timed_queue_length(args->job_queue));
-        pthread_mutex_unlock(args->stats_mutex);
-
-        // Free job resources
-        free(elem);
-        free(job);
+        serve_claimed(args, claimed, claimed_count);
 
         // Check exit condition.
         pthread_mutex_lock(args->simulation_state_mutex);
@@ -169,15 +339,21 @@ void* printer_thread_func(void* arg) {
     }
 
 exit_printer:
+    if (atomic_load(&args->retire)) {
+        // Scaled down: the printers still in service finish the run
+        if (g_debug) printf("Printer %d retired\n", args->printer->id);
+        return NULL;
+    }
+
     pthread_mutex_lock(args->simulation_state_mutex);
     *(args->all_jobs_served) = 1;
+    pthread_cond_broadcast(args->simulation_state_cv); // Stop the paper refill thread in case it's refilling a printer
     pthread_mutex_unlock(args->simulation_state_mutex);
     
     pthread_mutex_lock(args->paper_refill_queue_mutex);
     pthread_cond_broadcast(args->refill_supplier_cv); // Notify refill thread in case it's waiting
     pthread_cond_broadcast(args->refill_needed_cv); // Notify printer thread in case it's waiting
     pthread_mutex_unlock(args->paper_refill_queue_mutex);
-    pthread_cancel(*args->paper_refill_thread); // Cancel the paper refill thread in case it's refilling a printer
     if (g_debug) printf("Printer %d gracefully exited\n", args->printer->id);
     return NULL;
 }
@@ -185,16 +361,26 @@ exit_printer:
 // Printer Pool Management
 // ============================================================================
 
-void printer_pool_init(printer_pool_t* pool, int min_printers, int paper_capacity) {
+int printer_pool_init(printer_pool_t* pool, int min_printers, int max_printers, int paper_capacity,
+                      worker_pool_t* workers) {
     memset(pool, 0, sizeof(printer_pool_t));
+    int capacity = max_printers > min_printers ? max_printers : min_printers;
+    // printer_instance_t is cache-line aligned, so its size is a multiple of the alignment
+    pool->printers = aligned_alloc(CONFIG_CACHE_LINE_SIZE, sizeof(printer_instance_t) * capacity);
+    if (pool->printers == NULL) {
+        return 0;
+    }
+    memset(pool->printers, 0, sizeof(printer_instance_t) * capacity);
+    pool->capacity = capacity;
     pool->min_count = min_printers;
+    pool->workers = workers;
     pool->active_count = 0;
     pthread_mutex_init(&pool->pool_mutex, NULL);
     pool->last_scale_time_us = 0;
     pool->low_queue_start_time_us = 0;
     
     // Initialize all printer slots as inactive
-    for (int i = 0; i < CONFIG_RANGE_CONSUMER_COUNT_MAX; i++) {
+    for (int i = 0; i < capacity; i++) {
         pool->printers[i].active = 0;
         pool->printers[i].printer.id = i + 1;
         pool->printers[i].printer.current_paper_count = paper_capacity;
@@ -204,50 +390,121 @@ void printer_pool_init(printer_pool_t* pool, int min_printers, int paper_capacit
         pool->printers[i].printer.last_job_completion_time_us = 0;
         pool->printers[i].printer.is_idle = 1;
     }
+    return 1;
 }
 
-int printer_pool_start_printer(printer_pool_t* pool, int printer_id, const printer_thread_args_t* shared_args) {
-    if (pool->active_count >= CONFIG_RANGE_CONSUMER_COUNT_MAX) {
-        return 0;
+/**
+ * @brief Opens a free printer slot's deque and copies the shared args into it.
+ * @return The slot index, or -1 if the pool is full or the slot is taken.
+ */
+static int prepare_slot(printer_pool_t* pool, int printer_id, const printer_thread_args_t* shared_args) {
+    if (pool->active_count >= pool->capacity) {
+        return -1;
     }
     
     int index = printer_id - 1; // 0-indexed
     
-    if (pool->printers[index].active) {
-        return 0; // Already active
+    if (index < 0 || index >= pool->capacity || pool->printers[index].active) {
+        return -1; // Already active
     }
     
-    // Copy shared args
+    // Open this printer's deque before it starts taking jobs (dispatch modes only)
+    if (shared_args->dispatcher != NULL) {
+        job_dispatcher_open(shared_args->dispatcher, index);
+    }
+
+    // Copy shared args (a slot reused after a scale-down starts out of retirement)
     pool->printers[index].args = *shared_args;
+    atomic_store(&pool->printers[index].args.retire, FALSE);
     // Point to this printer's instance
     pool->printers[index].args.printer = &pool->printers[index].printer;
+    return index;
+}
+
+static void mark_active(printer_pool_t* pool, int index) {
+    pool->printers[index].active = 1;
+    pool->active_count++;
     
-    // Create thread
-    int result = pthread_create(&pool->printers[index].thread, NULL, 
-                                printer_thread_func, &pool->printers[index].args);
+    // Emit idle status for newly started printer (no job yet)
+    emit_printer_idle(&pool->printers[index].printer);
+}
+
+int printer_pool_start_printer(printer_pool_t* pool, int printer_id, const printer_thread_args_t* shared_args) {
+    int index = prepare_slot(pool, printer_id, shared_args);
+    if (index < 0) {
+        return 0;
+    }
     
-    if (result == 0) {
-        pool->printers[index].active = 1;
-        pool->active_count++;
-        
-        // Emit idle status for newly started printer (no job yet)
-        emit_printer_idle(&pool->printers[index].printer);
-        
+    // Hand the printer to a parked worker (a new thread only while the worker pool is cold)
+    if (pool->workers == NULL) {
+        return 0;
+    }
+    pool->printers[index].worker = worker_pool_run(pool->workers, printer_thread_func, &pool->printers[index].args);
+    if (pool->printers[index].worker != NULL) {
+        mark_active(pool, index);
         return 1;
     }
     
     return 0;
 }
 
+int printer_pool_add_printer(printer_pool_t* pool, int printer_id, const printer_thread_args_t* shared_args) {
+    int index = prepare_slot(pool, printer_id, shared_args);
+    if (index < 0) {
+        return 0;
+    }
+    mark_active(pool, index);
+    return 1;
+}
+
+void printer_pool_stop_printer(printer_pool_t* pool, int printer_id) {
+    int index = printer_id - 1;
+    if (index < 0 || index >= pool->capacity) {
+        return;
+    }
+    // Claim the worker, so printer_pool_join_all does not wait for it too
+    pthread_mutex_lock(&pool->pool_mutex);
+    worker_t* worker = pool->printers[index].worker;
+    pool->printers[index].worker = NULL;
+    pthread_mutex_unlock(&pool->pool_mutex);
+    if (worker == NULL) {
+        return; // no thread, or already joined
+    }
+    printer_thread_args_t* args = &pool->printers[index].args;
+
+    // Wake the printer wherever it waits: for a job (shared queue or own deque) or for paper
+    pthread_mutex_lock(args->job_queue_mutex);
+    atomic_store(&args->retire, TRUE);
+    pthread_cond_broadcast(args->job_queue_not_empty_cv);
+    pthread_mutex_unlock(args->job_queue_mutex);
+    job_dispatcher_wake_all(args->dispatcher);
+    pthread_mutex_lock(args->paper_refill_queue_mutex);
+    pthread_cond_broadcast(args->refill_needed_cv);
+    pthread_mutex_unlock(args->paper_refill_queue_mutex);
+
+    worker_wait(pool->workers, worker);
+}
+
 void printer_pool_join_all(printer_pool_t* pool) {
-    for (int i = 0; i < CONFIG_RANGE_CONSUMER_COUNT_MAX; i++) {
-        if (pool->printers[i].active) {
-            pthread_join(pool->printers[i].thread, NULL);
-            if (g_debug) printf("Joined printer %d thread\n", i + 1);
+    pthread_mutex_lock(&pool->pool_mutex);
+    for (int i = 0; i < pool->capacity; i++) {
+        worker_t* worker = pool->printers[i].worker;
+        if (worker == NULL) {
+            continue;
         }
+        pool->printers[i].worker = NULL;
+        pthread_mutex_unlock(&pool->pool_mutex); // the autoscaler may still scale while we wait
+        worker_wait(pool->workers, worker);
+        if (g_debug) printf("Joined printer %d thread\n", i + 1);
+        pthread_mutex_lock(&pool->pool_mutex);
+        i = -1; // a printer started meanwhile may sit in a slot already passed: rescan
     }
+    pthread_mutex_unlock(&pool->pool_mutex);
 }
 
 void printer_pool_destroy(printer_pool_t* pool) {
     pthread_mutex_destroy(&pool->pool_mutex);
+    free(pool->printers);
+    pool->printers = NULL;
+    pool->capacity = 0;
 }
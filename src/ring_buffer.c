@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include "common.h"
+#include "ring_buffer.h"
+
+int ring_buffer_init(ring_buffer_t* rb, size_t capacity) {
+    if (rb == NULL || capacity == 0) {
+        return FALSE;
+    }
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    rb->slots = (ring_slot_t*) malloc(size * sizeof(ring_slot_t));
+    if (rb->slots == NULL) {
+        return FALSE; // Memory allocation failure
+    }
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&rb->slots[i].sequence, i);
+        rb->slots[i].data = NULL;
+    }
+    rb->capacity = size;
+    rb->mask = size - 1;
+    atomic_init(&rb->enqueue_pos, 0);
+    atomic_init(&rb->dequeue_pos, 0);
+    return TRUE;
+}
+
+void ring_buffer_destroy(ring_buffer_t* rb) {
+    if (rb == NULL) {
+        return;
+    }
+    free(rb->slots);
+    rb->slots = NULL;
+    rb->capacity = 0;
+    rb->mask = 0;
+}
+
+int ring_buffer_push(ring_buffer_t* rb, void* data) {
+    size_t pos = atomic_load_explicit(&rb->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        ring_slot_t* slot = &rb->slots[pos & rb->mask];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        long diff = (long)seq - (long)pos;
+        if (diff == 0) {
+            // Slot is free for this lap; try to claim the ticket
+            if (atomic_compare_exchange_weak_explicit(&rb->enqueue_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                slot->data = data;
+                atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+                return TRUE;
+            }
+            // CAS failure reloaded pos; retry
+        } else if (diff < 0) {
+            return FALSE; // Ring is full
+        } else {
+            pos = atomic_load_explicit(&rb->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+void* ring_buffer_pop(ring_buffer_t* rb) {
+    size_t pos = atomic_load_explicit(&rb->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        ring_slot_t* slot = &rb->slots[pos & rb->mask];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        long diff = (long)seq - (long)(pos + 1);
+        if (diff == 0) {
+            // Slot holds data for this lap; try to claim the ticket
+            if (atomic_compare_exchange_weak_explicit(&rb->dequeue_pos, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                void* data = slot->data;
+                // Hand the slot back to producers for the next lap
+                atomic_store_explicit(&slot->sequence, pos + rb->mask + 1, memory_order_release);
+                return data;
+            }
+        } else if (diff < 0) {
+            return NULL; // Ring is empty
+        } else {
+            pos = atomic_load_explicit(&rb->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+int ring_buffer_length(ring_buffer_t* rb) {
+    size_t tail = atomic_load_explicit(&rb->dequeue_pos, memory_order_acquire);
+    size_t head = atomic_load_explicit(&rb->enqueue_pos, memory_order_acquire);
+    if (head <= tail) {
+        return 0;
+    }
+    size_t length = head - tail;
+    return (int)(length > rb->capacity ? rb->capacity : length);
+}
+
+void* ring_buffer_peek_at(ring_buffer_t* rb, int offset) {
+    if (offset < 0) {
+        return NULL;
+    }
+    size_t pos = atomic_load_explicit(&rb->dequeue_pos, memory_order_acquire) + (size_t)offset;
+    ring_slot_t* slot = &rb->slots[pos & rb->mask];
+    size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (seq != pos + 1) {
+        return NULL; // Slot not yet published (or offset past the back)
+    }
+    return slot->data;
+}
@@ -1,8 +1,11 @@
 // Mongoose-based websocket server that drives the print simulation.
 // Websocket endpoint accepts text frames: "start", "stop", "status".
+// Each client controls one session (simulation); clients connecting with the
+// same ?session=<key> share it, the others get one of their own.
 
 #include <pthread.h>
 #include <signal.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,39 +13,65 @@
 
 #include "common.h"
 #include "config.h"
+#include "timeutils.h"
 #include "mongoose.h"
 #include "preprocessing.h"
 #include "linked_list.h"
 #include "timed_queue.h"
 #include "job_receiver.h"
+#include "job_dispatcher.h"
 #include "paper_refiller.h"
 #include "printer.h"
 #include "autoscaling.h"
 #include "websocket_handler.h"
 #include "ws_bridge.h"
+#include "ws_batch.h"
+#include "ws_outbox.h"
+#include "ws_stats.h"
+#include "ws_deflate.h"
+#include "ring_buffer.h"
 #include "log_router.h"
 #include "simulation_stats.h"
 #include "signalcatcher.h"
+#include "worker_pool.h"
 
 // Default listen address and websocket paths
 static const char *s_listen_on = "http://127.0.0.1:8000";
 static const char *s_ws_path_primary = "/ws/simulation";
 static const char *s_web_root = "./tests";
 
-// Mongoose manager and active websocket tracking
+// Mongoose manager and websocket subscriber tracking
 static struct mg_mgr g_mgr; // used for mg_wakeup
-static pthread_mutex_t g_ws_mutex = PTHREAD_MUTEX_INITIALIZER;
-static unsigned long g_ws_conn_id = 0; // 0 means none
+static unsigned long g_doorbell_conn_id = 0; // the listener: wakeups go to it, set before any thread starts
+
+// Outbound state of one subscriber: the session it watches, its protocol, its
+// queue of shared messages and, for protocol 2, the batch of messages that the
+// event loop sends as one frame. Event loop thread only.
+typedef struct ws_client {
+	struct mg_connection* conn;
+	struct simulation_context* session; // the simulation this client watches and controls
+	int protocol; // WS_PROTOCOL_*
+	ws_batch_t batch;
+	ring_buffer_t queue; // ws_message_t* references waiting for room in conn's send buffer
+	ws_message_t* pending_stats; // newest stats snapshot (a ws_stats_t) not yet sent, or NULL
+	ws_stats_encoder_t stats_encoder; // what this client was last sent, for delta frames
+	ws_deflate_t* deflate; // permessage-deflate state, NULL if not negotiated
+	unsigned long lossy_seen; // lossy messages offered while over the threshold
+	unsigned long lossy_skipped;
+} ws_client_t;
+
+// Subscriber registry: every open websocket, in connection order
+static ws_client_t g_clients[CONFIG_WS_MAX_CLIENTS];
+static int g_client_count = 0;
 
 extern int g_debug;
-extern int g_terminate_now;
 
 typedef struct simulation_context {
-	// Threads
+	// Threads (the roles run on g_workers)
 	printer_pool_t printer_pool;
-	pthread_t autoscaling_thread;
-	pthread_t job_receiver_thread;
-	pthread_t paper_refill_thread;
+	worker_t* autoscaling_worker;
+	worker_t* job_receiver_worker;
+	worker_t* paper_refill_worker;
 	pthread_t simulation_runner_thread; // background wrapper
 
 	// Sync primitives
@@ -53,6 +82,7 @@ typedef struct simulation_context {
 	pthread_cond_t job_queue_not_empty_cv;
 	pthread_cond_t refill_needed_cv;
 	pthread_cond_t refill_supplier_cv;
+	pthread_cond_t simulation_state_cv; // broadcast when terminate_now or all_jobs_served is set
 
 	// State
 	simulation_parameters_t params;
@@ -60,6 +90,8 @@ typedef struct simulation_context {
 	int all_jobs_arrived;
 	int all_jobs_served;
 	timed_queue_t job_queue;
+	job_dispatcher_t job_dispatcher;
+	job_dispatcher_t* dispatcher; // &job_dispatcher in the per-printer deque modes, NULL otherwise
 	linked_list_t paper_refill_queue;
 
 	// Args
@@ -68,24 +100,49 @@ typedef struct simulation_context {
 	paper_refill_thread_args_t paper_refill_args;
 
 	// Control
-	int is_running;
+	int is_running; // protected by g_server_state_mutex
+	int terminate_now; // this session's stop flag, protected by simulation_state_mutex
+	int threads_started; // the run's roles are running, protected by simulation_state_mutex
+	int stop_requested; // a "stop" ended the run (the runner reports it), protected by simulation_state_mutex
+	int workers_committed; // this run's share of g_workers, protected by g_server_state_mutex
+	int has_runner; // simulation_runner_thread is still to be joined (event loop only)
+	unsigned int random_seed; // seed of the run's job stream, drawn by start_simulation_async
+
+	// Session: one simulation and the clients watching it. Event loop thread
+	// only, except subscriber_count and outbox, which the formatter thread uses.
+	int id; // index in g_sessions, and the log_router session of the run's threads
+	int in_use;
+	char key[CONFIG_WS_SESSION_KEY_MAX]; // ?session=<key> of its clients, "" if private to one client
+	int client_count;
+	atomic_int subscriber_count; // read by producers to skip work with nobody watching
+	ws_outbox_t outbox; // messages from this session's threads, drained by the event loop
+	int stats_delta; // delta-encoded stats_update frames, chosen by "start" ("statsDelta")
 } simulation_context_t;
 
-static simulation_context_t g_ctx; // single simulation instance
+// Session pool: every simulation the server can run at once
+static simulation_context_t g_sessions[CONFIG_WS_MAX_SESSIONS];
+static simulation_parameters_t g_base_params; // defaults plus the command line, for new sessions
 static pthread_mutex_t g_server_state_mutex = PTHREAD_MUTEX_INITIALIZER;
+static worker_pool_t g_workers; // threads shared by every session's runs
+static int g_workers_committed = 0; // workers promised to running sessions, protected by g_server_state_mutex
+static unsigned int g_random_state = 1; // seeded once per process, draws each run's seed (event loop only)
 
 /**
  * @brief Initialize the simulation context with default values and synchronization primitives
  * 
  * @param ctx Pointer to the simulation context to initialize
+ * @param id Index of the context in g_sessions
+ * @return TRUE on success, FALSE if the session's outbox cannot be allocated
  */
-static void init_context(simulation_context_t* ctx) {
+static int init_context(simulation_context_t* ctx, int id) {
 	memset(ctx, 0, sizeof(*ctx));
-	ctx->params = (simulation_parameters_t)SIMULATION_DEFAULT_PARAMS_HIGH_LOAD;
+	ctx->params = g_base_params;
 	ctx->stats = (simulation_statistics_t){0};
 	ctx->all_jobs_arrived = 0;
 	ctx->all_jobs_served = 0;
 	ctx->is_running = 0;
+	ctx->id = id;
+	if (!ws_outbox_init(&ctx->outbox, CONFIG_WS_OUTBOX_CAPACITY)) return FALSE;
 
 	pthread_mutex_init(&ctx->job_queue_mutex, NULL);
 	pthread_mutex_init(&ctx->paper_refill_queue_mutex, NULL);
@@ -94,9 +151,11 @@ static void init_context(simulation_context_t* ctx) {
 	pthread_cond_init(&ctx->job_queue_not_empty_cv, NULL);
 	pthread_cond_init(&ctx->refill_needed_cv, NULL);
 	pthread_cond_init(&ctx->refill_supplier_cv, NULL);
+	clock_cond_init(&ctx->simulation_state_cv);
 
-	timed_queue_init(&ctx->job_queue);
+	timed_queue_init_intrusive(&ctx->job_queue, TIMED_QUEUE_BACKEND_LIST, 0);
 	list_init(&ctx->paper_refill_queue);
+	return TRUE;
 }
 
 /**
@@ -105,6 +164,11 @@ static void init_context(simulation_context_t* ctx) {
  * @param ctx Pointer to the simulation context to destroy
  */
 static void destroy_context(simulation_context_t* ctx) {
+	ws_outbox_destroy(&ctx->outbox);
+	simulation_stats_destroy(&ctx->stats);
+	timed_queue_destroy(&ctx->job_queue);
+	if (ctx->dispatcher != NULL) job_dispatcher_destroy(ctx->dispatcher);
+	list_destroy(&ctx->paper_refill_queue);
 	pthread_mutex_destroy(&ctx->job_queue_mutex);
 	pthread_mutex_destroy(&ctx->paper_refill_queue_mutex);
 	pthread_mutex_destroy(&ctx->stats_mutex);
@@ -112,6 +176,42 @@ static void destroy_context(simulation_context_t* ctx) {
 	pthread_cond_destroy(&ctx->job_queue_not_empty_cv);
 	pthread_cond_destroy(&ctx->refill_needed_cv);
 	pthread_cond_destroy(&ctx->refill_supplier_cv);
+	pthread_cond_destroy(&ctx->simulation_state_cv);
+}
+
+/**
+ * @brief Destroys the first count session contexts.
+ */
+static void destroy_sessions(int count) {
+	for (int i = 0; i < count; i++) {
+		destroy_context(&g_sessions[i]);
+	}
+}
+
+/**
+ * @brief Count the sessions with a simulation running. The caller holds g_server_state_mutex.
+ * 
+ * @return Number of running simulations
+ */
+static int count_running_sessions(void) {
+	int running = 0;
+	for (int i = 0; i < CONFIG_WS_MAX_SESSIONS; i++) {
+		if (g_sessions[i].is_running) running++;
+	}
+	return running;
+}
+
+/**
+ * @brief Mark a session's run as over and give its workers back to the other sessions
+ * 
+ * @param ctx Pointer to the simulation context
+ */
+static void finish_run(simulation_context_t* ctx) {
+	pthread_mutex_lock(&g_server_state_mutex);
+	ctx->is_running = 0;
+	g_workers_committed -= ctx->workers_committed;
+	ctx->workers_committed = 0;
+	pthread_mutex_unlock(&g_server_state_mutex);
 }
 
 /**
@@ -126,39 +226,78 @@ static void destroy_context(simulation_context_t* ctx) {
 static void* simulation_runner(void* arg) {
     if (g_debug) printf("Simulation runner thread started\n");
 	simulation_context_t* ctx = (simulation_context_t*)arg;
+	log_router_bind_session(ctx->id); // this run's events go to this session's clients only
+
+	// Rebuild the job queue so the backend picked on "start" takes effect
+	timed_queue_destroy(&ctx->job_queue);
+	if (!job_queue_init(&ctx->job_queue, &ctx->params)) {
+		fprintf(stderr, "Failed to initialise job queue, falling back to list backend\n");
+		timed_queue_init_intrusive(&ctx->job_queue, TIMED_QUEUE_BACKEND_LIST, 0);
+	}
+
+	// Size the per-printer statistics and the printer pool for this run; queued
+	// stats updates from a cancel after the last run still point at the old stats
+	log_router_flush();
+	pthread_mutex_lock(&ctx->stats_mutex);
+	simulation_stats_destroy(&ctx->stats);
+	int stats_ready = simulation_stats_init(&ctx->stats, ctx->params.max_consumer_count);
+	pthread_mutex_unlock(&ctx->stats_mutex);
+	if (!stats_ready || !printer_pool_init(&ctx->printer_pool, ctx->params.consumer_count,
+			ctx->params.max_consumer_count, ctx->params.printer_paper_capacity, &g_workers)) {
+		fprintf(stderr, "Failed to allocate the printer pool, simulation not started\n");
+		finish_run(ctx);
+		return NULL;
+	}
+
+	// Likewise rebuild the per-printer deques for the dispatch mode picked on "start"
+	if (ctx->dispatcher != NULL) {
+		job_dispatcher_destroy(ctx->dispatcher);
+		ctx->dispatcher = NULL;
+	}
+	if (ctx->params.dispatch_mode != JOB_DISPATCH_SHARED) {
+		if (job_dispatcher_init(&ctx->job_dispatcher, ctx->params.dispatch_mode,
+				ctx->params.max_consumer_count, job_queue_key, CONFIG_JOB_INDEX_INITIAL_CAPACITY)) {
+			ctx->dispatcher = &ctx->job_dispatcher;
+		} else {
+			fprintf(stderr, "Failed to initialise job dispatcher, falling back to the shared queue\n");
+		}
+	}
 
 	// Prepare thread args
 	job_thread_args_t job_receiver_args = {
 		.job_queue_mutex = &ctx->job_queue_mutex,
-		.stats_mutex = &ctx->stats_mutex,
 		.simulation_state_mutex = &ctx->simulation_state_mutex,
+		.simulation_state_cv = &ctx->simulation_state_cv,
 		.job_queue_not_empty_cv = &ctx->job_queue_not_empty_cv,
 		.job_queue = &ctx->job_queue,
+		.dispatcher = ctx->dispatcher,
 		.simulation_params = &ctx->params,
 		.stats = &ctx->stats,
-		.all_jobs_arrived = &ctx->all_jobs_arrived
+		.all_jobs_arrived = &ctx->all_jobs_arrived,
+		.terminate_now = &ctx->terminate_now,
+		.session_id = ctx->id,
+		.random_seed = ctx->random_seed
 	};
 	ctx->job_receiver_args = job_receiver_args;
 
-	// Initialize printer pool
-	printer_pool_init(&ctx->printer_pool, ctx->params.consumer_count, ctx->params.printer_paper_capacity);
-
 	// Shared args template for all printers
 	printer_thread_args_t shared_printer_args = {
 		.paper_refill_queue_mutex = &ctx->paper_refill_queue_mutex,
 		.job_queue_mutex = &ctx->job_queue_mutex,
-		.stats_mutex = &ctx->stats_mutex,
 		.simulation_state_mutex = &ctx->simulation_state_mutex,
+		.simulation_state_cv = &ctx->simulation_state_cv,
 		.job_queue_not_empty_cv = &ctx->job_queue_not_empty_cv,
 		.refill_needed_cv = &ctx->refill_needed_cv,
 		.refill_supplier_cv = &ctx->refill_supplier_cv,
-		.paper_refill_thread = &ctx->paper_refill_thread,
 		.job_queue = &ctx->job_queue,
+		.dispatcher = ctx->dispatcher,
 		.paper_refill_queue = &ctx->paper_refill_queue,
 		.params = &ctx->params,
 		.stats = &ctx->stats,
 		.all_jobs_served = &ctx->all_jobs_served,
 		.all_jobs_arrived = &ctx->all_jobs_arrived,
+		.terminate_now = &ctx->terminate_now,
+		.session_id = ctx->id,
 		.printer = NULL // Will be set by printer_pool_start_printer
 	};
 
@@ -166,128 +305,234 @@ static void* simulation_runner(void* arg) {
 	autoscaling_thread_args_t autoscaling_args = {
 		.pool = &ctx->printer_pool,
 		.job_queue_mutex = &ctx->job_queue_mutex,
-		.stats_mutex = &ctx->stats_mutex,
+		.paper_refill_queue_mutex = &ctx->paper_refill_queue_mutex,
 		.simulation_state_mutex = &ctx->simulation_state_mutex,
+		.simulation_state_cv = &ctx->simulation_state_cv,
 		.job_queue_not_empty_cv = &ctx->job_queue_not_empty_cv,
 		.refill_needed_cv = &ctx->refill_needed_cv,
 		.refill_supplier_cv = &ctx->refill_supplier_cv,
-		.paper_refill_thread = &ctx->paper_refill_thread,
 		.job_queue = &ctx->job_queue,
+		.dispatcher = ctx->dispatcher,
 		.paper_refill_queue = &ctx->paper_refill_queue,
 		.params = &ctx->params,
 		.stats = &ctx->stats,
 		.all_jobs_served = &ctx->all_jobs_served,
-		.all_jobs_arrived = &ctx->all_jobs_arrived
+		.all_jobs_arrived = &ctx->all_jobs_arrived,
+		.terminate_now = &ctx->terminate_now,
+		.session_id = ctx->id
 	};
 	ctx->autoscaling_args = autoscaling_args;
 
 	// Paper refiller thread args
 	paper_refill_thread_args_t paper_refill_args = {
 		.paper_refill_queue_mutex = &ctx->paper_refill_queue_mutex,
-		.stats_mutex = &ctx->stats_mutex,
 		.simulation_state_mutex = &ctx->simulation_state_mutex,
+		.simulation_state_cv = &ctx->simulation_state_cv,
 		.refill_needed_cv = &ctx->refill_needed_cv,
 		.refill_supplier_cv = &ctx->refill_supplier_cv,
 		.paper_refill_queue = &ctx->paper_refill_queue,
 		.job_queue = &ctx->job_queue,
+		.dispatcher = ctx->dispatcher,
 		.params = &ctx->params,
 		.stats = &ctx->stats,
-		.all_jobs_served = &ctx->all_jobs_served
+		.all_jobs_served = &ctx->all_jobs_served,
+		.terminate_now = &ctx->terminate_now,
+		.session_id = ctx->id
 	};
 	ctx->paper_refill_args = paper_refill_args;
 
+	// Threads sleep on the scaled clock; logged times stay in simulated units. The
+	// clock is shared by every session, so only a run with no other session running
+	// may rescale it; otherwise it runs at the current scale (and reports that one).
+	pthread_mutex_lock(&g_server_state_mutex);
+	if (count_running_sessions() == 1) {
+		clock_set_time_scale(ctx->params.time_scale);
+	} else {
+		ctx->params.time_scale = clock_get_time_scale();
+	}
+	pthread_mutex_unlock(&g_server_state_mutex);
+
 	// Start of simulation logging
 	emit_simulation_parameters(&ctx->params);
 	emit_simulation_start(&ctx->stats);
 
-	// Create threads
-	pthread_create(&ctx->job_receiver_thread, NULL, job_receiver_thread_func, &ctx->job_receiver_args);
-	pthread_create(&ctx->paper_refill_thread, NULL, paper_refill_thread_func, &ctx->paper_refill_args);
+	// Park a worker for every role up front, so scaling up never waits for a new thread;
+	// the workers of earlier runs are reused. start_simulation_async has committed them
+	// to this run, so a failure here is a thread that could not be created.
+	if (!worker_pool_reserve(&g_workers, ctx->params.max_consumer_count + 3)) {
+		fprintf(stderr, "Failed to start worker threads, some printers may not start\n");
+	}
+
+	// Start the roles; from here on "stop" wakes them
+	pthread_mutex_lock(&ctx->simulation_state_mutex);
+	ctx->job_receiver_worker = worker_pool_run(&g_workers, job_receiver_thread_func, &ctx->job_receiver_args);
+	ctx->paper_refill_worker = worker_pool_run(&g_workers, paper_refill_thread_func, &ctx->paper_refill_args);
+	if (ctx->job_receiver_worker == NULL || ctx->paper_refill_worker == NULL) {
+		// End the run at once: the printers find no jobs coming and exit
+		fprintf(stderr, "Failed to start the simulation threads, stopping the run\n");
+		ctx->terminate_now = 1;
+		ctx->all_jobs_arrived = 1;
+	}
+	ctx->threads_started = 1;
+	pthread_mutex_unlock(&ctx->simulation_state_mutex);
 
 	// Start initial printers
+	int printers_started = 0;
 	for (int i = 1; i <= ctx->params.consumer_count; i++) {
-		printer_pool_start_printer(&ctx->printer_pool, i, &shared_printer_args);
+		printers_started += printer_pool_start_printer(&ctx->printer_pool, i, &shared_printer_args);
+	}
+	if (printers_started == 0) {
+		// Only printers set all_jobs_served: without one the run would never end
+		fprintf(stderr, "Failed to start any printer, stopping the run\n");
+		pthread_mutex_lock(&ctx->simulation_state_mutex);
+		ctx->terminate_now = 1;
+		ctx->all_jobs_arrived = 1;
+		pthread_cond_broadcast(&ctx->simulation_state_cv);
+		pthread_mutex_unlock(&ctx->simulation_state_mutex);
+		pthread_mutex_lock(&ctx->paper_refill_queue_mutex);
+		pthread_cond_broadcast(&ctx->refill_needed_cv);
+		pthread_mutex_unlock(&ctx->paper_refill_queue_mutex);
 	}
 
 	// Autoscaling thread (if enabled)
+	ctx->autoscaling_worker = NULL;
 	if (ctx->params.auto_scaling) {
-		pthread_create(&ctx->autoscaling_thread, NULL, autoscaling_thread_func, &ctx->autoscaling_args);
+		ctx->autoscaling_worker = worker_pool_run(&g_workers, autoscaling_thread_func, &ctx->autoscaling_args);
 		if (g_debug) printf("Autoscaling enabled\n");
 	}
 
-	// Join threads
-	pthread_join(ctx->job_receiver_thread, NULL);
+	// Wait for the roles; their workers park for the next run
+	if (ctx->job_receiver_worker != NULL) worker_wait(&g_workers, ctx->job_receiver_worker);
 	if (g_debug) printf("job_receiver_thread joined\n");
 
 	printer_pool_join_all(&ctx->printer_pool);
 	if (g_debug) printf("all printer threads joined\n");
 
-	pthread_join(ctx->paper_refill_thread, NULL);
+	if (ctx->paper_refill_worker != NULL) worker_wait(&g_workers, ctx->paper_refill_worker);
 	if (g_debug) printf("paper_refill_thread joined\n");
 
-	if (ctx->params.auto_scaling) {
-		pthread_join(ctx->autoscaling_thread, NULL);
+	if (ctx->autoscaling_worker != NULL) {
+		worker_wait(&g_workers, ctx->autoscaling_worker);
 		if (g_debug) printf("autoscaling_thread joined\n");
 	}
 
-	// Final logging
+	pthread_mutex_lock(&ctx->simulation_state_mutex);
+	ctx->threads_started = 0;
+	int stop_requested = ctx->stop_requested;
+	pthread_mutex_unlock(&ctx->simulation_state_mutex);
+
+	printer_pool_destroy(&ctx->printer_pool);
+
+	// Final logging. A stop is reported here rather than by the event loop,
+	// which must never wait on the formatter (see request_stop_simulation)
+	if (stop_requested) {
+		pthread_mutex_lock(&ctx->stats_mutex);
+		emit_simulation_stopped(&ctx->stats);
+		pthread_mutex_unlock(&ctx->stats_mutex);
+	}
 	emit_simulation_end(&ctx->stats);
 	emit_statistics(&ctx->stats);
 
 	// Clear stats for next run
-	ctx->stats = (simulation_statistics_t){0};
+	pthread_mutex_lock(&ctx->stats_mutex);
+	simulation_stats_destroy(&ctx->stats);
+	pthread_mutex_unlock(&ctx->stats_mutex);
 
-	pthread_mutex_lock(&g_server_state_mutex);
-	ctx->is_running = 0;
-	pthread_mutex_unlock(&g_server_state_mutex);
+	finish_run(ctx);
     if (g_debug) printf("Simulation runner thread finished\n");
 	return NULL;
 }
 
+/**
+ * @brief Check whether a session's simulation is running
+ * 
+ * @param ctx Pointer to the simulation context
+ * @return TRUE if a run has been started and its runner has not finished
+ */
+static int is_session_running(simulation_context_t* ctx) {
+	pthread_mutex_lock(&g_server_state_mutex);
+	int running = ctx->is_running;
+	pthread_mutex_unlock(&g_server_state_mutex);
+	return running;
+}
+
 /**
  * @brief Start the simulation asynchronously in a background thread
  * 
- * Checks if simulation is already running and creates a new simulation_runner thread if not.
+ * Reaps the session's previous runner, resets the run flags and creates a new
+ * simulation_runner thread. Event loop thread only. The run is refused unless
+ * g_workers can still host all of its roles (max_consumer_count + 3) next to
+ * the runs of the other sessions.
  * 
- * @param ctx Pointer to the simulation context
+ * @param ctx Pointer to the simulation context, not running
+ * @return TRUE if the run was started
  */
-static void start_simulation_async(simulation_context_t* ctx) {
+static int start_simulation_async(simulation_context_t* ctx) {
 	pthread_mutex_lock(&g_server_state_mutex);
-	if (ctx->is_running) {
+	int workers = ctx->params.max_consumer_count + 3;
+	if (ctx->is_running || g_workers_committed + workers > CONFIG_WORKER_POOL_MAX_THREADS) {
 		pthread_mutex_unlock(&g_server_state_mutex);
-		return;
+		return FALSE;
 	}
 	ctx->is_running = 1;
+	ctx->workers_committed = workers;
+	g_workers_committed += workers;
 	pthread_mutex_unlock(&g_server_state_mutex);
-	pthread_create(&ctx->simulation_runner_thread, NULL, simulation_runner, ctx);
+
+	// The previous runner has cleared is_running, so it is about to return
+	if (ctx->has_runner) {
+		pthread_join(ctx->simulation_runner_thread, NULL);
+		ctx->has_runner = FALSE;
+	}
+	pthread_mutex_lock(&ctx->simulation_state_mutex);
+	ctx->all_jobs_arrived = 0;
+	ctx->all_jobs_served = 0;
+	ctx->terminate_now = 0;
+	ctx->stop_requested = 0;
+	pthread_mutex_unlock(&ctx->simulation_state_mutex);
+	// Successive runs draw different jobs, as they would from one process-wide stream
+	ctx->random_seed = (unsigned int)rand_r(&g_random_state);
+
+	if (pthread_create(&ctx->simulation_runner_thread, NULL, simulation_runner, ctx) != 0) {
+		finish_run(ctx);
+		return FALSE;
+	}
+	ctx->has_runner = TRUE;
+	return TRUE;
 }
 
 /**
- * @brief Request graceful termination of the running simulation
+ * @brief Request graceful termination of a session's running simulation
  * 
- * Sets termination flags, cancels threads, empties the job queue, and broadcasts
- * condition variables to wake up waiting threads.
+ * Sets the session's termination flags, wakes its sleeping threads, empties its job
+ * queue, and broadcasts its condition variables to wake up waiting threads.
+ * Other sessions keep running. Does nothing if the session's threads are not
+ * running: a run still starting sees the flags and ends at once.
+ *
+ * Runs on the event loop, so it only emits events that are queued: the
+ * simulation_stopped message, which flushes the formatter, is left to the runner.
+ * A flush here could wait on a formatter that waits on this loop to drain an outbox.
  * 
  * @param ctx Pointer to the simulation context
  */
 static void request_stop_simulation(simulation_context_t* ctx) {
+	log_router_bind_session(ctx->id);
+
 	// Emulate signal catcher logic to stop simulation gracefully
 	pthread_mutex_lock(&ctx->simulation_state_mutex);
-	g_terminate_now = 1;
+	ctx->terminate_now = 1;
 	ctx->all_jobs_arrived = 1;
+	int threads_started = ctx->threads_started;
+	if (threads_started) ctx->stop_requested = 1;
+	pthread_cond_broadcast(&ctx->simulation_state_cv); // cut the receiver's and the refiller's sleeps short
 	pthread_mutex_unlock(&ctx->simulation_state_mutex);
-
-	pthread_mutex_lock(&ctx->stats_mutex);
-	emit_simulation_stopped(&ctx->stats);
-	pthread_mutex_unlock(&ctx->stats_mutex);
-
-    pthread_cancel(ctx->job_receiver_thread);
-    pthread_cancel(ctx->paper_refill_thread);
+	if (!threads_started) return;
 
 	// Lock in defined order and empty queue
 	pthread_mutex_lock(&ctx->job_queue_mutex);
 	pthread_mutex_lock(&ctx->stats_mutex);
 	empty_queue_if_terminating(&ctx->job_queue, &ctx->stats);
+	empty_dispatcher_if_terminating(ctx->dispatcher, &ctx->stats);
 	pthread_cond_broadcast(&ctx->job_queue_not_empty_cv);
 	pthread_mutex_unlock(&ctx->stats_mutex);
 	pthread_mutex_unlock(&ctx->job_queue_mutex);
@@ -299,7 +544,372 @@ static void request_stop_simulation(simulation_context_t* ctx) {
     pthread_mutex_unlock(&ctx->paper_refill_queue_mutex);
 }
 
+/**
+ * @brief Cancel a job that is still waiting in the job queue
+ * 
+ * Looks the job up through the job id index, removes it, and accounts for it
+ * the same way as jobs removed on termination. Jobs already at a printer
+ * cannot be cancelled.
+ * 
+ * @param ctx Pointer to the simulation context
+ * @param job_id Id of the job to cancel
+ * @return TRUE if the job was queued and has been cancelled, FALSE otherwise
+ */
+static int request_cancel_job(simulation_context_t* ctx, int job_id) {
+	log_router_bind_session(ctx->id);
+
+	// Lock in defined order
+	pthread_mutex_lock(&ctx->job_queue_mutex);
+	pthread_mutex_lock(&ctx->stats_mutex);
+
+	list_node_t* node = ctx->dispatcher != NULL
+		? job_dispatcher_remove_by_id(ctx->dispatcher, job_id)
+		: timed_queue_remove_by_id(&ctx->job_queue, job_id);
+	if (node != NULL) {
+		job_t* job = list_entry(node, job_t, node);
+		job->queue_departure_time_us = get_time_in_us();
+
+		simulation_stats_record_queue_area(&ctx->stats, job_backlog_area_us(&ctx->job_queue, ctx->dispatcher));
+		simulation_stats_count_removed(&ctx->stats);
+
+		emit_removed_job(job);
+		if (ctx->dispatcher == NULL) emit_jobs_update(&ctx->job_queue);
+		emit_stats_update(&ctx->stats, job_backlog_length(&ctx->job_queue, ctx->dispatcher));
+		free(job);
+	}
+
+	pthread_mutex_unlock(&ctx->stats_mutex);
+	pthread_mutex_unlock(&ctx->job_queue_mutex);
+	return node != NULL;
+}
+
 // Mongoose event handler
+/**
+ * @brief Find the subscriber of a websocket connection.
+ * 
+ * @param c The Mongoose connection
+ * @return The subscriber, or NULL if c is not a registered websocket
+ */
+static ws_client_t* find_client(struct mg_connection* c) {
+	for (int i = 0; i < g_client_count; i++) {
+		if (g_clients[i].conn == c) return &g_clients[i];
+	}
+	return NULL;
+}
+
+/**
+ * @brief Find a permessage-deflate offer the server accepts in an upgrade request.
+ * 
+ * @param hm The upgrade request
+ * @param window_bits Receives the deflate window to use
+ * @param no_context_takeover Receives TRUE if the client asked for server_no_context_takeover
+ * @return TRUE if compression is enabled and the client offered it
+ */
+static int accept_deflate_offer(struct mg_http_message* hm, int* window_bits, int* no_context_takeover) {
+	struct mg_str* offer = mg_http_get_header(hm, "Sec-WebSocket-Extensions");
+	if (!CONFIG_WS_DEFLATE_ENABLED || offer == NULL) return FALSE;
+	*window_bits = CONFIG_WS_DEFLATE_WINDOW_BITS;
+	return ws_deflate_parse_offer(offer->buf, offer->len, window_bits, no_context_takeover);
+}
+
+/**
+ * @brief Find the session a client asked for, or claim a free one for it.
+ * A session is free once its last client has gone and its simulation has
+ * ended; it then starts over from the server's parameters.
+ * 
+ * @param key Session key from the upgrade request, "" for a private session
+ * @return The session, or NULL if every session is taken
+ */
+static simulation_context_t* acquire_session(const char* key) {
+	simulation_context_t* free_session = NULL;
+	for (int i = 0; i < CONFIG_WS_MAX_SESSIONS; i++) {
+		simulation_context_t* session = &g_sessions[i];
+		if (key[0] != '\0' && session->in_use && strcmp(session->key, key) == 0) return session;
+		if (free_session == NULL && (!session->in_use
+				|| (session->client_count == 0 && !is_session_running(session)))) {
+			free_session = session;
+		}
+	}
+	if (free_session == NULL) return NULL;
+
+	if (free_session->has_runner) {
+		pthread_join(free_session->simulation_runner_thread, NULL);
+		free_session->has_runner = FALSE;
+	}
+	free_session->in_use = TRUE;
+	snprintf(free_session->key, sizeof(free_session->key), "%s", key);
+	free_session->params = g_base_params;
+	free_session->stats_delta = FALSE;
+	return free_session;
+}
+
+/**
+ * @brief Register a newly opened websocket in the session named by its
+ * ?session=<key> query parameter, or in a session of its own. It speaks
+ * protocol 1 until it says "hello", compressed if its upgrade request offered
+ * permessage-deflate.
+ * 
+ * @param c The Mongoose connection
+ * @param hm The upgrade request
+ * @return NULL on success, otherwise the reason the client was refused
+ */
+static const char* add_client(struct mg_connection* c, struct mg_http_message* hm) {
+	if (g_client_count >= CONFIG_WS_MAX_CLIENTS) return "too many clients";
+	char key[CONFIG_WS_SESSION_KEY_MAX];
+	if (mg_http_get_var(&hm->query, "session", key, sizeof(key)) < 0) key[0] = '\0';
+	simulation_context_t* session = acquire_session(key);
+	if (session == NULL) return "too many sessions";
+
+	ws_client_t* client = &g_clients[g_client_count];
+	*client = (ws_client_t){.conn = c, .session = session, .protocol = WS_PROTOCOL_SINGLE};
+	ws_stats_encoder_reset(&client->stats_encoder);
+	if (!ws_batch_init(&client->batch, CONFIG_WS_BATCH_MAX_BYTES, CONFIG_WS_BATCH_WINDOW_MS * 1000UL)) return "out of memory";
+	if (!ring_buffer_init(&client->queue, CONFIG_WS_CLIENT_QUEUE_LIMIT)) {
+		ws_batch_destroy(&client->batch);
+		return "out of memory";
+	}
+	int window_bits, no_context_takeover;
+	if (accept_deflate_offer(hm, &window_bits, &no_context_takeover)) {
+		client->deflate = malloc(sizeof(ws_deflate_t));
+		if (client->deflate == NULL || !ws_deflate_init(client->deflate, CONFIG_WS_DEFLATE_LEVEL, window_bits,
+				CONFIG_WS_DEFLATE_MEM_LEVEL, no_context_takeover)) {
+			free(client->deflate);
+			ring_buffer_destroy(&client->queue);
+			ws_batch_destroy(&client->batch);
+			return "out of memory";
+		}
+	}
+	g_client_count++;
+
+	// The session's events are formatted while anyone watches it
+	if (session->client_count++ == 0) {
+		ws_outbox_clear(&session->outbox); // anything left over had nobody to go to
+		atomic_store(&session->subscriber_count, 1);
+		log_router_set_session_subscribed(session->id, TRUE);
+	} else {
+		atomic_store(&session->subscriber_count, session->client_count);
+	}
+	return NULL;
+}
+
+/**
+ * @brief Unregister a closing websocket and release the messages it still held.
+ * 
+ * @param c The Mongoose connection
+ */
+static void remove_client(struct mg_connection* c) {
+	ws_client_t* client = find_client(c);
+	if (client == NULL) return;
+	ws_message_t* message;
+	while ((message = (ws_message_t*)ring_buffer_pop(&client->queue)) != NULL) {
+		ws_message_release(message);
+	}
+	ws_message_release(client->pending_stats);
+	ring_buffer_destroy(&client->queue);
+	ws_batch_destroy(&client->batch);
+	if (client->deflate != NULL) {
+		ws_deflate_destroy(client->deflate);
+		free(client->deflate);
+	}
+	simulation_context_t* session = client->session;
+	*client = g_clients[--g_client_count]; // keep the registry dense
+
+	// With nobody left to watch or stop it, the session's run is stopped and its events skipped
+	atomic_store(&session->subscriber_count, --session->client_count);
+	if (session->client_count == 0) {
+		log_router_set_session_subscribed(session->id, FALSE);
+		if (is_session_running(session)) request_stop_simulation(session);
+	}
+}
+
+/**
+ * @brief Send one text frame to a client, compressed if it negotiated
+ * permessage-deflate and the message is long enough to gain from it.
+ * 
+ * @param client The subscriber
+ * @param data The message
+ * @param len The length of the message
+ */
+static void send_text(ws_client_t* client, const char* data, size_t len) {
+	if (client->deflate == NULL || len < CONFIG_WS_DEFLATE_MIN_BYTES) {
+		mg_ws_send(client->conn, data, len, WEBSOCKET_OP_TEXT);
+		return;
+	}
+	size_t compressed_len;
+	const unsigned char* compressed = ws_deflate_compress(client->deflate, data, len, &compressed_len);
+	if (compressed == NULL) {
+		// The client's inflater can no longer follow the stream
+		fprintf(stderr, "Error: Websocket compression failed, closing connection %lu\n", client->conn->id);
+		client->conn->is_draining = 1;
+		return;
+	}
+	mg_ws_send(client->conn, compressed, compressed_len, WEBSOCKET_OP_TEXT | WS_DEFLATE_RSV1);
+}
+
+/**
+ * @brief Send a client's batch if it is due, or right away if forced.
+ * Event loop thread only: the frame goes straight to the connection.
+ * 
+ * @param client The subscriber
+ * @param force TRUE to send a non-empty batch regardless of its window
+ */
+static void flush_batch(ws_client_t* client, int force) {
+	if (ws_batch_is_empty(&client->batch)
+			|| !(force || ws_batch_is_due(&client->batch, get_unscaled_time_in_us()))) return;
+	size_t len;
+	const char* frame = ws_batch_frame(&client->batch, &len);
+	send_text(client, frame, len);
+	ws_batch_clear(&client->batch);
+}
+
+/**
+ * @brief Hand one JSON message to a client in its protocol: a frame of its own,
+ * or appended to the batch (sent at once if that fills it).
+ * 
+ * @param client The subscriber
+ * @param json The JSON message
+ * @param len The length of the message
+ */
+static void deliver_json(ws_client_t* client, const char* json, size_t len) {
+	if (client->protocol == WS_PROTOCOL_SINGLE) {
+		send_text(client, json, len);
+		return;
+	}
+	ws_batch_append(&client->batch, json, len, get_unscaled_time_in_us());
+	if (ws_batch_is_full(&client->batch)) flush_batch(client, TRUE);
+}
+
+/**
+ * @brief Hand one shared message to a client (see deliver_json).
+ * 
+ * @param client The subscriber
+ * @param message The message to deliver
+ */
+static void deliver_message(ws_client_t* client, const ws_message_t* message) {
+	deliver_json(client, message->data, message->len);
+}
+
+/**
+ * @brief Encode a stats snapshot for one client, full or as a delta against
+ * what it was last sent, and deliver it. A delta with no change sends nothing.
+ * 
+ * @param client The subscriber
+ * @param message The stats snapshot (a ws_stats_t)
+ */
+static void deliver_stats(ws_client_t* client, const ws_message_t* message) {
+	char frame[WS_STATS_FRAME_MAX];
+	size_t len = ws_stats_encode(&client->stats_encoder, (const ws_stats_t*)message->data,
+		client->session->stats_delta, frame, sizeof(frame));
+	if (len > 0) deliver_json(client, frame, len);
+}
+
+/**
+ * @brief Give a shared message to one client: delivered at once if the client
+ * is keeping up, otherwise queued by reference. Over the lossy threshold, a
+ * client keeps only one in CONFIG_WS_CLIENT_LOSSY_KEEP_EVERY lossy messages; a
+ * client whose queue is full even so is too slow to follow and is disconnected.
+ * 
+ * @param client The subscriber
+ * @param message The message (the client takes its own reference if it queues it)
+ */
+static void enqueue_message(ws_client_t* client, ws_message_t* message) {
+	if (ring_buffer_length(&client->queue) == 0 && client->conn->send.len <= CONFIG_WS_SEND_HIGH_WATER_BYTES) {
+		deliver_message(client, message);
+		return;
+	}
+	if (message->lossy && ring_buffer_length(&client->queue) >= CONFIG_WS_CLIENT_LOSSY_THRESHOLD
+			&& client->lossy_seen++ % CONFIG_WS_CLIENT_LOSSY_KEEP_EVERY != 0) {
+		client->lossy_skipped++;
+		return;
+	}
+	if (!ring_buffer_push(&client->queue, ws_message_retain(message))) {
+		ws_message_release(message);
+		if (!client->conn->is_closing) {
+			fprintf(stderr, "Closing websocket %lu: %d messages behind\n",
+				client->conn->id, ring_buffer_length(&client->queue));
+			client->conn->is_closing = 1;
+		}
+	}
+}
+
+/**
+ * @brief Move a client's queued messages into its send buffer while that
+ * buffer is under CONFIG_WS_SEND_HIGH_WATER_BYTES, then its stats_update once
+ * the queue is empty, then its batch if due.
+ * 
+ * @param client The subscriber
+ * @param force_batch TRUE to send a non-empty batch regardless of its window
+ */
+static void flush_client(ws_client_t* client, int force_batch) {
+	struct mg_connection* c = client->conn;
+	ws_message_t* message;
+	while (c->send.len <= CONFIG_WS_SEND_HIGH_WATER_BYTES
+			&& (message = (ws_message_t*)ring_buffer_pop(&client->queue)) != NULL) {
+		deliver_message(client, message);
+		ws_message_release(message);
+	}
+	// A slow client gets events first; its stats wait (and coalesce) until it catches up
+	if (client->pending_stats != NULL && ring_buffer_length(&client->queue) == 0
+			&& c->send.len <= CONFIG_WS_SEND_HIGH_WATER_BYTES) {
+		deliver_stats(client, client->pending_stats);
+		ws_message_release(client->pending_stats);
+		client->pending_stats = NULL;
+	}
+	flush_batch(client, force_batch);
+}
+
+/**
+ * @brief Fan each session's outbox out to the clients of that session: each
+ * message, serialized once by the formatter, is shared by reference among
+ * their queues. Event loop thread only; runs after every poll.
+ * 
+ * @param force_batch TRUE to send non-empty batches regardless of their window
+ */
+static void drain_outbox(int force_batch) {
+	for (int s = 0; s < CONFIG_WS_MAX_SESSIONS; s++) {
+		simulation_context_t* session = &g_sessions[s];
+		ws_outbox_answer_doorbell(&session->outbox);
+
+		ws_message_t* message;
+		while ((message = ws_outbox_pop(&session->outbox)) != NULL) {
+			for (int i = 0; i < g_client_count; i++) {
+				if (g_clients[i].session == session) enqueue_message(&g_clients[i], message);
+			}
+			ws_message_release(message); // the ring's reference
+		}
+		if ((message = ws_outbox_take_stats(&session->outbox)) != NULL) {
+			for (int i = 0; i < g_client_count; i++) {
+				if (g_clients[i].session != session) continue;
+				ws_message_release(g_clients[i].pending_stats); // superseded
+				g_clients[i].pending_stats = ws_message_retain(message);
+			}
+			ws_message_release(message);
+		}
+	}
+	for (int i = 0; i < g_client_count; i++) {
+		flush_client(&g_clients[i], force_batch);
+	}
+}
+
+/**
+ * @brief How long the event loop may block in mg_mgr_poll: until the first
+ * pending batch is due, or the regular poll interval when nothing is batched.
+ * New messages ring the doorbell and end the poll early, and a client draining
+ * its send buffer does too.
+ * 
+ * @return Poll timeout in milliseconds
+ */
+static int outbox_poll_ms(void) {
+	int ms = CONFIG_WS_POLL_INTERVAL_MS;
+	for (int i = 0; i < g_client_count; i++) {
+		if (!ws_batch_is_empty(&g_clients[i].batch)) {
+			unsigned long left_ms = (ws_batch_time_left_us(&g_clients[i].batch, get_unscaled_time_in_us()) + 999) / 1000;
+			if (left_ms < (unsigned long)ms) ms = (int)left_ms;
+		}
+	}
+	return ms;
+}
+
 /**
  * @brief Mongoose event handler for HTTP and WebSocket events
  * 
@@ -321,7 +931,12 @@ static void fn(struct mg_connection *c, int ev, void *ev_data) {
 		}
 		
 		if (mg_match(hm->uri, mg_str(s_ws_path_primary), NULL)) {
-			mg_ws_upgrade(c, hm, NULL);
+			// Agree to permessage-deflate if offered; MG_EV_WS_OPEN sets up the compressor
+			char extensions[128] = "";
+			int window_bits, no_context_takeover;
+			if (accept_deflate_offer(hm, &window_bits, &no_context_takeover))
+				ws_deflate_response_header(extensions, sizeof(extensions), window_bits, no_context_takeover);
+			mg_ws_upgrade(c, hm, "%s", extensions);
 		} else if (mg_match(hm->uri, mg_str("/api/config"), NULL)) {
 			// Build config JSON from C constants
 			char json_buffer[2048];
@@ -330,6 +945,7 @@ static void fn(struct mg_connection *c, int ev, void *ev_data) {
 				"\"config\":{"
 				"\"printRate\":%g,"
 				"\"consumerCount\":%d,"
+				"\"maxConsumers\":%d,"
 				"\"autoScaling\":%s,"
 				"\"refillRate\":%g,"
 				"\"paperCapacity\":%d,"
@@ -341,6 +957,7 @@ static void fn(struct mg_connection *c, int ev, void *ev_data) {
 				"\"maxQueue\":%d,"
 				"\"minPapers\":%d,"
 				"\"maxPapers\":%d,"
+				"\"timeScale\":%g,"
 				"\"showTime\":%s,"
 				"\"showSimulationStats\":%s,"
 				"\"showLogs\":%s,"
@@ -349,18 +966,21 @@ static void fn(struct mg_connection *c, int ev, void *ev_data) {
 				"\"ranges\":{"
 				"\"printRate\":{\"min\":%g,\"max\":%g},"
 				"\"consumerCount\":{\"min\":%d,\"max\":%d},"
+				"\"maxConsumers\":{\"min\":%d,\"max\":%d},"
 				"\"refillRate\":{\"min\":%g,\"max\":%g},"
 				"\"paperCapacity\":{\"min\":%d,\"max\":%d},"
 				"\"jobArrivalTime\":{\"min\":%d,\"max\":%d},"
 				"\"minArrivalTime\":{\"min\":%d,\"max\":%d},"
 				"\"maxArrivalTime\":{\"min\":%d,\"max\":%d},"
 				"\"minPapers\":{\"min\":%d,\"max\":%d},"
-				"\"maxPapers\":{\"min\":%d,\"max\":%d}"
+				"\"maxPapers\":{\"min\":%d,\"max\":%d},"
+				"\"timeScale\":{\"min\":%g,\"max\":%g}"
 				"}"
 				"}",
 				// config values
 				CONFIG_DEFAULT_PRINT_RATE,
 				CONFIG_DEFAULT_CONSUMER_COUNT,
+				CONFIG_DEFAULT_MAX_CONSUMER_COUNT,
 				CONFIG_DEFAULT_AUTO_SCALING ? "true" : "false",
 				CONFIG_DEFAULT_REFILL_RATE,
 				CONFIG_DEFAULT_PAPER_CAPACITY,
@@ -372,6 +992,7 @@ static void fn(struct mg_connection *c, int ev, void *ev_data) {
 				CONFIG_DEFAULT_MAX_QUEUE,
 				CONFIG_DEFAULT_MIN_PAPERS,
 				CONFIG_DEFAULT_MAX_PAPERS,
+				CONFIG_DEFAULT_TIME_SCALE,
 				CONFIG_DEFAULT_SHOW_TIME ? "true" : "false",
 				CONFIG_DEFAULT_SHOW_STATS ? "true" : "false",
 				CONFIG_DEFAULT_SHOW_LOGS ? "true" : "false",
@@ -379,13 +1000,15 @@ static void fn(struct mg_connection *c, int ev, void *ev_data) {
 				// ranges
 				CONFIG_RANGE_PRINT_RATE_MIN, CONFIG_RANGE_PRINT_RATE_MAX,
 				CONFIG_RANGE_CONSUMER_COUNT_MIN, CONFIG_RANGE_CONSUMER_COUNT_MAX,
+				CONFIG_RANGE_CONSUMER_COUNT_MIN, CONFIG_RANGE_CONSUMER_COUNT_MAX,
 				CONFIG_RANGE_REFILL_RATE_MIN, CONFIG_RANGE_REFILL_RATE_MAX,
 				CONFIG_RANGE_PAPER_CAPACITY_MIN, CONFIG_RANGE_PAPER_CAPACITY_MAX,
 				CONFIG_RANGE_JOB_ARRIVAL_TIME_MIN, CONFIG_RANGE_JOB_ARRIVAL_TIME_MAX,
 				CONFIG_RANGE_MIN_ARRIVAL_TIME_MIN, CONFIG_RANGE_MIN_ARRIVAL_TIME_MAX,
 				CONFIG_RANGE_MAX_ARRIVAL_TIME_MIN, CONFIG_RANGE_MAX_ARRIVAL_TIME_MAX,
 				CONFIG_RANGE_MIN_PAPERS_MIN, CONFIG_RANGE_MIN_PAPERS_MAX,
-				CONFIG_RANGE_MAX_PAPERS_MIN, CONFIG_RANGE_MAX_PAPERS_MAX
+				CONFIG_RANGE_MAX_PAPERS_MIN, CONFIG_RANGE_MAX_PAPERS_MAX,
+				CONFIG_RANGE_TIME_SCALE_MIN, CONFIG_RANGE_TIME_SCALE_MAX
 			);
 			
 			if (len > 0 && len < (int)sizeof(json_buffer)) {
@@ -403,15 +1026,45 @@ static void fn(struct mg_connection *c, int ev, void *ev_data) {
             mg_http_serve_dir(c, ev_data, &opts);
 		}
 	} else if (ev == MG_EV_WS_OPEN) {
-		// Track the active websocket client
-		pthread_mutex_lock(&g_ws_mutex);
-		g_ws_conn_id = c->id;
-		pthread_mutex_unlock(&g_ws_mutex);
+		// Register the subscriber in its session; a session's events are formatted while anyone watches it
+		const char* refused = add_client(c, (struct mg_http_message *) ev_data);
+		if (refused != NULL) {
+			char resp[64];
+			snprintf(resp, sizeof(resp), "{\"error\":\"%s\"}", refused);
+			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+			c->is_draining = 1;
+		}
 	} else if (ev == MG_EV_WS_MSG) {
 		struct mg_ws_message *wm = (struct mg_ws_message *) ev_data;
+		ws_client_t* sender = find_client(c);
+		if (sender == NULL) return; // refused on open, closing
+
+		// Every command acts on the sender's own session
+		simulation_context_t* session = sender->session;
+
+		// A compressed command (RSV1) is only valid once permessage-deflate was agreed
+		if (wm->flags & WS_DEFLATE_RSV1) {
+			size_t len = 0;
+			const unsigned char* inflated = sender->deflate != NULL
+				? ws_deflate_inflate(sender->deflate, wm->data.buf, wm->data.len, CONFIG_WS_DEFLATE_MAX_INFLATED, &len)
+				: NULL;
+			if (inflated == NULL) {
+				const char *resp = "{\"error\":\"bad compressed message\"}";
+				mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+				c->is_draining = 1;
+				return;
+			}
+			wm->data = mg_str_n((const char *) inflated, len);
+		}
 		
 		// Parse JSON command
 		char* command = mg_json_get_str(wm->data, "$.command");
+		if (command == NULL) {
+			// Not a command; one bad frame must not take down every session's run
+			const char *resp = "{\"error\":\"unknown command\"}";
+			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+			return;
+		}
 
 		// Handle JSON commands
 		if (strcmp(command, "start") == 0) {
@@ -419,90 +1072,242 @@ static void fn(struct mg_connection *c, int ev, void *ev_data) {
 			double num_jobs = 0;
 			mg_json_get_num(wm->data, "$.config.jobCount", &num_jobs);
 
+			if (is_session_running(session)) {
+				// Parameters are read by the running threads; a second start is refused, not queued
+				const char *resp = "{\"error\":\"simulation already running\"}";
+				mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+				free(command);
+				return;
+			}
+
 			if (num_jobs > 0) {
 				// Apply config overrides
 				pthread_mutex_lock(&g_server_state_mutex);
-				g_ctx.params.num_jobs = (int)num_jobs;
+				session->params.num_jobs = (int)num_jobs;
 
 				double print_rate;
 				if (1 == mg_json_get_num(wm->data, "$.config.printRate", &print_rate))
-					g_ctx.params.printing_rate = print_rate;
+					session->params.printing_rate = print_rate;
 
 				double consumer_count;
-				if (1 == mg_json_get_num(wm->data, "$.config.consumerCount", &consumer_count))
-					g_ctx.params.consumer_count = (int)consumer_count;
+				if (1 == mg_json_get_num(wm->data, "$.config.consumerCount", &consumer_count)
+					&& consumer_count >= CONFIG_RANGE_CONSUMER_COUNT_MIN && consumer_count <= CONFIG_RANGE_CONSUMER_COUNT_MAX)
+					session->params.consumer_count = (int)consumer_count;
+
+				double max_consumers;
+				if (1 == mg_json_get_num(wm->data, "$.config.maxConsumers", &max_consumers)
+					&& max_consumers >= CONFIG_RANGE_CONSUMER_COUNT_MIN && max_consumers <= CONFIG_RANGE_CONSUMER_COUNT_MAX)
+					session->params.max_consumer_count = (int)max_consumers;
 
 				double refill_rate;
 				if (1 == mg_json_get_num(wm->data, "$.config.refillRate", &refill_rate))
-					g_ctx.params.refill_rate = refill_rate;
+					session->params.refill_rate = refill_rate;
 
 				double paper_capacity;
 				if (1 == mg_json_get_num(wm->data, "$.config.paperCapacity", &paper_capacity))
-					g_ctx.params.printer_paper_capacity = (int)paper_capacity;
+					session->params.printer_paper_capacity = (int)paper_capacity;
 
 				double job_arrival;
 				if (1 == mg_json_get_num(wm->data, "$.config.jobArrivalTime", &job_arrival))
-					g_ctx.params.job_arrival_time_us = (int)job_arrival;
+					session->params.job_arrival_time_us = (int)job_arrival;
 
 				double max_queue;
 				if (1 == mg_json_get_num(wm->data, "$.config.maxQueue", &max_queue))
-					g_ctx.params.queue_capacity = (int)max_queue;
+					session->params.queue_capacity = (int)max_queue;
 
 				double min_papers;
 				if (1 == mg_json_get_num(wm->data, "$.config.minPapers", &min_papers))
-					g_ctx.params.papers_required_lower_bound = (int)min_papers;
+					session->params.papers_required_lower_bound = (int)min_papers;
 
 				double max_papers;
 				if (1 == mg_json_get_num(wm->data, "$.config.maxPapers", &max_papers))
-					g_ctx.params.papers_required_upper_bound = (int)max_papers;
+					session->params.papers_required_upper_bound = (int)max_papers;
 
 				bool auto_scaling;
 				if (1 == mg_json_get_bool(wm->data, "$.config.autoScaling", &auto_scaling))
-					g_ctx.params.auto_scaling = (int)auto_scaling;
+					session->params.auto_scaling = (int)auto_scaling;
+
+				// Same checks as the CLI: 0..100 each and premium + bulk <= 100, a split
+				// that breaks the sum keeps the previous one
+				int premium_job_percent = session->params.premium_job_percent;
+				int bulk_job_percent = session->params.bulk_job_percent;
+				double premium_percent;
+				if (1 == mg_json_get_num(wm->data, "$.config.premiumPercent", &premium_percent)
+					&& premium_percent >= 0 && premium_percent <= 100)
+					premium_job_percent = (int)premium_percent;
+
+				double bulk_percent;
+				if (1 == mg_json_get_num(wm->data, "$.config.bulkPercent", &bulk_percent)
+					&& bulk_percent >= 0 && bulk_percent <= 100)
+					bulk_job_percent = (int)bulk_percent;
+
+				if (premium_job_percent + bulk_job_percent <= 100) {
+					session->params.premium_job_percent = premium_job_percent;
+					session->params.bulk_job_percent = bulk_job_percent;
+				}
+
+				double printer_batch;
+				if (1 == mg_json_get_num(wm->data, "$.config.printerBatch", &printer_batch)
+					&& printer_batch >= 1 && printer_batch <= CONFIG_PRINTER_BATCH_MAX)
+					session->params.printer_batch_size = (int)printer_batch;
+
+				double burst_size;
+				if (1 == mg_json_get_num(wm->data, "$.config.burstSize", &burst_size)
+					&& burst_size >= 1 && burst_size <= CONFIG_JOB_BURST_MAX)
+					session->params.job_burst_size = (int)burst_size;
+
+				double time_scale;
+				if (1 == mg_json_get_num(wm->data, "$.config.timeScale", &time_scale)
+					&& time_scale >= CONFIG_RANGE_TIME_SCALE_MIN && time_scale <= CONFIG_RANGE_TIME_SCALE_MAX)
+					session->params.time_scale = time_scale;
+
+				char* queue_backend = mg_json_get_str(wm->data, "$.config.queueBackend");
+				if (queue_backend != NULL) {
+					session->params.queue_backend = strcmp(queue_backend, "ring") == 0
+						? TIMED_QUEUE_BACKEND_RING : TIMED_QUEUE_BACKEND_LIST;
+					free(queue_backend);
+				}
+
+				char* dispatch = mg_json_get_str(wm->data, "$.config.dispatch");
+				if (dispatch != NULL) {
+					session->params.dispatch_mode = strcmp(dispatch, "roundRobin") == 0 ? JOB_DISPATCH_ROUND_ROBIN
+						: strcmp(dispatch, "shortestQueue") == 0 ? JOB_DISPATCH_SHORTEST_QUEUE
+						: JOB_DISPATCH_SHARED;
+					free(dispatch);
+				}
+				clamp_pool_size(&session->params);
 				
 				pthread_mutex_unlock(&g_server_state_mutex);
 			}
+
+			// Stats encoding is the event loop's own business: no lock needed.
+			// Every client of the session starts the new simulation with a keyframe.
+			bool stats_delta = false;
+			mg_json_get_bool(wm->data, "$.config.statsDelta", &stats_delta);
+			session->stats_delta = stats_delta ? TRUE : FALSE;
+			for (int i = 0; i < g_client_count; i++) {
+				if (g_clients[i].session == session) ws_stats_encoder_reset(&g_clients[i].stats_encoder);
+			}
 			
-			start_simulation_async(&g_ctx);
+			if (!start_simulation_async(session)) {
+				// The sessions already running hold too many of the worker threads
+				const char *resp = "{\"error\":\"not enough worker threads\"}";
+				mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+			}
 		} else if (strcmp(command, "stop") == 0) {
-			request_stop_simulation(&g_ctx);
+			if (is_session_running(session)) request_stop_simulation(session);
+		} else if (strcmp(command, "cancel") == 0) {
+			double job_id = 0;
+			char resp[128];
+			if (1 == mg_json_get_num(wm->data, "$.jobId", &job_id) && request_cancel_job(session, (int)job_id)) {
+				snprintf(resp, sizeof(resp), "{\"cancelled\":%d}", (int)job_id);
+			} else {
+				snprintf(resp, sizeof(resp), "{\"error\":\"job not in queue\"}");
+			}
+			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
+		} else if (strcmp(command, "hello") == 0) {
+			// Protocol negotiation: the client asks for a version (and optionally batch
+			// limits) and gets back what the server will use on this connection
+			double protocol = WS_PROTOCOL_SINGLE;
+			double window_ms = CONFIG_WS_BATCH_WINDOW_MS;
+			double max_bytes = CONFIG_WS_BATCH_MAX_BYTES;
+			mg_json_get_num(wm->data, "$.protocol", &protocol);
+			if (1 == mg_json_get_num(wm->data, "$.batchWindowMs", &window_ms)
+				&& (window_ms < CONFIG_RANGE_WS_BATCH_WINDOW_MS_MIN || window_ms > CONFIG_RANGE_WS_BATCH_WINDOW_MS_MAX))
+				window_ms = CONFIG_WS_BATCH_WINDOW_MS;
+			if (1 == mg_json_get_num(wm->data, "$.batchMaxBytes", &max_bytes)
+				&& (max_bytes < CONFIG_RANGE_WS_BATCH_MAX_BYTES_MIN || max_bytes > CONFIG_RANGE_WS_BATCH_MAX_BYTES_MAX))
+				max_bytes = CONFIG_WS_BATCH_MAX_BYTES;
+
+			drain_outbox(TRUE); // messages queued under the old settings go first
+			sender->protocol = protocol >= WS_PROTOCOL_LATEST ? WS_PROTOCOL_LATEST : WS_PROTOCOL_SINGLE;
+			ws_batch_configure(&sender->batch, (size_t)max_bytes, (unsigned long)window_ms * 1000UL);
+			int negotiated = sender->protocol;
+			char resp[160];
+			snprintf(resp, sizeof(resp),
+				"{\"type\":\"hello\", \"data\":{\"protocol\":%d, \"batchWindowMs\":%d, \"batchMaxBytes\":%d}}",
+				negotiated, (int)window_ms, (int)max_bytes);
+			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
 		} else if (strcmp(command, "status") == 0) {
-			pthread_mutex_lock(&g_server_state_mutex);
-			int running = g_ctx.is_running;
-			pthread_mutex_unlock(&g_server_state_mutex);
-			const char *resp = running ? "{\"status\":\"running\"}" : "{\"status\":\"idle\"}";
+			char resp[CONFIG_WS_SESSION_KEY_MAX + 96];
+			snprintf(resp, sizeof(resp), "{\"status\":\"%s\", \"session\":\"%s\", \"clients\":%d}",
+				is_session_running(session) ? "running" : "idle", session->key, session->client_count);
 			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
 		} else {
 			const char *resp = "{\"error\":\"unknown command\"}";
 			mg_ws_send(c, resp, strlen(resp), WEBSOCKET_OP_TEXT);
 		}
 	} else if (ev == MG_EV_WAKEUP) {
-		// Deliver data enqueued from other threads
-		struct mg_str *data = (struct mg_str *) ev_data;
-		if (data && data->buf && data->len > 0) {
-			mg_ws_send(c, data->buf, data->len, WEBSOCKET_OP_TEXT);
-		}
+		// Doorbell only: the outbox is drained once this poll returns
 	} else if (ev == MG_EV_CLOSE) {
-		// Clear active websocket if it is closing
-		pthread_mutex_lock(&g_ws_mutex);
-		if (g_ws_conn_id == c->id) g_ws_conn_id = 0;
-		pthread_mutex_unlock(&g_ws_mutex);
+		// Unregister a closing websocket; a session with no client left stops and skips its events
+		remove_client(c);
+	}
+}
+
+/**
+ * @brief Get the session whose event is being published (see log_router_session)
+ * 
+ * @return The session, or NULL if nobody is watching it
+ */
+static simulation_context_t* bridge_session(void) {
+	simulation_context_t* session = &g_sessions[log_router_session()];
+	return atomic_load(&session->subscriber_count) > 0 ? session : NULL;
+}
+
+/**
+ * @brief Queue a message on the session's outbox and ring the event loop's
+ * doorbell if this is the first message since it last drained
+ * 
+ * @param json The JSON data to send
+ * @param len The length of the JSON data
+ * @param lossy TRUE if slow clients may skip the message
+ */
+static void bridge_push(const char *json, size_t len, int lossy) {
+	if (json == NULL || len == 0) return;
+	simulation_context_t* session = bridge_session();
+	if (session == NULL) return;
+
+	// Only the push that finds the doorbell unrung wakes the loop (an empty
+	// wakeup), so the pipe sees one small write per drain, not a copy per message
+	if (ws_outbox_push(&session->outbox, json, len, lossy)) {
+		mg_wakeup(&g_mgr, g_doorbell_conn_id, "", 0);
 	}
 }
 
 /**
- * @brief Thread-safe enqueue of a JSON frame for websocket client
+ * @brief Thread-safe enqueue of a JSON frame for every websocket client of the session
  * 
  * @param json The JSON data to send
  * @param len The length of the JSON data
  */
 void ws_bridge_send_json_from_any_thread(const char *json, size_t len) {
-	if (json == NULL || len == 0) return;
-	pthread_mutex_lock(&g_ws_mutex);
-	unsigned long id = g_ws_conn_id;
-	pthread_mutex_unlock(&g_ws_mutex);
-	if (id != 0) {
-		mg_wakeup(&g_mgr, id, json, len);
+	bridge_push(json, len, FALSE);
+}
+
+/**
+ * @brief Thread-safe enqueue of a per-job log line for the session, which slow clients may skip
+ * 
+ * @param json The JSON data to send
+ * @param len The length of the JSON data
+ */
+void ws_bridge_send_log_from_any_thread(const char *json, size_t len) {
+	bridge_push(json, len, TRUE);
+}
+
+/**
+ * @brief Thread-safe enqueue of a stats snapshot for every websocket client of
+ * the session, replacing any snapshot of that session not yet sent
+ * 
+ * @param stats The snapshot to send
+ */
+void ws_bridge_send_stats_from_any_thread(const ws_stats_t *stats) {
+	if (stats == NULL) return;
+	simulation_context_t* session = bridge_session();
+	if (session == NULL) return;
+
+	if (ws_outbox_put_stats(&session->outbox, stats, sizeof(*stats))) {
+		mg_wakeup(&g_mgr, g_doorbell_conn_id, "", 0);
 	}
 }
 
@@ -517,15 +1322,33 @@ void ws_bridge_send_json_from_any_thread(const char *json, size_t len) {
  * @return 0 on success, 1 on failure
  */
 int main(int argc, char *argv[]) {
-	// Initialize context and process args
-	init_context(&g_ctx);
-	if (!process_args(argc, argv, &g_ctx.params)) return 1;
+	// Every session starts from the command-line parameters
+	g_base_params = (simulation_parameters_t)SIMULATION_DEFAULT_PARAMS_HIGH_LOAD;
+	if (!process_args(argc, argv, &g_base_params)) return 1;
+	if (!worker_pool_init(&g_workers, CONFIG_WORKER_POOL_MAX_THREADS)) {
+		fprintf(stderr, "Failed to allocate the worker pool\n");
+		return 1;
+	}
+	int sessions_ready = 0;
+	while (sessions_ready < CONFIG_WS_MAX_SESSIONS && init_context(&g_sessions[sessions_ready], sessions_ready)) {
+		sessions_ready++;
+	}
+	if (sessions_ready < CONFIG_WS_MAX_SESSIONS) {
+		fprintf(stderr, "Failed to allocate the WebSocket outboxes\n");
+		destroy_sessions(sessions_ready);
+		worker_pool_destroy(&g_workers);
+		return 1;
+	}
 
 	// Register websocket handler
 	websocket_handler_register();
 
 	// Server mode: send over websocket
 	set_log_mode(LOG_MODE_SERVER);
+	// Format frames on their own thread so simulation threads never wait on the bridge
+	if (!log_router_start()) {
+		fprintf(stderr, "Failed to start the log formatter thread, logging synchronously\n");
+	}
 
 	mg_mgr_init(&g_mgr); // Initialise event manager
 
@@ -533,24 +1356,33 @@ int main(int argc, char *argv[]) {
 	if (!mg_wakeup_init(&g_mgr)) {
 		fprintf(stderr, "Failed to initialise Mongoose wakeup pipe\n");
 		mg_mgr_free(&g_mgr);
-		destroy_context(&g_ctx);
+		destroy_sessions(CONFIG_WS_MAX_SESSIONS);
+		worker_pool_destroy(&g_workers);
 		return 1;
 	}
 
     // Create HTTP listener
-	if (mg_http_listen(&g_mgr, s_listen_on, fn, NULL) == NULL) {
+	struct mg_connection *listener = mg_http_listen(&g_mgr, s_listen_on, fn, NULL);
+	if (listener == NULL) {
 		fprintf(stderr, "Failed to start Mongoose at %s\n", s_listen_on);
 		mg_mgr_free(&g_mgr);
-		destroy_context(&g_ctx);
+		destroy_sessions(CONFIG_WS_MAX_SESSIONS);
+		worker_pool_destroy(&g_workers);
 		return 1;
 	}
+	g_doorbell_conn_id = listener->id; // outlives every websocket, so wakeups always land
 
 	printf("Starting WS listener on %s%s\n", s_listen_on, s_ws_path_primary);
-	for (;;) mg_mgr_poll(&g_mgr, 100); // Infinite event loop
+	for (;;) { // Infinite event loop
+		mg_mgr_poll(&g_mgr, outbox_poll_ms());
+		drain_outbox(FALSE);
+	}
 
 	// Unreachable in normal flow
+	log_router_stop();
 	mg_mgr_free(&g_mgr);
-	destroy_context(&g_ctx);
+	destroy_sessions(CONFIG_WS_MAX_SESSIONS);
+	worker_pool_destroy(&g_workers);
 	return 0;
 }
 
@@ -9,22 +9,53 @@
 #include "job_receiver.h"
 #include "linked_list.h"
 #include "timed_queue.h"
+#include "job_dispatcher.h"
 #include "signalcatcher.h"
 #include "simulation_stats.h"
 
 extern int g_debug;
-extern int g_terminate_now;
 
 void empty_queue_if_terminating(timed_queue_t* queue, simulation_statistics_t* stats) {
     while (!timed_queue_is_empty(queue)) {
-    list_node_t* curr = timed_queue_dequeue_front(queue);
-    job_t* job = (job_t*)curr->data;
+        list_node_t* curr = timed_queue_dequeue_front(queue);
+        job_t* job = list_entry(curr, job_t, node);
         job->queue_departure_time_us = get_time_in_us();
         emit_removed_job(job);
-        free(curr);
         free(job);
-        stats->total_jobs_removed++;
+        simulation_stats_count_removed(stats);
     }
+    simulation_stats_record_queue_area(stats, timed_queue_area_us(queue));
+}
+
+/**
+ * @brief Drain callback: logs and frees a job removed from a deque on termination.
+ */
+static void remove_drained_job(list_node_t* node, void* ctx) {
+    simulation_statistics_t* stats = (simulation_statistics_t*)ctx;
+    job_t* job = list_entry(node, job_t, node);
+    job->queue_departure_time_us = get_time_in_us();
+    emit_removed_job(job);
+    free(job);
+    simulation_stats_count_removed(stats);
+}
+
+void empty_dispatcher_if_terminating(job_dispatcher_t* dispatcher, simulation_statistics_t* stats) {
+    if (dispatcher == NULL) {
+        return;
+    }
+    job_dispatcher_drain(dispatcher, remove_drained_job, stats);
+    simulation_stats_record_queue_area(stats, job_dispatcher_area_us(dispatcher));
+    job_dispatcher_wake_all(dispatcher); // wake up printer threads to let them exit
+}
+
+int sig_int_take_pending(sigset_t* signal_set) {
+    sigset_t pending;
+    if (signal_set == NULL || sigpending(&pending) != 0 || !sigismember(&pending, SIGINT)) {
+        return FALSE;
+    }
+    int sig;
+    sigwait(signal_set, &sig); // returns at once: SIGINT is pending
+    return TRUE;
 }
 
 void* sig_int_catching_thread_func(void* arg) {
@@ -33,23 +64,21 @@ void* sig_int_catching_thread_func(void* arg) {
     sigwait(args->signal_set, &sig);
 
     pthread_mutex_lock(args->simulation_state_mutex);
-    g_terminate_now = 1;
+    *args->terminate_now = 1;
     *args->all_jobs_arrived = 1;
+    pthread_cond_broadcast(args->simulation_state_cv); // cut the job receiver's sleep short
     pthread_mutex_unlock(args->simulation_state_mutex);
 
     pthread_mutex_lock(args->stats_mutex);
     emit_simulation_stopped(args->stats);
     pthread_mutex_unlock(args->stats_mutex);
-    if (g_debug) printf("Canceling job receiver thread\n");
-    if (args->job_receiver_thread) pthread_cancel(*args->job_receiver_thread);
-    if (g_debug) printf("Canceling paper refill thread\n");
-    if (args->paper_refill_thread) pthread_cancel(*args->paper_refill_thread);
-    
+
     // Lock both mutexes in a defined order to prevent deadlock
     pthread_mutex_lock(args->job_queue_mutex);
     pthread_mutex_lock(args->stats_mutex);
 
     empty_queue_if_terminating(args->job_queue, args->stats); // empty job queue
+    empty_dispatcher_if_terminating(args->dispatcher, args->stats); // empty per-printer deques
     pthread_cond_broadcast(args->job_queue_not_empty_cv); // wake up printer threads to let them exit
 
     // Unlock in reverse order
@@ -1,12 +1,73 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 #include "simulation_stats.h"
+#include "common.h"
 
 
+const char statistics_csv_header[] =
+    "simulation_duration_sec,total_jobs_arrived,total_jobs_served,total_jobs_dropped,"
+    "total_jobs_removed,job_arrival_rate_per_sec,job_drop_probability,avg_inter_arrival_time_sec,"
+    "avg_system_time_sec,system_time_std_dev_sec,avg_queue_wait_time_sec,avg_queue_length,"
+    "max_queue_length,paper_refill_events,total_refill_service_time_sec,papers_refilled";
+
+// JSON sizing for write_statistics_to_buffer: fixed fields plus one object per printer
+#define STATISTICS_JSON_BASE_BYTES          2048
+#define STATISTICS_JSON_BYTES_PER_PRINTER   128
+
+// Single-writer shard updates: a relaxed load and store, never a locked read-modify-write
+#define SHARD_LOAD(field) atomic_load_explicit(&(field), memory_order_relaxed)
+#define SHARD_ADD(field, delta) \
+    atomic_store_explicit(&(field), SHARD_LOAD(field) + (delta), memory_order_relaxed)
+#define SHARD_MAX(field, value) \
+    do { if ((value) > SHARD_LOAD(field)) atomic_store_explicit(&(field), (value), memory_order_relaxed); } while (0)
+
+static const char* const job_class_names[MAX_JOB_CLASSES] = {"premium", "standard", "bulk"};
+static const printer_statistics_t empty_printer_record = {0};
+
+// The shard the calling thread writes, and the statistics it belongs to
+static _Thread_local stats_shard_t* bound_shard = NULL;
+static _Thread_local const simulation_statistics_t* bound_stats = NULL;
+
 // --- Private Helper Functions ---
+/**
+ * @brief Returns the record of a zero-based printer index, or an all-zero record if untracked.
+ * @param stats Pointer to simulation_statistics_t struct.
+ * @param printer_index Zero-based printer index.
+ * @return Pointer to the record (never NULL).
+ */
+static const printer_statistics_t* printer_record(const simulation_statistics_t* stats, int printer_index) {
+    if (stats->printers == NULL || printer_index < 0 || printer_index >= stats->printer_capacity) {
+        return &empty_printer_record;
+    }
+    return &stats->printers[printer_index];
+}
+
+/**
+ * @brief Returns the shard the calling thread updates: its bound shard, or the shared one.
+ * @param stats Pointer to simulation_statistics_t struct.
+ * @return Pointer to the shard, or NULL if stats has no shards (not initialized).
+ */
+static stats_shard_t* local_shard_of(simulation_statistics_t* stats) {
+    if (stats == NULL || stats->shards == NULL) {
+        return NULL;
+    }
+    return bound_stats == stats ? bound_shard : &stats->shards[STATS_SHARD_SHARED];
+}
+
+/**
+ * @brief Returns how many printers the reports list (at least the default pool of 2).
+ * @param stats Pointer to simulation_statistics_t struct.
+ * @return Number of printers to report.
+ */
+static int printers_to_report_of(const simulation_statistics_t* stats) {
+    return stats->max_printers_used > 0 ? stats->max_printers_used : 2;
+}
+
 /**
  * @brief Calculates the average inter-arrival time in seconds.
  * @param stats Pointer to simulation_statistics_t struct.
@@ -34,18 +95,52 @@ static double calculate_average_queue_wait_time(simulation_statistics_t* stats)
 /**
  * @brief Calculates the average service time for a specific printer in seconds.
  * @param stats Pointer to simulation_statistics_t struct.
- * @param printer_index Zero-based printer index (0 - MAX_PRINTERS-1 for printers 1 - MAX_PRINTERS).
+ * @param printer_index Zero-based printer index (printer id - 1).
  * @return Average service time in seconds.
  */
 static double calculate_average_service_time(simulation_statistics_t* stats, int printer_index) {
-    if (printer_index < 0 || printer_index >= MAX_PRINTERS) {
+    const printer_statistics_t* record = printer_record(stats, printer_index);
+    if (record->jobs_served == 0) {
         return 0.0;
     }
-    double jobs_served = stats->jobs_served_by_printer[printer_index];
+    return ((double)record->total_service_time_us / 1000000.0) / record->jobs_served;
+}
+
+/**
+ * @brief Calculates the average queue wait time of one service class in seconds.
+ * @param stats Pointer to simulation_statistics_t struct.
+ * @param class_index Service class index (JOB_CLASS_*).
+ * @return Average queue wait time in seconds.
+ */
+static double calculate_class_average_queue_wait_time(simulation_statistics_t* stats, int class_index) {
+    double jobs_served = stats->jobs_served_by_class[class_index];
     if (jobs_served == 0) {
         return 0.0;
     }
-    return ((double)stats->total_service_time_printer_us[printer_index] / 1000000.0) / jobs_served;
+    return ((double)stats->total_queue_wait_time_class_us[class_index] / 1000000.0) / jobs_served;
+}
+
+/**
+ * @brief Calculates the average system time of one service class in seconds.
+ * @param stats Pointer to simulation_statistics_t struct.
+ * @param class_index Service class index (JOB_CLASS_*).
+ * @return Average system time in seconds.
+ */
+static double calculate_class_average_system_time(simulation_statistics_t* stats, int class_index) {
+    double jobs_served = stats->jobs_served_by_class[class_index];
+    if (jobs_served == 0) {
+        return 0.0;
+    }
+    return ((double)stats->total_system_time_class_us[class_index] / 1000000.0) / jobs_served;
+}
+
+/**
+ * @brief Checks whether any job outside the default (standard) class was served.
+ * @param stats Pointer to simulation_statistics_t struct.
+ * @return 1 if more than one class saw traffic, 0 otherwise.
+ */
+static int has_multiple_classes(simulation_statistics_t* stats) {
+    return stats->jobs_served_by_class[0] + stats->jobs_served_by_class[MAX_JOB_CLASSES - 1] > 0;
 }
 
 /**
@@ -81,17 +176,14 @@ static double calculate_system_time_std_dev(simulation_statistics_t* stats) {
 /**
  * @brief Calculates the system utilization for a specific printer.
  * @param stats Pointer to simulation_statistics_t struct.
- * @param printer_index Zero-based printer index (0 - MAX_PRINTERS-1 for printers 1 - MAX_PRINTERS).
+ * @param printer_index Zero-based printer index (printer id - 1).
  * @return Utilization (a value between 0 and 1).
  */
 static double calculate_system_utilization(simulation_statistics_t* stats, int printer_index) {
-    if (printer_index < 0 || printer_index >= MAX_PRINTERS) {
-        return 0.0;
-    }
     if (stats->simulation_duration_us == 0) {
         return 0.0;
     }
-    return ((double)stats->total_service_time_printer_us[printer_index]) / stats->simulation_duration_us;
+    return ((double)printer_record(stats, printer_index)->total_service_time_us) / stats->simulation_duration_us;
 }
 
 /**
@@ -122,8 +214,186 @@ static double calculate_job_drop_probability(simulation_statistics_t* stats) {
 
 
 // --- Public API Function Implementations ---
+int simulation_stats_init(simulation_statistics_t* stats, int printer_capacity) {
+    if (stats == NULL || printer_capacity < 0) return FALSE;
+    *stats = (simulation_statistics_t){0};
+
+    // Shards and records are cache-line aligned, so their sizes are multiples of the alignment
+    int shard_count = STATS_SHARD_PRINTERS + printer_capacity;
+    stats->shards = aligned_alloc(CONFIG_CACHE_LINE_SIZE, sizeof(stats_shard_t) * shard_count);
+    if (stats->shards == NULL) return FALSE;
+    memset(stats->shards, 0, sizeof(stats_shard_t) * shard_count);
+    stats->shard_count = shard_count;
+    if (printer_capacity == 0) return TRUE;
+
+    stats->printers = aligned_alloc(CONFIG_CACHE_LINE_SIZE, sizeof(printer_statistics_t) * printer_capacity);
+    if (stats->printers == NULL) {
+        free(stats->shards);
+        *stats = (simulation_statistics_t){0};
+        return FALSE;
+    }
+    memset(stats->printers, 0, sizeof(printer_statistics_t) * printer_capacity);
+    stats->printer_capacity = printer_capacity;
+    return TRUE;
+}
+
+void simulation_stats_destroy(simulation_statistics_t* stats) {
+    if (stats == NULL) return;
+    free(stats->printers);
+    free(stats->shards);
+    *stats = (simulation_statistics_t){0};
+}
+
+int simulation_stats_bind_shard(simulation_statistics_t* stats, int shard_index) {
+    if (stats == NULL || stats->shards == NULL || shard_index <= STATS_SHARD_SHARED
+        || shard_index >= stats->shard_count) {
+        return FALSE;
+    }
+    bound_shard = &stats->shards[shard_index];
+    bound_stats = stats;
+    return TRUE;
+}
+
+void simulation_stats_snapshot(const simulation_statistics_t* stats, simulation_statistics_t* snapshot) {
+    *snapshot = *stats;
+    snapshot->shards = NULL;
+    snapshot->shard_count = 0;
+
+    for (int i = 0; i < stats->shard_count; i++) {
+        stats_shard_t* shard = &stats->shards[i];
+        snapshot->total_jobs_arrived += SHARD_LOAD(shard->jobs_arrived);
+        snapshot->total_jobs_served += SHARD_LOAD(shard->jobs_served);
+        snapshot->total_jobs_dropped += SHARD_LOAD(shard->jobs_dropped);
+        snapshot->total_jobs_removed += SHARD_LOAD(shard->jobs_removed);
+        snapshot->total_inter_arrival_time_us += SHARD_LOAD(shard->inter_arrival_time_us);
+        snapshot->total_system_time_us += SHARD_LOAD(shard->system_time_us);
+        snapshot->sum_of_system_time_squared_us2 += SHARD_LOAD(shard->system_time_squared_us2);
+        snapshot->total_queue_wait_time_us += SHARD_LOAD(shard->queue_wait_time_us);
+        // The queue area only grows, so the largest value any thread saw is the latest
+        unsigned long queue_area_us = SHARD_LOAD(shard->queue_area_us);
+        if (queue_area_us > snapshot->area_num_in_job_queue_us) snapshot->area_num_in_job_queue_us = queue_area_us;
+        unsigned int max_queue_length = SHARD_LOAD(shard->max_queue_length);
+        if (max_queue_length > snapshot->max_job_queue_length) snapshot->max_job_queue_length = max_queue_length;
+        int max_printer_id = SHARD_LOAD(shard->max_printer_id);
+        if (max_printer_id > snapshot->max_printers_used) snapshot->max_printers_used = max_printer_id;
+        for (int c = 0; c < MAX_JOB_CLASSES; c++) {
+            snapshot->jobs_served_by_class[c] += SHARD_LOAD(shard->jobs_served_by_class[c]);
+            snapshot->total_queue_wait_time_class_us[c] += SHARD_LOAD(shard->queue_wait_time_class_us[c]);
+            snapshot->total_system_time_class_us[c] += SHARD_LOAD(shard->system_time_class_us[c]);
+        }
+        snapshot->paper_refill_events += SHARD_LOAD(shard->paper_refill_events);
+        snapshot->total_refill_service_time_us += SHARD_LOAD(shard->refill_service_time_us);
+        snapshot->papers_refilled += SHARD_LOAD(shard->papers_refilled);
+    }
+}
+
+void simulation_stats_count_arrival(simulation_statistics_t* stats, unsigned long inter_arrival_time_us) {
+    stats_shard_t* shard = local_shard_of(stats);
+    if (shard == NULL) return;
+    SHARD_ADD(shard->jobs_arrived, 1);
+    SHARD_ADD(shard->inter_arrival_time_us, inter_arrival_time_us);
+}
+
+void simulation_stats_count_dropped(simulation_statistics_t* stats) {
+    stats_shard_t* shard = local_shard_of(stats);
+    if (shard == NULL) return;
+    SHARD_ADD(shard->jobs_dropped, 1);
+}
+
+void simulation_stats_count_removed(simulation_statistics_t* stats) {
+    stats_shard_t* shard = local_shard_of(stats);
+    if (shard == NULL) return;
+    SHARD_ADD(shard->jobs_removed, 1);
+}
+
+void simulation_stats_count_departure(simulation_statistics_t* stats, int service_class,
+    unsigned long queue_wait_time_us, unsigned long system_time_us) {
+    stats_shard_t* shard = local_shard_of(stats);
+    if (shard == NULL) return;
+    SHARD_ADD(shard->jobs_served, 1);
+    SHARD_ADD(shard->system_time_us, system_time_us);
+    SHARD_ADD(shard->system_time_squared_us2, (double)system_time_us * system_time_us);
+    SHARD_ADD(shard->queue_wait_time_us, queue_wait_time_us);
+
+    // Track per service class (0-indexed by JOB_CLASS_*)
+    if (service_class >= 0 && service_class < MAX_JOB_CLASSES) {
+        SHARD_ADD(shard->jobs_served_by_class[service_class], 1);
+        SHARD_ADD(shard->queue_wait_time_class_us[service_class], queue_wait_time_us);
+        SHARD_ADD(shard->system_time_class_us[service_class], system_time_us);
+    }
+}
+
+void simulation_stats_count_printed(simulation_statistics_t* stats, int printer_id,
+    int papers, unsigned long service_time_us) {
+    printer_statistics_t* record = simulation_stats_printer(stats, printer_id);
+    stats_shard_t* shard = local_shard_of(stats);
+    if (record == NULL || shard == NULL) return;
+    SHARD_ADD(record->jobs_served, 1);
+    SHARD_ADD(record->paper_used, papers);
+    SHARD_ADD(record->total_service_time_us, service_time_us);
+    SHARD_MAX(shard->max_printer_id, printer_id);
+}
+
+void simulation_stats_count_paper_empty(simulation_statistics_t* stats, int printer_id,
+    unsigned long paper_empty_time_us) {
+    printer_statistics_t* record = simulation_stats_printer(stats, printer_id);
+    if (record == NULL) return;
+    SHARD_ADD(record->paper_empty_time_us, paper_empty_time_us);
+}
+
+void simulation_stats_count_refill(simulation_statistics_t* stats, int papers, unsigned long refill_time_us) {
+    stats_shard_t* shard = local_shard_of(stats);
+    if (shard == NULL) return;
+    SHARD_ADD(shard->paper_refill_events, 1);
+    SHARD_ADD(shard->refill_service_time_us, refill_time_us);
+    SHARD_ADD(shard->papers_refilled, papers);
+}
+
+void simulation_stats_record_queue_area(simulation_statistics_t* stats, unsigned long queue_area_us) {
+    stats_shard_t* shard = local_shard_of(stats);
+    if (shard == NULL) return;
+    SHARD_MAX(shard->queue_area_us, queue_area_us);
+}
+
+void simulation_stats_record_queue_length(simulation_statistics_t* stats, unsigned int queue_length) {
+    stats_shard_t* shard = local_shard_of(stats);
+    if (shard == NULL) return;
+    SHARD_MAX(shard->max_queue_length, queue_length);
+}
+
+printer_statistics_t* simulation_stats_printer(simulation_statistics_t* stats, int printer_id) {
+    if (stats == NULL || stats->printers == NULL || printer_id < 1 || printer_id > stats->printer_capacity) {
+        return NULL;
+    }
+    return &stats->printers[printer_id - 1];
+}
+
+int statistics_buffer_size(const simulation_statistics_t* stats) {
+    if (stats == NULL) return STATISTICS_JSON_BASE_BYTES;
+    simulation_statistics_t snapshot;
+    simulation_stats_snapshot(stats, &snapshot);
+    int printer_count = printers_to_report_of(&snapshot);
+    return STATISTICS_JSON_BASE_BYTES + printer_count * STATISTICS_JSON_BYTES_PER_PRINTER;
+}
+
 int write_statistics_to_buffer(simulation_statistics_t* stats, char* buf, int buf_size) {
     if (stats == NULL || buf == NULL || buf_size <= 0) return -1;
+    int offset = snprintf(buf, buf_size, "{\"type\":\"statistics\", \"data\":");
+    if (offset >= buf_size) return -1;
+    int written = write_statistics_data_to_buffer(stats, buf + offset, buf_size - offset);
+    if (written < 0) return -1;
+    offset += written;
+    offset += snprintf(buf + offset, buf_size - offset, "}");
+    return offset < buf_size ? offset : -1;
+}
+
+int write_statistics_data_to_buffer(simulation_statistics_t* stats, char* buf, int buf_size) {
+    if (stats == NULL || buf == NULL || buf_size <= 0) return -1;
+
+    // Report the shards merged with the base fields
+    simulation_statistics_t snapshot;
+    simulation_stats_snapshot(stats, &snapshot);
+    stats = &snapshot;
 
     // Calculate derived statistics
     double avg_inter_arrival_time = calculate_average_inter_arrival_time(stats);
@@ -137,7 +407,7 @@ int write_statistics_to_buffer(simulation_statistics_t* stats, char* buf, int bu
     
     // Start building JSON
     int offset = snprintf(buf, buf_size,
-        "{\"type\":\"statistics\", \"data\":{"
+        "{"
         "\"simulation_duration_sec\":%.3g,"
         "\"total_jobs_arrived\":%.0f,"
         "\"total_jobs_served\":%.0f,"
@@ -167,40 +437,93 @@ int write_statistics_to_buffer(simulation_statistics_t* stats, char* buf, int bu
     );
     
     // Add dynamic printer statistics array
+    if (offset >= buf_size) return -1;
     offset += snprintf(buf + offset, buf_size - offset, "\"printers\":[");
     
-    int printers_to_report = stats->max_printers_used > 0 ? stats->max_printers_used : 2;
+    int printers_to_report = printers_to_report_of(stats);
     for (int i = 0; i < printers_to_report; i++) {
         double avg_service_time = calculate_average_service_time(stats, i);
         double utilization = calculate_system_utilization(stats, i);
-        
+        if (offset >= buf_size) return -1; // see statistics_buffer_size
+
         offset += snprintf(buf + offset, buf_size - offset,
             "{\"id\":%d,\"jobs_served\":%.0f,\"paper_used\":%d,"
             "\"avg_service_time_sec\":%.3g,\"utilization\":%.3g}%s",
             i + 1,
-            stats->jobs_served_by_printer[i],
-            stats->printer_paper_used[i],
+            printer_record(stats, i)->jobs_served,
+            printer_record(stats, i)->paper_used,
             avg_service_time,
             utilization,
             (i < printers_to_report - 1) ? "," : ""
         );
     }
     
-    // Close printers array and add paper refill stats
+    // Add per-class statistics array
+    offset += snprintf(buf + offset, buf_size - offset, "],\"classes\":[");
+    for (int i = 0; i < MAX_JOB_CLASSES; i++) {
+        if (offset >= buf_size) return -1;
+        offset += snprintf(buf + offset, buf_size - offset,
+            "{\"class\":\"%s\",\"jobs_served\":%.0f,"
+            "\"avg_queue_wait_time_sec\":%.3g,\"avg_system_time_sec\":%.3g}%s",
+            job_class_names[i],
+            stats->jobs_served_by_class[i],
+            calculate_class_average_queue_wait_time(stats, i),
+            calculate_class_average_system_time(stats, i),
+            (i < MAX_JOB_CLASSES - 1) ? "," : ""
+        );
+    }
+
+    // Close classes array and add paper refill stats
+    if (offset >= buf_size) return -1;
     offset += snprintf(buf + offset, buf_size - offset,
         "],\"paper_refill_events\":%.0f,"
         "\"total_refill_service_time_sec\":%.3g,"
-        "\"papers_refilled\":%d}}",
+        "\"papers_refilled\":%d}",
         stats->paper_refill_events,
         stats->total_refill_service_time_us / 1000000.0,
         stats->papers_refilled
     );
 
-    return offset;
+    return offset < buf_size ? offset : -1;
+}
+
+int write_statistics_csv_row(simulation_statistics_t* stats, char* buf, int buf_size) {
+    if (stats == NULL || buf == NULL || buf_size <= 0) return -1;
+
+    simulation_statistics_t snapshot;
+    simulation_stats_snapshot(stats, &snapshot);
+    stats = &snapshot;
+
+    // Same metrics and order as the scalar fields of write_statistics_data_to_buffer
+    int offset = snprintf(buf, buf_size,
+        "%.6g,%.0f,%.0f,%.0f,%.0f,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%u,%.0f,%.6g,%d",
+        stats->simulation_duration_us / 1000000.0,
+        stats->total_jobs_arrived,
+        stats->total_jobs_served,
+        stats->total_jobs_dropped,
+        stats->total_jobs_removed,
+        calculate_job_arrival_rate(stats),
+        calculate_job_drop_probability(stats),
+        calculate_average_inter_arrival_time(stats),
+        calculate_average_system_time(stats),
+        calculate_system_time_std_dev(stats),
+        calculate_average_queue_wait_time(stats),
+        calculate_average_queue_length(stats),
+        stats->max_job_queue_length,
+        stats->paper_refill_events,
+        stats->total_refill_service_time_us / 1000000.0,
+        stats->papers_refilled
+    );
+    return offset < buf_size ? offset : -1;
 }
 
 void log_statistics(simulation_statistics_t* stats) {
     if (stats == NULL) return;
+
+    // Report the shards merged with the base fields
+    simulation_statistics_t snapshot;
+    simulation_stats_snapshot(stats, &snapshot);
+    stats = &snapshot;
     
     // Calculate derived statistics (same calculations as publish_statistics)
     double avg_inter_arrival_time = calculate_average_inter_arrival_time(stats);
@@ -240,11 +563,11 @@ void log_statistics(simulation_statistics_t* stats) {
     printf("--- Printer Statistics ---\n");
     
     // Dynamically report on printers that were actually used
-    int printers_to_report = stats->max_printers_used > 0 ? stats->max_printers_used : 2;
+    int printers_to_report = printers_to_report_of(stats);
     for (int i = 0; i < printers_to_report; i++) {
         int printer_id = i + 1;
-        double jobs_served = stats->jobs_served_by_printer[i];
-        int paper_used = stats->printer_paper_used[i];
+        double jobs_served = printer_record(stats, i)->jobs_served;
+        int paper_used = printer_record(stats, i)->paper_used;
         double avg_service_time = calculate_average_service_time(stats, i);
         double utilization = calculate_system_utilization(stats, i);
         
@@ -255,6 +578,21 @@ void log_statistics(simulation_statistics_t* stats) {
         if (i < printers_to_report - 1) printf("\n");
     }
     
+    if (has_multiple_classes(stats)) {
+        printf("\n");
+        printf("--- Service Class Statistics ---\n");
+        char label[64];
+        for (int i = 0; i < MAX_JOB_CLASSES; i++) {
+            snprintf(label, sizeof(label), "Jobs Served (%s):", job_class_names[i]);
+            printf("%-35s%.0f\n", label, stats->jobs_served_by_class[i]);
+            snprintf(label, sizeof(label), "Avg Queue Wait (%s):", job_class_names[i]);
+            printf("%-35s%.3g sec\n", label, calculate_class_average_queue_wait_time(stats, i));
+            snprintf(label, sizeof(label), "Avg System Time (%s):", job_class_names[i]);
+            printf("%-35s%.3g sec\n", label, calculate_class_average_system_time(stats, i));
+            if (i < MAX_JOB_CLASSES - 1) printf("\n");
+        }
+    }
+
     printf("\n");
     printf("--- Paper Management ---\n");
     printf("Paper Refill Events:               %.0f\n", stats->paper_refill_events);
@@ -276,8 +614,8 @@ int calculate_total_papers_used(simulation_statistics_t* stats) {
     if (stats == NULL) return 0;
     
     int total = 0;
-    for (int i = 0; i < stats->max_printers_used && i < MAX_PRINTERS; i++) {
-        total += stats->printer_paper_used[i];
+    for (int i = 0; i < stats->max_printers_used; i++) {
+        total += printer_record(stats, i)->paper_used;
     }
     return total;
 }
@@ -288,8 +626,8 @@ double calculate_overall_average_service_time(simulation_statistics_t* stats) {
     }
     
     unsigned long total_service_time = 0;
-    for (int i = 0; i < stats->max_printers_used && i < MAX_PRINTERS; i++) {
-        total_service_time += stats->total_service_time_printer_us[i];
+    for (int i = 0; i < stats->max_printers_used; i++) {
+        total_service_time += printer_record(stats, i)->total_service_time_us;
     }
     
     return (total_service_time / stats->total_jobs_served) / 1000000.0;
@@ -300,6 +638,9 @@ void debug_statistics(const simulation_statistics_t* stats) {
         printf("Statistics struct is NULL\n");
         return;
     }
+    simulation_statistics_t snapshot;
+    simulation_stats_snapshot(stats, &snapshot);
+    stats = &snapshot;
     
     flockfile(stdout);
     printf("\n=== RAW STATISTICS DEBUG ===\n");
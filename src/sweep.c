@@ -0,0 +1,254 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sweep.h"
+#include "common.h"
+#include "config.h"
+#include "preprocessing.h"
+#include "simulation_stats.h"
+#include "virtual_engine.h"
+
+// Longest CSV row of write_statistics_csv_row
+#define SWEEP_CSV_ROW_BYTES 512
+
+// Shared by the worker threads of one sweep_run
+typedef struct sweep_work {
+    simulation_parameters_t* params; // one per point
+    char** results;                  // one formatted result per point, filled by the workers
+    int point_count;
+    int format;
+    atomic_int next_point;
+    atomic_int failed;
+} sweep_work_t;
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Formats the statistics of a finished run as a CSV row or a JSON object.
+ *
+ * @return A malloc'd string, or NULL on failure.
+ */
+static char* format_result(simulation_statistics_t* stats, int format) {
+    int buf_size = format == SWEEP_FORMAT_JSON ? statistics_buffer_size(stats) : SWEEP_CSV_ROW_BYTES;
+    char* buf = malloc(buf_size);
+    if (buf == NULL) return NULL;
+    int written = format == SWEEP_FORMAT_JSON
+        ? write_statistics_data_to_buffer(stats, buf, buf_size)
+        : write_statistics_csv_row(stats, buf, buf_size);
+    if (written < 0) {
+        free(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+/**
+ * @brief Worker thread: runs points until none are left. Each run gets fresh
+ * statistics and restarts this thread's random stream, so its result does not
+ * depend on which worker runs it or what ran before.
+ */
+static void* sweep_worker_func(void* arg) {
+    sweep_work_t* work = (sweep_work_t*)arg;
+    int point;
+    while ((point = atomic_fetch_add(&work->next_point, 1)) < work->point_count) {
+        simulation_parameters_t* params = &work->params[point];
+        simulation_statistics_t stats;
+        if (!simulation_stats_init(&stats, params->max_consumer_count)) {
+            atomic_store(&work->failed, TRUE);
+            continue;
+        }
+        random_seed(1);
+        if (virtual_engine_simulate(params, &stats)) {
+            work->results[point] = format_result(&stats, work->format);
+        }
+        if (work->results[point] == NULL) atomic_store(&work->failed, TRUE);
+        simulation_stats_destroy(&stats);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Writes an axis value as a JSON number if it is one, as a string otherwise.
+ */
+static void write_json_value(FILE* out, const char* value) {
+    char* end;
+    strtod(value, &end);
+    if (*value != '\0' && *end == '\0') {
+        fputs(value, out);
+    } else {
+        fprintf(out, "\"%s\"", value);
+    }
+}
+
+static void write_csv(const sweep_spec_t* spec, char** results, FILE* out) {
+    const char* values[CONFIG_SWEEP_MAX_AXES];
+    for (int a = 0; a < spec->axis_count; a++) {
+        fprintf(out, "%s,", spec->axes[a].option);
+    }
+    fprintf(out, "%s\n", statistics_csv_header);
+    for (int p = 0; p < spec->point_count; p++) {
+        sweep_point_values(spec, p, values);
+        for (int a = 0; a < spec->axis_count; a++) {
+            fprintf(out, "%s,", values[a]);
+        }
+        fprintf(out, "%s\n", results[p]);
+    }
+}
+
+static void write_json(const sweep_spec_t* spec, char** results, FILE* out) {
+    const char* values[CONFIG_SWEEP_MAX_AXES];
+    fprintf(out, "[\n");
+    for (int p = 0; p < spec->point_count; p++) {
+        sweep_point_values(spec, p, values);
+        fprintf(out, "  {\"point\":{");
+        for (int a = 0; a < spec->axis_count; a++) {
+            fprintf(out, "%s\"%s\":", a > 0 ? "," : "", spec->axes[a].option);
+            write_json_value(out, values[a]);
+        }
+        fprintf(out, "},\"statistics\":%s}%s\n", results[p], p < spec->point_count - 1 ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+// --- Public API Function Implementations ---
+
+void sweep_init(sweep_spec_t* spec, int base_argc, char** base_argv) {
+    memset(spec, 0, sizeof(*spec));
+    spec->point_count = 1;
+    spec->base_argc = base_argc;
+    spec->base_argv = base_argv;
+}
+
+int sweep_add_axis(sweep_spec_t* spec, const char* axis) {
+    if (spec->axis_count >= CONFIG_SWEEP_MAX_AXES) {
+        fprintf(stderr, "Error: at most %d options can be swept.\n", CONFIG_SWEEP_MAX_AXES);
+        return FALSE;
+    }
+    const char* equals = strchr(axis, '=');
+    if (equals == NULL || equals == axis || equals[1] == '\0') {
+        fprintf(stderr, "Error: sweep axis must look like option=value1,value2,... (got %s).\n", axis);
+        return FALSE;
+    }
+
+    sweep_axis_t* a = &spec->axes[spec->axis_count];
+    a->option = strdup(axis);
+    if (a->option == NULL) return FALSE;
+    char* values = a->option + (equals - axis);
+    *values++ = '\0';
+    if (a->option[0] == '-') memmove(a->option, a->option + 1, strlen(a->option)); // "-s=..." means "s=..."
+
+    a->value_count = 0;
+    char* save = NULL;
+    for (char* value = strtok_r(values, ",", &save); value != NULL; value = strtok_r(NULL, ",", &save)) {
+        if (a->value_count == CONFIG_SWEEP_MAX_VALUES) {
+            fprintf(stderr, "Error: at most %d values per swept option.\n", CONFIG_SWEEP_MAX_VALUES);
+            free(a->option);
+            return FALSE;
+        }
+        a->values[a->value_count++] = value;
+    }
+    if (a->value_count == 0 || (long)spec->point_count * a->value_count > CONFIG_SWEEP_MAX_POINTS) {
+        fprintf(stderr, "Error: a sweep needs at least 1 and at most %d points.\n", CONFIG_SWEEP_MAX_POINTS);
+        free(a->option);
+        return FALSE;
+    }
+    spec->point_count *= a->value_count;
+    spec->axis_count++;
+    return TRUE;
+}
+
+void sweep_destroy(sweep_spec_t* spec) {
+    for (int a = 0; a < spec->axis_count; a++) {
+        free(spec->axes[a].option);
+    }
+    spec->axis_count = 0;
+    spec->point_count = 1;
+}
+
+void sweep_point_values(const sweep_spec_t* spec, int point, const char** values) {
+    for (int a = spec->axis_count - 1; a >= 0; a--) {
+        const sweep_axis_t* axis = &spec->axes[a];
+        values[a] = axis->values[point % axis->value_count];
+        point /= axis->value_count;
+    }
+}
+
+int sweep_point_params(const sweep_spec_t* spec, int point, struct simulation_parameters* params) {
+    // argv for process_args: program name, base options, then "-option value" per axis
+    char* argv[spec->base_argc + 2 * CONFIG_SWEEP_MAX_AXES];
+    char flags[CONFIG_SWEEP_MAX_AXES][64];
+    const char* values[CONFIG_SWEEP_MAX_AXES];
+    int argc = 0;
+    for (int i = 0; i < spec->base_argc; i++) {
+        argv[argc++] = spec->base_argv[i];
+    }
+    sweep_point_values(spec, point, values);
+    for (int a = 0; a < spec->axis_count; a++) {
+        snprintf(flags[a], sizeof(flags[a]), "-%s", spec->axes[a].option);
+        argv[argc++] = flags[a];
+        argv[argc++] = (char*)values[a];
+    }
+
+    *params = (simulation_parameters_t)SIMULATION_DEFAULT_PARAMS_HIGH_LOAD;
+    return process_args(argc, argv, params);
+}
+
+int sweep_run(const sweep_spec_t* spec, int worker_count, int format, FILE* out) {
+    sweep_work_t work = {
+        .point_count = spec->point_count,
+        .format = format
+    };
+    atomic_init(&work.next_point, 0);
+    atomic_init(&work.failed, FALSE);
+    work.params = malloc(sizeof(simulation_parameters_t) * spec->point_count);
+    work.results = calloc(spec->point_count, sizeof(char*));
+    if (work.params == NULL || work.results == NULL) {
+        free(work.params);
+        free(work.results);
+        return FALSE;
+    }
+
+    // Validate every point up front: a typo in the last value should not waste the whole sweep
+    int ok = TRUE;
+    for (int p = 0; p < spec->point_count && ok; p++) {
+        if (!sweep_point_params(spec, p, &work.params[p])) {
+            fprintf(stderr, "Error: sweep point %d is invalid.\n", p + 1);
+            ok = FALSE;
+        }
+    }
+
+    if (ok) {
+        if (worker_count < 1) worker_count = 1;
+        if (worker_count > CONFIG_SWEEP_MAX_WORKERS) worker_count = CONFIG_SWEEP_MAX_WORKERS;
+        if (worker_count > spec->point_count) worker_count = spec->point_count;
+        pthread_t workers[worker_count];
+        int started = 0;
+        while (started < worker_count
+                && pthread_create(&workers[started], NULL, sweep_worker_func, &work) == 0) {
+            started++;
+        }
+        if (started == 0) sweep_worker_func(&work); // no threads available: run on this one
+        for (int i = 0; i < started; i++) {
+            pthread_join(workers[i], NULL);
+        }
+        ok = !atomic_load(&work.failed);
+    }
+
+    if (ok) {
+        if (format == SWEEP_FORMAT_JSON) {
+            write_json(spec, work.results, out);
+        } else {
+            write_csv(spec, work.results, out);
+        }
+    }
+
+    for (int p = 0; p < spec->point_count; p++) {
+        free(work.results[p]);
+    }
+    free(work.results);
+    free(work.params);
+    return ok;
+}
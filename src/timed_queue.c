@@ -1,25 +1,278 @@
 #include <stdlib.h>
 #include "timed_queue.h"
 #include "linked_list.h"
+#include "ring_buffer.h"
 #include "timeutils.h"
 #include "common.h"
 
+// --- Private Helper Functions ---
+/**
+ * @brief Moves last_interaction_time_us forward to the current time and adds
+ * the state that just ended to the queue-length area.
+ * Uses a compare-and-swap loop so concurrent ring producers and consumers
+ * never move the timestamp backwards.
+ * @param tq Pointer to the TimedQueue.
+ * @param delta Change in length made by the mutation (e.g. +1 enqueue, -k batch dequeue).
+ */
+static void touch(timed_queue_t* tq, int delta) {
+    unsigned long now = get_time_in_us();
+    unsigned long last = atomic_load(&tq->last_interaction_time_us);
+    while (now > last) {
+        if (atomic_compare_exchange_weak(&tq->last_interaction_time_us, &last, now)) {
+            // The queue held (length - delta) jobs from last until now
+            tq->area_us += (now - last) * (unsigned long)(timed_queue_length(tq) - delta);
+            break;
+        }
+        // last was reloaded by the failed CAS; retry while we are still newer
+    }
+}
+
+static int is_ring(timed_queue_t* tq) {
+    return tq->backend == TIMED_QUEUE_BACKEND_RING;
+}
+
+static int is_intrusive(timed_queue_t* tq) {
+    return tq->list.intrusive;
+}
+
+/**
+ * @brief Adds a node to the id index, if the index is enabled.
+ * @return 1 on success (or no index), 0 if the index could not grow.
+ */
+static int index_add(timed_queue_t* tq, list_node_t* node) {
+    if (tq->key_of == NULL) {
+        return TRUE;
+    }
+    return hash_index_put(&tq->index, tq->key_of(node), node);
+}
+
+static void index_drop(timed_queue_t* tq, list_node_t* node) {
+    if (tq->key_of != NULL && node != NULL) {
+        hash_index_remove(&tq->index, tq->key_of(node));
+    }
+}
+
+static int has_classes(timed_queue_t* tq) {
+    return tq->class_of != NULL;
+}
+
+/**
+ * @brief Returns the (clamped) service class of a node.
+ */
+static int class_index(timed_queue_t* tq, list_node_t* node) {
+    int cls = tq->class_of(node);
+    if (cls < 0) return 0;
+    if (cls >= tq->class_count) return tq->class_count - 1;
+    return cls;
+}
+
+static void reset_classes(timed_queue_t* tq) {
+    for (int i = 0; i < TIMED_QUEUE_MAX_CLASSES; i++) {
+        tq->class_head[i] = NULL;
+        tq->class_tail[i] = NULL;
+        tq->class_length[i] = 0;
+    }
+    tq->wrr_class = 0;
+    tq->wrr_credit = tq->class_weights[0];
+}
+
+/**
+ * @brief Links a node at the back (or front) of its class segment.
+ * The list stays ordered by class, then by arrival within a class.
+ */
+static void class_insert(timed_queue_t* tq, list_node_t* node, int at_front) {
+    int cls = class_index(tq, node);
+    list_node_t* prev;
+    if (tq->class_length[cls] > 0) {
+        prev = at_front ? tq->class_head[cls]->prev : tq->class_tail[cls];
+    } else {
+        // Empty class: go after the last node of the nearest higher-priority class
+        prev = &tq->list.head;
+        for (int i = cls - 1; i >= 0; i--) {
+            if (tq->class_length[i] > 0) {
+                prev = tq->class_tail[i];
+                break;
+            }
+        }
+    }
+    list_insert_node_after(&tq->list, prev, node);
+
+    if (tq->class_length[cls] == 0 || at_front) tq->class_head[cls] = node;
+    if (tq->class_length[cls] == 0 || !at_front) tq->class_tail[cls] = node;
+    tq->class_length[cls]++;
+}
+
+/**
+ * @brief Updates the class segment bookkeeping for a node that is about to be unlinked.
+ */
+static void class_drop(timed_queue_t* tq, list_node_t* node) {
+    if (!has_classes(tq) || node == NULL) {
+        return;
+    }
+    int cls = class_index(tq, node);
+    int last_in_class = tq->class_length[cls] == 1;
+    if (tq->class_head[cls] == node) tq->class_head[cls] = last_in_class ? NULL : node->next;
+    if (tq->class_tail[cls] == node) tq->class_tail[cls] = last_in_class ? NULL : node->prev;
+    tq->class_length[cls]--;
+}
+
+/**
+ * @brief Picks the class the next dequeue_front serves, by weighted round-robin.
+ * The current class keeps being served until its credit (weight) runs out or
+ * it empties; then the next non-empty class in order gets a fresh credit.
+ * @param commit FALSE to only peek (timed_queue_first), TRUE to consume credit.
+ * @return The class index, or -1 if every class is empty.
+ */
+static int wrr_pick(timed_queue_t* tq, int commit) {
+    int picked = -1;
+    if (tq->class_length[tq->wrr_class] > 0 && tq->wrr_credit > 0) {
+        picked = tq->wrr_class;
+    } else {
+        for (int i = 1; i <= tq->class_count; i++) {
+            int cls = (tq->wrr_class + i) % tq->class_count;
+            if (tq->class_length[cls] > 0) {
+                picked = cls;
+                break;
+            }
+        }
+    }
+    if (picked < 0 || !commit) {
+        return picked;
+    }
+    if (picked != tq->wrr_class || tq->wrr_credit <= 0) {
+        tq->wrr_class = picked;
+        tq->wrr_credit = tq->class_weights[picked];
+    }
+    tq->wrr_credit--;
+    return picked;
+}
+
+/**
+ * @brief Unlinks the node dequeue_front would return, without touching the timestamp.
+ * @return The unlinked node, or NULL if the queue is empty.
+ */
+static list_node_t* take_front(timed_queue_t* tq) {
+    if (is_ring(tq)) {
+        return (list_node_t*) ring_buffer_pop(&tq->ring);
+    }
+
+    list_node_t* node;
+    if (has_classes(tq)) {
+        int cls = wrr_pick(tq, TRUE);
+        node = cls < 0 ? NULL : tq->class_head[cls];
+    } else {
+        node = list_first(&tq->list);
+    }
+    if (node != NULL) {
+        index_drop(tq, node);
+        class_drop(tq, node);
+        list_unlink(&tq->list, node);
+    }
+    return node;
+}
+
+
+// --- Public API Function Implementations ---
 int timed_queue_init(timed_queue_t* tq) {
+    return timed_queue_init_backend(tq, TIMED_QUEUE_BACKEND_LIST, 0);
+}
+
+int timed_queue_init_backend(timed_queue_t* tq, int backend, int capacity) {
     if (tq == NULL) {
         return FALSE;
     }
-    
+
+    tq->backend = backend;
+    tq->ring.slots = NULL;
+    tq->index.slots = NULL;
+    tq->key_of = NULL;
+    tq->class_of = NULL;
+    tq->class_count = 1;
+    tq->class_weights[0] = 1;
+    reset_classes(tq);
     int result = list_init(&tq->list);
+    if (result && backend == TIMED_QUEUE_BACKEND_RING) {
+        result = capacity > 0 && ring_buffer_init(&tq->ring, (size_t)capacity);
+    }
     if (result) {
-        tq->last_interaction_time_us = get_time_in_us();
+        tq->area_us = 0;
+        atomic_init(&tq->last_interaction_time_us, get_time_in_us());
     }
     return result;
 }
 
+int timed_queue_init_intrusive(timed_queue_t* tq, int backend, int capacity) {
+    if (!timed_queue_init_backend(tq, backend, capacity)) {
+        return FALSE;
+    }
+    tq->list.intrusive = TRUE;
+    return TRUE;
+}
+
+int timed_queue_enable_index(timed_queue_t* tq, int (*key_of)(const list_node_t* node), int capacity) {
+    if (tq == NULL || key_of == NULL || is_ring(tq) || tq->key_of != NULL) {
+        return FALSE;
+    }
+    int length = list_length(&tq->list);
+    if (!hash_index_init(&tq->index, (size_t)(capacity > length ? capacity : length))) {
+        return FALSE;
+    }
+    tq->key_of = key_of;
+    for (list_node_t* node = list_first(&tq->list); node != NULL; node = list_next(&tq->list, node)) {
+        if (!index_add(tq, node)) {
+            hash_index_destroy(&tq->index);
+            tq->key_of = NULL;
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+int timed_queue_enable_classes(timed_queue_t* tq, int (*class_of)(const list_node_t* node),
+                               const int* weights, int class_count) {
+    if (tq == NULL || class_of == NULL || weights == NULL || is_ring(tq) || !is_intrusive(tq)
+        || class_count < 1 || class_count > TIMED_QUEUE_MAX_CLASSES || !list_is_empty(&tq->list)) {
+        return FALSE;
+    }
+    tq->class_of = class_of;
+    tq->class_count = class_count;
+    for (int i = 0; i < class_count; i++) {
+        tq->class_weights[i] = weights[i] > 0 ? weights[i] : 1;
+    }
+    reset_classes(tq);
+    return TRUE;
+}
+
+int timed_queue_class_length(timed_queue_t* tq, int cls) {
+    if (tq == NULL || !has_classes(tq) || cls < 0 || cls >= tq->class_count) {
+        return 0;
+    }
+    return tq->class_length[cls];
+}
+
+void timed_queue_destroy(timed_queue_t* tq) {
+    if (tq == NULL) {
+        return;
+    }
+
+    timed_queue_clear(tq);
+    if (is_ring(tq)) {
+        ring_buffer_destroy(&tq->ring);
+    }
+    if (tq->key_of != NULL) {
+        hash_index_destroy(&tq->index);
+        tq->key_of = NULL;
+    }
+    list_destroy(&tq->list);
+}
+
 int timed_queue_length(timed_queue_t* tq) {
     if (tq == NULL) {
         return 0;
     }
+    if (is_ring(tq)) {
+        return ring_buffer_length(&tq->ring);
+    }
     return list_length(&tq->list);
 }
 
@@ -27,41 +280,140 @@ int timed_queue_is_empty(timed_queue_t* tq) {
     if (tq == NULL) {
         return TRUE;
     }
+    if (is_ring(tq)) {
+        return ring_buffer_length(&tq->ring) == 0;
+    }
     return list_is_empty(&tq->list);
 }
 
 int timed_queue_enqueue(timed_queue_t* tq, void* data) {
-    if (tq == NULL) {
+    if (tq == NULL || is_intrusive(tq)) {
         return FALSE;
     }
-    
-    int result = list_append(&tq->list, data);
+
+    int result;
+    if (is_ring(tq)) {
+        list_node_t* node = (list_node_t*) malloc(sizeof(list_node_t));
+        if (node == NULL) {
+            return FALSE; // Memory allocation failure
+        }
+        node->data = data;
+        node->next = NULL;
+        node->prev = NULL;
+        result = ring_buffer_push(&tq->ring, node);
+        if (!result) {
+            free(node); // Ring is full
+        }
+    } else {
+        result = list_append(&tq->list, data);
+        if (result && !index_add(tq, list_last(&tq->list))) {
+            list_release_node(&tq->list, list_pop(&tq->list));
+            result = FALSE;
+        }
+    }
     if (result) {
-        tq->last_interaction_time_us = get_time_in_us();
+        touch(tq, 1);
     }
     return result;
 }
 
 int timed_queue_enqueue_front(timed_queue_t* tq, void* data) {
-    if (tq == NULL) {
+    if (tq == NULL || is_ring(tq) || is_intrusive(tq)) {
         return FALSE;
     }
-    
+
     int result = list_append_left(&tq->list, data);
+    if (result && !index_add(tq, list_first(&tq->list))) {
+        list_release_node(&tq->list, list_pop_left(&tq->list));
+        result = FALSE;
+    }
     if (result) {
-        tq->last_interaction_time_us = get_time_in_us();
+        touch(tq, 1);
     }
     return result;
 }
 
+int timed_queue_enqueue_node(timed_queue_t* tq, list_node_t* node) {
+    if (tq == NULL || node == NULL || !is_intrusive(tq)) {
+        return FALSE;
+    }
+
+    if (is_ring(tq)) {
+        if (!ring_buffer_push(&tq->ring, node)) {
+            return FALSE; // Ring is full
+        }
+    } else {
+        if (!index_add(tq, node)) {
+            return FALSE;
+        }
+        if (has_classes(tq)) {
+            class_insert(tq, node, FALSE);
+        } else {
+            list_append_node(&tq->list, node);
+        }
+    }
+    touch(tq, 1);
+    return TRUE;
+}
+
+int timed_queue_enqueue_node_front(timed_queue_t* tq, list_node_t* node) {
+    if (tq == NULL || node == NULL || is_ring(tq) || !is_intrusive(tq)) {
+        return FALSE;
+    }
+
+    if (!index_add(tq, node)) {
+        return FALSE;
+    }
+    if (has_classes(tq)) {
+        class_insert(tq, node, TRUE);
+    } else {
+        list_append_node_left(&tq->list, node);
+    }
+    touch(tq, 1);
+    return TRUE;
+}
+
+int timed_queue_enqueue_batch(timed_queue_t* tq, list_node_t** nodes, int count) {
+    if (tq == NULL || nodes == NULL || !is_intrusive(tq)) {
+        return 0;
+    }
+
+    int enqueued = 0;
+    while (enqueued < count) {
+        list_node_t* node = nodes[enqueued];
+        if (is_ring(tq)) {
+            if (!ring_buffer_push(&tq->ring, node)) {
+                break; // Ring is full
+            }
+        } else {
+            if (!index_add(tq, node)) {
+                break;
+            }
+            if (has_classes(tq)) {
+                class_insert(tq, node, FALSE);
+            } else {
+                list_append_node(&tq->list, node);
+            }
+        }
+        enqueued++;
+    }
+    if (enqueued > 0) {
+        touch(tq, enqueued); // one state change for the whole batch
+    }
+    return enqueued;
+}
+
 list_node_t* timed_queue_dequeue(timed_queue_t* tq) {
-    if (tq == NULL) {
+    if (tq == NULL || is_ring(tq)) {
         return NULL;
     }
-    
-    list_node_t* node = list_pop(&tq->list);
+
+    list_node_t* node = list_last(&tq->list);
     if (node != NULL) {
-        tq->last_interaction_time_us = get_time_in_us();
+        index_drop(tq, node);
+        class_drop(tq, node);
+        list_unlink(&tq->list, node);
+        touch(tq, -1);
     }
     return node;
 }
@@ -70,30 +422,79 @@ list_node_t* timed_queue_dequeue_front(timed_queue_t* tq) {
     if (tq == NULL) {
         return NULL;
     }
-    
-    list_node_t* node = list_pop_left(&tq->list);
+
+    list_node_t* node = take_front(tq);
     if (node != NULL) {
-        tq->last_interaction_time_us = get_time_in_us();
+        touch(tq, -1);
     }
     return node;
 }
 
-void timed_queue_remove(timed_queue_t* tq, list_node_t* node) {
+int timed_queue_dequeue_batch(timed_queue_t* tq, list_node_t** out, int max) {
+    return timed_queue_dequeue_batch_while(tq, out, max, NULL, NULL);
+}
+
+int timed_queue_dequeue_batch_while(timed_queue_t* tq, list_node_t** out, int max,
+                                    int (*accept)(list_node_t* node, void* ctx), void* ctx) {
+    if (tq == NULL || out == NULL) {
+        return 0;
+    }
+
+    int count = 0;
+    while (count < max) {
+        list_node_t* next = timed_queue_first(tq);
+        if (next == NULL || (accept != NULL && !accept(next, ctx))) {
+            break;
+        }
+        out[count++] = take_front(tq);
+    }
+    if (count > 0) {
+        touch(tq, -count); // one state change for the whole batch
+    }
+    return count;
+}
+
+void timed_queue_release_node(timed_queue_t* tq, list_node_t* node) {
     if (tq == NULL || node == NULL) {
         return;
     }
-    
+    if (is_ring(tq)) {
+        if (!is_intrusive(tq)) {
+            free(node); // Ring nodes are allocated outside any lock
+        }
+    } else {
+        list_release_node(&tq->list, node);
+    }
+}
+
+void timed_queue_remove(timed_queue_t* tq, list_node_t* node) {
+    if (tq == NULL || node == NULL || is_ring(tq)) {
+        return;
+    }
+
+    index_drop(tq, node);
+    class_drop(tq, node);
     list_remove(&tq->list, node);
-    tq->last_interaction_time_us = get_time_in_us();
+    touch(tq, -1);
 }
 
 void timed_queue_clear(timed_queue_t* tq) {
     if (tq == NULL) {
         return;
     }
-    
-    list_clear(&tq->list);
-    tq->last_interaction_time_us = get_time_in_us();
+
+    int length_before = timed_queue_length(tq);
+    if (is_ring(tq)) {
+        list_node_t* node;
+        while ((node = (list_node_t*) ring_buffer_pop(&tq->ring)) != NULL) {
+            timed_queue_release_node(tq, node);
+        }
+    } else {
+        list_clear(&tq->list);
+        hash_index_clear(&tq->index);
+        reset_classes(tq);
+    }
+    touch(tq, -length_before);
 }
 
 list_node_t* timed_queue_first(timed_queue_t* tq) {
@@ -101,6 +502,25 @@ list_node_t* timed_queue_first(timed_queue_t* tq) {
         return NULL;
     }
     // Read-only operation - does NOT update timestamp
+    if (is_ring(tq)) {
+        return (list_node_t*) ring_buffer_peek_at(&tq->ring, 0);
+    }
+    if (has_classes(tq)) {
+        // The node dequeue_front would return next
+        int cls = wrr_pick(tq, FALSE);
+        return cls < 0 ? NULL : tq->class_head[cls];
+    }
+    return list_first(&tq->list);
+}
+
+list_node_t* timed_queue_head(timed_queue_t* tq) {
+    if (tq == NULL) {
+        return NULL;
+    }
+    // Read-only operation - does NOT update timestamp
+    if (is_ring(tq)) {
+        return (list_node_t*) ring_buffer_peek_at(&tq->ring, 0);
+    }
     return list_first(&tq->list);
 }
 
@@ -109,6 +529,9 @@ list_node_t* timed_queue_last(timed_queue_t* tq) {
         return NULL;
     }
     // Read-only operation - does NOT update timestamp
+    if (is_ring(tq)) {
+        return (list_node_t*) ring_buffer_peek_at(&tq->ring, ring_buffer_length(&tq->ring) - 1);
+    }
     return list_last(&tq->list);
 }
 
@@ -117,11 +540,75 @@ list_node_t* timed_queue_find(timed_queue_t* tq, void* data) {
         return NULL;
     }
     // Read-only operation - does NOT update timestamp
+    if (is_ring(tq)) {
+        int length = ring_buffer_length(&tq->ring);
+        for (int i = 0; i < length; i++) {
+            list_node_t* node = (list_node_t*) ring_buffer_peek_at(&tq->ring, i);
+            if (node != NULL && node->data == data) {
+                return node;
+            }
+        }
+        return NULL;
+    }
     return list_find(&tq->list, data);
 }
 
-list_node_t* timed_queue_next(timed_queue_t* tq, list_node_t* node) {
+unsigned long timed_queue_area_us(timed_queue_t* tq) {
+    if (tq == NULL) {
+        return 0;
+    }
+    // Read-only operation - does NOT update timestamp
+    return tq->area_us;
+}
+
+list_node_t* timed_queue_find_by_id(timed_queue_t* tq, int id) {
+    if (tq == NULL || tq->key_of == NULL) {
+        return NULL;
+    }
+    // Read-only operation - does NOT update timestamp
+    return (list_node_t*) hash_index_get(&tq->index, id);
+}
+
+list_node_t* timed_queue_remove_by_id(timed_queue_t* tq, int id) {
+    if (tq == NULL || tq->key_of == NULL) {
+        return NULL;
+    }
+
+    list_node_t* node = (list_node_t*) hash_index_remove(&tq->index, id);
+    if (node != NULL) {
+        class_drop(tq, node);
+        list_unlink(&tq->list, node);
+        touch(tq, -1);
+    }
+    return node;
+}
+
+int timed_queue_for_each(timed_queue_t* tq, void (*visit)(list_node_t* node, void* ctx), void* ctx) {
     if (tq == NULL) {
+        return 0;
+    }
+    // Read-only operation - does NOT update timestamp
+    int visited = 0;
+    if (is_ring(tq)) {
+        // By offset: a ring node has no link to the next one
+        int length = ring_buffer_length(&tq->ring);
+        for (int i = 0; i < length; i++) {
+            list_node_t* node = (list_node_t*) ring_buffer_peek_at(&tq->ring, i);
+            if (node == NULL) break;
+            visit(node, ctx);
+            visited++;
+        }
+        return visited;
+    }
+    for (list_node_t* node = list_first(&tq->list); node != NULL; node = list_next(&tq->list, node)) {
+        visit(node, ctx);
+        visited++;
+    }
+    return visited;
+}
+
+list_node_t* timed_queue_next(timed_queue_t* tq, list_node_t* node) {
+    if (tq == NULL || is_ring(tq)) {
         return NULL;
     }
     // Read-only operation - does NOT update timestamp
@@ -129,7 +616,7 @@ list_node_t* timed_queue_next(timed_queue_t* tq, list_node_t* node) {
 }
 
 list_node_t* timed_queue_prev(timed_queue_t* tq, list_node_t* node) {
-    if (tq == NULL) {
+    if (tq == NULL || is_ring(tq)) {
         return NULL;
     }
     // Read-only operation - does NOT update timestamp
@@ -0,0 +1,461 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "virtual_engine.h"
+#include "event_heap.h"
+#include "common.h"
+#include "config.h"
+#include "timeutils.h"
+#include "linked_list.h"
+#include "timed_queue.h"
+#include "job_receiver.h"
+#include "job_dispatcher.h"
+#include "printer.h"
+#include "paper_refiller.h"
+#include "autoscaling.h"
+#include "preprocessing.h"
+#include "log_router.h"
+#include "simulation_stats.h"
+#include "signalcatcher.h"
+
+extern int g_debug;
+
+// --- Event types ---
+#define EVENT_JOB_ARRIVAL     0 // the next burst arrives (arg unused)
+#define EVENT_PRINT_DONE      1 // a printer finishes its job (arg: printer_run_t*)
+#define EVENT_REFILL_DONE     2 // the refiller finishes a printer (arg: printer_t*)
+#define EVENT_AUTOSCALE_CHECK 3 // the autoscaler wakes up (arg unused)
+
+// What a printer thread keeps on its stack, per pool slot
+typedef struct printer_run {
+    list_node_t* claimed[CONFIG_PRINTER_BATCH_MAX];
+    int claimed_count;
+    int next_claimed; // index of the next claimed job to print
+    job_t* printing; // job being printed, NULL while idle
+    int waiting_papers; // papers needed by the job the printer waits to refill for, 0 if not waiting
+    unsigned long wait_start_time_us;
+    int index; // pool slot
+} printer_run_t;
+
+typedef struct engine {
+    virtual_engine_args_t* args;
+    event_heap_t events;
+    printer_run_t* runs; // one per pool slot
+
+    // Arguments for the shared steps; the engine is their only thread
+    job_thread_args_t receiver_args;
+    printer_thread_args_t printer_args;
+    paper_refill_thread_args_t refiller_args;
+    pthread_mutex_t job_queue_mutex; // never contended
+    pthread_cond_t job_queue_not_empty_cv; // never waited on
+
+    // Paper refiller: printers waiting for it, in order, and the one being refilled
+    linked_list_t refill_queue;
+    printer_t* refilling;
+    int refill_papers;
+    unsigned long refill_start_time_us;
+
+    int last_job_id;
+    unsigned long previous_job_arrival_time_us;
+    int all_jobs_arrived;
+    int printing_count; // printers with a job in service
+    int terminating;
+} engine_t;
+
+// --- Private Helper Functions ---
+/**
+ * @brief Schedules an event. The heap is sized for one pending event per
+ * printer and component, so this never has to grow it.
+ */
+static void schedule(engine_t* e, unsigned long time_us, int type, void* arg) {
+    if (!event_heap_push(&e->events, time_us, type, arg)) {
+        fprintf(stderr, "Error: Failed to schedule event %d\n", type);
+    }
+}
+
+static printer_thread_args_t* args_of(engine_t* e, printer_run_t* run) {
+    return &e->args->pool->printers[run->index].args;
+}
+
+static int backlog_length(engine_t* e) {
+    return job_backlog_length(e->args->job_queue, e->args->dispatcher);
+}
+
+/**
+ * @brief A printer is free when it is active, not printing and not waiting for paper.
+ */
+static int is_free(engine_t* e, printer_run_t* run) {
+    return e->args->pool->printers[run->index].active && run->printing == NULL && run->waiting_papers == 0;
+}
+
+/**
+ * @brief Starts printing the printer's next claimed job and schedules its end.
+ */
+static void print_next_claimed(engine_t* e, printer_run_t* run) {
+    job_t* job = list_entry(run->claimed[run->next_claimed++], job_t, node);
+    printer_begin_job(args_of(e, run), job);
+    run->printing = job;
+    e->printing_count++;
+    schedule(e, job->service_arrival_time_us + job->service_time_requested_ms * 1000UL, EVENT_PRINT_DONE, run);
+}
+
+/**
+ * @brief Wakes a printer that was waiting for paper once it has enough.
+ */
+static void end_paper_wait(engine_t* e, printer_t* printer) {
+    printer_run_t* run = &e->runs[printer->id - 1];
+    if (run->waiting_papers == 0 || run->waiting_papers > printer->current_paper_count) {
+        return;
+    }
+    run->waiting_papers = 0;
+    // Printer is no longer waiting for refill
+    emit_printer_idle(printer);
+    simulation_stats_count_paper_empty(e->args->stats, printer->id, get_time_in_us() - run->wait_start_time_us);
+}
+
+/**
+ * @brief Starts refilling the first printer waiting for the refiller, if it is idle.
+ * A printer that is already full is skipped, as the refiller thread does.
+ */
+static void refill_next(engine_t* e) {
+    while (e->refilling == NULL && !list_is_empty(&e->refill_queue)) {
+        unsigned long refill_start_time_us = get_time_in_us();
+        list_node_t* elem = list_pop_left(&e->refill_queue);
+        printer_t* printer = (printer_t*)elem->data;
+        list_release_node(&e->refill_queue, elem);
+
+        int time_to_refill_us = paper_refill_begin(&e->refiller_args, printer, refill_start_time_us, &e->refill_papers);
+        if (time_to_refill_us == 0) {
+            end_paper_wait(e, printer);
+            continue;
+        }
+        e->refilling = printer;
+        e->refill_start_time_us = refill_start_time_us;
+        schedule(e, refill_start_time_us + time_to_refill_us, EVENT_REFILL_DONE, printer);
+    }
+}
+
+/**
+ * @brief Queues a printer for a refill because the job it would claim next does not fit.
+ */
+static void wait_for_paper(engine_t* e, printer_run_t* run, int papers_required, int job_id) {
+    printer_t* printer = args_of(e, run)->printer;
+    run->waiting_papers = papers_required;
+    run->wait_start_time_us = get_time_in_us();
+    emit_paper_empty(printer, job_id, run->wait_start_time_us);
+    emit_printer_waiting_refill(printer);
+    list_append(&e->refill_queue, printer);
+    refill_next(e);
+}
+
+/**
+ * @brief Lets a free printer claim jobs and starts the first one, or sends it
+ * to the refiller if the job it would claim does not fit in its paper tray.
+ */
+static void claim_jobs(engine_t* e, printer_run_t* run, int may_steal) {
+    if (e->terminating || !is_free(e, run)) {
+        return;
+    }
+    int blocked_job_id, blocked_papers;
+    run->claimed_count = printer_claim_jobs(args_of(e, run), run->claimed, may_steal, &blocked_job_id, &blocked_papers);
+    run->next_claimed = 0;
+    if (run->claimed_count > 0) {
+        print_next_claimed(e, run);
+    } else if (blocked_job_id != 0) {
+        wait_for_paper(e, run, blocked_papers, blocked_job_id);
+    }
+}
+
+/**
+ * @brief Hands queued jobs to the free printers, in id order. With per-printer
+ * deques every printer first takes from its own deque, then free printers steal.
+ */
+static void assign_jobs(engine_t* e) {
+    int passes = e->args->dispatcher != NULL ? 2 : 1;
+    for (int pass = 0; pass < passes; pass++) {
+        for (int i = 0; i < e->args->pool->capacity && backlog_length(e) > 0; i++) {
+            claim_jobs(e, &e->runs[i], pass == passes - 1);
+        }
+    }
+}
+
+/**
+ * @brief Adds a printer, as scale_up does with a printer thread.
+ */
+static void scale_up_pool(engine_t* e) {
+    printer_pool_t* pool = e->args->pool;
+    int new_printer_id = pool->active_count + 1;
+    unsigned long current_time_us = get_time_in_us();
+    emit_scale_up(pool->active_count + 1, backlog_length(e), current_time_us); // +1 because this log prints before actual scaling
+    if (printer_pool_add_printer(pool, new_printer_id, &e->printer_args)) {
+        pool->last_scale_time_us = current_time_us;
+        pool->low_queue_start_time_us = 0; // Reset scale-down timer
+        // Hand the new printer its share of the queued jobs
+        job_dispatcher_rebalance(e->args->dispatcher);
+        assign_jobs(e);
+    }
+}
+
+/**
+ * @brief Removes the most recently added free printer, as scale_down does
+ * with a printer thread. A printer waiting for paper is not free, so a refill
+ * never completes for a removed printer.
+ */
+static void scale_down_pool(engine_t* e) {
+    printer_pool_t* pool = e->args->pool;
+    int printer_to_remove = -1;
+    for (int i = pool->active_count - 1; i >= pool->min_count; i--) {
+        if (is_free(e, &e->runs[i])) {
+            printer_to_remove = i;
+            break;
+        }
+    }
+    if (printer_to_remove < 0) {
+        return;
+    }
+
+    pool->printers[printer_to_remove].active = 0;
+    pool->active_count--;
+    // Move the jobs still on the stopped printer's deque to the remaining printers
+    job_dispatcher_close(e->args->dispatcher, printer_to_remove);
+    unsigned long current_time_us = get_time_in_us();
+    pool->last_scale_time_us = current_time_us;
+    pool->low_queue_start_time_us = 0; // Reset timer
+    emit_scale_down(pool->active_count, backlog_length(e), current_time_us);
+    assign_jobs(e);
+}
+
+static void on_job_arrival(engine_t* e) {
+    simulation_parameters_t* params = e->args->params;
+    job_t* burst[CONFIG_JOB_BURST_MAX];
+    int burst_count = job_receiver_create_burst(params, burst, &e->last_job_id);
+    if (burst_count > 0) {
+        job_receiver_admit_burst(&e->receiver_args, burst, burst_count, &e->previous_job_arrival_time_us);
+    }
+    if (e->last_job_id < params->num_jobs) {
+        schedule(e, get_time_in_us() + (unsigned long)params->job_arrival_time_us, EVENT_JOB_ARRIVAL, NULL);
+    } else {
+        e->all_jobs_arrived = TRUE;
+    }
+    assign_jobs(e);
+}
+
+static void on_print_done(engine_t* e, printer_run_t* run) {
+    printer_finish_job(args_of(e, run), run->printing);
+    run->printing = NULL;
+    e->printing_count--;
+
+    if (e->terminating) {
+        // Stopped mid-batch: the rest of the claimed jobs count as removed
+        while (run->next_claimed < run->claimed_count) {
+            job_t* job = list_entry(run->claimed[run->next_claimed++], job_t, node);
+            emit_removed_job(job);
+            simulation_stats_count_removed(e->args->stats);
+            free(job);
+        }
+        return;
+    }
+    if (run->next_claimed < run->claimed_count) {
+        print_next_claimed(e, run);
+    } else {
+        claim_jobs(e, run, TRUE);
+    }
+}
+
+static void on_refill_done(engine_t* e, printer_t* printer) {
+    paper_refill_finish(&e->refiller_args, printer, e->refill_papers, e->refill_start_time_us);
+    e->refilling = NULL;
+    end_paper_wait(e, printer);
+    refill_next(e);
+    claim_jobs(e, &e->runs[printer->id - 1], TRUE);
+}
+
+static void on_autoscale_check(engine_t* e) {
+    printer_pool_t* pool = e->args->pool;
+    int queue_length = backlog_length(e);
+    unsigned long current_time_us = get_time_in_us();
+    if (should_scale_up(pool, queue_length, current_time_us)) {
+        scale_up_pool(e);
+    } else if (should_scale_down(pool, queue_length, current_time_us)) {
+        scale_down_pool(e);
+    }
+    schedule(e, current_time_us + CONFIG_AUTOSCALE_CHECK_INTERVAL_US, EVENT_AUTOSCALE_CHECK, NULL);
+}
+
+/**
+ * @brief Ctrl+C: removes the queued jobs and lets only the printing jobs finish,
+ * as the signal catching thread does for the printer threads.
+ */
+static void terminate(engine_t* e) {
+    e->terminating = TRUE;
+    if (!*e->args->terminate_now) {
+        *e->args->terminate_now = 1;
+        emit_simulation_stopped(e->args->stats);
+    }
+    empty_queue_if_terminating(e->args->job_queue, e->args->stats);
+    empty_dispatcher_if_terminating(e->args->dispatcher, e->args->stats);
+}
+
+static int is_finished(engine_t* e) {
+    if (e->terminating) {
+        return e->printing_count == 0;
+    }
+    // Pending refills and autoscaler checks are dropped, like the threads are cancelled
+    return e->all_jobs_arrived && e->printing_count == 0 && backlog_length(e) == 0;
+}
+
+static int engine_init(engine_t* e, virtual_engine_args_t* args) {
+    memset(e, 0, sizeof(engine_t));
+    e->args = args;
+    int capacity = args->pool->capacity;
+    e->runs = calloc(capacity, sizeof(printer_run_t));
+    // At most one print per printer, one refill, one arrival and one autoscaler check
+    if (e->runs == NULL || !event_heap_init(&e->events, capacity + 3)) {
+        free(e->runs);
+        return FALSE;
+    }
+    for (int i = 0; i < capacity; i++) {
+        e->runs[i].index = i;
+    }
+    list_init(&e->refill_queue);
+    pthread_mutex_init(&e->job_queue_mutex, NULL);
+    pthread_cond_init(&e->job_queue_not_empty_cv, NULL);
+
+    e->receiver_args = (job_thread_args_t){
+        .job_queue_mutex = &e->job_queue_mutex,
+        .job_queue_not_empty_cv = &e->job_queue_not_empty_cv,
+        .job_queue = args->job_queue,
+        .dispatcher = args->dispatcher,
+        .simulation_params = args->params,
+        .stats = args->stats,
+        .all_jobs_arrived = &e->all_jobs_arrived,
+    };
+    e->printer_args = (printer_thread_args_t){
+        .job_queue = args->job_queue,
+        .dispatcher = args->dispatcher,
+        .params = args->params,
+        .stats = args->stats,
+        .all_jobs_arrived = &e->all_jobs_arrived,
+        .printer = NULL // Set by printer_pool_add_printer
+    };
+    e->refiller_args = (paper_refill_thread_args_t){
+        .paper_refill_queue = &e->refill_queue,
+        .job_queue = args->job_queue,
+        .dispatcher = args->dispatcher,
+        .params = args->params,
+        .stats = args->stats,
+    };
+    return TRUE;
+}
+
+static void engine_destroy(engine_t* e) {
+    event_heap_destroy(&e->events);
+    list_destroy(&e->refill_queue);
+    pthread_mutex_destroy(&e->job_queue_mutex);
+    pthread_cond_destroy(&e->job_queue_not_empty_cv);
+    free(e->runs);
+}
+
+// --- Public API Function Implementations ---
+int virtual_engine_run(virtual_engine_args_t* args) {
+    engine_t e;
+    if (!engine_init(&e, args)) {
+        return FALSE;
+    }
+    simulation_parameters_t* params = args->params;
+    // Every statistic is written from this thread, so one shard takes them all
+    simulation_stats_bind_shard(args->stats, STATS_SHARD_RECEIVER);
+
+    for (int i = 1; i <= params->consumer_count; i++) {
+        printer_pool_add_printer(args->pool, i, &e.printer_args);
+    }
+    unsigned long start_time_us = get_time_in_us();
+    e.previous_job_arrival_time_us = args->stats->simulation_start_time_us;
+    if (params->num_jobs > 0) {
+        schedule(&e, start_time_us + (unsigned long)params->job_arrival_time_us, EVENT_JOB_ARRIVAL, NULL);
+    } else {
+        e.all_jobs_arrived = TRUE;
+    }
+    if (params->auto_scaling) {
+        schedule(&e, start_time_us, EVENT_AUTOSCALE_CHECK, NULL);
+    }
+
+    event_heap_entry_t event;
+    unsigned long event_count = 0;
+    while (!is_finished(&e) && event_heap_pop(&e.events, &event)) {
+        event_count++;
+        if (!e.terminating && (*args->terminate_now
+                || (event_count % CONFIG_VIRTUAL_ENGINE_SIGNAL_POLL_EVENTS == 0 && sig_int_take_pending(args->signal_set)))) {
+            terminate(&e);
+        }
+        if (e.terminating && event.type != EVENT_PRINT_DONE) {
+            continue;
+        }
+        virtual_clock_advance(event.time_us);
+        switch (event.type) {
+            case EVENT_JOB_ARRIVAL:
+                on_job_arrival(&e);
+                break;
+            case EVENT_PRINT_DONE:
+                on_print_done(&e, (printer_run_t*)event.arg);
+                break;
+            case EVENT_REFILL_DONE:
+                on_refill_done(&e, (printer_t*)event.arg);
+                break;
+            case EVENT_AUTOSCALE_CHECK:
+                on_autoscale_check(&e);
+                break;
+        }
+    }
+    if (g_debug) printf("Virtual-time engine finished after %lu events\n", event_count);
+
+    engine_destroy(&e);
+    return TRUE;
+}
+
+int virtual_engine_simulate(struct simulation_parameters* params, struct simulation_statistics* stats) {
+    timed_queue_t job_queue;
+    job_dispatcher_t job_dispatcher;
+    job_dispatcher_t* dispatcher = NULL;
+    printer_pool_t pool;
+    int terminate_now = 0;
+
+    if (!job_queue_init(&job_queue, params)) return FALSE;
+    if (params->dispatch_mode != JOB_DISPATCH_SHARED) {
+        if (!job_dispatcher_init(&job_dispatcher, params->dispatch_mode, params->max_consumer_count,
+                job_queue_key, CONFIG_JOB_INDEX_INITIAL_CAPACITY)) {
+            timed_queue_destroy(&job_queue);
+            return FALSE;
+        }
+        dispatcher = &job_dispatcher;
+    }
+    if (!printer_pool_init(&pool, params->consumer_count, params->max_consumer_count,
+            params->printer_paper_capacity, NULL)) {
+        if (dispatcher != NULL) job_dispatcher_destroy(dispatcher);
+        timed_queue_destroy(&job_queue);
+        return FALSE;
+    }
+
+    // What emit_simulation_start/emit_simulation_end record when a logger is registered
+    virtual_clock_start(get_time_in_us());
+    stats->simulation_start_time_us = get_time_in_us();
+    virtual_engine_args_t args = {
+        .job_queue = &job_queue,
+        .dispatcher = dispatcher,
+        .params = params,
+        .stats = stats,
+        .pool = &pool,
+        .signal_set = NULL,
+        .terminate_now = &terminate_now
+    };
+    int ok = virtual_engine_run(&args);
+    stats->simulation_duration_us = get_time_in_us() - stats->simulation_start_time_us;
+    virtual_clock_stop();
+
+    printer_pool_destroy(&pool);
+    if (dispatcher != NULL) job_dispatcher_destroy(dispatcher);
+    timed_queue_destroy(&job_queue);
+    return ok;
+}
@@ -1,7 +1,9 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "common.h"
+#include "config.h"
 #include "websocket_handler.h"
 #include "preprocessing.h"
 #include "timeutils.h"
@@ -14,14 +16,21 @@
 #include "timed_queue.h"
 #include "printer.h"
 
-static unsigned long reference_time_us = 0;
-static unsigned long reference_end_time_us = 0;
+// Start time of each session's simulation; timestamps are sent relative to it
+static unsigned long s_reference_time_us[CONFIG_LOG_MAX_SESSIONS];
 
 
 // --- Private Helper Functions ---
+/**
+ * @brief Gets the start time of the simulation whose event is being published.
+ */
+static unsigned long reference_time_us(void) {
+    return s_reference_time_us[log_router_session()];
+}
+
 static void publish_simulation_start(simulation_statistics_t* stats) {
-    reference_time_us = get_time_in_us();
-    stats->simulation_start_time_us = reference_time_us;
+    s_reference_time_us[log_router_session()] = get_time_in_us();
+    stats->simulation_start_time_us = reference_time_us();
     char buf[1024];
 
     // Send simulation_started message
@@ -35,11 +44,11 @@ static void publish_simulation_start(simulation_statistics_t* stats) {
 
 static void publish_simulation_end(simulation_statistics_t* stats)
 {
-    reference_end_time_us = get_time_in_us();
+    unsigned long reference_end_time_us = get_time_in_us();
     char buf[1024];
 
-    stats->simulation_duration_us = reference_end_time_us - reference_time_us;
-    double timestamp_ms = (reference_end_time_us - reference_time_us) / 1000.0;
+    stats->simulation_duration_us = reference_end_time_us - reference_time_us();
+    double timestamp_ms = (reference_end_time_us - reference_time_us()) / 1000.0;
     double duration_ms = stats->simulation_duration_us / 1000.0;
 
     // Send log message
@@ -56,120 +65,79 @@ static void publish_simulation_end(simulation_statistics_t* stats)
 /**
  * @brief Publishes an event when a new job is created in the system or when a job is dropped
  * 
- * @param job_id The id of the job that has been created or dropped.
- * @param papers_required The number of papers required by the job.
- * @param previous_job_arrival_time_us The arrival time of the previous job in microseconds
- * @param current_job_arrival_time_us The current simulation time in microseconds.
+ * @param event The arrival event (job id, papers required, arrival and inter-arrival time).
  * @param is_dropped Whether the job was dropped (TRUE) or created (FALSE).
  */
-static void job_arrival_helper(int job_id, int papers_required,
-    unsigned long previous_job_arrival_time_us, unsigned long current_job_arrival_time_us,
-    int is_dropped)
-{
+static void job_arrival_helper(const log_event_t* event, int is_dropped) {
     char buf[1024];
 
-    double timestamp_ms = (current_job_arrival_time_us - reference_time_us) / 1000.0;
-
-    int inter_arrival_time_us = current_job_arrival_time_us - previous_job_arrival_time_us;
-    double inter_arrival_ms = inter_arrival_time_us / 1000.0;
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
+    double inter_arrival_ms = event->duration_us / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d arrives, needs %d paper%s, inter-arrival time = %.3fms%s\"}}",
-        timestamp_ms, job_id, papers_required,
-        papers_required == 1 ? "" : "s", inter_arrival_ms,
+        timestamp_ms, event->job_id, event->papers,
+        event->papers == 1 ? "" : "s", inter_arrival_ms,
         is_dropped ? ", dropped" : ""
     );
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    ws_bridge_send_log_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_system_arrival(job_t* job, unsigned long previous_job_arrival_time_us,
-    simulation_statistics_t* stats)
-{
-    stats->total_jobs_arrived++; // stats: total jobs arrived
-    stats->total_inter_arrival_time_us += job->system_arrival_time_us - previous_job_arrival_time_us; // stats: avg job inter-arrival time
-    job_arrival_helper(job->id, job->papers_required,
-        previous_job_arrival_time_us, job->system_arrival_time_us, FALSE
-    );
+static void publish_system_arrival(const log_event_t* event) {
+    job_arrival_helper(event, FALSE);
 }
 
-static void publish_dropped_job(job_t* job, unsigned long previous_job_arrival_time_us,
-    simulation_statistics_t* stats)
-{
-    stats->total_jobs_dropped++; // stats: total jobs dropped
-    job_arrival_helper(job->id, job->papers_required,
-        previous_job_arrival_time_us, job->system_arrival_time_us, TRUE
-    );
+static void publish_dropped_job(const log_event_t* event) {
+    job_arrival_helper(event, TRUE);
 }
 
-static void publish_removed_job(job_t* job) {
-    unsigned long current_time_us = get_time_in_us();
+static void publish_removed_job(const log_event_t* event) {
     char buf[1024];
 
-    double timestamp_ms = (current_time_us - reference_time_us) / 1000.0;
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d removed from system\"}}",
-        timestamp_ms, job->id);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+        timestamp_ms, event->job_id);
+    ws_bridge_send_log_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_queue_arrival(const job_t* job, simulation_statistics_t* stats,
-    timed_queue_t* job_queue, unsigned long last_interaction_time_us)
-{
-    stats->area_num_in_job_queue_us +=
-        (job->queue_arrival_time_us - last_interaction_time_us) * // duration of previous state
-        (timed_queue_length(job_queue) - 1); // -1 for the job that just entered the queue
-    // stats: avg job queue length
-    job_queue->last_interaction_time_us = job->queue_arrival_time_us;
-
+static void publish_queue_arrival(const log_event_t* event) {
     char buf[1024];
-    double timestamp_ms = (job->queue_arrival_time_us - reference_time_us) / 1000.0;
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
 
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d enters queue, queue length = %d\"}}",
-        timestamp_ms, job->id, timed_queue_length(job_queue));
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+        timestamp_ms, event->job_id, event->queue_length);
+    ws_bridge_send_log_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_queue_departure(const job_t* job, simulation_statistics_t* stats,
-    timed_queue_t* job_queue, unsigned long last_interaction_time_us)
-{
-    stats->area_num_in_job_queue_us +=
-        (job->queue_departure_time_us - last_interaction_time_us) * // duration of previous state
-        (timed_queue_length(job_queue) + 1); // +1 for the job that just left the queue
-    // stats: avg job queue length
-    job_queue->last_interaction_time_us = job->queue_departure_time_us;
-
+static void publish_queue_departure(const log_event_t* event) {
     char buf[1024];
-    double timestamp_ms = (job->queue_departure_time_us - reference_time_us) / 1000.0;
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
 
-    double queue_duration_ms = (job->queue_departure_time_us - job->queue_arrival_time_us) / 1000.0;
+    double queue_duration_ms = event->duration_us / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d leaves queue, time in queue = %.3fms, queue_length = %d\"}}",
-        timestamp_ms, job->id, queue_duration_ms, timed_queue_length(job_queue));
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+        timestamp_ms, event->job_id, queue_duration_ms, event->queue_length);
+    ws_bridge_send_log_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_job_update(const job_t* job) {
+static void publish_job_update(const log_event_t* event) {
     char buf[512];
 
     sprintf(buf, "{\"type\":\"job_update\", \"data\":{\"id\":%d, \"papersRequired\":%d}}", 
-            job->id, job->papers_required);
+            event->job_id, event->papers);
     ws_bridge_send_json_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_jobs_update(timed_queue_t* job_queue) {
+static void publish_jobs_update(const log_event_t* event) {
     char buf[8192];
     int offset = 0;
     
     offset += sprintf(buf + offset, "{\"type\":\"jobs_update\", \"data\":[");
     
-    // Iterate through all jobs in the queue
-    int first = 1;
-    list_node_t* current = timed_queue_first(job_queue);
-    while (current != NULL) {
-        job_t* job = (job_t*)current->data;
-        if (!first) {
+    // Iterate through the jobs that were queued when the update was emitted
+    for (int i = 0; i < event->count; i++) {
+        if (i > 0) {
             offset += sprintf(buf + offset, ",");
         }
         offset += sprintf(buf + offset, "{\"id\":%d,\"papersRequired\":%d}",
-                         job->id, job->papers_required);
-        first = 0;
-        current = timed_queue_next(job_queue, current);
+                         event->jobs[i].id, event->jobs[i].papers_required);
         
         // Safety check to prevent buffer overflow
         if (offset > 7900) break;
@@ -179,87 +147,56 @@ static void publish_jobs_update(timed_queue_t* job_queue) {
     ws_bridge_send_json_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_printer_arrival(const job_t* job, const printer_t* printer)
-{
+static void publish_printer_arrival(const log_event_t* event) {
     char buf[1024];
-    double timestamp_ms = (job->service_arrival_time_us - reference_time_us) / 1000.0;
-    sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d begins service at printer%d, printing %d pages in about %dms\"}}",
-        timestamp_ms, job->id, printer->id, job->papers_required, job->service_time_requested_ms);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
+    sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d begins service at printer%d, printing %d pages in about %lums\"}}",
+        timestamp_ms, event->job_id, event->printer_id, event->papers, event->duration_us / 1000);
+    ws_bridge_send_log_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_system_departure(const job_t* job, const printer_t* printer,
-    simulation_statistics_t* stats)
-{
+static void publish_system_departure(const log_event_t* event) {
     char buf[1024];
-    double timestamp_ms = (job->service_departure_time_us - reference_time_us) / 1000.0;
-
-    int system_time = job->service_departure_time_us - job->system_arrival_time_us;
-    stats->total_system_time_us += system_time; // stats: avg job system time
-    stats->sum_of_system_time_squared_us2 += system_time * system_time; // stats: stddev job system time
-    stats->total_jobs_served += 1; // stats: total jobs served
-
-    int service_duration = job->service_departure_time_us - job->service_arrival_time_us;
-
-    // Track in array format (0-indexed)
-    int idx = printer->id - 1;
-    if (idx >= 0 && idx < MAX_PRINTERS) {
-        stats->jobs_served_by_printer[idx] += 1;
-        stats->printer_paper_used[idx] += job->papers_required;
-        stats->total_service_time_printer_us[idx] += service_duration;
-        
-        // Update max_printers_used
-        if (printer->id > stats->max_printers_used) {
-            stats->max_printers_used = printer->id;
-        }
-    }
-
-    stats->total_queue_wait_time_us +=
-        (job->queue_departure_time_us - job->queue_arrival_time_us); // stats: avg job queue wait time
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
 
-    double service_duration_ms = service_duration / 1000.0;
+    double service_duration_ms = event->duration_us / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d departs from printer%d, service time = %.3fms\"}}",
-        timestamp_ms, job->id, printer->id, service_duration_ms);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+        timestamp_ms, event->job_id, event->printer_id, service_duration_ms);
+    ws_bridge_send_log_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_paper_empty(printer_t* printer, int job_id, unsigned long current_time_us)
-{
+static void publish_paper_empty(const log_event_t* event) {
     char buf[1024];
-    double timestamp_ms = (current_time_us - reference_time_us) / 1000.0;
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"printer%d does not have enough paper for job%d and is requesting refill\"}}",
-        timestamp_ms, printer->id, job_id);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+        timestamp_ms, event->printer_id, event->job_id);
+    ws_bridge_send_log_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_paper_refill_start(printer_t* printer, int papers_needed,
-    int time_to_refill_us, unsigned long current_time_us)
-{
+static void publish_paper_refill_start(const log_event_t* event) {
     char buf[1024];
-    double timestamp_ms = (current_time_us - reference_time_us) / 1000.0;
-    double refill_time_ms = time_to_refill_us / 1000.0;
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
+    double refill_time_ms = event->duration_us / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"printer%d starts refilling %d papers, estimated time = %.3fms\"}}",
-        timestamp_ms, printer->id, papers_needed, refill_time_ms);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+        timestamp_ms, event->printer_id, event->papers, refill_time_ms);
+    ws_bridge_send_log_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_paper_refill_end(printer_t* printer, int refill_duration_us,
-    unsigned long current_time_us)
-{
+static void publish_paper_refill_end(const log_event_t* event) {
     char buf[1024];
-    double timestamp_ms = (current_time_us - reference_time_us) / 1000.0;
-    double refill_time_ms = refill_duration_us / 1000.0;
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
+    double refill_time_ms = event->duration_us / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"printer%d finishes refilling, actual time = %.3fms\"}}",
-        timestamp_ms, printer->id, refill_time_ms);
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+        timestamp_ms, event->printer_id, refill_time_ms);
+    ws_bridge_send_log_from_any_thread(buf, strlen(buf));
 }
 
 static void publish_simulation_stopped(simulation_statistics_t* stats) {
     char buf[1024];
-    reference_end_time_us = get_time_in_us();
+    unsigned long reference_end_time_us = get_time_in_us();
 
-    stats->simulation_duration_us = reference_end_time_us - reference_time_us;
-    double timestamp_ms = (reference_end_time_us - reference_time_us) / 1000.0;
+    stats->simulation_duration_us = reference_end_time_us - reference_time_us();
+    double timestamp_ms = (reference_end_time_us - reference_time_us()) / 1000.0;
     double duration_ms = stats->simulation_duration_us / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"simulation stopped, duration = %.3fms\"}}",
         timestamp_ms, duration_ms);
@@ -269,74 +206,72 @@ static void publish_simulation_stopped(simulation_statistics_t* stats) {
 static void publish_statistics(simulation_statistics_t* stats) {
     if (stats == NULL) return;
 
-    char buf[4096];
-    if (write_statistics_to_buffer(stats, buf, sizeof(buf)) > 0) {
+    // Sized per printer: large pools do not fit a fixed buffer
+    int buf_size = statistics_buffer_size(stats);
+    char* buf = malloc(buf_size);
+    if (buf == NULL) return;
+    if (write_statistics_to_buffer(stats, buf, buf_size) > 0) {
         ws_bridge_send_json_from_any_thread(buf, strlen(buf));
     }
+    free(buf);
 }
 
-static void publish_scale_up(int new_printer_count, int queue_length, unsigned long current_time_us) {
+static void publish_scale_up(const log_event_t* event) {
     char buf[1024];
     
-    double timestamp_ms = (current_time_us - reference_time_us) / 1000.0;
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"Autoscaling: Scaled UP to %d printers (queue length: %d)\"}}",
-        timestamp_ms, new_printer_count, queue_length);
+        timestamp_ms, event->count, event->queue_length);
     ws_bridge_send_json_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_scale_down(int new_printer_count, int queue_length, unsigned long current_time_us) {
+static void publish_scale_down(const log_event_t* event) {
     char buf[1024];
     
-    double timestamp_ms = (current_time_us - reference_time_us) / 1000.0;
+    double timestamp_ms = (event->time_us - reference_time_us()) / 1000.0;
     sprintf(buf, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"Autoscaling: Scaled DOWN to %d printers (queue length: %d)\"}}",
-        timestamp_ms, new_printer_count, queue_length);
+        timestamp_ms, event->count, event->queue_length);
     ws_bridge_send_json_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_printer_idle(const printer_t* printer) {
+static void publish_printer_idle(const log_event_t* event) {
     char buf[1024];
     
     sprintf(buf, "{\"type\":\"consumer_update\", \"data\":{\"id\":%d, \"papersLeft\":%d, \"status\":\"idle\", \"currentJobId\":null}}",
-        printer->id, printer->current_paper_count);
+        event->printer_id, event->papers);
     ws_bridge_send_json_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_printer_busy(const printer_t* printer, int job_id) {
+static void publish_printer_busy(const log_event_t* event) {
     char buf[1024];
 
     sprintf(buf, "{\"type\":\"consumer_update\", \"data\":{\"id\":%d, \"papersLeft\":%d, \"status\":\"serving\", \"currentJobId\":%d}}",
-        printer->id, printer->current_paper_count, job_id);
+        event->printer_id, event->papers, event->job_id);
     ws_bridge_send_json_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_printer_waiting_refill(const printer_t* printer) {
+static void publish_printer_waiting_refill(const log_event_t* event) {
     char buf[1024];
 
     sprintf(buf, "{\"type\":\"consumer_update\", \"data\":{\"id\":%d, \"papersLeft\":%d, \"status\":\"waiting_refill\", \"currentJobId\":null}}",
-        printer->id, printer->current_paper_count);
+        event->printer_id, event->papers);
     ws_bridge_send_json_from_any_thread(buf, strlen(buf));
 }
 
-static void publish_stats_update(simulation_statistics_t* stats, int queue_length) {
-    char buf[1024];
-    
-    sprintf(buf, "{\"type\":\"stats_update\", \"data\":{"
-                 "\"jobsProcessed\":%.0f, "
-                 "\"jobsReceived\":%.0f, "
-                 "\"queueLength\":%d, "
-                 "\"avgCompletionTime\":%.2f, "
-                 "\"papersUsed\":%d, "
-                 "\"refillEvents\":%.0f, "
-                 "\"avgServiceTime\":%.2f}}",
-            stats->total_jobs_served,
-            stats->total_jobs_arrived,
-            queue_length,
-            calculate_average_system_time(stats),
-            calculate_total_papers_used(stats),
-            stats->paper_refill_events,
-            calculate_overall_average_service_time(stats));
-    
-    ws_bridge_send_json_from_any_thread(buf, strlen(buf));
+static void publish_stats_update(const log_event_t* event) {
+    simulation_statistics_t snapshot;
+    simulation_stats_snapshot(event->stats, &snapshot);
+
+    // The event loop turns this into JSON per client (see ws_stats.h)
+    ws_stats_t stats;
+    stats.values[WS_STATS_JOBS_PROCESSED] = snapshot.total_jobs_served;
+    stats.values[WS_STATS_JOBS_RECEIVED] = snapshot.total_jobs_arrived;
+    stats.values[WS_STATS_QUEUE_LENGTH] = event->queue_length;
+    stats.values[WS_STATS_AVG_COMPLETION_TIME] = calculate_average_system_time(&snapshot);
+    stats.values[WS_STATS_PAPERS_USED] = calculate_total_papers_used(&snapshot);
+    stats.values[WS_STATS_REFILL_EVENTS] = snapshot.paper_refill_events;
+    stats.values[WS_STATS_AVG_SERVICE_TIME] = calculate_overall_average_service_time(&snapshot);
+    ws_bridge_send_stats_from_any_thread(&stats);
 }
 
 
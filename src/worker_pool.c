@@ -0,0 +1,162 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "worker_pool.h"
+#include "common.h"
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Worker thread: runs the tasks it is handed, parking between them,
+ * until worker_pool_destroy tells it to exit.
+ */
+static void* worker_main(void* arg) {
+    worker_t* worker = (worker_t*)arg;
+    pthread_mutex_lock(&worker->mutex);
+    for (;;) {
+        while (worker->task == NULL && !worker->exiting) {
+            pthread_cond_wait(&worker->cv, &worker->mutex);
+        }
+        if (worker->task == NULL) break; // exiting
+
+        worker_task_t task = worker->task;
+        void* task_arg = worker->arg;
+        pthread_mutex_unlock(&worker->mutex);
+        task(task_arg);
+        pthread_mutex_lock(&worker->mutex);
+
+        worker->task = NULL;
+        worker->finished = TRUE;
+        pthread_cond_broadcast(&worker->cv); // wake worker_wait
+    }
+    pthread_mutex_unlock(&worker->mutex);
+    return NULL;
+}
+
+/**
+ * @brief Pushes an idle worker on the parked stack. The caller holds pool->mutex.
+ */
+static void park(worker_pool_t* pool, worker_t* worker) {
+    worker->next_parked = pool->parked;
+    pool->parked = worker;
+    pool->parked_count++;
+}
+
+/**
+ * @brief Starts the thread of the next free slot. The caller holds pool->mutex.
+ * @return The new idle worker, or NULL if the pool is full or the thread could not be created.
+ */
+static worker_t* start_worker(worker_pool_t* pool) {
+    if (pool->thread_count >= pool->capacity) return NULL;
+    worker_t* worker = &pool->workers[pool->thread_count];
+    pthread_mutex_init(&worker->mutex, NULL);
+    pthread_cond_init(&worker->cv, NULL);
+    worker->task = NULL;
+    worker->finished = FALSE;
+    worker->exiting = FALSE;
+    if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+        pthread_mutex_destroy(&worker->mutex);
+        pthread_cond_destroy(&worker->cv);
+        return NULL;
+    }
+    pool->thread_count++;
+    return worker;
+}
+
+// --- Public API Function Implementations ---
+
+int worker_pool_init(worker_pool_t* pool, int capacity) {
+    memset(pool, 0, sizeof(worker_pool_t));
+    if (capacity < 1) capacity = 1;
+    // worker_t is cache-line aligned, so its size is a multiple of the alignment
+    pool->workers = aligned_alloc(CONFIG_CACHE_LINE_SIZE, sizeof(worker_t) * capacity);
+    if (pool->workers == NULL) {
+        return FALSE;
+    }
+    memset(pool->workers, 0, sizeof(worker_t) * capacity);
+    pool->capacity = capacity;
+    pthread_mutex_init(&pool->mutex, NULL);
+    return TRUE;
+}
+
+int worker_pool_reserve(worker_pool_t* pool, int count) {
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->parked_count < count) {
+        worker_t* worker = start_worker(pool);
+        if (worker == NULL) break;
+        park(pool, worker);
+    }
+    int reserved = pool->parked_count >= count;
+    pthread_mutex_unlock(&pool->mutex);
+    return reserved;
+}
+
+worker_t* worker_pool_run(worker_pool_t* pool, worker_task_t task, void* arg) {
+    pthread_mutex_lock(&pool->mutex);
+    worker_t* worker = pool->parked;
+    if (worker != NULL) {
+        pool->parked = worker->next_parked;
+        pool->parked_count--;
+    } else {
+        worker = start_worker(pool); // cold pool: pay for the thread once
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    if (worker == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&worker->mutex);
+    worker->task = task;
+    worker->arg = arg;
+    pthread_cond_signal(&worker->cv); // the worker is the only waiter
+    pthread_mutex_unlock(&worker->mutex);
+    return worker;
+}
+
+void worker_wait(worker_pool_t* pool, worker_t* worker) {
+    pthread_mutex_lock(&worker->mutex);
+    while (!worker->finished) {
+        pthread_cond_wait(&worker->cv, &worker->mutex);
+    }
+    worker->finished = FALSE;
+    pthread_mutex_unlock(&worker->mutex);
+
+    pthread_mutex_lock(&pool->mutex);
+    park(pool, worker);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+int worker_pool_thread_count(worker_pool_t* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    int count = pool->thread_count;
+    pthread_mutex_unlock(&pool->mutex);
+    return count;
+}
+
+int worker_pool_parked_count(worker_pool_t* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    int count = pool->parked_count;
+    pthread_mutex_unlock(&pool->mutex);
+    return count;
+}
+
+void worker_pool_destroy(worker_pool_t* pool) {
+    for (int i = 0; i < pool->thread_count; i++) {
+        worker_t* worker = &pool->workers[i];
+        pthread_mutex_lock(&worker->mutex);
+        worker->exiting = TRUE;
+        pthread_cond_signal(&worker->cv);
+        pthread_mutex_unlock(&worker->mutex);
+        pthread_join(worker->thread, NULL);
+        pthread_mutex_destroy(&worker->mutex);
+        pthread_cond_destroy(&worker->cv);
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->workers);
+    pool->workers = NULL;
+    pool->capacity = 0;
+    pool->thread_count = 0;
+    pool->parked_count = 0;
+    pool->parked = NULL;
+}
@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "ws_batch.h"
+
+// --- Private Helper Functions ---
+/**
+ * @brief Grow the buffer to hold at least needed bytes.
+ * @return 1 on success, 0 on memory allocation failure.
+ */
+static int reserve(ws_batch_t* b, size_t needed) {
+    if (needed <= b->cap) {
+        return TRUE;
+    }
+    size_t cap = b->cap * 2;
+    while (cap < needed) {
+        cap *= 2;
+    }
+    char* buf = realloc(b->buf, cap);
+    if (buf == NULL) {
+        return FALSE;
+    }
+    b->buf = buf;
+    b->cap = cap;
+    return TRUE;
+}
+
+
+// --- Public API Function Implementations ---
+int ws_batch_init(ws_batch_t* b, size_t max_bytes, unsigned long window_us) {
+    if (b == NULL) {
+        return FALSE;
+    }
+    b->cap = max_bytes > 0 ? max_bytes + 1 : 64; // room for the closing bracket
+    b->buf = malloc(b->cap);
+    if (b->buf == NULL) {
+        return FALSE; // Memory allocation failure
+    }
+    b->max_bytes = max_bytes;
+    b->window_us = window_us;
+    ws_batch_clear(b);
+    return TRUE;
+}
+
+void ws_batch_destroy(ws_batch_t* b) {
+    if (b == NULL) {
+        return;
+    }
+    free(b->buf);
+    b->buf = NULL;
+    b->len = 0;
+    b->cap = 0;
+    b->count = 0;
+}
+
+void ws_batch_configure(ws_batch_t* b, size_t max_bytes, unsigned long window_us) {
+    b->max_bytes = max_bytes;
+    b->window_us = window_us;
+}
+
+int ws_batch_append(ws_batch_t* b, const char* json, size_t len, unsigned long now_us) {
+    // Separator, message and the closing bracket added by ws_batch_frame
+    if (!reserve(b, b->len + 1 + len + 1)) {
+        return FALSE;
+    }
+    if (b->count > 0) {
+        b->buf[b->len++] = ',';
+    } else {
+        b->oldest_us = now_us;
+    }
+    memcpy(b->buf + b->len, json, len);
+    b->len += len;
+    b->count++;
+    return TRUE;
+}
+
+int ws_batch_is_empty(const ws_batch_t* b) {
+    return b->count == 0;
+}
+
+int ws_batch_is_full(const ws_batch_t* b) {
+    return b->count > 0 && b->len + 1 >= b->max_bytes;
+}
+
+int ws_batch_is_due(const ws_batch_t* b, unsigned long now_us) {
+    if (b->count == 0) {
+        return FALSE;
+    }
+    return ws_batch_is_full(b) || now_us - b->oldest_us >= b->window_us;
+}
+
+unsigned long ws_batch_time_left_us(const ws_batch_t* b, unsigned long now_us) {
+    if (ws_batch_is_due(b, now_us) || b->count == 0) {
+        return 0;
+    }
+    return b->window_us - (now_us - b->oldest_us);
+}
+
+const char* ws_batch_frame(ws_batch_t* b, size_t* len) {
+    if (b->count == 0) {
+        *len = 0;
+        return NULL;
+    }
+    b->buf[b->len] = ']'; // reserved by ws_batch_append; not counted in len
+    *len = b->len + 1;
+    return b->buf;
+}
+
+void ws_batch_clear(ws_batch_t* b) {
+    b->buf[0] = '[';
+    b->len = 1;
+    b->count = 0;
+    b->oldest_us = 0;
+}
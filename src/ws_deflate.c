@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "ws_deflate.h"
+
+// Every sync flush ends with this empty stored block; RFC 7692 strips it on the wire
+static const unsigned char s_flush_tail[4] = {0x00, 0x00, 0xff, 0xff};
+
+// --- Private Helper Functions ---
+/**
+ * @brief Grow the output buffer to hold at least needed bytes.
+ * @return 1 on success, 0 on memory allocation failure.
+ */
+static int reserve(ws_deflate_buffer_t* buf, size_t needed) {
+    if (needed <= buf->cap) {
+        return TRUE;
+    }
+    size_t cap = buf->cap > 0 ? buf->cap * 2 : 1024;
+    while (cap < needed) {
+        cap *= 2;
+    }
+    unsigned char* data = realloc(buf->data, cap);
+    if (data == NULL) {
+        return FALSE;
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return TRUE;
+}
+
+/**
+ * @brief Trim spaces and tabs from both ends of a token, in place.
+ */
+static char* trim(char* token) {
+    while (*token == ' ' || *token == '\t') token++;
+    char* end = token + strlen(token);
+    while (end > token && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+    return token;
+}
+
+/**
+ * @brief Check one "permessage-deflate; param; param=value" offer.
+ * @return 1 if the server can accept it (window_bits and no_context_takeover updated), 0 otherwise.
+ */
+static int accept_offer(char* offer, int* window_bits, int* no_context_takeover) {
+    char* save = NULL;
+    char* token = strtok_r(offer, ";", &save);
+    if (token == NULL || strcmp(trim(token), "permessage-deflate") != 0) {
+        return FALSE;
+    }
+    int bits = *window_bits;
+    int no_takeover = FALSE;
+    while ((token = strtok_r(NULL, ";", &save)) != NULL) {
+        char* name = trim(token);
+        char* value = strchr(name, '=');
+        if (value != NULL) {
+            *value++ = '\0';
+            name = trim(name);
+            value = trim(value);
+            if (*value == '"') value++; // quoted-string form
+        }
+        if (strcmp(name, "server_no_context_takeover") == 0 && value == NULL) {
+            no_takeover = TRUE;
+        } else if (strcmp(name, "server_max_window_bits") == 0 && value != NULL) {
+            int max_bits = atoi(value);
+            if (max_bits < 9 || max_bits > 15) return FALSE; // zlib cannot deflate with a 256 byte window
+            if (max_bits < bits) bits = max_bits;
+        } else if (strcmp(name, "client_no_context_takeover") == 0 && value == NULL) {
+            // Inflating with a full window handles either choice
+        } else if (strcmp(name, "client_max_window_bits") == 0) {
+            // Same: any client window fits in the inflater's 15 bits
+        } else {
+            return FALSE; // unknown parameter: decline this offer
+        }
+    }
+    *window_bits = bits;
+    *no_context_takeover = no_takeover;
+    return TRUE;
+}
+
+
+// --- Public API Function Implementations ---
+int ws_deflate_parse_offer(const char* header, size_t len, int* window_bits, int* no_context_takeover) {
+    char offers[512];
+    if (header == NULL || len == 0 || len >= sizeof(offers)) {
+        return FALSE;
+    }
+    memcpy(offers, header, len);
+    offers[len] = '\0';
+
+    // Offers are listed in the client's order of preference
+    char* save = NULL;
+    for (char* offer = strtok_r(offers, ",", &save); offer != NULL; offer = strtok_r(NULL, ",", &save)) {
+        if (accept_offer(offer, window_bits, no_context_takeover)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+int ws_deflate_response_header(char* buf, size_t size, int window_bits, int no_context_takeover) {
+    return snprintf(buf, size, "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=%d%s\r\n",
+                    window_bits, no_context_takeover ? "; server_no_context_takeover" : "");
+}
+
+int ws_deflate_init(ws_deflate_t* d, int level, int window_bits, int mem_level, int no_context_takeover) {
+    if (d == NULL) {
+        return FALSE;
+    }
+    memset(d, 0, sizeof(*d));
+    d->no_context_takeover = no_context_takeover;
+    // Negative window bits: raw deflate, no zlib header or checksum
+    if (deflateInit2(&d->deflater, level, Z_DEFLATED, -window_bits, mem_level, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return FALSE;
+    }
+    if (inflateInit2(&d->inflater, -15) != Z_OK) {
+        deflateEnd(&d->deflater);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void ws_deflate_destroy(ws_deflate_t* d) {
+    if (d == NULL) {
+        return;
+    }
+    deflateEnd(&d->deflater);
+    inflateEnd(&d->inflater);
+    free(d->compressed.data);
+    free(d->inflated.data);
+    d->compressed = (ws_deflate_buffer_t){0};
+    d->inflated = (ws_deflate_buffer_t){0};
+}
+
+const unsigned char* ws_deflate_compress(ws_deflate_t* d, const void* data, size_t len, size_t* out_len) {
+    // deflateBound covers the worst case of a fresh stream; the flush adds a few bytes
+    ws_deflate_buffer_t* out = &d->compressed;
+    if (!reserve(out, deflateBound(&d->deflater, len) + 16)) {
+        return NULL;
+    }
+    d->deflater.next_in = (Bytef*)data;
+    d->deflater.avail_in = (uInt)len;
+    size_t produced = 0;
+    do {
+        if (produced == out->cap && !reserve(out, out->cap * 2)) {
+            return NULL;
+        }
+        d->deflater.next_out = out->data + produced;
+        d->deflater.avail_out = (uInt)(out->cap - produced);
+        if (deflate(&d->deflater, Z_SYNC_FLUSH) == Z_STREAM_ERROR) {
+            return NULL;
+        }
+        produced = out->cap - d->deflater.avail_out;
+    } while (d->deflater.avail_out == 0); // output full: there may be more to flush
+
+    if (d->no_context_takeover) {
+        deflateReset(&d->deflater);
+    }
+    if (produced >= sizeof(s_flush_tail) && memcmp(out->data + produced - 4, s_flush_tail, 4) == 0) {
+        produced -= sizeof(s_flush_tail);
+    }
+    *out_len = produced;
+    return out->data;
+}
+
+const unsigned char* ws_deflate_inflate(ws_deflate_t* d, const void* data, size_t len, size_t max_len, size_t* out_len) {
+    ws_deflate_buffer_t* out = &d->inflated;
+    size_t produced = 0;
+    // The message, then the stripped flush tail
+    const unsigned char* inputs[2] = {(const unsigned char*)data, s_flush_tail};
+    size_t input_lens[2] = {len, sizeof(s_flush_tail)};
+    int ended = FALSE;
+    for (int i = 0; i < 2 && !ended; i++) {
+        d->inflater.next_in = (Bytef*)inputs[i];
+        d->inflater.avail_in = (uInt)input_lens[i];
+        do {
+            if (produced == out->cap && (produced >= max_len || !reserve(out, out->cap + 1))) {
+                return NULL; // too large, or out of memory
+            }
+            d->inflater.next_out = out->data + produced;
+            d->inflater.avail_out = (uInt)(out->cap - produced);
+            int status = inflate(&d->inflater, Z_SYNC_FLUSH);
+            if (status != Z_OK && status != Z_BUF_ERROR && status != Z_STREAM_END) {
+                inflateReset(&d->inflater);
+                return NULL;
+            }
+            produced = out->cap - d->inflater.avail_out;
+            if (status == Z_STREAM_END) {
+                inflateReset(&d->inflater); // the client closed its block stream (BFINAL)
+                ended = TRUE;
+                break;
+            }
+            if (status == Z_BUF_ERROR) {
+                break; // no progress possible with this input
+            }
+        } while (d->inflater.avail_in > 0 || d->inflater.avail_out == 0); // input left, or output full
+    }
+    if (produced > max_len) {
+        return NULL;
+    }
+    *out_len = produced;
+    return out->data;
+}
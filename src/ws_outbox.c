@@ -0,0 +1,146 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "ws_outbox.h"
+
+// --- Private Helper Functions ---
+/**
+ * @brief Copy a message into a new heap record.
+ * @return The record, or NULL on memory allocation failure.
+ */
+static ws_message_t* copy_message(const void* json, size_t len, int lossy) {
+    ws_message_t* message = malloc(sizeof(ws_message_t) + len);
+    if (message == NULL) {
+        return NULL;
+    }
+    message->refs = 1;
+    message->lossy = lossy;
+    message->next = NULL;
+    message->len = len;
+    memcpy(message->data, json, len);
+    return message;
+}
+
+/**
+ * @brief Claim the doorbell.
+ * @return 1 if this call rang it (the caller wakes the loop), 0 if it was already rung.
+ */
+static int ring_doorbell(ws_outbox_t* outbox) {
+    return atomic_exchange(&outbox->doorbell, 1) == 0;
+}
+
+
+// --- Public API Function Implementations ---
+int ws_outbox_init(ws_outbox_t* outbox, size_t capacity) {
+    if (outbox == NULL || !ring_buffer_init(&outbox->pending, capacity)) {
+        return FALSE;
+    }
+    atomic_init(&outbox->latest_stats, NULL);
+    atomic_init(&outbox->doorbell, 0);
+    pthread_mutex_init(&outbox->overflow_mutex, NULL);
+    outbox->overflow_head = NULL;
+    outbox->overflow_tail = NULL;
+    atomic_init(&outbox->overflow_count, 0);
+    atomic_init(&outbox->dropped, 0);
+    return TRUE;
+}
+
+void ws_outbox_destroy(ws_outbox_t* outbox) {
+    if (outbox == NULL) {
+        return;
+    }
+    ws_outbox_clear(outbox);
+    ring_buffer_destroy(&outbox->pending);
+    pthread_mutex_destroy(&outbox->overflow_mutex);
+}
+
+int ws_outbox_push(ws_outbox_t* outbox, const char* json, size_t len, int lossy) {
+    ws_message_t* message = copy_message(json, len, lossy);
+    if (message == NULL) {
+        return FALSE;
+    }
+    // While older messages wait in the overflow list, a newer one must not pass them in the ring
+    if (atomic_load(&outbox->overflow_count) == 0 && ring_buffer_push(&outbox->pending, message)) {
+        return ring_doorbell(outbox);
+    }
+
+    // The loop is behind, and may be waiting on this very thread: never wait for it
+    if (lossy) {
+        free(message);
+        atomic_fetch_add(&outbox->dropped, 1);
+    } else {
+        pthread_mutex_lock(&outbox->overflow_mutex);
+        if (outbox->overflow_tail != NULL) {
+            outbox->overflow_tail->next = message;
+        } else {
+            outbox->overflow_head = message;
+        }
+        outbox->overflow_tail = message;
+        atomic_fetch_add(&outbox->overflow_count, 1);
+        pthread_mutex_unlock(&outbox->overflow_mutex);
+    }
+    return ring_doorbell(outbox);
+}
+
+int ws_outbox_put_stats(ws_outbox_t* outbox, const void* stats, size_t len) {
+    ws_message_t* message = copy_message(stats, len, TRUE);
+    if (message == NULL) {
+        return FALSE;
+    }
+    // Coalesce: an unsent older snapshot is superseded by this one
+    free(atomic_exchange(&outbox->latest_stats, message));
+    return ring_doorbell(outbox);
+}
+
+void ws_outbox_answer_doorbell(ws_outbox_t* outbox) {
+    // An exchange rather than a store, so the loop synchronizes with the last
+    // producer that rang and sees every message pushed before the ring
+    atomic_exchange(&outbox->doorbell, 0);
+}
+
+unsigned long ws_outbox_dropped(ws_outbox_t* outbox) {
+    return atomic_load(&outbox->dropped);
+}
+
+ws_message_t* ws_outbox_pop(ws_outbox_t* outbox) {
+    ws_message_t* message = (ws_message_t*)ring_buffer_pop(&outbox->pending);
+    if (message != NULL || atomic_load(&outbox->overflow_count) == 0) {
+        return message;
+    }
+    // The ring is drained: the overflow list holds the next messages in order
+    pthread_mutex_lock(&outbox->overflow_mutex);
+    message = outbox->overflow_head;
+    if (message != NULL) {
+        outbox->overflow_head = message->next;
+        if (outbox->overflow_head == NULL) outbox->overflow_tail = NULL;
+        message->next = NULL;
+        atomic_fetch_sub(&outbox->overflow_count, 1);
+    }
+    pthread_mutex_unlock(&outbox->overflow_mutex);
+    return message;
+}
+
+ws_message_t* ws_outbox_take_stats(ws_outbox_t* outbox) {
+    return atomic_exchange(&outbox->latest_stats, NULL);
+}
+
+ws_message_t* ws_message_retain(ws_message_t* message) {
+    message->refs++;
+    return message;
+}
+
+void ws_message_release(ws_message_t* message) {
+    if (message != NULL && --message->refs == 0) {
+        free(message);
+    }
+}
+
+void ws_outbox_clear(ws_outbox_t* outbox) {
+    ws_message_t* message;
+    while ((message = ws_outbox_pop(outbox)) != NULL) {
+        ws_message_release(message);
+    }
+    ws_message_release(ws_outbox_take_stats(outbox));
+}
@@ -0,0 +1,62 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "common.h"
+#include "config.h"
+#include "ws_stats.h"
+
+// JSON name and printed decimals of each field
+static const struct {
+    const char* name;
+    int decimals;
+} s_fields[WS_STATS_FIELD_COUNT] = {
+    [WS_STATS_JOBS_PROCESSED]      = {"jobsProcessed", 0},
+    [WS_STATS_JOBS_RECEIVED]       = {"jobsReceived", 0},
+    [WS_STATS_QUEUE_LENGTH]        = {"queueLength", 0},
+    [WS_STATS_AVG_COMPLETION_TIME] = {"avgCompletionTime", 2},
+    [WS_STATS_PAPERS_USED]         = {"papersUsed", 0},
+    [WS_STATS_REFILL_EVENTS]       = {"refillEvents", 0},
+    [WS_STATS_AVG_SERVICE_TIME]    = {"avgServiceTime", 2},
+};
+
+
+// --- Private Helper Functions ---
+/**
+ * @brief A field's value as the client sees it, so changes below the printed
+ * precision do not count as changes.
+ */
+static long long printed_value(int field, double value) {
+    return llround(value * (s_fields[field].decimals == 2 ? 100.0 : 1.0));
+}
+
+
+// --- Public API Function Implementations ---
+void ws_stats_encoder_reset(ws_stats_encoder_t* encoder) {
+    encoder->frames_since_keyframe = -1;
+}
+
+size_t ws_stats_encode(ws_stats_encoder_t* encoder, const ws_stats_t* stats, int delta, char* buf, size_t size) {
+    int keyframe = !delta || encoder->frames_since_keyframe < 0
+        || encoder->frames_since_keyframe + 1 >= CONFIG_WS_STATS_KEYFRAME_INTERVAL;
+
+    int len = snprintf(buf, size, keyframe ? "{\"type\":\"stats_update\", \"data\":{"
+                                           : "{\"type\":\"stats_update\", \"delta\":true, \"data\":{");
+    int written = 0;
+    for (int i = 0; i < WS_STATS_FIELD_COUNT; i++) {
+        long long value = printed_value(i, stats->values[i]);
+        if (!keyframe && value == encoder->sent[i]) {
+            continue;
+        }
+        encoder->sent[i] = value;
+        len += snprintf(buf + len, size - len, "%s\"%s\":%.*f", written > 0 ? ", " : "",
+                        s_fields[i].name, s_fields[i].decimals, stats->values[i]);
+        written++;
+    }
+    if (written == 0) {
+        return 0; // nothing changed since the last frame
+    }
+    len += snprintf(buf + len, size - len, "}}");
+
+    encoder->frames_since_keyframe = keyframe ? 0 : encoder->frames_since_keyframe + 1;
+    return (size_t)len;
+}
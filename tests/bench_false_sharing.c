@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "printer.h"
+
+/**
+ * @file bench_false_sharing.c
+ * @brief Measures the cost of false sharing between printers' hot state.
+ *
+ * Every printer thread updates its own printer's hot fields the way serve_job
+ * does (paper, busy/idle flag, completion time, counters) as fast as it can,
+ * i.e. at an unbounded job rate, while an autoscaler thread keeps polling
+ * every printer's idle flag and completion time. Two layouts are compared:
+ *
+ * - packed: the old printer_t, laid out back to back as the fixed pool array
+ *   did, so neighbouring printers share cache lines
+ * - padded: the current printer_instance_t array, whose hot fields sit on
+ *   their own cache line
+ *
+ * False sharing needs threads running in parallel: on a single CPU both
+ * layouts cost about the same, so the bench refuses to run with fewer than
+ * two online CPUs rather than report figures that say nothing about padding.
+ *
+ * Usage: ./bench_false_sharing [printer_count] [jobs_per_printer]
+ */
+
+#define BENCH_DEFAULT_PRINTERS   4
+#define BENCH_DEFAULT_JOBS       5000000
+
+// printer_t as it was before the hot/cold split
+typedef struct packed_printer {
+    int id;
+    int current_paper_count;
+    int total_papers_used;
+    int capacity;
+    int jobs_printed_count;
+    unsigned long last_job_completion_time_us;
+    int is_idle;
+} packed_printer_t;
+
+// Pointers into one printer's fields, so both layouts run the same loop
+typedef struct hot_fields {
+    volatile int* current_paper_count;
+    volatile int* is_idle;
+    volatile unsigned long* last_job_completion_time_us;
+    volatile int* total_papers_used;
+    volatile int* jobs_printed_count;
+} hot_fields_t;
+
+typedef struct bench_run {
+    hot_fields_t* printers;
+    int printer_count;
+    long jobs_per_printer;
+    volatile int done;
+} bench_run_t;
+
+typedef struct printer_worker {
+    bench_run_t* run;
+    int index;
+} printer_worker_t;
+
+static void* bench_printer(void* arg) {
+    printer_worker_t* worker = (printer_worker_t*)arg;
+    hot_fields_t* p = &worker->run->printers[worker->index];
+    for (long job = 0; job < worker->run->jobs_per_printer; job++) {
+        *p->is_idle = 0;
+        *p->current_paper_count -= 1;
+        *p->total_papers_used += 1;
+        *p->last_job_completion_time_us = (unsigned long)job;
+        *p->is_idle = 1;
+        *p->jobs_printed_count += 1;
+    }
+    return NULL;
+}
+
+static void* bench_autoscaler(void* arg) {
+    bench_run_t* run = (bench_run_t*)arg;
+    unsigned long idle_seen = 0;
+    while (!run->done) {
+        for (int i = 0; i < run->printer_count; i++) {
+            idle_seen += *run->printers[i].is_idle + *run->printers[i].last_job_completion_time_us;
+        }
+    }
+    return (void*)idle_seen;
+}
+
+static double elapsed_ms(const struct timespec* start, const struct timespec* end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static void run_bench(const char* name, hot_fields_t* printers, int printer_count, long jobs_per_printer) {
+    bench_run_t run = {printers, printer_count, jobs_per_printer, 0};
+    pthread_t* threads = malloc(sizeof(pthread_t) * printer_count);
+    printer_worker_t* workers = malloc(sizeof(printer_worker_t) * printer_count);
+    if (threads == NULL || workers == NULL) {
+        free(threads);
+        free(workers);
+        return;
+    }
+
+    pthread_t autoscaler;
+    struct timespec start, end;
+    pthread_create(&autoscaler, NULL, bench_autoscaler, &run);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < printer_count; i++) {
+        workers[i] = (printer_worker_t){&run, i};
+        pthread_create(&threads[i], NULL, bench_printer, &workers[i]);
+    }
+    for (int i = 0; i < printer_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    run.done = 1;
+    pthread_join(autoscaler, NULL);
+
+    double ms = elapsed_ms(&start, &end);
+    printf("%-8s %8d %12ld %12.1f %14.2f\n", name, printer_count, jobs_per_printer, ms,
+        ms * 1000000.0 / ((double)printer_count * jobs_per_printer));
+    free(threads);
+    free(workers);
+}
+
+int main(int argc, char* argv[]) {
+    int printer_count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_PRINTERS;
+    long jobs_per_printer = argc > 2 ? atol(argv[2]) : BENCH_DEFAULT_JOBS;
+    if (printer_count < 1 || jobs_per_printer < 1) {
+        fprintf(stderr, "Usage: %s [printer_count] [jobs_per_printer]\n", argv[0]);
+        return 1;
+    }
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu_count < 2) {
+        // Exit cleanly so "make bench" goes on to the other benches
+        printf("Skipped: false sharing needs at least 2 online CPUs, this machine has %ld.\n", cpu_count);
+        return 0;
+    }
+
+    packed_printer_t* packed = calloc(printer_count, sizeof(packed_printer_t));
+    printer_instance_t* padded = aligned_alloc(CONFIG_CACHE_LINE_SIZE, sizeof(printer_instance_t) * printer_count);
+    hot_fields_t* fields = malloc(sizeof(hot_fields_t) * printer_count);
+    if (packed == NULL || padded == NULL || fields == NULL) {
+        fprintf(stderr, "Error: allocation failed\n");
+        return 1;
+    }
+
+    printf("%-8s %8s %12s %12s %14s\n", "layout", "printers", "jobs_each", "elapsed_ms", "ns_per_job");
+
+    for (int i = 0; i < printer_count; i++) {
+        fields[i] = (hot_fields_t){&packed[i].current_paper_count, &packed[i].is_idle,
+            &packed[i].last_job_completion_time_us, &packed[i].total_papers_used, &packed[i].jobs_printed_count};
+    }
+    run_bench("packed", fields, printer_count, jobs_per_printer);
+
+    for (int i = 0; i < printer_count; i++) {
+        printer_t* printer = &padded[i].printer;
+        *printer = (printer_t){0};
+        fields[i] = (hot_fields_t){&printer->current_paper_count, &printer->is_idle,
+            &printer->last_job_completion_time_us, &printer->total_papers_used, &printer->jobs_printed_count};
+    }
+    run_bench("padded", fields, printer_count, jobs_per_printer);
+
+    free(packed);
+    free(padded);
+    free(fields);
+    return 0;
+}
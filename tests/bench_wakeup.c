@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+/**
+ * @file bench_wakeup.c
+ * @brief Compares waking the printer pool with pthread_cond_broadcast against
+ * one pthread_cond_signal per job.
+ *
+ * Models the shared job queue wait loop in printer_thread_func: idle printers
+ * block on one condition variable, the receiver adds one job at a time and
+ * wakes them. Reports how many wakeups found the queue already empty and the
+ * process's context switches (getrusage) for each strategy.
+ *
+ * Usage: ./bench_wakeup [printer_count] [job_count]
+ */
+
+#define BENCH_DEFAULT_PRINTERS   16
+#define BENCH_DEFAULT_JOBS       2000
+#define BENCH_INTER_ARRIVAL_US   200 // long enough for every printer to go idle
+#define BENCH_SERVICE_US         50
+
+typedef struct bench_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty_cv;
+    int queued;
+    int done;
+    int use_broadcast;
+    long wakeups; // returns from pthread_cond_wait
+    long empty_wakeups; // wakeups that found no job to take
+} bench_pool_t;
+
+static void* bench_printer(void* arg) {
+    bench_pool_t* pool = (bench_pool_t*)arg;
+    pthread_mutex_lock(&pool->mutex);
+    while (1) {
+        while (pool->queued == 0 && !pool->done) {
+            pthread_cond_wait(&pool->not_empty_cv, &pool->mutex);
+            pool->wakeups++;
+            if (pool->queued == 0 && !pool->done) pool->empty_wakeups++;
+        }
+        if (pool->queued == 0) break; // done and drained
+        pool->queued--;
+        pthread_mutex_unlock(&pool->mutex);
+        usleep(BENCH_SERVICE_US);
+        pthread_mutex_lock(&pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+static long context_switches(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+static void run_bench(const char* name, int use_broadcast, int printer_count, int job_count) {
+    bench_pool_t pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, use_broadcast, 0, 0};
+    pthread_t* printers = malloc(sizeof(pthread_t) * printer_count);
+    if (printers == NULL) return;
+
+    long switches_before = context_switches();
+    for (int i = 0; i < printer_count; i++) {
+        pthread_create(&printers[i], NULL, bench_printer, &pool);
+    }
+    for (int i = 0; i < job_count; i++) {
+        pthread_mutex_lock(&pool.mutex);
+        pool.queued++;
+        if (pool.use_broadcast) {
+            pthread_cond_broadcast(&pool.not_empty_cv);
+        } else {
+            pthread_cond_signal(&pool.not_empty_cv);
+        }
+        pthread_mutex_unlock(&pool.mutex);
+        usleep(BENCH_INTER_ARRIVAL_US);
+    }
+    pthread_mutex_lock(&pool.mutex);
+    pool.done = 1;
+    pthread_cond_broadcast(&pool.not_empty_cv);
+    pthread_mutex_unlock(&pool.mutex);
+    for (int i = 0; i < printer_count; i++) {
+        pthread_join(printers[i], NULL);
+    }
+    long switches = context_switches() - switches_before;
+
+    printf("%-10s %8d %8d %10ld %14ld %18ld\n",
+        name, printer_count, job_count, pool.wakeups, pool.empty_wakeups, switches);
+    free(printers);
+}
+
+int main(int argc, char* argv[]) {
+    int printer_count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_PRINTERS;
+    int job_count = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_JOBS;
+    if (printer_count < 1 || job_count < 1) {
+        fprintf(stderr, "Usage: %s [printer_count] [job_count]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-10s %8s %8s %10s %14s %18s\n",
+        "strategy", "printers", "jobs", "wakeups", "empty_wakeups", "context_switches");
+    run_bench("broadcast", 1, printer_count, job_count);
+    run_bench("signal", 0, printer_count, job_count);
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "ws_deflate.h"
+
+/**
+ * @file bench_ws_deflate.c
+ * @brief Bytes on the wire and CPU per event of permessage-deflate for the
+ * WebSocket event stream.
+ *
+ * Builds the messages a simulation run sends (the formats of
+ * websocket_handler.c: log lines, job and consumer updates, a small jobs_update
+ * queue snapshot and a stats_update every few jobs), then sends them through
+ * ws_deflate one message per frame (protocol 1) and as JSON-array batches
+ * (protocol 2) for several compression levels and windows. Reports frame
+ * bytes on the wire, including WebSocket headers, compression CPU time per
+ * event, and the deflater's memory per connection (zlib's documented
+ * 2^(window+2) + 2^(memLevel+9) bytes).
+ *
+ * Usage: ./bench_ws_deflate [job_count]
+ */
+
+#define BENCH_DEFAULT_JOBS       10000
+#define BENCH_PRINTERS           10
+#define BENCH_BATCH_MESSAGES     20 // about one 20 ms batch window at a busy rate
+#define BENCH_MEM_LEVEL          8
+
+typedef struct bench_stream {
+    char** messages;
+    size_t* lengths;
+    int count;
+    int cap;
+} bench_stream_t;
+
+static void add_message(bench_stream_t* stream, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void add_message(bench_stream_t* stream, const char* fmt, ...) {
+    if (stream->count == stream->cap) {
+        stream->cap = stream->cap > 0 ? stream->cap * 2 : 1024;
+        stream->messages = realloc(stream->messages, sizeof(char*) * stream->cap);
+        stream->lengths = realloc(stream->lengths, sizeof(size_t) * stream->cap);
+    }
+    char buf[1024];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    stream->messages[stream->count] = strdup(buf);
+    stream->lengths[stream->count] = (size_t)len;
+    stream->count++;
+}
+
+/**
+ * @brief The messages of one run, in the order the server would send them.
+ */
+static void build_stream(bench_stream_t* stream, int job_count) {
+    srand(42);
+    double t = 0;
+    for (int id = 1; id <= job_count; id++) {
+        int papers = 5 + rand() % 10;
+        int printer = 1 + rand() % BENCH_PRINTERS;
+        int queue_length = rand() % 6;
+        double inter_arrival = 200 + rand() % 600 + (rand() % 1000) / 1000.0;
+        double queue_wait = (rand() % 5000) / 1000.0;
+        double service = papers * 0.4 + (rand() % 1000) / 1000.0;
+        t += inter_arrival;
+
+        add_message(stream, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d arrives, needs %d papers, inter-arrival time = %.3fms\"}}",
+            t, id, papers, inter_arrival);
+        add_message(stream, "{\"type\":\"job_update\", \"data\":{\"id\":%d, \"papersRequired\":%d}}", id, papers);
+        add_message(stream, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d enters queue, queue length = %d\"}}",
+            t + 0.012, id, queue_length + 1);
+        char jobs[256];
+        int offset = 0;
+        for (int q = 0; q <= queue_length; q++) {
+            offset += snprintf(jobs + offset, sizeof(jobs) - offset, "%s{\"id\":%d, \"papersRequired\":%d}",
+                q > 0 ? ", " : "", id + q, 5 + (id + q) % 10);
+        }
+        add_message(stream, "{\"type\":\"jobs_update\", \"data\":[%s]}", jobs);
+        add_message(stream, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d leaves queue, time in queue = %.3fms, queue_length = %d\"}}",
+            t + queue_wait, id, queue_wait, queue_length);
+        add_message(stream, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d begins service at printer%d, printing %d pages in about %dms\"}}",
+            t + queue_wait, id, printer, papers, (int)service);
+        add_message(stream, "{\"type\":\"consumer_update\", \"data\":{\"id\":%d, \"papersLeft\":%d, \"status\":\"serving\", \"currentJobId\":%d}}",
+            printer, 100 - papers, id);
+        add_message(stream, "{\"type\":\"log\", \"data\":{\"timestamp\":%.3f, \"message\":\"job%d departs from printer%d, service time = %.3fms\"}}",
+            t + queue_wait + service, id, printer, service);
+        add_message(stream, "{\"type\":\"consumer_update\", \"data\":{\"id\":%d, \"papersLeft\":%d, \"status\":\"idle\", \"currentJobId\":null}}",
+            printer, 100 - papers);
+        if (id % 3 == 0) {
+            add_message(stream, "{\"type\":\"stats_update\", \"data\":{\"jobsProcessed\":%d, \"jobsReceived\":%d, \"queueLength\":%d, "
+                "\"avgCompletionTime\":%.2f, \"papersUsed\":%d, \"refillEvents\":%d, \"avgServiceTime\":%.2f}}",
+                id - 1, id, queue_length, 6.5 + (rand() % 100) / 100.0, id * 10, id / 50, 4.0 + (rand() % 100) / 100.0);
+        }
+    }
+}
+
+// Header bytes of an unmasked server frame
+static size_t frame_header_len(size_t len) {
+    return len < 126 ? 2 : len < 65536 ? 4 : 10;
+}
+
+static double cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Send the stream as frames of batch_size messages (1: protocol 1) and
+ * print the bytes on the wire and CPU per event. level 0 sends uncompressed.
+ */
+static void run_bench(const bench_stream_t* stream, int batch_size, int level, int window_bits) {
+    ws_deflate_t d;
+    if (level > 0 && !ws_deflate_init(&d, level, window_bits, BENCH_MEM_LEVEL, FALSE)) {
+        fprintf(stderr, "Error: deflate init failed\n");
+        return;
+    }
+    char* batch = malloc(1024 * (BENCH_BATCH_MESSAGES + 1));
+    size_t wire_bytes = 0;
+    double cpu = 0;
+
+    for (int i = 0; i < stream->count; i += batch_size) {
+        const char* payload = stream->messages[i];
+        size_t len = stream->lengths[i];
+        if (batch_size > 1) { // protocol 2: "[m1,m2,...]"
+            len = 0;
+            batch[len++] = '[';
+            for (int j = i; j < i + batch_size && j < stream->count; j++) {
+                if (j > i) batch[len++] = ',';
+                memcpy(batch + len, stream->messages[j], stream->lengths[j]);
+                len += stream->lengths[j];
+            }
+            batch[len++] = ']';
+            payload = batch;
+        }
+        if (level > 0) {
+            double start = cpu_ns();
+            ws_deflate_compress(&d, payload, len, &len);
+            cpu += cpu_ns() - start;
+        }
+        wire_bytes += frame_header_len(len) + len;
+    }
+
+    static size_t s_raw_bytes[2];
+    int mode = batch_size > 1;
+    if (level == 0) s_raw_bytes[mode] = wire_bytes;
+    size_t memory = level > 0 ? (1u << (window_bits + 2)) + (1u << (BENCH_MEM_LEVEL + 9)) : 0;
+    printf("%-10s %5d %6d %14zu %8.1f%% %12.1f %9zuK\n", batch_size > 1 ? "batched" : "single",
+        level, window_bits, wire_bytes, s_raw_bytes[mode] > 0 ? 100.0 * wire_bytes / s_raw_bytes[mode] : 100.0,
+        cpu / stream->count, memory / 1024);
+
+    free(batch);
+    if (level > 0) ws_deflate_destroy(&d);
+}
+
+int main(int argc, char* argv[]) {
+    int job_count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_JOBS;
+    if (job_count < 1) {
+        fprintf(stderr, "Usage: %s [job_count]\n", argv[0]);
+        return 1;
+    }
+
+    bench_stream_t stream = {0};
+    build_stream(&stream, job_count);
+    size_t payload_bytes = 0;
+    for (int i = 0; i < stream.count; i++) payload_bytes += stream.lengths[i];
+    printf("%d jobs, %d events, %zu bytes of JSON\n\n", job_count, stream.count, payload_bytes);
+
+    static const int levels[] = {1, 3, 6, 9};
+    static const int windows[] = {9, 11, 13, 15};
+    printf("%-10s %5s %6s %14s %9s %12s %10s\n", "framing", "level", "window", "wire_bytes", "of_raw",
+           "cpu_ns_event", "memory");
+    for (int batch_size = 1; batch_size <= BENCH_BATCH_MESSAGES; batch_size += BENCH_BATCH_MESSAGES - 1) {
+        run_bench(&stream, batch_size, 0, 0);
+        for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+            for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+                run_bench(&stream, batch_size, levels[l], windows[w]);
+            }
+        }
+        printf("\n");
+    }
+
+    for (int i = 0; i < stream.count; i++) free(stream.messages[i]);
+    free(stream.messages);
+    free(stream.lengths);
+    return 0;
+}
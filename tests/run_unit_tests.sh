@@ -30,6 +30,19 @@ TESTS=(
     "./test_job_receiver"
     "./test_simulation_stats"
     "./test_timed_queue"
+    "./test_ring_buffer"
+    "./test_hash_index"
+    "./test_job_dispatcher"
+    "./test_log_router"
+    "./test_ws_batch"
+    "./test_ws_outbox"
+    "./test_ws_stats"
+    "./test_ws_deflate"
+    "./test_event_heap"
+    "./test_virtual_engine"
+    "./test_timeutils"
+    "./test_sweep"
+    "./test_worker_pool"
 )
 
 TOTAL_PASSED=0
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "event_heap.h"
+#include "test_utils.h"
+
+#define BULK_COUNT 5000
+
+int test_time_order_and_ties() {
+    printf("\n--- Testing Time Order and Ties ---\n");
+    event_heap_t heap;
+    event_heap_entry_t event;
+    int failed = 0;
+    event_heap_init(&heap, 2);
+
+    // Pushed out of order; the three events at t=20 must come out in push order
+    const unsigned long times[] = {30, 20, 10, 20, 40, 20};
+    for (int i = 0; i < 6; i++) {
+        event_heap_push(&heap, times[i], i, NULL);
+    }
+    const int expected_types[] = {2, 1, 3, 5, 0, 4};
+    for (int i = 0; i < 6; i++) {
+        if (!event_heap_pop(&heap, &event) || event.type != expected_types[i]) {
+            printf("Failed: pop %d returned type %d, expected %d.\n", i, event.type, expected_types[i]);
+            failed = 1;
+        }
+    }
+    if (event_heap_pop(&heap, &event) || event_heap_length(&heap) != 0) {
+        printf("Failed: the heap should be empty.\n");
+        failed = 1;
+    }
+    if (!failed) printf("Passed time order and ties test.\n");
+    event_heap_destroy(&heap);
+    return failed;
+}
+
+int test_interleaved_growth() {
+    printf("\n--- Testing Interleaved Push/Pop With Growth ---\n");
+    event_heap_t heap;
+    event_heap_entry_t event;
+    int failed = 0;
+    event_heap_init(&heap, 4);
+    srand(7);
+
+    // Like the engine: every popped event schedules later ones, never earlier than now
+    unsigned long now = 0;
+    event_heap_push(&heap, 0, 0, NULL);
+    int popped = 0;
+    while (event_heap_pop(&heap, &event)) {
+        if (event.time_us < now) {
+            printf("Failed: event at %lu came after %lu.\n", event.time_us, now);
+            failed = 1;
+            break;
+        }
+        now = event.time_us;
+        if (++popped < BULK_COUNT) {
+            for (int k = 0; k < 1 + rand() % 3 && event_heap_length(&heap) < BULK_COUNT; k++) {
+                event_heap_push(&heap, now + rand() % 1000, 0, NULL);
+            }
+        }
+    }
+    if (!failed && popped < BULK_COUNT) {
+        printf("Failed: only %d events popped.\n", popped);
+        failed = 1;
+    }
+    if (!failed) printf("Passed interleaved growth test (%d events, capacity %d).\n", popped, heap.capacity);
+    event_heap_destroy(&heap);
+    return failed;
+}
+
+int main() {
+    char test_name[] = "EVENT HEAP";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_time_order_and_ties());
+    RUN_TEST(test_interleaved_growth());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "hash_index.h"
+#include "test_utils.h"
+
+#define BULK_COUNT 5000
+
+int test_put_get_remove() {
+    hash_index_t index;
+    hash_index_init(&index, 4);
+    int a = 1, b = 2, c = 3;
+    int failed = 0;
+
+    hash_index_put(&index, 10, &a);
+    hash_index_put(&index, 20, &b);
+    hash_index_put(&index, 10, &c); // replaces the value for key 10
+    if (hash_index_get(&index, 10) != &c || hash_index_get(&index, 20) != &b || index.count != 2) {
+        printf("Failed put/get test.\n");
+        failed = 1;
+    }
+    if (hash_index_remove(&index, 10) != &c || hash_index_get(&index, 10) != NULL
+        || hash_index_remove(&index, 99) != NULL || index.count != 1) {
+        printf("Failed remove test.\n");
+        failed = 1;
+    }
+    if (!failed) printf("Passed hash index put/get/remove test.\n");
+    hash_index_destroy(&index);
+    return failed;
+}
+
+int test_growth_and_probe_runs() {
+    hash_index_t index;
+    hash_index_init(&index, 8);
+    int* values = (int*) malloc(BULK_COUNT * sizeof(int));
+    int failed = 0;
+
+    for (int i = 0; i < BULK_COUNT; i++) {
+        values[i] = i;
+        hash_index_put(&index, i + 1, &values[i]);
+    }
+    // Remove every other key so backward-shift deletion has to repair probe runs
+    for (int i = 0; i < BULK_COUNT; i += 2) {
+        hash_index_remove(&index, i + 1);
+    }
+    for (int i = 0; i < BULK_COUNT; i++) {
+        void* expected = (i % 2 == 0) ? NULL : &values[i];
+        if (hash_index_get(&index, i + 1) != expected) {
+            printf("Failed growth test: wrong value for key %d.\n", i + 1);
+            failed = 1;
+            break;
+        }
+    }
+    if (!failed && (index.count != BULK_COUNT / 2 || index.count * 2 > index.capacity)) {
+        printf("Failed growth test: count %zu, capacity %zu.\n", index.count, index.capacity);
+        failed = 1;
+    }
+    if (!failed) printf("Passed hash index growth test (%d keys, capacity %zu).\n", BULK_COUNT, index.capacity);
+    hash_index_destroy(&index);
+    free(values);
+    return failed;
+}
+
+int main() {
+    char test_name[] = "HASH INDEX";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_put_get_remove());
+    RUN_TEST(test_growth_and_probe_runs());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
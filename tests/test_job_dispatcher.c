@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "job_dispatcher.h"
+#include "linked_list.h"
+#include "test_utils.h"
+
+#define TEST_DEQUE_COUNT 5
+
+typedef struct dispatch_item {
+    int id;
+    list_node_t node;
+} dispatch_item_t;
+
+static int dispatch_item_key(const list_node_t* node) {
+    return list_entry(node, dispatch_item_t, node)->id;
+}
+
+static int item_id(list_node_t* node) {
+    return node == NULL ? -1 : list_entry(node, dispatch_item_t, node)->id;
+}
+
+static void init_items(dispatch_item_t* items, int count) {
+    for (int i = 0; i < count; i++) {
+        items[i] = (dispatch_item_t){i + 1, {0}};
+    }
+}
+
+int test_round_robin_placement() {
+    printf("\n--- Testing Round-Robin Placement ---\n");
+    job_dispatcher_t d;
+    dispatch_item_t items[6];
+    list_node_t* out[4];
+    int failed = 0;
+    init_items(items, 6);
+    if (!job_dispatcher_init(&d, JOB_DISPATCH_ROUND_ROBIN, TEST_DEQUE_COUNT, dispatch_item_key, 8)) {
+        printf("Failed dispatcher init test.\n");
+        return 1;
+    }
+    job_dispatcher_open(&d, 0);
+    job_dispatcher_open(&d, 2); // deque 1 stays closed
+
+    for (int i = 0; i < 6; i++) {
+        int idx = job_dispatcher_push(&d, &items[i].node);
+        if (idx != (i % 2 == 0 ? 0 : 2)) {
+            printf("Failed: item %d went to deque %d.\n", i + 1, idx);
+            failed = 1;
+        }
+    }
+    if (job_dispatcher_length(&d) != 6) {
+        printf("Failed: total length should be 6 (got %d).\n", job_dispatcher_length(&d));
+        failed = 1;
+    }
+
+    // The owner takes its own deque front first: items 1, 3, 5
+    int count = job_dispatcher_take(&d, 0, out, 4, NULL, NULL);
+    if (count != 3 || item_id(out[0]) != 1 || item_id(out[1]) != 3 || item_id(out[2]) != 5) {
+        printf("Failed: take did not return deque 0 in FIFO order.\n");
+        failed = 1;
+    }
+
+    job_dispatcher_destroy(&d);
+    if (!failed) printf("Passed round-robin placement test.\n");
+    return failed;
+}
+
+int test_shortest_queue_placement() {
+    printf("\n--- Testing Shortest-Queue Placement ---\n");
+    job_dispatcher_t d;
+    dispatch_item_t items[5];
+    list_node_t* out[4];
+    int failed = 0;
+    init_items(items, 5);
+    job_dispatcher_init(&d, JOB_DISPATCH_SHORTEST_QUEUE, TEST_DEQUE_COUNT, dispatch_item_key, 8);
+    job_dispatcher_open(&d, 0);
+    job_dispatcher_open(&d, 1);
+
+    job_dispatcher_push(&d, &items[0].node); // deque 0
+    job_dispatcher_push(&d, &items[1].node); // deque 1
+    job_dispatcher_take(&d, 1, out, 1, NULL, NULL); // deque 1 drains
+    // Deque 1 is now shorter, so the next two land there before deque 0 gets another
+    int a = job_dispatcher_push(&d, &items[2].node);
+    int b = job_dispatcher_push(&d, &items[3].node);
+    int c = job_dispatcher_push(&d, &items[4].node);
+    if (a != 1 || b != 0 || c != 1) {
+        printf("Failed: shortest-queue placement went to %d, %d, %d (expected 1, 0, 1).\n", a, b, c);
+        failed = 1;
+    }
+
+    job_dispatcher_destroy(&d);
+    if (!failed) printf("Passed shortest-queue placement test.\n");
+    return failed;
+}
+
+static int accept_below_four(list_node_t* node, void* ctx) {
+    (void)ctx;
+    return list_entry(node, dispatch_item_t, node)->id < 4;
+}
+
+int test_steal_from_back() {
+    printf("\n--- Testing Work Stealing ---\n");
+    job_dispatcher_t d;
+    dispatch_item_t items[5];
+    int failed = 0;
+    init_items(items, 5);
+    job_dispatcher_init(&d, JOB_DISPATCH_ROUND_ROBIN, TEST_DEQUE_COUNT, dispatch_item_key, 8);
+    job_dispatcher_open(&d, 0);
+
+    for (int i = 0; i < 3; i++) job_dispatcher_push(&d, &items[i].node); // deque 0: 1 2 3
+    job_dispatcher_open(&d, 1);
+
+    // Printer 2 has nothing; it steals the newest job from the back of deque 0
+    list_node_t* stolen = job_dispatcher_steal(&d, 1, NULL, NULL);
+    if (item_id(stolen) != 3 || job_dispatcher_length(&d) != 2) {
+        printf("Failed: steal should take item 3 from the back (got %d).\n", item_id(stolen));
+        failed = 1;
+    }
+    if (job_dispatcher_steal(&d, 0, NULL, NULL) != NULL) {
+        printf("Failed: a printer must not steal from its own deque.\n");
+        failed = 1;
+    }
+
+    // A victim whose back job is rejected is skipped
+    job_dispatcher_push(&d, &items[3].node);
+    job_dispatcher_push(&d, &items[4].node);
+    stolen = job_dispatcher_steal(&d, 1, accept_below_four, NULL);
+    if (stolen != NULL && item_id(stolen) >= 4) {
+        printf("Failed: steal ignored the accept filter.\n");
+        failed = 1;
+    }
+
+    job_dispatcher_destroy(&d);
+    if (!failed) printf("Passed work stealing test.\n");
+    return failed;
+}
+
+static void count_drained(list_node_t* node, void* ctx) {
+    (void)node;
+    (*(int*)ctx)++;
+}
+
+/**
+ * @brief Checks that a deque holds exactly the given item ids, front to back.
+ */
+static int deque_holds(job_dispatcher_t* d, int idx, const int* ids, int count) {
+    timed_queue_t* queue = &d->deques[idx].queue;
+    list_node_t* node = timed_queue_head(queue);
+    for (int i = 0; i < count; i++, node = timed_queue_next(queue, node)) {
+        if (item_id(node) != ids[i]) return FALSE;
+    }
+    return node == NULL;
+}
+
+int test_close_and_rebalance() {
+    printf("\n--- Testing Close and Rebalance ---\n");
+    job_dispatcher_t d;
+    dispatch_item_t items[8];
+    int failed = 0;
+    init_items(items, 8);
+    job_dispatcher_init(&d, JOB_DISPATCH_ROUND_ROBIN, TEST_DEQUE_COUNT, dispatch_item_key, 8);
+    job_dispatcher_open(&d, 0);
+    for (int i = 0; i < 8; i++) job_dispatcher_push(&d, &items[i].node);
+
+    // Scale up: a new printer's deque gets half of the backlog
+    job_dispatcher_open(&d, 1);
+    int moved = job_dispatcher_rebalance(&d);
+    if (moved != 4 || atomic_load(&d.deques[0].depth) != 4 || atomic_load(&d.deques[1].depth) != 4) {
+        printf("Failed: rebalance moved %d jobs (expected 4 to even out 8).\n", moved);
+        failed = 1;
+    }
+    const int kept[] = {1, 2, 3, 4};
+    const int taken[] = {5, 6, 7, 8};
+    if (!deque_holds(&d, 0, kept, 4) || !deque_holds(&d, 1, taken, 4)) {
+        printf("Failed: rebalanced jobs should keep their arrival order.\n");
+        failed = 1;
+    }
+
+    // Scale down: the closed deque's jobs move to the remaining printer
+    moved = job_dispatcher_close(&d, 1);
+    if (moved != 4 || atomic_load(&d.deques[0].depth) != 8 || job_dispatcher_length(&d) != 8) {
+        printf("Failed: close moved %d jobs (expected 4).\n", moved);
+        failed = 1;
+    }
+    const int all[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    if (!deque_holds(&d, 0, all, 8)) {
+        printf("Failed: jobs moved on close should keep their arrival order.\n");
+        failed = 1;
+    }
+
+    // Cancel by id wherever the job lives, then drain the rest
+    if (item_id(job_dispatcher_remove_by_id(&d, 5)) != 5 || job_dispatcher_remove_by_id(&d, 5) != NULL) {
+        printf("Failed: remove_by_id did not find item 5 exactly once.\n");
+        failed = 1;
+    }
+    int drained = 0;
+    if (job_dispatcher_drain(&d, count_drained, &drained) != 7 || drained != 7
+        || job_dispatcher_length(&d) != 0) {
+        printf("Failed: drain should remove the 7 remaining jobs (got %d).\n", drained);
+        failed = 1;
+    }
+
+    job_dispatcher_destroy(&d);
+    if (!failed) printf("Passed close and rebalance test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "JOB DISPATCHER";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_round_robin_placement());
+    RUN_TEST(test_shortest_queue_placement());
+    RUN_TEST(test_steal_from_back());
+    RUN_TEST(test_close_and_rebalance());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -144,6 +144,84 @@ int test_append_left_check(linked_list_t* list, int* d) {
     }
 }
 
+int test_node_pool_reuse() {
+    linked_list_t pool_list;
+    list_init(&pool_list);
+    int values[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    int failed = 0;
+
+    // Warm-up: the first appends have to malloc
+    for (int i = 0; i < 8; i++) list_append(&pool_list, &values[i]);
+    while (!list_is_empty(&pool_list)) list_release_node(&pool_list, list_pop_left(&pool_list));
+    unsigned long warm_misses = pool_list.pool_misses;
+    unsigned long warm_hits = pool_list.pool_hits;
+
+    // Steady state: every append/append_left must be served from the pool
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < 4; i++) list_append(&pool_list, &values[i]);
+        for (int i = 4; i < 8; i++) list_append_left(&pool_list, &values[i]);
+        list_remove(&pool_list, list_find(&pool_list, &values[0]));
+        while (!list_is_empty(&pool_list)) list_release_node(&pool_list, list_pop(&pool_list));
+    }
+
+    printf("Pool after warm-up: %lu hits, %lu misses\n", warm_hits, warm_misses);
+    printf("Pool after 8000 appends: %lu hits, %lu misses\n", pool_list.pool_hits, pool_list.pool_misses);
+    if (warm_misses != 8 || pool_list.pool_misses != warm_misses
+        || pool_list.pool_hits != warm_hits + 8000) {
+        printf("Failed node pool test: appends still allocate after warm-up.\n");
+        failed = 1;
+    } else {
+        printf("Passed node pool test: no per-op malloc after warm-up.\n");
+    }
+
+    list_destroy(&pool_list);
+    if (pool_list.free_nodes != NULL || pool_list.free_count != 0) {
+        printf("Failed node pool test: list_destroy left pooled nodes behind.\n");
+        failed = 1;
+    }
+    return failed;
+}
+
+typedef struct intrusive_item {
+    int value;
+    list_node_t node;
+} intrusive_item_t;
+
+int test_intrusive_list() {
+    linked_list_t list;
+    list_init_intrusive(&list);
+    intrusive_item_t items[3] = {{1}, {2}, {3}};
+    int failed = 0;
+
+    if (list_append(&list, &items[0]) != FALSE) {
+        printf("Failed: list_append should fail on an intrusive list.\n");
+        failed = 1;
+    }
+    list_append_node(&list, &items[1].node);
+    list_append_node(&list, &items[2].node);
+    list_append_node_left(&list, &items[0].node);
+
+    int expected = 1;
+    for (list_node_t* curr = list_first(&list); curr != NULL; curr = list_next(&list, curr)) {
+        if (list_entry(curr, intrusive_item_t, node)->value != expected++) {
+            printf("Failed: intrusive list order is wrong.\n");
+            failed = 1;
+        }
+    }
+
+    list_remove(&list, &items[1].node);
+    list_node_t* popped = list_pop_left(&list);
+    list_release_node(&list, popped); // no-op: the item owns its node
+    if (popped != &items[0].node || list_length(&list) != 1 || list.pool_misses != 0) {
+        printf("Failed: intrusive remove/pop returned the wrong node or allocated.\n");
+        failed = 1;
+    }
+
+    list_destroy(&list); // must not free the embedded nodes
+    if (!failed) printf("Passed intrusive list test: no node allocations.\n");
+    return failed;
+}
+
 int main() {
     char test_name[] = "LINKED LIST";
     print_test_start(test_name);
@@ -170,7 +248,7 @@ int main() {
     // Test popping elements
     list_node_t* popped = test_list_pop(&list);
     printf("Popped element, should be 3: %d\n", *(int*)popped->data);
-    free(popped);
+    list_release_node(&list, popped);
     
     // Test if list is empty
     printf("List is empty, should be 0: %d\n", test_list_is_empty(&list));
@@ -187,6 +265,13 @@ int main() {
 
     // Test if list is empty
     printf("List is empty, should be 1: %d\n", test_list_is_empty(&list));
+    list_destroy(&list);
+
+    // Test node pool recycling
+    RUN_TEST(test_node_pool_reuse());
+
+    // Test caller-owned (intrusive) nodes
+    RUN_TEST(test_intrusive_list());
 
     int passed_tests = total_tests - failed_tests;
     print_test_end(test_name, passed_tests, failed_tests);
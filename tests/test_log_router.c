@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "config.h"
+#include "job_receiver.h"
+#include "log_router.h"
+#include "printer.h"
+#include "simulation_stats.h"
+#include "test_utils.h"
+
+#define PRODUCER_COUNT 4
+// More events than the record pool holds, so producers have to wait for the formatter
+#define EVENTS_PER_PRODUCER (CONFIG_LOG_EVENT_QUEUE_CAPACITY)
+#define TOTAL_EVENTS (PRODUCER_COUNT * EVENTS_PER_PRODUCER)
+
+// What the test backend has seen, written only by the thread that formats events
+static log_event_t s_last_event;
+static int s_job_updates[TOTAL_EVENTS];
+static int s_job_update_count = 0;
+static int s_updates_before_end = -1;
+static int s_stats_updates = 0;
+static int s_last_stats_queue_length = -1;
+static int s_last_event_session = -1;
+static int s_stats_session_queue_length[CONFIG_LOG_MAX_SESSIONS];
+static pthread_t s_formatting_thread;
+
+static void record_event(const log_event_t* event) {
+    s_last_event = *event;
+    s_last_event_session = log_router_session();
+    s_formatting_thread = pthread_self();
+}
+
+static void record_job_update(const log_event_t* event) {
+    if (s_job_update_count < TOTAL_EVENTS) s_job_updates[s_job_update_count] = event->job_id;
+    s_job_update_count++;
+    s_formatting_thread = pthread_self();
+}
+
+static void record_stats_update(const log_event_t* event) {
+    s_stats_updates++;
+    s_last_stats_queue_length = event->queue_length;
+    s_stats_session_queue_length[log_router_session()] = event->queue_length;
+}
+
+static void record_simulation_end(simulation_statistics_t* stats) {
+    (void)stats;
+    s_updates_before_end = s_job_update_count;
+}
+
+static const log_ops_t s_test_ops = {
+    .simulation_end = record_simulation_end,
+    .system_arrival = record_event,
+    .system_departure = record_event,
+    .job_update = record_job_update,
+    .stats_update = record_stats_update,
+};
+
+static void* produce_job_updates(void* arg) {
+    int producer = *(int*)arg;
+    job_t job = {0};
+    for (int i = 0; i < EVENTS_PER_PRODUCER; i++) {
+        job.id = producer * EVENTS_PER_PRODUCER + i;
+        emit_job_update(&job);
+    }
+    return NULL;
+}
+
+int test_synchronous_without_formatter() {
+    printf("\n--- Testing Synchronous Routing ---\n");
+    simulation_statistics_t stats;
+    simulation_stats_init(&stats, 2);
+    int failed = 0;
+
+    job_t job = {0};
+    job.id = 7;
+    job.papers_required = 12;
+    job.system_arrival_time_us = 5000;
+    emit_system_arrival(&job, 3000, &stats);
+    if (s_last_event.type != LOG_EVENT_SYSTEM_ARRIVAL || s_last_event.job_id != 7 || s_last_event.papers != 12
+        || s_last_event.time_us != 5000 || s_last_event.duration_us != 2000
+        || !pthread_equal(s_formatting_thread, pthread_self())) {
+        printf("Failed: arrival was not formatted on the caller's thread with the job's fields.\n");
+        failed = 1;
+    }
+
+    // The router keeps the statistics, whatever the backend does with the event
+    printer_t printer = {0};
+    printer.id = 2;
+    job.queue_arrival_time_us = 6000;
+    job.queue_departure_time_us = 7000;
+    job.service_arrival_time_us = 7000;
+    job.service_departure_time_us = 9500;
+    emit_system_departure(&job, &printer, &stats);
+    simulation_statistics_t snapshot;
+    simulation_stats_snapshot(&stats, &snapshot);
+    if (snapshot.total_jobs_arrived != 1 || snapshot.total_jobs_served != 1
+        || simulation_stats_printer(&snapshot, 2)->paper_used != 12 || s_last_event.duration_us != 2500) {
+        printf("Failed: router did not count the arrival and departure.\n");
+        failed = 1;
+    }
+
+    simulation_stats_destroy(&stats);
+    if (!failed) printf("Passed synchronous routing test.\n");
+    return failed;
+}
+
+int test_no_subscriber_skips_formatting() {
+    printf("\n--- Testing No-Subscriber Fast Path ---\n");
+    simulation_statistics_t stats;
+    simulation_stats_init(&stats, 1);
+    int failed = 0;
+
+    s_last_event = (log_event_t){0};
+    log_router_set_subscribed(FALSE);
+    job_t job = {0};
+    job.id = 9;
+    job.system_arrival_time_us = 1000;
+    emit_system_arrival(&job, 0, &stats);
+    log_router_set_subscribed(TRUE);
+
+    simulation_statistics_t snapshot;
+    simulation_stats_snapshot(&stats, &snapshot);
+    if (s_last_event.type != 0) {
+        printf("Failed: an event reached the backend with no subscriber.\n");
+        failed = 1;
+    }
+    if (snapshot.total_jobs_arrived != 1) {
+        printf("Failed: statistics were skipped along with the event.\n");
+        failed = 1;
+    }
+
+    simulation_stats_destroy(&stats);
+    if (!failed) printf("Passed no-subscriber fast path test.\n");
+    return failed;
+}
+
+int test_formatter_drains_in_order() {
+    printf("\n--- Testing Formatter Thread ---\n");
+    int failed = 0;
+    if (!log_router_start()) {
+        printf("Failed to start the formatter thread.\n");
+        return 1;
+    }
+
+    pthread_t producers[PRODUCER_COUNT];
+    int indexes[PRODUCER_COUNT];
+    for (int i = 0; i < PRODUCER_COUNT; i++) {
+        indexes[i] = i;
+        pthread_create(&producers[i], NULL, produce_job_updates, &indexes[i]);
+    }
+    for (int i = 0; i < PRODUCER_COUNT; i++) {
+        pthread_join(producers[i], NULL);
+    }
+
+    // Lifecycle events run on the caller's thread only after everything queued before them
+    simulation_statistics_t stats;
+    simulation_stats_init(&stats, 1);
+    emit_simulation_end(&stats);
+    if (s_updates_before_end != TOTAL_EVENTS) {
+        printf("Failed: simulation_end ran after %d of %d job updates.\n", s_updates_before_end, TOTAL_EVENTS);
+        failed = 1;
+    }
+    if (pthread_equal(s_formatting_thread, pthread_self())) {
+        printf("Failed: job updates were formatted on the caller's thread.\n");
+        failed = 1;
+    }
+
+    // Each producer's events come out in the order it emitted them
+    int next_expected[PRODUCER_COUNT] = {0};
+    for (int i = 0; i < TOTAL_EVENTS && !failed; i++) {
+        int producer = s_job_updates[i] / EVENTS_PER_PRODUCER;
+        int sequence = s_job_updates[i] % EVENTS_PER_PRODUCER;
+        if (sequence != next_expected[producer]++) {
+            printf("Failed: producer %d event %d was formatted out of order.\n", producer, sequence);
+            failed = 1;
+        }
+    }
+
+    log_router_stop();
+    simulation_stats_destroy(&stats);
+    if (!failed) printf("Passed formatter thread test (%d events from %d threads).\n", TOTAL_EVENTS, PRODUCER_COUNT);
+    return failed;
+}
+
+int test_stats_published_on_tick() {
+    printf("\n--- Testing Stats Tick ---\n");
+    int failed = 0;
+    if (!log_router_start()) {
+        printf("Failed to start the formatter thread.\n");
+        return 1;
+    }
+    simulation_statistics_t stats;
+    simulation_stats_init(&stats, 1);
+
+    // A burst of updates well inside one publish interval
+    s_stats_updates = 0;
+    for (int i = 1; i <= 1000; i++) {
+        emit_stats_update(&stats, i);
+    }
+    log_router_flush();
+    if (s_stats_updates < 1 || s_stats_updates > 2) {
+        printf("Failed: 1000 updates in one tick were published %d times.\n", s_stats_updates);
+        failed = 1;
+    }
+    // The flush publishes the latest values even if the tick has not come yet
+    if (s_last_stats_queue_length != 1000) {
+        printf("Failed: last published queue length is %d, not 1000.\n", s_last_stats_queue_length);
+        failed = 1;
+    }
+    log_router_flush();
+    if (s_stats_updates > 2) {
+        printf("Failed: a flush with nothing dirty published stats again.\n");
+        failed = 1;
+    }
+
+    log_router_stop();
+    simulation_stats_destroy(&stats);
+    if (!failed) printf("Passed stats tick test (published %d time(s) for 1000 updates).\n", s_stats_updates);
+    return failed;
+}
+
+int test_sessions_routed_separately() {
+    printf("\n--- Testing Sessions ---\n");
+    int failed = 0;
+    if (!log_router_start()) {
+        printf("Failed to start the formatter thread.\n");
+        return 1;
+    }
+    simulation_statistics_t stats;
+    simulation_stats_init(&stats, 1);
+    job_t job = {0};
+    job.system_arrival_time_us = 1000;
+
+    // The formatter hands each event to the backend under the session it was emitted in
+    s_last_event = (log_event_t){0};
+    log_router_bind_session(2);
+    job.id = 21;
+    emit_system_arrival(&job, 0, &stats);
+    log_router_flush();
+    if (s_last_event.job_id != 21 || s_last_event.session_id != 2 || s_last_event_session != 2) {
+        printf("Failed: event of session 2 was seen as job %d of session %d (backend saw %d).\n",
+               s_last_event.job_id, s_last_event.session_id, s_last_event_session);
+        failed = 1;
+    }
+
+    // Unsubscribing one session skips its events only
+    log_router_set_session_subscribed(2, FALSE);
+    job.id = 22;
+    emit_system_arrival(&job, 0, &stats);
+    log_router_flush();
+    log_router_bind_session(1);
+    job.id = 11;
+    emit_system_arrival(&job, 0, &stats);
+    log_router_flush();
+    if (s_last_event.job_id != 11 || s_last_event_session != 1) {
+        printf("Failed: expected job 11 of session 1 last, got job %d of session %d.\n",
+               s_last_event.job_id, s_last_event_session);
+        failed = 1;
+    }
+    log_router_set_session_subscribed(2, TRUE);
+
+    // Each session's latest stats are published under that session
+    for (int i = 0; i < CONFIG_LOG_MAX_SESSIONS; i++) s_stats_session_queue_length[i] = -1;
+    emit_stats_update(&stats, 10);
+    log_router_bind_session(2);
+    emit_stats_update(&stats, 20);
+    log_router_flush();
+    log_router_bind_session(1);
+    log_router_flush();
+    if (s_stats_session_queue_length[1] != 10 || s_stats_session_queue_length[2] != 20) {
+        printf("Failed: session stats were published as %d and %d, not 10 and 20.\n",
+               s_stats_session_queue_length[1], s_stats_session_queue_length[2]);
+        failed = 1;
+    }
+
+    // Out-of-range sessions are ignored
+    log_router_bind_session(CONFIG_LOG_MAX_SESSIONS);
+    if (log_router_session() != 1) {
+        printf("Failed: binding an out-of-range session changed the session.\n");
+        failed = 1;
+    }
+
+    log_router_bind_session(0);
+    log_router_stop();
+    simulation_stats_destroy(&stats);
+    if (!failed) printf("Passed sessions test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "LOG ROUTER";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    log_router_register_console_handler(&s_test_ops);
+    set_log_mode(LOG_MODE_TERMINAL);
+
+    RUN_TEST(test_synchronous_without_formatter());
+    RUN_TEST(test_no_subscriber_skips_formatting());
+    RUN_TEST(test_formatter_drains_in_order());
+    RUN_TEST(test_stats_published_on_tick());
+    RUN_TEST(test_sessions_routed_separately());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "ring_buffer.h"
+#include "test_utils.h"
+
+#define PRODUCER_COUNT 4
+#define CONSUMER_COUNT 4
+#define ITEMS_PER_PRODUCER 20000
+
+typedef struct mpmc_args {
+    ring_buffer_t* rb;
+    int producer_index;
+    atomic_int* consumed_count;
+    atomic_long* consumed_sum;
+} mpmc_args_t;
+
+int test_ring_init_rounds_capacity() {
+    ring_buffer_t rb;
+    if (!ring_buffer_init(&rb, 5)) {
+        printf("Failed ring init test.\n");
+        return 1;
+    }
+    int failed = 0;
+    if (rb.capacity == 8) {
+        printf("Passed ring capacity rounding test (5 -> 8).\n");
+    } else {
+        printf("Failed ring capacity rounding test (got %zu).\n", rb.capacity);
+        failed = 1;
+    }
+    ring_buffer_destroy(&rb);
+    return failed;
+}
+
+int test_ring_fifo_order() {
+    ring_buffer_t rb;
+    ring_buffer_init(&rb, 4);
+    int values[4] = {1, 2, 3, 4};
+    int failed = 0;
+
+    for (int i = 0; i < 4; i++) {
+        ring_buffer_push(&rb, &values[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        int* popped = (int*) ring_buffer_pop(&rb);
+        if (popped == NULL || *popped != values[i]) {
+            printf("Failed FIFO order test at position %d.\n", i);
+            failed = 1;
+        }
+    }
+    if (!failed) printf("Passed ring FIFO order test.\n");
+    ring_buffer_destroy(&rb);
+    return failed;
+}
+
+int test_ring_full_and_empty() {
+    ring_buffer_t rb;
+    ring_buffer_init(&rb, 2);
+    int a = 1, b = 2, c = 3;
+    int failed = 0;
+
+    if (ring_buffer_pop(&rb) != NULL) {
+        printf("Failed: pop from empty ring should return NULL.\n");
+        failed = 1;
+    }
+    ring_buffer_push(&rb, &a);
+    ring_buffer_push(&rb, &b);
+    if (ring_buffer_push(&rb, &c) != FALSE) {
+        printf("Failed: push to full ring should return 0.\n");
+        failed = 1;
+    }
+    if (ring_buffer_length(&rb) != 2) {
+        printf("Failed: full ring length should be 2 (got %d).\n", ring_buffer_length(&rb));
+        failed = 1;
+    }
+    if (ring_buffer_peek_at(&rb, 1) != &b || ring_buffer_peek_at(&rb, 2) != NULL) {
+        printf("Failed: peek_at returned the wrong slot.\n");
+        failed = 1;
+    }
+    if (!failed) printf("Passed ring full/empty test.\n");
+    ring_buffer_destroy(&rb);
+    return failed;
+}
+
+static void* producer_func(void* arg) {
+    mpmc_args_t* args = (mpmc_args_t*) arg;
+    for (long i = 1; i <= ITEMS_PER_PRODUCER; i++) {
+        long value = args->producer_index * ITEMS_PER_PRODUCER + i;
+        while (!ring_buffer_push(args->rb, (void*) value)) {
+            // Ring full; spin until a consumer frees a slot
+        }
+    }
+    return NULL;
+}
+
+static void* consumer_func(void* arg) {
+    mpmc_args_t* args = (mpmc_args_t*) arg;
+    const int total = PRODUCER_COUNT * ITEMS_PER_PRODUCER;
+    while (atomic_load(args->consumed_count) < total) {
+        void* data = ring_buffer_pop(args->rb);
+        if (data != NULL) {
+            atomic_fetch_add(args->consumed_sum, (long) data);
+            atomic_fetch_add(args->consumed_count, 1);
+        }
+    }
+    return NULL;
+}
+
+int test_ring_mpmc() {
+    ring_buffer_t rb;
+    ring_buffer_init(&rb, 256);
+    atomic_int consumed_count = 0;
+    atomic_long consumed_sum = 0;
+    pthread_t producers[PRODUCER_COUNT];
+    pthread_t consumers[CONSUMER_COUNT];
+    mpmc_args_t producer_args[PRODUCER_COUNT];
+    mpmc_args_t consumer_args = {&rb, 0, &consumed_count, &consumed_sum};
+
+    for (int i = 0; i < CONSUMER_COUNT; i++) {
+        pthread_create(&consumers[i], NULL, consumer_func, &consumer_args);
+    }
+    for (int i = 0; i < PRODUCER_COUNT; i++) {
+        producer_args[i] = (mpmc_args_t){&rb, i, &consumed_count, &consumed_sum};
+        pthread_create(&producers[i], NULL, producer_func, &producer_args[i]);
+    }
+    for (int i = 0; i < PRODUCER_COUNT; i++) pthread_join(producers[i], NULL);
+    for (int i = 0; i < CONSUMER_COUNT; i++) pthread_join(consumers[i], NULL);
+
+    long n = (long) PRODUCER_COUNT * ITEMS_PER_PRODUCER;
+    long expected_sum = n * (n + 1) / 2;
+    int failed = 0;
+    if (atomic_load(&consumed_sum) == expected_sum && ring_buffer_length(&rb) == 0) {
+        printf("Passed MPMC test (%ld items, every item consumed exactly once).\n", n);
+    } else {
+        printf("Failed MPMC test (sum %ld, expected %ld).\n", atomic_load(&consumed_sum), expected_sum);
+        failed = 1;
+    }
+    ring_buffer_destroy(&rb);
+    return failed;
+}
+
+int main() {
+    char test_name[] = "RING BUFFER";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_ring_init_rounds_capacity());
+    RUN_TEST(test_ring_fifo_order());
+    RUN_TEST(test_ring_full_and_empty());
+    RUN_TEST(test_ring_mpmc());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -148,7 +148,7 @@ class ServerIntegrationTest:
             # Check config fields
             config = data.get("config", {})
             expected_fields = [
-                "printRate", "consumerCount", "autoScaling", "refillRate",
+                "printRate", "consumerCount", "maxConsumers", "autoScaling", "refillRate",
                 "paperCapacity", "jobArrivalTime", "jobCount", "maxQueue",
                 "minPapers", "maxPapers"
             ]
@@ -1,11 +1,17 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "test_utils.h"
 #include "simulation_stats.h"
 
 int test_create_simulation_stats(simulation_statistics_t* stats) {
-    *stats = (simulation_statistics_t){0};
+    if (!simulation_stats_init(stats, 5)) {
+        printf("Failed to allocate printer statistics\n");
+        return 1;
+    }
 
     // Simulate some statistics
     stats->simulation_start_time_us = 0;
@@ -20,9 +26,14 @@ int test_create_simulation_stats(simulation_statistics_t* stats) {
     stats->total_queue_wait_time_us = 400000; // total wait time in queue
     stats->area_num_in_job_queue_us = 2000000; // integral of queue length over time
     stats->max_job_queue_length = 5;
-    // total jobs served by printer [1-5]
-    // total service time for printer [1-5]
-    // paper empty time for printer [1-5]
+    // jobs served, paper used and service time of printers 1 and 2
+    simulation_stats_printer(stats, 1)->jobs_served = 5;
+    simulation_stats_printer(stats, 1)->paper_used = 50;
+    simulation_stats_printer(stats, 1)->total_service_time_us = 500000;
+    simulation_stats_printer(stats, 2)->jobs_served = 3;
+    simulation_stats_printer(stats, 2)->paper_used = 30;
+    simulation_stats_printer(stats, 2)->total_service_time_us = 300000;
+    stats->max_printers_used = 2;
     stats->paper_refill_events = 2;
     stats->total_refill_service_time_us = 20000; // total refill service time
     stats->papers_refilled = 15;
@@ -59,6 +70,147 @@ int test_log_statistics(simulation_statistics_t* stats) {
     return 0;
 }
 
+int test_large_printer_pool() {
+    printf("\n--- Testing Statistics for a Large Printer Pool ---\n");
+    int failed = 0;
+    int printer_count = 300;
+    simulation_statistics_t stats;
+    if (!simulation_stats_init(&stats, printer_count)) {
+        printf("Failed to allocate printer statistics\n");
+        return 1;
+    }
+
+    // Records are padded so neighbouring printers never share a cache line
+    printer_statistics_t* first = simulation_stats_printer(&stats, 1);
+    printer_statistics_t* second = simulation_stats_printer(&stats, 2);
+    if ((uintptr_t)first % CONFIG_CACHE_LINE_SIZE != 0
+        || (char*)second - (char*)first < CONFIG_CACHE_LINE_SIZE) {
+        printf("Failed: printer records are not cache-line padded\n");
+        failed = 1;
+    }
+    if (simulation_stats_printer(&stats, 0) != NULL || simulation_stats_printer(&stats, printer_count + 1) != NULL) {
+        printf("Failed: ids outside the pool should have no record\n");
+        failed = 1;
+    }
+
+    for (int id = 1; id <= printer_count; id++) {
+        simulation_stats_printer(&stats, id)->jobs_served = 1;
+        simulation_stats_printer(&stats, id)->paper_used = 10;
+    }
+    stats.max_printers_used = printer_count;
+    stats.total_jobs_served = printer_count;
+    if (calculate_total_papers_used(&stats) != 10 * printer_count) {
+        printf("Failed: total papers used should be %d\n", 10 * printer_count);
+        failed = 1;
+    }
+
+    // The JSON report grows with the pool; a fixed small buffer is rejected rather than overrun
+    int buf_size = statistics_buffer_size(&stats);
+    char* buf = malloc(buf_size);
+    char small_buf[1024];
+    if (buf == NULL || write_statistics_to_buffer(&stats, buf, buf_size) <= 0
+        || strstr(buf, "\"id\":300,") == NULL) {
+        printf("Failed: statistics for %d printers did not fit the sized buffer\n", printer_count);
+        failed = 1;
+    }
+    if (write_statistics_to_buffer(&stats, small_buf, sizeof(small_buf)) != -1) {
+        printf("Failed: a too-small buffer should be reported as an error\n");
+        failed = 1;
+    }
+    free(buf);
+    simulation_stats_destroy(&stats);
+
+    if (!failed) printf("Passed large printer pool statistics test.\n");
+    return failed;
+}
+
+#define SHARD_TEST_PRINTERS 4
+#define SHARD_TEST_JOBS     10000
+
+typedef struct shard_worker {
+    simulation_statistics_t* stats;
+    int printer_id;
+} shard_worker_t;
+
+static void* count_on_own_shard(void* arg) {
+    shard_worker_t* worker = (shard_worker_t*)arg;
+    simulation_stats_bind_shard(worker->stats, STATS_SHARD_PRINTER(worker->printer_id));
+    for (int i = 0; i < SHARD_TEST_JOBS; i++) {
+        simulation_stats_count_departure(worker->stats, i % MAX_JOB_CLASSES, 10, 20);
+        simulation_stats_count_printed(worker->stats, worker->printer_id, 2, 5);
+    }
+    simulation_stats_record_queue_length(worker->stats, worker->printer_id * 10);
+    return NULL;
+}
+
+int test_sharded_accumulation() {
+    printf("\n--- Testing Per-Thread Statistics Shards ---\n");
+    int failed = 0;
+    simulation_statistics_t stats;
+    if (!simulation_stats_init(&stats, SHARD_TEST_PRINTERS)) {
+        printf("Failed to allocate statistics shards\n");
+        return 1;
+    }
+    if (simulation_stats_bind_shard(&stats, STATS_SHARD_SHARED)
+        || simulation_stats_bind_shard(&stats, STATS_SHARD_PRINTER(SHARD_TEST_PRINTERS + 1))) {
+        printf("Failed: only the per-thread shards inside the pool can be bound\n");
+        failed = 1;
+    }
+
+    // Each printer thread counts on its own shard without any lock
+    pthread_t threads[SHARD_TEST_PRINTERS];
+    shard_worker_t workers[SHARD_TEST_PRINTERS];
+    for (int i = 0; i < SHARD_TEST_PRINTERS; i++) {
+        workers[i] = (shard_worker_t){&stats, i + 1};
+        pthread_create(&threads[i], NULL, count_on_own_shard, &workers[i]);
+    }
+    for (int i = 0; i < SHARD_TEST_PRINTERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // This thread never bound a shard, so it counts on the shared one; base fields still add up
+    simulation_stats_count_arrival(&stats, 100);
+    simulation_stats_count_removed(&stats);
+    stats.total_jobs_arrived = 1;
+
+    simulation_statistics_t snapshot;
+    simulation_stats_snapshot(&stats, &snapshot);
+    double served = (double)SHARD_TEST_PRINTERS * SHARD_TEST_JOBS;
+    if (snapshot.total_jobs_served != served || snapshot.total_system_time_us != 20 * served
+        || snapshot.total_queue_wait_time_us != 10 * served) {
+        printf("Failed: merged served totals are wrong (served %.0f)\n", snapshot.total_jobs_served);
+        failed = 1;
+    }
+    if (snapshot.total_jobs_arrived != 2 || snapshot.total_jobs_removed != 1
+        || snapshot.total_inter_arrival_time_us != 100) {
+        printf("Failed: shared shard was not merged with the base fields\n");
+        failed = 1;
+    }
+    if (snapshot.max_job_queue_length != 10 * SHARD_TEST_PRINTERS
+        || snapshot.max_printers_used != SHARD_TEST_PRINTERS) {
+        printf("Failed: peaks should merge by max (queue %u, printers %d)\n",
+            snapshot.max_job_queue_length, snapshot.max_printers_used);
+        failed = 1;
+    }
+    if (calculate_total_papers_used(&snapshot) != 2 * SHARD_TEST_PRINTERS * SHARD_TEST_JOBS) {
+        printf("Failed: printer records lost updates\n");
+        failed = 1;
+    }
+
+    // The report merges on read as well
+    char buf[4096];
+    char expected[64];
+    snprintf(expected, sizeof(expected), "\"total_jobs_served\":%.0f,", served);
+    if (write_statistics_to_buffer(&stats, buf, sizeof(buf)) <= 0 || strstr(buf, expected) == NULL) {
+        printf("Failed: statistics report did not merge the shards\n");
+        failed = 1;
+    }
+    simulation_stats_destroy(&stats);
+
+    if (!failed) printf("Passed per-thread statistics shards test.\n");
+    return failed;
+}
+
 int main() {
     char test_name[] = "SIMULATION STATS";
     print_test_start(test_name);
@@ -70,6 +222,9 @@ int main() {
     RUN_TEST(test_create_simulation_stats(&stats));
     RUN_TEST(test_write_statistics_to_buffer(&stats));
     RUN_TEST(test_log_statistics(&stats));
+    simulation_stats_destroy(&stats);
+    RUN_TEST(test_large_printer_pool());
+    RUN_TEST(test_sharded_accumulation());
 
     int passed_tests = total_tests - failed_tests;
     print_test_end(test_name, passed_tests, failed_tests);
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "config.h"
+#include "preprocessing.h"
+#include "simulation_stats.h"
+#include "sweep.h"
+#include "test_utils.h"
+
+static char* base_argv[] = {"sweep", "-num", "20"};
+#define BASE_ARGC 3
+
+/**
+ * @brief Runs a sweep into a temporary file and returns its contents.
+ *
+ * @return A malloc'd string, or NULL if the sweep failed.
+ */
+static char* run_to_string(const sweep_spec_t* spec, int workers, int format) {
+    FILE* out = tmpfile();
+    if (out == NULL) return NULL;
+    char* text = NULL;
+    if (sweep_run(spec, workers, format, out)) {
+        long size = ftell(out);
+        text = calloc(size + 1, 1);
+        rewind(out);
+        if (text != NULL && fread(text, 1, size, out) != (size_t)size) {
+            free(text);
+            text = NULL;
+        }
+    }
+    fclose(out);
+    return text;
+}
+
+static int count_lines(const char* text) {
+    int lines = 0;
+    for (; *text; text++) {
+        if (*text == '\n') lines++;
+    }
+    return lines;
+}
+
+int test_add_axis() {
+    printf("\n--- Testing Sweep Axis Parsing ---\n");
+    int failed = 0;
+    sweep_spec_t spec;
+    sweep_init(&spec, BASE_ARGC, base_argv);
+
+    if (spec.point_count != 1) {
+        printf("Failed: an empty sweep should have 1 point, got %d.\n", spec.point_count);
+        failed++;
+    }
+    if (!sweep_add_axis(&spec, "s=4,6,8") || !sweep_add_axis(&spec, "-dispatch=shared,rr")) {
+        printf("Failed: valid axes were rejected.\n");
+        failed++;
+    } else {
+        if (strcmp(spec.axes[0].option, "s") != 0 || spec.axes[0].value_count != 3
+                || strcmp(spec.axes[0].values[2], "8") != 0) {
+            printf("Failed: axis s=4,6,8 was parsed wrong.\n");
+            failed++;
+        }
+        if (strcmp(spec.axes[1].option, "dispatch") != 0 || spec.axes[1].value_count != 2) {
+            printf("Failed: a leading dash should be dropped from the option name.\n");
+            failed++;
+        }
+        if (spec.point_count != 6) {
+            printf("Failed: expected 6 points, got %d.\n", spec.point_count);
+            failed++;
+        }
+    }
+
+    const char* malformed[] = {"s", "=4,6", "s=", "s=,,"};
+    for (int i = 0; i < 4; i++) {
+        if (sweep_add_axis(&spec, malformed[i])) {
+            printf("Failed: malformed axis \"%s\" was accepted.\n", malformed[i]);
+            failed++;
+        }
+    }
+    if (spec.axis_count != 2 || spec.point_count != 6) {
+        printf("Failed: rejected axes should leave the sweep unchanged.\n");
+        failed++;
+    }
+
+    sweep_destroy(&spec);
+    if (!failed) printf("Passed sweep axis parsing test.\n");
+    return failed;
+}
+
+int test_point_values() {
+    printf("\n--- Testing Sweep Point Order ---\n");
+    int failed = 0;
+    sweep_spec_t spec;
+    sweep_init(&spec, BASE_ARGC, base_argv);
+    sweep_add_axis(&spec, "s=4,6,8");
+    sweep_add_axis(&spec, "consumers=1,2");
+
+    // Last axis varies fastest: (4,1) (4,2) (6,1) (6,2) (8,1) (8,2)
+    const char* expected[6][2] = {{"4", "1"}, {"4", "2"}, {"6", "1"}, {"6", "2"}, {"8", "1"}, {"8", "2"}};
+    const char* values[CONFIG_SWEEP_MAX_AXES];
+    for (int p = 0; p < spec.point_count; p++) {
+        sweep_point_values(&spec, p, values);
+        if (strcmp(values[0], expected[p][0]) != 0 || strcmp(values[1], expected[p][1]) != 0) {
+            printf("Failed: point %d is (%s,%s), expected (%s,%s).\n",
+                   p, values[0], values[1], expected[p][0], expected[p][1]);
+            failed++;
+        }
+    }
+
+    sweep_destroy(&spec);
+    if (!failed) printf("Passed sweep point order test.\n");
+    return failed;
+}
+
+int test_point_params() {
+    printf("\n--- Testing Sweep Point Parameters ---\n");
+    int failed = 0;
+    sweep_spec_t spec;
+    sweep_init(&spec, BASE_ARGC, base_argv);
+    sweep_add_axis(&spec, "s=4,8");
+    sweep_add_axis(&spec, "consumers=3");
+
+    simulation_parameters_t params;
+    if (!sweep_point_params(&spec, 1, &params)) {
+        printf("Failed: a valid point was rejected.\n");
+        failed++;
+    } else {
+        if (params.num_jobs != 20) {
+            printf("Failed: the base option -num 20 was not applied (got %d).\n", params.num_jobs);
+            failed++;
+        }
+        if (params.printing_rate != 8 || params.consumer_count != 3) {
+            printf("Failed: axis values were not applied (s=%.2f consumers=%d).\n",
+                   params.printing_rate, params.consumer_count);
+            failed++;
+        }
+    }
+    sweep_destroy(&spec);
+
+    // Out-of-range values are rejected by process_args, like bin/cli does
+    sweep_init(&spec, BASE_ARGC, base_argv);
+    sweep_add_axis(&spec, "s=4,99");
+    if (!sweep_point_params(&spec, 0, &params) || sweep_point_params(&spec, 1, &params)) {
+        printf("Failed: s=99 should be the only invalid point.\n");
+        failed++;
+    }
+    FILE* out = tmpfile();
+    if (out != NULL) {
+        if (sweep_run(&spec, 2, SWEEP_FORMAT_CSV, out) || ftell(out) != 0) {
+            printf("Failed: a sweep with an invalid point should fail without output.\n");
+            failed++;
+        }
+        fclose(out);
+    }
+    sweep_destroy(&spec);
+
+    if (!failed) printf("Passed sweep point parameters test.\n");
+    return failed;
+}
+
+int test_run_csv() {
+    printf("\n--- Testing Sweep CSV Output ---\n");
+    int failed = 0;
+    sweep_spec_t spec;
+    sweep_init(&spec, BASE_ARGC, base_argv);
+    sweep_add_axis(&spec, "s=4,8");
+    sweep_add_axis(&spec, "consumers=1,2");
+
+    char* serial = run_to_string(&spec, 1, SWEEP_FORMAT_CSV);
+    char* parallel = run_to_string(&spec, 4, SWEEP_FORMAT_CSV);
+    if (serial == NULL || parallel == NULL) {
+        printf("Failed: the sweep did not run.\n");
+        failed++;
+    } else {
+        char header[256];
+        snprintf(header, sizeof(header), "s,consumers,%s\n", statistics_csv_header);
+        if (strncmp(serial, header, strlen(header)) != 0) {
+            printf("Failed: unexpected CSV header.\n");
+            failed++;
+        }
+        if (count_lines(serial) != 5) {
+            printf("Failed: expected a header and 4 rows, got %d lines.\n", count_lines(serial));
+            failed++;
+        }
+        if (strstr(serial, "\n4,1,") == NULL || strstr(serial, "\n8,2,") == NULL) {
+            printf("Failed: rows should start with the point's axis values.\n");
+            failed++;
+        }
+        // Every point restarts its random stream, so the worker count cannot change the results
+        if (strcmp(serial, parallel) != 0) {
+            printf("Failed: 1 and 4 workers produced different results.\n");
+            failed++;
+        }
+    }
+
+    free(serial);
+    free(parallel);
+    sweep_destroy(&spec);
+    if (!failed) printf("Passed sweep CSV output test.\n");
+    return failed;
+}
+
+int test_run_json() {
+    printf("\n--- Testing Sweep JSON Output ---\n");
+    int failed = 0;
+    sweep_spec_t spec;
+    sweep_init(&spec, BASE_ARGC, base_argv);
+    sweep_add_axis(&spec, "dispatch=shared,rr");
+
+    char* text = run_to_string(&spec, 2, SWEEP_FORMAT_JSON);
+    if (text == NULL) {
+        printf("Failed: the sweep did not run.\n");
+        failed++;
+    } else {
+        if (text[0] != '[' || strstr(text, "]\n") == NULL) {
+            printf("Failed: output should be a JSON array.\n");
+            failed++;
+        }
+        if (strstr(text, "{\"point\":{\"dispatch\":\"shared\"},\"statistics\":{") == NULL
+                || strstr(text, "{\"point\":{\"dispatch\":\"rr\"},\"statistics\":{") == NULL) {
+            printf("Failed: missing a point object.\n");
+            failed++;
+        }
+        if (strstr(text, "\"printers\"") == NULL) {
+            printf("Failed: JSON statistics should include the per-printer stats.\n");
+            failed++;
+        }
+    }
+
+    free(text);
+    sweep_destroy(&spec);
+    if (!failed) printf("Passed sweep JSON output test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "Sweep";
+    print_test_start(test_name);
+    int total_tests = 0, failed_tests = 0;
+
+    RUN_TEST(test_add_axis());
+    RUN_TEST(test_point_values());
+    RUN_TEST(test_point_params());
+    RUN_TEST(test_run_csv());
+    RUN_TEST(test_run_json());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
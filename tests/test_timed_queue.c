@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "common.h"
@@ -110,7 +111,7 @@ int test_timed_queue_dequeue(timed_queue_t* tq, int expected_value) {
             failed = 1;
         }
         
-        free(node);
+        timed_queue_release_node(tq, node);
     } else {
         printf("Failed dequeue test (returned NULL).\n");
         failed = 1;
@@ -195,6 +196,356 @@ int test_clear_timestamp(timed_queue_t* tq) {
     }
 }
 
+typedef struct {
+    int* values;
+    int count;
+} visited_values_t;
+
+static void record_value(list_node_t* node, void* ctx) {
+    visited_values_t* visited = (visited_values_t*)ctx;
+    visited->values[visited->count++] = *(int*)node->data;
+}
+
+int test_ring_backend() {
+    printf("\n--- Testing Ring Backend ---\n");
+    timed_queue_t ring_tq;
+    int failed = 0;
+    if (!timed_queue_init_backend(&ring_tq, TIMED_QUEUE_BACKEND_RING, 2)) {
+        printf("Failed ring backend init test.\n");
+        return 1;
+    }
+
+    int a = 1, b = 2, c = 3;
+    unsigned long time_before = ring_tq.last_interaction_time_us;
+    usleep(1000);
+    timed_queue_enqueue(&ring_tq, &a);
+    timed_queue_enqueue(&ring_tq, &b);
+    if (timed_queue_enqueue(&ring_tq, &c) != FALSE) {
+        printf("Failed: enqueue into a full ring should fail.\n");
+        failed = 1;
+    }
+    if (ring_tq.last_interaction_time_us <= time_before) {
+        printf("Failed: ring enqueue did not update the timestamp.\n");
+        failed = 1;
+    }
+
+    int values[2] = {0};
+    visited_values_t visited = {values, 0};
+    list_node_t* first = timed_queue_first(&ring_tq);
+    if (timed_queue_for_each(&ring_tq, record_value, &visited) != 2 || values[0] != 1 || values[1] != 2) {
+        printf("Failed: ring iteration returned the wrong nodes.\n");
+        failed = 1;
+    }
+    if (first == NULL || timed_queue_next(&ring_tq, first) != NULL) {
+        printf("Failed: timed_queue_next is list-only and should return NULL on a ring.\n");
+        failed = 1;
+    }
+
+    list_node_t* node = timed_queue_dequeue_front(&ring_tq);
+    if (node == NULL || *(int*)node->data != 1 || timed_queue_length(&ring_tq) != 1) {
+        printf("Failed: ring dequeue_front returned the wrong node.\n");
+        failed = 1;
+    }
+    timed_queue_release_node(&ring_tq, node);
+
+    timed_queue_destroy(&ring_tq);
+    if (!failed) printf("Passed ring backend test.\n");
+    return failed;
+}
+
+typedef struct intrusive_item {
+    int value;
+    list_node_t node;
+} intrusive_item_t;
+
+int test_intrusive_ring_backend() {
+    printf("\n--- Testing Intrusive Ring Backend ---\n");
+    timed_queue_t ring_tq;
+    intrusive_item_t items[3] = {{1}, {2}, {3}};
+    int failed = 0;
+    if (!timed_queue_init_intrusive(&ring_tq, TIMED_QUEUE_BACKEND_RING, 2)) {
+        printf("Failed intrusive ring init test.\n");
+        return 1;
+    }
+
+    if (timed_queue_enqueue(&ring_tq, &items[0]) != FALSE) {
+        printf("Failed: timed_queue_enqueue should fail on an intrusive queue.\n");
+        failed = 1;
+    }
+    timed_queue_enqueue_node(&ring_tq, &items[0].node);
+    timed_queue_enqueue_node(&ring_tq, &items[1].node);
+    if (timed_queue_enqueue_node(&ring_tq, &items[2].node) != FALSE) {
+        printf("Failed: enqueue_node into a full ring should fail.\n");
+        failed = 1;
+    }
+
+    list_node_t* node = timed_queue_dequeue_front(&ring_tq);
+    if (node != &items[0].node || list_entry(node, intrusive_item_t, node)->value != 1) {
+        printf("Failed: intrusive dequeue_front returned the wrong node.\n");
+        failed = 1;
+    }
+
+    timed_queue_destroy(&ring_tq); // must not free the embedded nodes
+    if (!failed) printf("Passed intrusive ring backend test.\n");
+    return failed;
+}
+
+static int intrusive_item_key(const list_node_t* node) {
+    return list_entry(node, intrusive_item_t, node)->value;
+}
+
+int test_index_find_and_remove_by_id() {
+    printf("\n--- Testing Job Id Index ---\n");
+    timed_queue_t indexed_tq;
+    intrusive_item_t items[4] = {{1}, {2}, {3}, {4}};
+    int failed = 0;
+    timed_queue_init_intrusive(&indexed_tq, TIMED_QUEUE_BACKEND_LIST, 0);
+    timed_queue_enqueue_node(&indexed_tq, &items[0].node); // indexed when the index is enabled
+    if (!timed_queue_enable_index(&indexed_tq, intrusive_item_key, 2)) {
+        printf("Failed index enable test.\n");
+        return 1;
+    }
+    for (int i = 1; i < 4; i++) timed_queue_enqueue_node(&indexed_tq, &items[i].node);
+
+    if (timed_queue_find_by_id(&indexed_tq, 1) != &items[0].node
+        || timed_queue_find_by_id(&indexed_tq, 3) != &items[2].node) {
+        printf("Failed: find_by_id returned the wrong node.\n");
+        failed = 1;
+    }
+
+    unsigned long time_before = indexed_tq.last_interaction_time_us;
+    usleep(1000);
+    list_node_t* removed = timed_queue_remove_by_id(&indexed_tq, 3);
+    if (removed != &items[2].node || timed_queue_length(&indexed_tq) != 3
+        || timed_queue_find_by_id(&indexed_tq, 3) != NULL
+        || indexed_tq.last_interaction_time_us <= time_before) {
+        printf("Failed: remove_by_id did not unlink the node.\n");
+        failed = 1;
+    }
+
+    timed_queue_dequeue_front(&indexed_tq);
+    if (timed_queue_find_by_id(&indexed_tq, 1) != NULL || timed_queue_remove_by_id(&indexed_tq, 3) != NULL) {
+        printf("Failed: index kept a dequeued or removed node.\n");
+        failed = 1;
+    }
+
+    timed_queue_destroy(&indexed_tq);
+    if (!failed) printf("Passed job id index test.\n");
+    return failed;
+}
+
+static int accept_value_budget(list_node_t* node, void* ctx) {
+    int* budget = (int*)ctx;
+    int value = list_entry(node, intrusive_item_t, node)->value;
+    if (value > *budget) return FALSE;
+    *budget -= value;
+    return TRUE;
+}
+
+int test_batch_dequeue() {
+    printf("\n--- Testing Batch Dequeue ---\n");
+    timed_queue_t batch_tq;
+    intrusive_item_t items[5] = {{1}, {2}, {3}, {4}, {5}};
+    list_node_t* out[5];
+    int failed = 0;
+    timed_queue_init_intrusive(&batch_tq, TIMED_QUEUE_BACKEND_LIST, 0);
+    for (int i = 0; i < 5; i++) timed_queue_enqueue_node(&batch_tq, &items[i].node);
+
+    int count = timed_queue_dequeue_batch(&batch_tq, out, 2);
+    if (count != 2 || out[0] != &items[0].node || out[1] != &items[1].node
+        || timed_queue_length(&batch_tq) != 3) {
+        printf("Failed: dequeue_batch did not take the first 2 nodes in order.\n");
+        failed = 1;
+    }
+
+    // Budget 8 takes 3 (left 5) and 4 (left 1), then stops at 5
+    int budget = 8;
+    count = timed_queue_dequeue_batch_while(&batch_tq, out, 5, accept_value_budget, &budget);
+    if (count != 2 || out[0] != &items[2].node || out[1] != &items[3].node || budget != 1
+        || timed_queue_first(&batch_tq) != &items[4].node) {
+        printf("Failed: dequeue_batch_while did not stop at the rejected node.\n");
+        failed = 1;
+    }
+
+    count = timed_queue_dequeue_batch(&batch_tq, out, 5);
+    if (count != 1 || timed_queue_dequeue_batch(&batch_tq, out, 5) != 0) {
+        printf("Failed: dequeue_batch on a drained queue should return 0.\n");
+        failed = 1;
+    }
+
+    timed_queue_destroy(&batch_tq);
+    if (!failed) printf("Passed batch dequeue test.\n");
+    return failed;
+}
+
+int test_batch_enqueue() {
+    printf("\n--- Testing Batch Enqueue ---\n");
+    timed_queue_t ring_tq;
+    intrusive_item_t items[3] = {{1}, {2}, {3}};
+    list_node_t* nodes[3] = {&items[0].node, &items[1].node, &items[2].node};
+    int failed = 0;
+    timed_queue_init_intrusive(&ring_tq, TIMED_QUEUE_BACKEND_RING, 2);
+
+    unsigned long time_before = ring_tq.last_interaction_time_us;
+    usleep(1000);
+    // The ring holds 2, so the batch stops before the third node
+    int count = timed_queue_enqueue_batch(&ring_tq, nodes, 3);
+    if (count != 2 || timed_queue_length(&ring_tq) != 2
+        || ring_tq.last_interaction_time_us <= time_before) {
+        printf("Failed: enqueue_batch into a ring of 2 should take 2 nodes (took %d).\n", count);
+        failed = 1;
+    }
+    if (timed_queue_dequeue_front(&ring_tq) != &items[0].node
+        || timed_queue_dequeue_front(&ring_tq) != &items[1].node) {
+        printf("Failed: enqueue_batch did not keep the node order.\n");
+        failed = 1;
+    }
+
+    timed_queue_destroy(&ring_tq);
+    if (!failed) printf("Passed batch enqueue test.\n");
+    return failed;
+}
+
+int test_queue_length_area() {
+    printf("\n--- Testing Queue Length Area ---\n");
+    timed_queue_t area_tq;
+    intrusive_item_t items[2] = {{1}, {2}};
+    list_node_t* out[2];
+    int failed = 0;
+    timed_queue_init_intrusive(&area_tq, TIMED_QUEUE_BACKEND_LIST, 0);
+    timed_queue_enqueue_node(&area_tq, &items[0].node);
+    timed_queue_enqueue_node(&area_tq, &items[1].node);
+    unsigned long area_before = timed_queue_area_us(&area_tq);
+
+    // Two jobs wait ~10ms, then leave together in one batch
+    usleep(10000);
+    timed_queue_dequeue_batch(&area_tq, out, 2);
+    unsigned long area_after = timed_queue_area_us(&area_tq);
+    printf("Area grew by %lu job-us over ~10ms with 2 queued\n", area_after - area_before);
+    if (area_after - area_before < 2 * 10000) {
+        printf("Failed: batch dequeue undercounted the queue length area.\n");
+        failed = 1;
+    }
+
+    // An empty queue accrues no area
+    usleep(2000);
+    timed_queue_enqueue_node(&area_tq, &items[0].node);
+    if (timed_queue_area_us(&area_tq) != area_after) {
+        printf("Failed: empty queue accrued area.\n");
+        failed = 1;
+    }
+
+    timed_queue_destroy(&area_tq);
+    if (!failed) printf("Passed queue length area test.\n");
+    return failed;
+}
+
+typedef struct classed_item {
+    char label;
+    int service_class;
+    list_node_t node;
+} classed_item_t;
+
+static int classed_item_class(const list_node_t* node) {
+    return list_entry(node, classed_item_t, node)->service_class;
+}
+
+int test_weighted_round_robin_classes() {
+    printf("\n--- Testing Weighted Round-Robin Classes ---\n");
+    timed_queue_t classed_tq;
+    const int weights[3] = {2, 1, 1};
+    classed_item_t items[12];
+    int failed = 0;
+    timed_queue_init_intrusive(&classed_tq, TIMED_QUEUE_BACKEND_LIST, 0);
+    if (!timed_queue_enable_classes(&classed_tq, classed_item_class, weights, 3)) {
+        printf("Failed classes enable test.\n");
+        return 1;
+    }
+
+    // Interleave arrivals: B S P B S P ... (4 of each class)
+    const char labels[3] = {'P', 'S', 'B'};
+    for (int i = 0; i < 12; i++) {
+        int cls = 2 - (i % 3);
+        items[i] = (classed_item_t){labels[cls], cls, {0}};
+        timed_queue_enqueue_node(&classed_tq, &items[i].node);
+    }
+    if (timed_queue_class_length(&classed_tq, 0) != 4 || timed_queue_class_length(&classed_tq, 2) != 4) {
+        printf("Failed: per-class lengths are wrong.\n");
+        failed = 1;
+    }
+
+    // Premium gets 2 turns per round, standard and bulk 1 each, until premium runs dry
+    const char* expected = "PPSBPPSBSBSB";
+    char actual[13] = {0};
+    for (int i = 0; i < 12; i++) {
+        list_node_t* peeked = timed_queue_first(&classed_tq);
+        list_node_t* node = timed_queue_dequeue_front(&classed_tq);
+        if (node == NULL || node != peeked) {
+            printf("Failed: first() did not match dequeue_front() at step %d.\n", i);
+            failed = 1;
+            break;
+        }
+        actual[i] = list_entry(node, classed_item_t, node)->label;
+    }
+    printf("Dequeue order: %s (expected %s)\n", actual, expected);
+    if (strcmp(actual, expected) != 0 || !timed_queue_is_empty(&classed_tq)) {
+        failed = 1;
+    }
+
+    timed_queue_destroy(&classed_tq);
+    if (!failed) printf("Passed weighted round-robin classes test.\n");
+    else printf("Failed weighted round-robin classes test.\n");
+    return failed;
+}
+
+int test_classed_iteration() {
+    printf("\n--- Testing Iteration With Classes ---\n");
+    timed_queue_t classed_tq;
+    const int weights[3] = {2, 1, 1};
+    classed_item_t items[12];
+    int failed = 0;
+    timed_queue_init_intrusive(&classed_tq, TIMED_QUEUE_BACKEND_LIST, 0);
+    if (!timed_queue_enable_classes(&classed_tq, classed_item_class, weights, 3)) {
+        printf("Failed classes enable test.\n");
+        return 1;
+    }
+    const char labels[3] = {'P', 'S', 'B'};
+    for (int i = 0; i < 12; i++) {
+        int cls = 2 - (i % 3);
+        items[i] = (classed_item_t){labels[cls], cls, {0}};
+        timed_queue_enqueue_node(&classed_tq, &items[i].node);
+    }
+
+    // Serve premium until its credit runs out and standard is up next
+    int served = 0;
+    while (served < 12 && list_entry(timed_queue_first(&classed_tq), classed_item_t, node)->label != 'S') {
+        timed_queue_dequeue_front(&classed_tq);
+        served++;
+    }
+    if (served != 2) {
+        printf("Failed: expected standard after 2 premium jobs, got it after %d.\n", served);
+        failed = 1;
+    }
+
+    // Premium jobs are still queued ahead of standard: head-to-last iteration must visit them
+    char actual[13] = {0};
+    int visited = 0;
+    for (list_node_t* node = timed_queue_head(&classed_tq); node != NULL && visited < 12;
+            node = timed_queue_next(&classed_tq, node)) {
+        actual[visited++] = list_entry(node, classed_item_t, node)->label;
+    }
+    printf("Iteration order: %s (expected PPSSSSBBBB)\n", actual);
+    if (visited != timed_queue_length(&classed_tq) || strcmp(actual, "PPSSSSBBBB") != 0) {
+        printf("Failed: iteration from the head should visit all %d queued nodes.\n",
+               timed_queue_length(&classed_tq));
+        failed = 1;
+    }
+
+    timed_queue_destroy(&classed_tq);
+    if (!failed) printf("Passed iteration with classes test.\n");
+    return failed;
+}
+
 int main() {
     char test_name[] = "TIMED QUEUE";
     print_test_start(test_name);
@@ -239,6 +590,15 @@ int main() {
     // Test clear operation
     printf("\n--- Testing Clear Operation ---\n");
     RUN_TEST(test_clear_timestamp(&tq));
+
+    RUN_TEST(test_ring_backend());
+    RUN_TEST(test_intrusive_ring_backend());
+    RUN_TEST(test_index_find_and_remove_by_id());
+    RUN_TEST(test_weighted_round_robin_classes());
+    RUN_TEST(test_classed_iteration());
+    RUN_TEST(test_batch_dequeue());
+    RUN_TEST(test_batch_enqueue());
+    RUN_TEST(test_queue_length_area());
     
     int passed_tests = total_tests - failed_tests;
     print_test_end(test_name, passed_tests, failed_tests);
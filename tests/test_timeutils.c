@@ -0,0 +1,205 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "common.h"
+#include "timeutils.h"
+#include "test_utils.h"
+
+int test_scaled_sleep() {
+    printf("\n--- Testing Scaled Sleep ---\n");
+    int failed = 0;
+    clock_set_time_scale(10.0);
+
+    // 200 ms of simulated time takes 20 ms of real time at 10x
+    unsigned long sim_start_us = get_time_in_us();
+    unsigned long real_start_us = get_unscaled_time_in_us();
+    clock_sleep_us(200000);
+    unsigned long sim_elapsed_us = get_time_in_us() - sim_start_us;
+    unsigned long real_elapsed_us = get_unscaled_time_in_us() - real_start_us;
+    if (sim_elapsed_us < 200000 || real_elapsed_us < 20000 || real_elapsed_us > 150000) {
+        printf("Failed: slept %lu us simulated in %lu us real, expected 200000 in about 20000.\n",
+               sim_elapsed_us, real_elapsed_us);
+        failed = 1;
+    }
+
+    // Waking at a time already passed returns at once
+    real_start_us = get_unscaled_time_in_us();
+    clock_sleep_until(sim_start_us);
+    if (get_unscaled_time_in_us() - real_start_us > 10000) {
+        printf("Failed: sleeping until a past time should not block.\n");
+        failed = 1;
+    }
+
+    // Changing the scale keeps simulated time continuous
+    unsigned long before_us = get_time_in_us();
+    clock_set_time_scale(1.0);
+    unsigned long after_us = get_time_in_us();
+    if (after_us < before_us || after_us - before_us > 10000) {
+        printf("Failed: time jumped from %lu to %lu on a scale change.\n", before_us, after_us);
+        failed = 1;
+    }
+    if (!failed) printf("Passed scaled sleep test.\n");
+    return failed;
+}
+
+int test_scaled_timed_wait() {
+    printf("\n--- Testing Scaled Timed Wait ---\n");
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t cv;
+    int failed = 0;
+    if (clock_cond_init(&cv) != 0) {
+        printf("Failed: clock_cond_init.\n");
+        return 1;
+    }
+    clock_set_time_scale(100.0);
+
+    // Nobody signals: a 1 s simulated timeout ends after about 10 ms
+    unsigned long real_start_us = get_unscaled_time_in_us();
+    pthread_mutex_lock(&mutex);
+    int result = clock_timed_wait(&cv, &mutex, 1000000);
+    pthread_mutex_unlock(&mutex);
+    unsigned long real_elapsed_us = get_unscaled_time_in_us() - real_start_us;
+    if (result != ETIMEDOUT || real_elapsed_us < 10000 || real_elapsed_us > 150000) {
+        printf("Failed: wait returned %d after %lu us, expected ETIMEDOUT after about 10000.\n",
+               result, real_elapsed_us);
+        failed = 1;
+    }
+
+    clock_set_time_scale(1.0);
+    pthread_cond_destroy(&cv);
+    if (!failed) printf("Passed scaled timed wait test.\n");
+    return failed;
+}
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    int stop;
+} stop_flag_t;
+
+static void* set_stop_later(void* arg) {
+    stop_flag_t* flag = (stop_flag_t*)arg;
+    clock_sleep_us(20000);
+    pthread_mutex_lock(&flag->mutex);
+    flag->stop = 1;
+    pthread_cond_broadcast(&flag->cv);
+    pthread_mutex_unlock(&flag->mutex);
+    return NULL;
+}
+
+int test_sleep_unless() {
+    printf("\n--- Testing Interruptible Sleep ---\n");
+    stop_flag_t flag = {.mutex = PTHREAD_MUTEX_INITIALIZER, .stop = 0};
+    int failed = 0;
+    if (clock_cond_init(&flag.cv) != 0) {
+        printf("Failed: clock_cond_init.\n");
+        return 1;
+    }
+
+    // Nobody stops it: the whole duration passes
+    unsigned long start_us = get_time_in_us();
+    if (!clock_sleep_unless(10000, &flag.stop, &flag.mutex, &flag.cv) || get_time_in_us() - start_us < 10000) {
+        printf("Failed: an uninterrupted sleep should last its whole duration.\n");
+        failed = 1;
+    }
+
+    // Setting the flag ends a 60 s sleep after about 20 ms
+    pthread_t stopper;
+    pthread_create(&stopper, NULL, set_stop_later, &flag);
+    start_us = get_time_in_us();
+    int completed = clock_sleep_unless(60000000, &flag.stop, &flag.mutex, &flag.cv);
+    unsigned long elapsed_us = get_time_in_us() - start_us;
+    pthread_join(stopper, NULL);
+    if (completed || elapsed_us > 1000000) {
+        printf("Failed: a stopped sleep returned %d after %lu us, expected 0 after about 20000.\n",
+               completed, elapsed_us);
+        failed = 1;
+    }
+
+    // A flag set beforehand does not sleep at all
+    if (clock_sleep_unless(60000000, &flag.stop, &flag.mutex, &flag.cv)) {
+        printf("Failed: a sleep with the flag already set should return 0.\n");
+        failed = 1;
+    }
+
+    pthread_cond_destroy(&flag.cv);
+    if (!failed) printf("Passed interruptible sleep test.\n");
+    return failed;
+}
+
+typedef struct {
+    atomic_int done;
+    int went_back;
+} clock_reader_t;
+
+static void* read_clock_until_done(void* arg) {
+    clock_reader_t* reader = (clock_reader_t*)arg;
+    unsigned long previous_us = get_time_in_us();
+    while (!atomic_load(&reader->done)) {
+        unsigned long now_us = get_time_in_us();
+        if (now_us < previous_us) reader->went_back = 1;
+        previous_us = now_us;
+    }
+    return NULL;
+}
+
+int test_scale_change_while_reading() {
+    printf("\n--- Testing Scale Change While Reading ---\n");
+    int failed = 0;
+    clock_reader_t reader = {.went_back = 0};
+    atomic_init(&reader.done, 0);
+
+    // A reader mixing one origin with another scale would see time jump back
+    pthread_t thread;
+    pthread_create(&thread, NULL, read_clock_until_done, &reader);
+    for (int i = 0; i < 20000; i++) clock_set_time_scale(i % 2 ? 1.0 : 1000.0);
+    atomic_store(&reader.done, 1);
+    pthread_join(thread, NULL);
+    clock_set_time_scale(1.0);
+    if (reader.went_back) {
+        printf("Failed: get_time_in_us went back while the scale changed.\n");
+        failed = 1;
+    }
+    if (!failed) printf("Passed scale change while reading test.\n");
+    return failed;
+}
+
+int test_virtual_clock() {
+    printf("\n--- Testing Virtual Clock ---\n");
+    int failed = 0;
+    virtual_clock_start(5000);
+    virtual_clock_advance(9000);
+    virtual_clock_advance(7000); // earlier times are ignored
+    clock_sleep_us(60000000);    // returns at once on the virtual clock
+    if (get_time_in_us() != 9000) {
+        printf("Failed: virtual time is %lu, expected 9000.\n", get_time_in_us());
+        failed = 1;
+    }
+    virtual_clock_stop();
+    if (get_time_in_us() == 9000) {
+        printf("Failed: the real clock should be back after virtual_clock_stop.\n");
+        failed = 1;
+    }
+    if (!failed) printf("Passed virtual clock test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "TIMEUTILS";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_scaled_sleep());
+    RUN_TEST(test_scaled_timed_wait());
+    RUN_TEST(test_sleep_unless());
+    RUN_TEST(test_scale_change_while_reading());
+    RUN_TEST(test_virtual_clock());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "config.h"
+#include "job_dispatcher.h"
+#include "job_receiver.h"
+#include "preprocessing.h"
+#include "printer.h"
+#include "simulation_stats.h"
+#include "timed_queue.h"
+#include "timeutils.h"
+#include "virtual_engine.h"
+#include "test_utils.h"
+
+#define START_TIME_US 1000000UL
+
+/**
+ * @brief Runs one simulation on the virtual engine, the way cli.c does but
+ * without a logger. Leaves the merged statistics in snapshot and, when
+ * printer_jobs_served is not NULL, each printer's served count in it.
+ *
+ * @return The virtual time (relative to the start) the run ended at, 0 on failure.
+ */
+static unsigned long run_virtual(simulation_parameters_t* params, simulation_statistics_t* snapshot,
+        double* printer_jobs_served) {
+    simulation_statistics_t stats;
+    timed_queue_t job_queue;
+    job_dispatcher_t job_dispatcher;
+    job_dispatcher_t* dispatcher = NULL;
+    printer_pool_t pool;
+    int terminate_now = 0;
+
+    if (!simulation_stats_init(&stats, params->max_consumer_count)) return 0;
+    if (!job_queue_init(&job_queue, params)) return 0;
+    if (params->dispatch_mode != JOB_DISPATCH_SHARED) {
+        if (!job_dispatcher_init(&job_dispatcher, params->dispatch_mode, params->max_consumer_count,
+                job_queue_key, CONFIG_JOB_INDEX_INITIAL_CAPACITY)) return 0;
+        dispatcher = &job_dispatcher;
+    }
+    if (!printer_pool_init(&pool, params->consumer_count, params->max_consumer_count,
+            params->printer_paper_capacity, NULL)) return 0;
+
+    virtual_clock_start(START_TIME_US);
+    stats.simulation_start_time_us = START_TIME_US;
+    virtual_engine_args_t args = {
+        .job_queue = &job_queue,
+        .dispatcher = dispatcher,
+        .params = params,
+        .stats = &stats,
+        .pool = &pool,
+        .signal_set = NULL,
+        .terminate_now = &terminate_now
+    };
+    int ok = virtual_engine_run(&args);
+    unsigned long end_time_us = get_time_in_us() - START_TIME_US;
+    virtual_clock_stop();
+
+    simulation_stats_snapshot(&stats, snapshot);
+    snapshot->printers = NULL; // freed with stats below
+    for (int i = 0; printer_jobs_served != NULL && i < params->max_consumer_count; i++) {
+        printer_jobs_served[i] = stats.printers[i].jobs_served;
+    }
+    printer_pool_destroy(&pool);
+    timed_queue_destroy(&job_queue);
+    if (dispatcher != NULL) job_dispatcher_destroy(dispatcher);
+    simulation_stats_destroy(&stats);
+    return ok ? end_time_us : 0;
+}
+
+int test_single_printer_timeline() {
+    printf("\n--- Testing Single Printer Timeline ---\n");
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    params.papers_required_lower_bound = 10;
+    params.papers_required_upper_bound = 10;
+    params.printer_paper_capacity = 100;
+    params.num_jobs = 4;
+    params.consumer_count = 1;
+    simulation_statistics_t snapshot;
+    int failed = 0;
+
+    // Arrivals every 0.5 s, 2 s per job: the printer finishes at 2.5, 4.5, 6.5 and 8.5 s
+    unsigned long end_time_us = run_virtual(&params, &snapshot, NULL);
+    if (end_time_us != 8500000UL) {
+        printf("Failed: the run ended at %lu us, expected 8500000.\n", end_time_us);
+        failed = 1;
+    }
+    if (snapshot.total_jobs_served != 4 || snapshot.total_system_time_us != 17000000UL) {
+        printf("Failed: served %.0f jobs in %lu us of system time, expected 4 in 17000000.\n",
+               snapshot.total_jobs_served, snapshot.total_system_time_us);
+        failed = 1;
+    }
+    if (!failed) printf("Passed single printer timeline test.\n");
+    return failed;
+}
+
+int test_refill() {
+    printf("\n--- Testing Paper Refill ---\n");
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    params.papers_required_lower_bound = 10;
+    params.papers_required_upper_bound = 10;
+    params.printer_paper_capacity = 50;
+    params.num_jobs = 6;
+    params.consumer_count = 1;
+    simulation_statistics_t snapshot;
+    int failed = 0;
+
+    // The tray empties after five jobs, so the sixth waits for one full refill
+    if (run_virtual(&params, &snapshot, NULL) == 0) {
+        printf("Failed: the engine did not run.\n");
+        failed = 1;
+    } else if (snapshot.total_jobs_served != 6 || snapshot.paper_refill_events != 1
+            || snapshot.papers_refilled != 50) {
+        printf("Failed: served %.0f jobs with %.0f refills of %d papers, expected 6 with 1 of 50.\n",
+               snapshot.total_jobs_served, snapshot.paper_refill_events, snapshot.papers_refilled);
+        failed = 1;
+    }
+    if (!failed) printf("Passed paper refill test.\n");
+    return failed;
+}
+
+int test_round_robin_burst() {
+    printf("\n--- Testing Round-Robin Burst ---\n");
+    simulation_parameters_t params = SIMULATION_DEFAULT_PARAMS;
+    params.papers_required_lower_bound = 10;
+    params.papers_required_upper_bound = 10;
+    params.printer_paper_capacity = 100;
+    params.num_jobs = 4;
+    params.consumer_count = 2;
+    params.job_burst_size = 4;
+    params.dispatch_mode = JOB_DISPATCH_ROUND_ROBIN;
+    simulation_statistics_t snapshot;
+    double printer_jobs_served[CONFIG_DEFAULT_MAX_CONSUMER_COUNT];
+    int failed = 0;
+
+    // All four jobs arrive at 0.5 s, two on each printer's deque
+    unsigned long end_time_us = run_virtual(&params, &snapshot, printer_jobs_served);
+    if (end_time_us != 4500000UL) {
+        printf("Failed: the run ended at %lu us, expected 4500000.\n", end_time_us);
+        failed = 1;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (printer_jobs_served[i] != 2) {
+            printf("Failed: printer%d served %.0f jobs, expected 2.\n", i + 1, printer_jobs_served[i]);
+            failed = 1;
+        }
+    }
+    if (!failed) printf("Passed round-robin burst test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "VIRTUAL ENGINE";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_single_printer_timeline());
+    RUN_TEST(test_refill());
+    RUN_TEST(test_round_robin_burst());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
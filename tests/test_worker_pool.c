@@ -0,0 +1,171 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "common.h"
+#include "worker_pool.h"
+#include "test_utils.h"
+
+static void* count_task(void* arg) {
+    atomic_fetch_add((atomic_int*)arg, 1);
+    return NULL;
+}
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    int released;
+} gate_t;
+
+// Blocks its worker until the gate opens, so tests can hold workers busy
+static void* gate_task(void* arg) {
+    gate_t* gate = (gate_t*)arg;
+    pthread_mutex_lock(&gate->mutex);
+    while (!gate->released) {
+        pthread_cond_wait(&gate->cv, &gate->mutex);
+    }
+    pthread_mutex_unlock(&gate->mutex);
+    return NULL;
+}
+
+static void open_gate(gate_t* gate) {
+    pthread_mutex_lock(&gate->mutex);
+    gate->released = TRUE;
+    pthread_cond_broadcast(&gate->cv);
+    pthread_mutex_unlock(&gate->mutex);
+}
+
+int test_run_and_reuse() {
+    printf("\n--- Testing Worker Reuse ---\n");
+    int failed = 0;
+    worker_pool_t pool;
+    if (!worker_pool_init(&pool, 4)) {
+        printf("Failed: worker_pool_init.\n");
+        return 1;
+    }
+
+    // Three rounds of three tasks, like three runs of the same simulation
+    atomic_int runs = 0;
+    for (int round = 0; round < 3; round++) {
+        worker_t* workers[3];
+        for (int i = 0; i < 3; i++) {
+            workers[i] = worker_pool_run(&pool, count_task, &runs);
+            if (workers[i] == NULL) {
+                printf("Failed: round %d task %d did not start.\n", round, i);
+                failed = 1;
+            }
+        }
+        for (int i = 0; i < 3; i++) {
+            if (workers[i] != NULL) worker_wait(&pool, workers[i]);
+        }
+    }
+    if (atomic_load(&runs) != 9) {
+        printf("Failed: %d tasks ran, expected 9.\n", atomic_load(&runs));
+        failed = 1;
+    }
+    if (worker_pool_thread_count(&pool) != 3 || worker_pool_parked_count(&pool) != 3) {
+        printf("Failed: %d threads and %d parked after three rounds, expected 3 and 3.\n",
+               worker_pool_thread_count(&pool), worker_pool_parked_count(&pool));
+        failed = 1;
+    }
+
+    worker_pool_destroy(&pool);
+    if (!failed) printf("Passed worker reuse test.\n");
+    return failed;
+}
+
+int test_reserve() {
+    printf("\n--- Testing Worker Reservation ---\n");
+    int failed = 0;
+    worker_pool_t pool;
+    if (!worker_pool_init(&pool, 8)) {
+        printf("Failed: worker_pool_init.\n");
+        return 1;
+    }
+
+    if (!worker_pool_reserve(&pool, 5) || worker_pool_parked_count(&pool) != 5) {
+        printf("Failed: reserving 5 workers parked %d.\n", worker_pool_parked_count(&pool));
+        failed = 1;
+    }
+    // Running on a reserved pool starts no thread
+    atomic_int runs = 0;
+    worker_t* worker = worker_pool_run(&pool, count_task, &runs);
+    if (worker == NULL || worker_pool_thread_count(&pool) != 5 || worker_pool_parked_count(&pool) != 4) {
+        printf("Failed: a task on a reserved pool should take a parked worker.\n");
+        failed = 1;
+    }
+    if (worker != NULL) worker_wait(&pool, worker);
+
+    // Parked workers count towards a reservation; the capacity bounds it
+    if (!worker_pool_reserve(&pool, 3) || worker_pool_thread_count(&pool) != 5) {
+        printf("Failed: a smaller reservation should start no thread.\n");
+        failed = 1;
+    }
+    if (worker_pool_reserve(&pool, 10) || worker_pool_thread_count(&pool) != 8) {
+        printf("Failed: a reservation past the capacity should start 8 threads and fail.\n");
+        failed = 1;
+    }
+
+    worker_pool_destroy(&pool);
+    if (!failed) printf("Passed worker reservation test.\n");
+    return failed;
+}
+
+int test_capacity() {
+    printf("\n--- Testing Worker Pool Capacity ---\n");
+    int failed = 0;
+    worker_pool_t pool;
+    if (!worker_pool_init(&pool, 2)) {
+        printf("Failed: worker_pool_init.\n");
+        return 1;
+    }
+
+    gate_t gate = {.mutex = PTHREAD_MUTEX_INITIALIZER, .cv = PTHREAD_COND_INITIALIZER, .released = FALSE};
+    worker_t* first = worker_pool_run(&pool, gate_task, &gate);
+    worker_t* second = worker_pool_run(&pool, gate_task, &gate);
+    atomic_int runs = 0;
+    if (first == NULL || second == NULL) {
+        printf("Failed: two tasks should fit in a pool of 2.\n");
+        failed = 1;
+    } else if (worker_pool_run(&pool, count_task, &runs) != NULL) {
+        printf("Failed: a third task should not start while both workers are busy.\n");
+        failed = 1;
+    }
+
+    // Once a worker is waited for, it takes the next task
+    open_gate(&gate);
+    if (first != NULL) worker_wait(&pool, first);
+    if (second != NULL) worker_wait(&pool, second);
+    worker_t* third = worker_pool_run(&pool, count_task, &runs);
+    if (third == NULL) {
+        printf("Failed: a parked worker should take the next task.\n");
+        failed = 1;
+    } else {
+        worker_wait(&pool, third);
+    }
+    if (atomic_load(&runs) != 1 || worker_pool_thread_count(&pool) != 2) {
+        printf("Failed: expected 1 counted task on 2 threads, got %d on %d.\n",
+               atomic_load(&runs), worker_pool_thread_count(&pool));
+        failed = 1;
+    }
+
+    worker_pool_destroy(&pool);
+    if (!failed) printf("Passed worker pool capacity test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "WORKER POOL";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_run_and_reuse());
+    RUN_TEST(test_reserve());
+    RUN_TEST(test_capacity());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
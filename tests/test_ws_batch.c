@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "ws_batch.h"
+#include "test_utils.h"
+
+static int frame_equals(ws_batch_t* b, const char* expected) {
+    size_t len;
+    const char* frame = ws_batch_frame(b, &len);
+    return frame != NULL && len == strlen(expected) && memcmp(frame, expected, len) == 0;
+}
+
+int test_batch_builds_json_array() {
+    printf("\n--- Testing Batch Frame ---\n");
+    ws_batch_t b;
+    if (!ws_batch_init(&b, 1024, 20000)) {
+        printf("Failed batch init test.\n");
+        return 1;
+    }
+    int failed = 0;
+    size_t len;
+    if (!ws_batch_is_empty(&b) || ws_batch_frame(&b, &len) != NULL) {
+        printf("Failed: a new batch should be empty and have no frame.\n");
+        failed = 1;
+    }
+
+    ws_batch_append(&b, "{\"a\":1}", 7, 100);
+    if (!frame_equals(&b, "[{\"a\":1}]")) {
+        printf("Failed: single message frame is wrong.\n");
+        failed = 1;
+    }
+    // Appending after taking a frame continues the same batch
+    ws_batch_append(&b, "{\"b\":2}", 7, 200);
+    if (!frame_equals(&b, "[{\"a\":1},{\"b\":2}]") || b.count != 2) {
+        printf("Failed: two message frame is wrong.\n");
+        failed = 1;
+    }
+
+    ws_batch_clear(&b);
+    ws_batch_append(&b, "{\"c\":3}", 7, 300);
+    if (!frame_equals(&b, "[{\"c\":3}]")) {
+        printf("Failed: clear did not start a new array.\n");
+        failed = 1;
+    }
+
+    ws_batch_destroy(&b);
+    if (!failed) printf("Passed batch frame test.\n");
+    return failed;
+}
+
+int test_batch_due_by_window_or_size() {
+    printf("\n--- Testing Batch Flush Triggers ---\n");
+    ws_batch_t b;
+    ws_batch_init(&b, 64, 20000); // 64 bytes or 20 ms
+    int failed = 0;
+
+    ws_batch_append(&b, "{\"id\":1}", 8, 1000000);
+    if (ws_batch_is_due(&b, 1010000) || ws_batch_time_left_us(&b, 1010000) != 10000) {
+        printf("Failed: a 10 ms old batch should wait another 10 ms.\n");
+        failed = 1;
+    }
+    // A later message does not restart the window
+    ws_batch_append(&b, "{\"id\":2}", 8, 1015000);
+    if (!ws_batch_is_due(&b, 1020000) || ws_batch_time_left_us(&b, 1020000) != 0) {
+        printf("Failed: the batch should be due once its first message is 20 ms old.\n");
+        failed = 1;
+    }
+
+    // Size: the batch is due as soon as the frame reaches max_bytes, whatever its age
+    ws_batch_clear(&b);
+    char message[40];
+    memset(message, 'x', sizeof(message));
+    ws_batch_append(&b, message, sizeof(message), 2000000);
+    if (ws_batch_is_full(&b)) {
+        printf("Failed: 42 bytes should not fill a 64 byte batch.\n");
+        failed = 1;
+    }
+    ws_batch_append(&b, message, sizeof(message), 2000000);
+    if (!ws_batch_is_full(&b) || !ws_batch_is_due(&b, 2000000)) {
+        printf("Failed: 83 bytes should fill a 64 byte batch.\n");
+        failed = 1;
+    }
+    // The buffer grew past max_bytes rather than dropping the message
+    size_t len;
+    ws_batch_frame(&b, &len);
+    if (len != 2 + 2 * sizeof(message) + 1 || b.count != 2) {
+        printf("Failed: oversized batch frame has length %zu.\n", len);
+        failed = 1;
+    }
+
+    ws_batch_destroy(&b);
+    if (!failed) printf("Passed batch flush trigger test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "WS BATCH";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_batch_builds_json_array());
+    RUN_TEST(test_batch_due_by_window_or_size());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
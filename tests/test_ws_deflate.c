@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "config.h"
+#include "ws_deflate.h"
+#include "test_utils.h"
+
+static const char* s_log_line =
+    "{\"type\":\"log\", \"data\":{\"timestamp\":1234.567, \"message\":\"job42 departs from printer3, service time = 4.120ms\"}}";
+
+int test_parse_offer() {
+    printf("\n--- Testing Offer Parsing ---\n");
+    int failed = 0;
+    int bits, no_takeover;
+
+    const char* plain = "permessage-deflate; client_max_window_bits";
+    bits = CONFIG_WS_DEFLATE_WINDOW_BITS;
+    if (!ws_deflate_parse_offer(plain, strlen(plain), &bits, &no_takeover)
+            || bits != CONFIG_WS_DEFLATE_WINDOW_BITS || no_takeover) {
+        printf("Failed: a browser's default offer should be accepted with the server's window.\n");
+        failed = 1;
+    }
+
+    // The first acceptable offer wins; its window limit applies
+    const char* limited = "x-webkit-deflate-frame, permessage-deflate; server_max_window_bits=10; server_no_context_takeover";
+    bits = 15;
+    if (!ws_deflate_parse_offer(limited, strlen(limited), &bits, &no_takeover) || bits != 10 || !no_takeover) {
+        printf("Failed: expected window 10 without context takeover, got %d/%d.\n", bits, no_takeover);
+        failed = 1;
+    }
+
+    const char* declined[] = {
+        "x-webkit-deflate-frame",
+        "permessage-deflate; server_max_window_bits=8", // below what zlib can deflate with
+        "permessage-deflate; unknown_param",
+    };
+    for (size_t i = 0; i < sizeof(declined) / sizeof(declined[0]); i++) {
+        bits = 15;
+        if (ws_deflate_parse_offer(declined[i], strlen(declined[i]), &bits, &no_takeover)) {
+            printf("Failed: offer \"%s\" should be declined.\n", declined[i]);
+            failed = 1;
+        }
+    }
+
+    char header[128];
+    ws_deflate_response_header(header, sizeof(header), 10, TRUE);
+    if (strcmp(header, "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=10; server_no_context_takeover\r\n") != 0) {
+        printf("Failed: unexpected response header %s", header);
+        failed = 1;
+    }
+
+    if (!failed) printf("Passed offer parsing test.\n");
+    return failed;
+}
+
+int test_round_trip() {
+    printf("\n--- Testing Compress/Inflate Round Trip ---\n");
+    ws_deflate_t server, client;
+    int failed = 0;
+    if (!ws_deflate_init(&server, CONFIG_WS_DEFLATE_LEVEL, CONFIG_WS_DEFLATE_WINDOW_BITS, CONFIG_WS_DEFLATE_MEM_LEVEL, FALSE)
+            || !ws_deflate_init(&client, CONFIG_WS_DEFLATE_LEVEL, 15, CONFIG_WS_DEFLATE_MEM_LEVEL, FALSE)) {
+        printf("Failed: init.\n");
+        return 1;
+    }
+
+    size_t len = strlen(s_log_line);
+    size_t first_len = 0;
+    for (int i = 0; i < 5; i++) {
+        size_t compressed_len, inflated_len;
+        const unsigned char* compressed = ws_deflate_compress(&server, s_log_line, len, &compressed_len);
+        if (compressed == NULL || compressed_len < 4) {
+            printf("Failed: compress returned nothing.\n");
+            failed = 1;
+            break;
+        }
+        if (memcmp(compressed + compressed_len - 4, "\x00\x00\xff\xff", 4) == 0) {
+            printf("Failed: the sync flush tail should be stripped.\n");
+            failed = 1;
+        }
+        if (i == 0) {
+            first_len = compressed_len;
+        } else if (compressed_len * 4 > first_len) {
+            // Context takeover: a repeat is mostly back-references into the window
+            printf("Failed: repeat %d took %zu bytes, first took %zu.\n", i, compressed_len, first_len);
+            failed = 1;
+        }
+        const unsigned char* inflated = ws_deflate_inflate(&client, compressed, compressed_len, len, &inflated_len);
+        if (inflated == NULL || inflated_len != len || memcmp(inflated, s_log_line, len) != 0) {
+            printf("Failed: message %d did not survive the round trip.\n", i);
+            failed = 1;
+        }
+    }
+
+    // Larger than max_len is rejected
+    size_t compressed_len, inflated_len;
+    const unsigned char* compressed = ws_deflate_compress(&server, s_log_line, len, &compressed_len);
+    if (ws_deflate_inflate(&client, compressed, compressed_len, len - 1, &inflated_len) != NULL) {
+        printf("Failed: a message over max_len should be rejected.\n");
+        failed = 1;
+    }
+
+    ws_deflate_destroy(&server);
+    ws_deflate_destroy(&client);
+    if (!failed) printf("Passed round trip test.\n");
+    return failed;
+}
+
+int test_no_context_takeover() {
+    printf("\n--- Testing No Context Takeover ---\n");
+    ws_deflate_t server, client;
+    int failed = 0;
+    if (!ws_deflate_init(&server, CONFIG_WS_DEFLATE_LEVEL, CONFIG_WS_DEFLATE_WINDOW_BITS, CONFIG_WS_DEFLATE_MEM_LEVEL, TRUE)
+            || !ws_deflate_init(&client, CONFIG_WS_DEFLATE_LEVEL, 15, CONFIG_WS_DEFLATE_MEM_LEVEL, FALSE)) {
+        printf("Failed: init.\n");
+        return 1;
+    }
+
+    // Every message starts from an empty window, so repeats compress the same
+    size_t len = strlen(s_log_line);
+    size_t first_len = 0;
+    for (int i = 0; i < 3; i++) {
+        size_t compressed_len, inflated_len;
+        const unsigned char* compressed = ws_deflate_compress(&server, s_log_line, len, &compressed_len);
+        if (i == 0) first_len = compressed_len;
+        if (compressed == NULL || compressed_len != first_len) {
+            printf("Failed: message %d took %zu bytes, first took %zu.\n", i, compressed_len, first_len);
+            failed = 1;
+            break;
+        }
+        const unsigned char* inflated = ws_deflate_inflate(&client, compressed, compressed_len, len, &inflated_len);
+        if (inflated == NULL || inflated_len != len || memcmp(inflated, s_log_line, len) != 0) {
+            printf("Failed: message %d did not survive the round trip.\n", i);
+            failed = 1;
+        }
+    }
+
+    ws_deflate_destroy(&server);
+    ws_deflate_destroy(&client);
+    if (!failed) printf("Passed no context takeover test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "WS DEFLATE";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_parse_offer());
+    RUN_TEST(test_round_trip());
+    RUN_TEST(test_no_context_takeover());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "ws_outbox.h"
+#include "test_utils.h"
+
+#define PRODUCER_COUNT 4
+// More messages than the ring holds, so producers overflow while the consumer catches up
+#define OUTBOX_CAPACITY 64
+#define MESSAGES_PER_PRODUCER 1000
+
+static ws_outbox_t s_outbox;
+static int s_doorbells = 0; // rung by producers, read after they are joined
+static pthread_mutex_t s_doorbell_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int message_equals(const ws_message_t* message, const char* expected) {
+    return message != NULL && message->len == strlen(expected) && memcmp(message->data, expected, message->len) == 0;
+}
+
+static void* produce_messages(void* arg) {
+    int producer = *(int*)arg;
+    char json[32];
+    for (int i = 0; i < MESSAGES_PER_PRODUCER; i++) {
+        int len = snprintf(json, sizeof(json), "%d:%d", producer, i);
+        if (ws_outbox_push(&s_outbox, json, len, FALSE)) {
+            pthread_mutex_lock(&s_doorbell_mutex);
+            s_doorbells++;
+            pthread_mutex_unlock(&s_doorbell_mutex);
+        }
+    }
+    return NULL;
+}
+
+int test_doorbell_rings_once_per_drain() {
+    printf("\n--- Testing Outbox Doorbell ---\n");
+    ws_outbox_t outbox;
+    if (!ws_outbox_init(&outbox, 8)) {
+        printf("Failed outbox init test.\n");
+        return 1;
+    }
+    int failed = 0;
+
+    int rang_first = ws_outbox_push(&outbox, "{\"a\":1}", 7, FALSE);
+    int rang_second = ws_outbox_push(&outbox, "{\"b\":2}", 7, TRUE);
+    if (!rang_first || rang_second) {
+        printf("Failed: only the first push before a drain should ring the doorbell.\n");
+        failed = 1;
+    }
+
+    ws_outbox_answer_doorbell(&outbox);
+    ws_message_t* first = ws_outbox_pop(&outbox);
+    ws_message_t* second = ws_outbox_pop(&outbox);
+    if (!message_equals(first, "{\"a\":1}") || !message_equals(second, "{\"b\":2}") || ws_outbox_pop(&outbox) != NULL) {
+        printf("Failed: messages did not come out once each, in order.\n");
+        failed = 1;
+    }
+    ws_message_release(first);
+    ws_message_release(second);
+
+    if (!ws_outbox_push(&outbox, "{\"c\":3}", 7, FALSE)) {
+        printf("Failed: a push after the loop answered should ring again.\n");
+        failed = 1;
+    }
+
+    ws_outbox_destroy(&outbox); // frees the message still queued
+    if (!failed) printf("Passed outbox doorbell test.\n");
+    return failed;
+}
+
+int test_stats_coalesce_and_share() {
+    printf("\n--- Testing Stats Coalescing ---\n");
+    ws_outbox_t outbox;
+    ws_outbox_init(&outbox, 8);
+    int failed = 0;
+
+    ws_outbox_put_stats(&outbox, "{\"jobs\":1}", 10);
+    ws_outbox_put_stats(&outbox, "{\"jobs\":2}", 10);
+    ws_outbox_push(&outbox, "{\"event\":1}", 11, FALSE);
+
+    // Only the newest stats survive, and they never take a slot in the ring
+    ws_message_t* stats = ws_outbox_take_stats(&outbox);
+    if (!message_equals(stats, "{\"jobs\":2}") || ws_outbox_take_stats(&outbox) != NULL) {
+        printf("Failed: the pending stats should be the newest one, taken once.\n");
+        failed = 1;
+    }
+    // Shared like a fanned-out message: the last release frees it
+    ws_message_retain(stats);
+    ws_message_release(stats);
+    if (stats->refs != 1) {
+        printf("Failed: retain and release left %d references.\n", stats->refs);
+        failed = 1;
+    }
+    ws_message_release(stats);
+    ws_message_t* event = ws_outbox_pop(&outbox);
+    if (!message_equals(event, "{\"event\":1}") || ws_outbox_pop(&outbox) != NULL) {
+        printf("Failed: stats should not be queued on the ring.\n");
+        failed = 1;
+    }
+    ws_message_release(event);
+
+    ws_outbox_put_stats(&outbox, "{\"jobs\":3}", 10);
+    ws_outbox_clear(&outbox);
+    if (ws_outbox_take_stats(&outbox) != NULL) {
+        printf("Failed: clear did not drop the pending stats.\n");
+        failed = 1;
+    }
+
+    ws_outbox_destroy(&outbox);
+    if (!failed) printf("Passed stats coalescing test.\n");
+    return failed;
+}
+
+int test_producers_under_load() {
+    printf("\n--- Testing Outbox Under Load ---\n");
+    if (!ws_outbox_init(&s_outbox, OUTBOX_CAPACITY)) {
+        printf("Failed outbox init test.\n");
+        return 1;
+    }
+    int failed = 0;
+
+    pthread_t producers[PRODUCER_COUNT];
+    int indexes[PRODUCER_COUNT];
+    for (int i = 0; i < PRODUCER_COUNT; i++) {
+        indexes[i] = i;
+        pthread_create(&producers[i], NULL, produce_messages, &indexes[i]);
+    }
+
+    // Consume like the event loop: answer the doorbell, then drain
+    int next_expected[PRODUCER_COUNT] = {0};
+    int received = 0;
+    while (received < PRODUCER_COUNT * MESSAGES_PER_PRODUCER && !failed) {
+        ws_outbox_answer_doorbell(&s_outbox);
+        ws_message_t* message;
+        while ((message = ws_outbox_pop(&s_outbox)) != NULL) {
+            int producer, sequence;
+            char json[32];
+            memcpy(json, message->data, message->len);
+            json[message->len] = '\0';
+            if (sscanf(json, "%d:%d", &producer, &sequence) != 2 || sequence != next_expected[producer]++) {
+                printf("Failed: message %s arrived out of order.\n", json);
+                failed = 1;
+            }
+            received++;
+            ws_message_release(message);
+        }
+    }
+
+    for (int i = 0; i < PRODUCER_COUNT; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    if (s_doorbells < 1 || s_doorbells > received) {
+        printf("Failed: %d doorbells for %d messages.\n", s_doorbells, received);
+        failed = 1;
+    }
+
+    ws_outbox_destroy(&s_outbox);
+    if (!failed) printf("Passed outbox load test (%d messages, %d doorbells).\n", received, s_doorbells);
+    return failed;
+}
+
+int test_full_ring_never_waits() {
+    printf("\n--- Testing Full Outbox Overflow ---\n");
+    ws_outbox_t outbox;
+    if (!ws_outbox_init(&outbox, 4)) {
+        printf("Failed outbox init test.\n");
+        return 1;
+    }
+    int failed = 0;
+
+    // Nobody drains: the ring fills, then log lines are dropped and events overflow
+    const char* pushed[] = {"e0", "e1", "e2", "e3", "log4", "e5", "log6", "e7"};
+    const int lossy[] = {FALSE, FALSE, FALSE, FALSE, TRUE, FALSE, TRUE, FALSE};
+    for (int i = 0; i < 8; i++) {
+        ws_outbox_push(&outbox, pushed[i], strlen(pushed[i]), lossy[i]);
+    }
+    if (ws_outbox_dropped(&outbox) != 2) {
+        printf("Failed: expected 2 dropped log lines, got %lu.\n", ws_outbox_dropped(&outbox));
+        failed = 1;
+    }
+
+    // The ring drains first, then the overflow list; a log line pushed once there is
+    // room again still queues behind the overflowed events
+    ws_message_t* first = ws_outbox_pop(&outbox);
+    ws_outbox_push(&outbox, "log8", 4, TRUE);
+    const char* expected[] = {"e1", "e2", "e3", "e5", "e7"};
+    if (!message_equals(first, "e0")) failed = 1;
+    ws_message_release(first);
+    for (int i = 0; i < 5; i++) {
+        ws_message_t* message = ws_outbox_pop(&outbox);
+        if (!message_equals(message, expected[i])) {
+            printf("Failed: message %d is not %s.\n", i + 1, expected[i]);
+            failed = 1;
+        }
+        ws_message_release(message);
+    }
+    if (ws_outbox_pop(&outbox) != NULL || ws_outbox_dropped(&outbox) != 3) {
+        printf("Failed: a log line should not pass overflowed events.\n");
+        failed = 1;
+    }
+
+    // With the overflow list empty, messages use the ring again
+    ws_outbox_push(&outbox, "e9", 2, FALSE);
+    ws_message_t* message = ws_outbox_pop(&outbox);
+    if (!message_equals(message, "e9")) {
+        printf("Failed: the ring was not used again after the overflow drained.\n");
+        failed = 1;
+    }
+    ws_message_release(message);
+
+    ws_outbox_destroy(&outbox);
+    if (!failed) printf("Passed full outbox overflow test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "WS OUTBOX";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_doorbell_rings_once_per_drain());
+    RUN_TEST(test_stats_coalesce_and_share());
+    RUN_TEST(test_producers_under_load());
+    RUN_TEST(test_full_ring_never_waits());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "config.h"
+#include "ws_stats.h"
+#include "test_utils.h"
+
+static ws_stats_t sample_stats(void) {
+    ws_stats_t stats = {0};
+    stats.values[WS_STATS_JOBS_PROCESSED] = 3;
+    stats.values[WS_STATS_JOBS_RECEIVED] = 5;
+    stats.values[WS_STATS_QUEUE_LENGTH] = 2;
+    stats.values[WS_STATS_AVG_COMPLETION_TIME] = 12.5;
+    stats.values[WS_STATS_PAPERS_USED] = 40;
+    stats.values[WS_STATS_REFILL_EVENTS] = 1;
+    stats.values[WS_STATS_AVG_SERVICE_TIME] = 7.25;
+    return stats;
+}
+
+static int frame_equals(const char* frame, size_t len, const char* expected) {
+    return len == strlen(expected) && memcmp(frame, expected, len) == 0;
+}
+
+int test_keyframe_then_deltas() {
+    printf("\n--- Testing Delta Frames ---\n");
+    ws_stats_encoder_t encoder;
+    ws_stats_encoder_reset(&encoder);
+    ws_stats_t stats = sample_stats();
+    char frame[WS_STATS_FRAME_MAX];
+    int failed = 0;
+
+    size_t len = ws_stats_encode(&encoder, &stats, TRUE, frame, sizeof(frame));
+    if (!frame_equals(frame, len, "{\"type\":\"stats_update\", \"data\":{\"jobsProcessed\":3, \"jobsReceived\":5, "
+                                  "\"queueLength\":2, \"avgCompletionTime\":12.50, \"papersUsed\":40, "
+                                  "\"refillEvents\":1, \"avgServiceTime\":7.25}}")) {
+        printf("Failed: the first frame should be a full keyframe, got %.*s\n", (int)len, frame);
+        failed = 1;
+    }
+
+    stats.values[WS_STATS_JOBS_RECEIVED] = 6;
+    stats.values[WS_STATS_QUEUE_LENGTH] = 3;
+    len = ws_stats_encode(&encoder, &stats, TRUE, frame, sizeof(frame));
+    if (!frame_equals(frame, len, "{\"type\":\"stats_update\", \"delta\":true, \"data\":{\"jobsReceived\":6, \"queueLength\":3}}")) {
+        printf("Failed: the delta should carry the two changed fields, got %.*s\n", (int)len, frame);
+        failed = 1;
+    }
+
+    // A change the client cannot see (below the printed precision) is no change
+    stats.values[WS_STATS_AVG_SERVICE_TIME] = 7.251;
+    if (ws_stats_encode(&encoder, &stats, TRUE, frame, sizeof(frame)) != 0) {
+        printf("Failed: an unchanged snapshot should produce no frame.\n");
+        failed = 1;
+    }
+
+    if (!failed) printf("Passed delta frame test.\n");
+    return failed;
+}
+
+int test_periodic_keyframes() {
+    printf("\n--- Testing Keyframe Interval ---\n");
+    ws_stats_encoder_t encoder;
+    ws_stats_encoder_reset(&encoder);
+    ws_stats_t stats = sample_stats();
+    char frame[WS_STATS_FRAME_MAX];
+    int failed = 0;
+
+    int keyframes = 0;
+    for (int i = 0; i < 3 * CONFIG_WS_STATS_KEYFRAME_INTERVAL; i++) {
+        stats.values[WS_STATS_JOBS_RECEIVED]++;
+        size_t len = ws_stats_encode(&encoder, &stats, TRUE, frame, sizeof(frame));
+        frame[len] = '\0';
+        if (strstr(frame, "\"delta\"") == NULL) {
+            if (i % CONFIG_WS_STATS_KEYFRAME_INTERVAL != 0) {
+                printf("Failed: frame %d should be a delta.\n", i);
+                failed = 1;
+            }
+            keyframes++;
+        }
+    }
+    if (keyframes != 3) {
+        printf("Failed: expected 3 keyframes, got %d.\n", keyframes);
+        failed = 1;
+    }
+
+    // With deltas off every frame is full, changed or not
+    size_t len = ws_stats_encode(&encoder, &stats, FALSE, frame, sizeof(frame));
+    frame[len] = '\0';
+    if (len == 0 || strstr(frame, "\"delta\"") != NULL || strstr(frame, "avgServiceTime") == NULL) {
+        printf("Failed: delta off should send a full frame.\n");
+        failed = 1;
+    }
+
+    if (!failed) printf("Passed keyframe interval test.\n");
+    return failed;
+}
+
+int main() {
+    char test_name[] = "WS STATS";
+    print_test_start(test_name);
+
+    int total_tests = 0;
+    int failed_tests = 0;
+
+    RUN_TEST(test_keyframe_then_deltas());
+    RUN_TEST(test_periodic_keyframes());
+
+    int passed_tests = total_tests - failed_tests;
+    print_test_end(test_name, passed_tests, failed_tests);
+    return failed_tests > 0 ? 1 : 0;
+}